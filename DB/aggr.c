@@ -0,0 +1,432 @@
+/*
+ * This file implements native aggregation (COUNT,SUM,MIN,MAX,AVG) & GROUP BY
+ *
+
+AGPL License
+
+Copyright (c) 2011 Russell Sullivan <jaksprats AT gmail DOT com>
+ALL RIGHTS RESERVED
+
+   This file is part of ALCHEMY_DATABASE
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Affero General Public License as
+    published by the Free Software Foundation, either version 3 of the
+    License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Affero General Public License for more details.
+
+    You should have received a copy of the GNU Affero General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <assert.h>
+#include <limits.h>
+
+#include "redis.h"
+
+#include "xdb_hooks.h"
+#include "row.h"
+#include "parser.h"
+#include "colparse.h"
+#include "aobj.h"
+#include "query.h"
+#include "common.h"
+#include "aggr.h"
+
+/* NOTE:
+    SELECT k, COUNT(*), SUM(x), AVG(x) FROM t WHERE ... GROUP BY k
+    runs the normal (index driven) range scan, but instead of replying one
+    row per match, each matching row is folded into its group's accumulators
+    and ONE row per group is replied.
+      HASH:   groups live in a dict keyed by a memcmp()-comparable encoding of
+              the GROUP BY values, sorted by that key at the end of the scan
+      STREAM: when the scan's index IS the (single) GROUP BY column, rows
+              arrive already grouped -> only the current group is held and it
+              is replied when the key changes (no hash table, no sort)
+    NULLs are skipped by COUNT(col), SUM, MIN, MAX & AVG; LIMIT/OFFSET apply
+    to the groups (STREAM stops scanning once OFFSET+LIMIT groups are out).
+    Zero groups -> the reply is just the column header row.
+*/
+
+// GLOBALS
+extern r_tbl_t *Tbl;
+extern r_ind_t *Index;
+extern char     OUTPUT_DELIM;
+
+static char *AGGR_Desc[6] = {"", "COUNT", "SUM", "MIN", "MAX", "AVG"};
+
+// PROTOTYPES (from redis.c)
+unsigned int dictSdsHash(const void *key);
+int dictSdsKeyCompare(void *privdata, const void *key1, const void *key2);
+
+// SPEC SPEC SPEC SPEC SPEC SPEC SPEC SPEC SPEC SPEC SPEC SPEC SPEC SPEC
+void initAggr(aggr_t *ag, int tmatch, int ncols) {
+    bzero(ag, sizeof(aggr_t));
+    ag->tmatch = tmatch; ag->ncols = ncols;
+    ag->cols   = malloc(sizeof(agc_t) * ncols);          /* FREE ME 189 */
+    bzero(ag->cols, sizeof(agc_t) * ncols);
+    for (int i = 0; i < ncols; i++) {
+        INIT_ICOL(ag->cols[i].ic, -1) ag->cols[i].gbi = -1;
+    }
+}
+void releaseAggr(aggr_t *ag) {
+    if (!ag->cols) return;
+    for (int i = 0; i < ag->ncols; i++) {
+        releaseIC(&ag->cols[i].ic);
+        if (ag->cols[i].cname) sdsfree(ag->cols[i].cname);
+    }
+    free(ag->cols);                                      /* FREED 189 */
+    if (ag->reg) free(ag->reg);                          /* FREED 190 */
+    ag->cols = NULL; ag->reg = NULL;
+}
+static bool sameIC(icol_t *ic1, icol_t *ic2) {
+    if (ic1->cmatch != ic2->cmatch || ic1->nlo != ic2->nlo)      return 0;
+    for (uint32 i = 0; i < ic1->nlo; i++) {
+        if (strcmp(ic1->lo[i], ic2->lo[i]))                      return 0;
+    }
+    return 1;
+}
+void setAggrRegs(aggr_t *ag) { /* SUM(x), MIN(x), MAX(x) -> fetch x ONCE */
+    ag->reg  = malloc(sizeof(icol_t) * ag->ncols);       /* FREE ME 190 */
+    ag->nreg = 0;
+    for (int i = 0; i < ag->ncols; i++) {
+        agc_t *ac = &ag->cols[i];
+        if (ac->func == AGGR_NONE || ac->star) continue;
+        uint32 j;
+        for (j = 0; j < ag->nreg; j++) if (sameIC(&ag->reg[j], &ac->ic)) break;
+        if (j == ag->nreg) { ag->reg[j] = ac->ic; ag->nreg++; }
+        ac->reg = j;
+    }
+}
+bool validateAggr(cli *c, aggr_t *ag, wob_t *wb) {
+    if (wb->nob) { addReply(c, shared.aggr_orderby);               return 0; }
+    for (int i = 0; i < ag->ncols; i++) {
+        agc_t *ac = &ag->cols[i];
+        if (ac->func != AGGR_NONE) continue;
+        for (uint32 j = 0; j < wb->ngby; j++) {
+            if (sameIC(&ac->ic, &wb->gbc[j])) { ac->gbi = j; break; }
+        }
+        if (ac->gbi == -1) { addReply(c, shared.aggr_not_grouped); return 0; }
+    }
+    return 1;
+}
+bool canStreamAggr(cswc_t *w, wob_t *wb) {
+    if (wb->ngby != 1 || w->wtype == SQL_IN_LKP || w->wf.imatch == -1) return 0;
+    r_ind_t *ri = &Index[w->wf.imatch];
+    if (ri->luat || ri->fname)                                         return 0;
+    if (ri->virt) return !wb->gbc[0].cmatch && !wb->gbc[0].nlo;
+    return sameIC(&ri->icol, &wb->gbc[0]); /* NOTE: MCI -> 1st column */
+}
+
+// GROUPS GROUPS GROUPS GROUPS GROUPS GROUPS GROUPS GROUPS GROUPS GROUPS
+static void ownAobj(aobj *dest, aobj *src) { /* getCol() strings are in-row */
+    memcpy(dest, src, sizeof(aobj)); dest->ic = NULL;
+    if (src->s && (C_IS_S(src->type) || src->enc == COL_TYPE_STRING)) {
+        dest->s      = malloc(src->len ? src->len : 1);
+        memcpy(dest->s, src->s, src->len);
+        dest->freeme = 1;
+    } else dest->freeme = 0;
+}
+static uchar *beBytes(uchar *b, uint128 x, int n) {
+    for (int i = n - 1; i >= 0; i--) { b[i] = (uchar)(x & 0xFF); x >>= 8; }
+    return b;
+}
+static sds encGroupVal(sds k, aobj *a) {
+    uchar b[16];
+    if (a->empty) return sdscatlen(k, "\0", 1);       /* NULLs group first */
+    k = sdscatlen(k, "\1", 1);
+    if      C_IS_I(a->type) return sdscatlen(k, beBytes(b, a->i, 4),  4);
+    else if C_IS_L(a->type) return sdscatlen(k, beBytes(b, a->l, 8),  8);
+    else if C_IS_X(a->type) return sdscatlen(k, beBytes(b, a->x, 16), 16);
+    else if C_IS_F(a->type) {
+        uint32 u; float f = (a->f == 0.0) ? 0.0 : a->f; /* -0 == 0 */
+        memcpy(&u, &f, sizeof(uint32));
+        u = (u & 0x80000000) ? ~u : (u | 0x80000000);
+        return sdscatlen(k, beBytes(b, u, 4), 4);
+    }
+    sds   t = NULL; char *s; uint32 len;
+    if (C_IS_S(a->type)) { s = a->s; len = a->len; }
+    else { t = createSDSFromAobj(a); s = t; len = sdslen(t); }
+    for (uint32 i = 0; i < len; i++) { /* escape \0 -> \0\xFF, end: \0\0 */
+        if (s[i]) k = sdscatlen(k, &s[i], 1);
+        else      k = sdscatlen(k, "\0\xFF", 2);
+    }
+    if (t) sdsfree(t);
+    return sdscatlen(k, "\0\0", 2);
+}
+static agrp_t *newGroup(agst_t *as, aobj *gv) {
+    aggr_t *ag   = as->ag; uint32 ngby = as->wb->ngby;
+    agrp_t *grp  = malloc(sizeof(agrp_t));               /* FREE ME 191 */
+    grp->key     = sdsdup(as->kbuf);                     /* FREE ME 192 */
+    grp->gv      = ngby ? malloc(sizeof(aobj) * ngby) : NULL; /* FREE ME 193 */
+    for (uint32 i = 0; i < ngby; i++) ownAobj(&grp->gv[i], &gv[i]);
+    grp->acc     = malloc(sizeof(aacc_t) * ag->ncols);  /* FREE ME 194 */
+    bzero(grp->acc, sizeof(aacc_t) * ag->ncols);
+    for (int j = 0; j < ag->ncols; j++) initAobj(&grp->acc[j].v);
+    return grp;
+}
+static void destroyGroup(agst_t *as, agrp_t *grp) {
+    for (uint32 i = 0; i < as->wb->ngby; i++) releaseAobj(&grp->gv[i]);
+    for (int    j = 0; j < as->ag->ncols; j++) releaseAobj(&grp->acc[j].v);
+    if (grp->gv) free(grp->gv);                          /* FREED 193 */
+    free(grp->acc);                                      /* FREED 194 */
+    sdsfree(grp->key);                                   /* FREED 192 */
+    free(grp);                                           /* FREED 191 */
+}
+static void aggrGroupDestructor(void *privdata, void *val) {
+    destroyGroup((agst_t *)privdata, (agrp_t *)val);
+}
+/* Group->dict, keys are the group's own key (freed w/ the group) */
+static dictType aggrGroupDictType = {
+    dictSdsHash,                /* hash function */
+    NULL,                       /* key dup */
+    NULL,                       /* val dup */
+    dictSdsKeyCompare,          /* key compare */
+    NULL,                       /* key destructor */
+    aggrGroupDestructor         /* val destructor */
+};
+
+// ACCUMULATE ACCUMULATE ACCUMULATE ACCUMULATE ACCUMULATE ACCUMULATE
+#define CMP3(a, b) (((a) == (b)) ? 0 : ((a) < (b)) ? -1 : 1)
+static int aggrCmp(aobj *a, aobj *b) {
+    if      C_IS_I(a->type) return CMP3(a->i, b->i);
+    else if C_IS_L(a->type) return CMP3(a->l, b->l);
+    else if C_IS_X(a->type) return CMP3(a->x, b->x);
+    else if C_IS_F(a->type) return CMP3(a->f, b->f);
+    else if C_IS_S(a->type) {
+        uint32 n = (a->len < b->len) ? a->len : b->len;
+        int    r = memcmp(a->s, b->s, n);
+        return r ? r : CMP3(a->len, b->len);
+    }
+    sds sa = createSDSFromAobj(a); sds sb = createSDSFromAobj(b);
+    int r  = sdscmp(sa, sb); sdsfree(sa); sdsfree(sb);
+    return r;
+}
+static void accumGroup(agst_t *as,  agrp_t *grp, bt *btr, aobj *apk,
+                       void   *rrow) {
+    aggr_t *ag = as->ag;
+    aobj    ra[ag->nreg + 1];
+    bool    rf[ag->nreg + 1]; bzero(rf, sizeof(bool) * (ag->nreg + 1));
+    for (int j = 0; j < ag->ncols; j++) {
+        agc_t  *ac  = &ag->cols[j];
+        aacc_t *acc = &grp->acc[j];
+        if (ac->func == AGGR_NONE) continue;
+        if (ac->star) { acc->cnt++; continue; }
+        aobj   *a   = &ra[ac->reg];
+        if (!rf[ac->reg]) {
+            *a = getCol(btr, rrow, ac->ic, apk, ag->tmatch, NULL);
+            rf[ac->reg] = 1;
+        }
+        if (a->empty) continue;                     /* NULLs are skipped */
+        acc->cnt++;
+        if        (ac->func == AGGR_SUM || ac->func == AGGR_AVG) {
+            if C_IS_F(a->type) acc->d += a->f;
+            else {
+                uint128 v = C_IS_I(a->type) ? (uint128)a->i :
+                            C_IS_L(a->type) ? (uint128)a->l : a->x;
+                acc->x += v; acc->d += (double)v;
+            }
+        } else if (ac->func == AGGR_MIN || ac->func == AGGR_MAX) {
+            int r = acc->v.empty ? 0 : aggrCmp(a, &acc->v);
+            if (acc->v.empty || (ac->func == AGGR_MIN && r < 0) ||
+                                (ac->func == AGGR_MAX && r > 0)) {
+                releaseAobj(&acc->v); ownAobj(&acc->v, a);
+            }
+        }
+    }
+    for (uint32 i = 0; i < ag->nreg; i++) if (rf[i]) releaseAobj(&ra[i]);
+}
+
+// OUTPUT OUTPUT OUTPUT OUTPUT OUTPUT OUTPUT OUTPUT OUTPUT OUTPUT OUTPUT
+static void initDoubleCell(aobj *a, double d) {
+    char buf[64]; snprintf(buf, 64, FLOAT_FMT, d);
+    initAobjFloat(a, (float)d); /* EMBEDDED reads a->f, text keeps double */
+    a->s   = _strdup(buf); a->len = strlen(buf);
+    a->enc = COL_TYPE_STRING; a->freeme = 1;
+}
+static void setCell(aobj *cell, aggr_t *ag, agrp_t *grp, int j) {
+    agc_t  *ac  = &ag->cols[j];
+    aacc_t *acc = &grp->acc[j];
+    initAobj(cell);
+    if        (ac->func == AGGR_NONE) { /* shallow, group owns it */
+        memcpy(cell, &grp->gv[ac->gbi], sizeof(aobj)); cell->freeme = 0;
+    } else if (ac->func == AGGR_COUNT) {
+        initAobjLong(cell, (ulong)acc->cnt);
+    } else if (!acc->cnt) {
+        return;                                     /* NULL (no values) */
+    } else if (ac->func == AGGR_AVG) {
+        initDoubleCell(cell, acc->d / (double)acc->cnt);
+    } else if (ac->func == AGGR_SUM) {
+        if      C_IS_F(ac->ctype)                   initDoubleCell(cell, acc->d);
+        else if (C_IS_X(ac->ctype) || acc->x > (uint128)ULONG_MAX) {
+            initAobjU128(cell, acc->x);
+        } else                                      initAobjLong(cell, acc->x);
+    } else { /* MIN, MAX -> shallow, group owns it */
+        memcpy(cell, &acc->v, sizeof(aobj)); cell->freeme = 0;
+    }
+}
+static sds catCellRedis(sds s, aobj *a) {
+    if      (a->empty)       return sdscatlen(s, ":-1\r\n", 5);
+    else if C_IS_I(a->type)  return sdscatprintf(s, ":%u\r\n",  a->i);
+    else if C_IS_L(a->type)  return sdscatprintf(s, ":%lu\r\n", a->l);
+    sds t = createSDSFromAobj(a);
+    s     = sdscatprintf(s, "$%lu\r\n", (ulong)sdslen(t));
+    s     = sdscatlen(s, t, sdslen(t)); sdsfree(t);
+    return sdscatlen(s, "\r\n", 2);
+}
+static sds catCellNormal(sds s, aobj *a) {
+    if (a->empty) return s;
+    sds  t = createSDSFromAobj(a);
+    bool q = C_IS_S(a->type) && sdslen(t);
+    if (q) s = sdscatlen(s, "'", 1);
+    s      = sdscatlen(s, t, sdslen(t)); sdsfree(t);
+    if (q) s = sdscatlen(s, "'", 1);
+    return s;
+}
+static robj *outputAggrRow(int ncols, aobj *cells) {
+    if (EREDIS) {
+        robj   *r  = createObject(REDIS_STRING, NULL);
+        erow_t *er = malloc(sizeof(erow_t));
+        er->ncols  = ncols;
+        er->cols   = malloc(sizeof(aobj *) * ncols);
+        for (int i = 0; i < ncols; i++) er->cols[i] = cloneAobj(&cells[i]);
+        r->ptr = er; return r;
+    }
+    if (LREDIS) {
+        CLEAR_LUA_STACK
+        lua_getglobal(server.lua, server.alc.OutputLuaFunc_Row);
+        for (int i = 0; i < ncols; i++) {
+            if (cells[i].empty) { lua_pushnil(server.lua); continue; }
+            sds t = createSDSFromAobj(&cells[i]);
+            lua_pushlstring(server.lua, t, sdslen(t)); sdsfree(t);
+        }
+        int ret = DXDB_lua_pcall(server.lua, ncols, 1, 0);
+        sds s   = ret ? sdsempty()                                    :
+                        sdsnewlen((char*)lua_tostring(server.lua, -1),
+                                  lua_strlen(server.lua, -1));
+        CLEAR_LUA_STACK
+        return createObject(REDIS_STRING, s);
+    }
+    sds s = OREDIS ? sdscatprintf(sdsempty(), "*%d\r\n", ncols) : sdsempty();
+    for (int i = 0; i < ncols; i++) {
+        if OREDIS s = catCellRedis(s, &cells[i]);
+        else {
+            if (i) s = sdscatlen(s, &OUTPUT_DELIM, 1);
+            s = catCellNormal(s, &cells[i]);
+        }
+    }
+    return createObject(REDIS_STRING, s);
+}
+static bool emitGroup(agst_t *as, agrp_t *grp) {
+    INCR(as->ngrp)
+    if (as->ofst > 0   && as->ngrp <= as->ofst) return 1;
+    if (as->lim != -1  && as->sent >= as->lim)  return 1;
+    aggr_t *ag = as->ag;
+    aobj    cells[ag->ncols];
+    for (int j = 0; j < ag->ncols; j++) setCell(&cells[j], ag, grp, j);
+    robj   *r   = outputAggrRow(ag->ncols, cells);
+    for (int j = 0; j < ag->ncols; j++) releaseAobj(&cells[j]);
+    bool    ret = addReplyRow(as->c, r, -1, NULL, NULL, 0, NULL, 0);
+    decrRefCount(r);
+    INCR(as->sent)
+    return ret;
+}
+
+// RUN RUN RUN RUN RUN RUN RUN RUN RUN RUN RUN RUN RUN RUN RUN RUN RUN RUN
+void initAggrState(agst_t *as, cli *c, aggr_t *ag, cswc_t *w, wob_t *wb) {
+    bzero(as, sizeof(agst_t));
+    as->c    = c;       as->ag   = ag;       as->wb  = wb;
+    as->lim  = wb->lim; as->ofst = wb->ofst;
+    as->strm = canStreamAggr(w, wb);
+    /* HASH: the scan must see EVERY matching row, STREAM: groups arrive in
+       order -> the scan stops after OFFSET+LIMIT groups (card: groups) */
+    wb->ofst = -1;
+    wb->lim  = (as->strm && as->lim != -1) ?
+                 as->lim + ((as->ofst > 0) ? as->ofst : 0) : -1;
+    if (!as->strm) as->groups = dictCreate(&aggrGroupDictType, as);//FREE 195
+    as->kbuf = sdsempty();                               /* FREE ME 196 */
+}
+bool aggrRow(agst_t *as, bt *btr, aobj *apk, void *rrow) {
+    wob_t  *wb  = as->wb;
+    aobj    gv[MAX_GROUP_BY_COLS];
+    as->kbuf    = sdscpylen(as->kbuf, "", 0);
+    for (uint32 i = 0; i < wb->ngby; i++) {
+        gv[i]    = getCol(btr, rrow, wb->gbc[i], apk, as->ag->tmatch, NULL);
+        as->kbuf = encGroupVal(as->kbuf, &gv[i]);
+    }
+    agrp_t *grp; bool ret = 1;
+    if (as->strm) {
+        if (as->cg && sdscmp(as->cg->key, as->kbuf)) { /* key changed */
+            ret = emitGroup(as, as->cg); destroyGroup(as, as->cg); as->cg = NULL;
+        }
+        if (!as->cg) as->cg = newGroup(as, gv);
+        grp = as->cg;
+    } else {
+        dictEntry *de = dictFind(as->groups, as->kbuf);
+        if (de) grp = dictGetEntryVal(de);
+        else {
+            grp = newGroup(as, gv); ASSERT_OK(dictAdd(as->groups, grp->key, grp));
+        }
+    }
+    for (uint32 i = 0; i < wb->ngby; i++) releaseAobj(&gv[i]);
+    accumGroup(as, grp, btr, apk, rrow);
+    return ret;
+}
+static int cmpGroupKey(const void *a, const void *b) {
+    return sdscmp((*(agrp_t **)a)->key, (*(agrp_t **)b)->key);
+}
+bool finishAggr(agst_t *as) {
+    bool ret = 1;
+    if (as->strm) {
+        if (as->cg) {
+            ret = emitGroup(as, as->cg); destroyGroup(as, as->cg); as->cg = NULL;
+        }
+    } else if (dictSize(as->groups)) {
+        long          n    = (long)dictSize(as->groups); long i = 0;
+        agrp_t      **grps = malloc(sizeof(agrp_t *) * n);  /* FREE ME 197 */
+        dictEntry    *de;
+        dictIterator *di   = dictGetIterator(as->groups);
+        while((de = dictNext(di))) grps[i++] = dictGetEntryVal(de);
+        dictReleaseIterator(di);
+        qsort(grps, n, sizeof(agrp_t *), cmpGroupKey);
+        for (i = 0; i < n; i++) if (!(ret = emitGroup(as, grps[i]))) break;
+        free(grps);                                         /* FREED 197 */
+    }
+    if (ret && !as->wb->ngby && !as->ngrp) { /* no rows -> ONE row [0,NULL] */
+        as->kbuf    = sdscpylen(as->kbuf, "", 0);
+        agrp_t *grp = newGroup(as, NULL);
+        ret         = emitGroup(as, grp); destroyGroup(as, grp);
+    }
+    return ret;
+}
+void releaseAggrState(agst_t *as) {
+    as->wb->lim = as->lim; as->wb->ofst = as->ofst;
+    if (as->cg)     destroyGroup(as, as->cg);
+    if (as->groups) dictRelease(as->groups);                 /* FREED 195 */
+    sdsfree(as->kbuf);                                       /* FREED 196 */
+}
+
+// EXPLAIN EXPLAIN EXPLAIN EXPLAIN EXPLAIN EXPLAIN EXPLAIN EXPLAIN EXPLAIN
+void dumpAggr(printer *prn, aggr_t *ag, wob_t *wb, cswc_t *w) {
+    (*prn)("\tAGGREGATE: %s ncols: %d nreg: %u ngby: %u\n",
+            canStreamAggr(w, wb) ? "STREAM (GROUP BY index order)" : "HASH",
+            ag->ncols, ag->nreg, wb->ngby);
+    for (int i = 0; i < ag->ncols; i++) {
+        agc_t *ac = &ag->cols[i];
+        if (ac->func == AGGR_NONE) {
+            (*prn)("\t\t%d: GROUP_COL[%d] %s\n", i, ac->gbi, ac->cname);
+        } else {
+            (*prn)("\t\t%d: %s %s", i, AGGR_Desc[ac->func], ac->cname);
+            if (!ac->star) (*prn)(" R%u", ac->reg);
+            (*prn)("\n");
+        }
+    }
+}
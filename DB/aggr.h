@@ -0,0 +1,103 @@
+/*
+ * This file implements native aggregation (COUNT,SUM,MIN,MAX,AVG) & GROUP BY
+ *
+
+AGPL License
+
+Copyright (c) 2011 Russell Sullivan <jaksprats AT gmail DOT com>
+ALL RIGHTS RESERVED
+
+   This file is part of ALCHEMY_DATABASE
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Affero General Public License as
+    published by the Free Software Foundation, either version 3 of the
+    License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Affero General Public License for more details.
+
+    You should have received a copy of the GNU Affero General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __ALCHEMY_AGGR__H
+#define __ALCHEMY_AGGR__H
+
+#include "adlist.h"
+#include "dict.h"
+#include "redis.h"
+
+#include "btreepriv.h"
+#include "query.h"
+#include "xdb_common.h"
+#include "common.h"
+
+#define AGGR_NONE  0 /* GROUP BY column, echoed once per group */
+#define AGGR_COUNT 1
+#define AGGR_SUM   2
+#define AGGR_MIN   3
+#define AGGR_MAX   4
+#define AGGR_AVG   5
+
+typedef struct aggr_col {
+    uchar    func;   /* AGGR_*                                          */
+    bool     star;   /* COUNT(*)                                        */
+    icol_t   ic;
+    uchar    ctype;  /* type of ic (COUNT(*) -> COL_TYPE_NONE)          */
+    int      gbi;    /* AGGR_NONE: slot in wob_t.gbc[]                  */
+    uint32   reg;    /* column register (fetched once per row)          */
+    sds      cname;  /* column header (e.g. "SUM(x)")                   */
+} agc_t;
+
+typedef struct aggr_select {
+    int      tmatch;
+    int      ncols;
+    agc_t   *cols;
+    uint32   nreg;   /* distinct aggregated columns                     */
+    icol_t  *reg;    /* NOTE: referential (cols[].ic)                   */
+} aggr_t;
+
+typedef struct aggr_acc {
+    long     cnt;    /* COUNT & AVG divisor: non-NULL values seen       */
+    uint128  x;      /* SUM [INT,LONG,U128]                             */
+    double   d;      /* SUM [FLOAT], AVG                                */
+    aobj     v;      /* MIN/MAX (owns its string)                       */
+} aacc_t;
+
+typedef struct aggr_group {
+    sds      key;    /* memcmp() comparable encoding of gv[]            */
+    aobj    *gv;     /* GROUP BY values (owned)                         */
+    aacc_t  *acc;    /* one per aggr_col                                */
+} agrp_t;
+
+typedef struct aggr_state {
+    cli     *c;
+    aggr_t  *ag;
+    wob_t   *wb;
+    long     lim;    /* LIMIT & OFFSET apply to GROUPS, not rows        */
+    long     ofst;
+    bool     strm;   /* rows arrive in GROUP BY order -> no hash table  */
+    dict    *groups; /* HASH: key -> agrp_t                             */
+    agrp_t  *cg;     /* STREAM: current group                           */
+    sds      kbuf;   /* group key of the current row                    */
+    long     ngrp;
+    long     sent;
+} agst_t;
+
+void initAggr   (aggr_t *ag, int tmatch, int ncols);
+void releaseAggr(aggr_t *ag);
+void setAggrRegs(aggr_t *ag);
+bool validateAggr(cli *c, aggr_t *ag, wob_t *wb);
+bool canStreamAggr(cswc_t *w, wob_t *wb);
+
+void initAggrState   (agst_t *as, cli *c, aggr_t *ag, cswc_t *w, wob_t *wb);
+bool aggrRow         (agst_t *as, bt  *btr, aobj *apk, void *rrow);
+bool finishAggr      (agst_t *as);
+void releaseAggrState(agst_t *as);
+
+void dumpAggr(printer *prn, aggr_t *ag, wob_t *wb, cswc_t *w);
+
+#endif /* __ALCHEMY_AGGR__H */
@@ -49,6 +49,12 @@ ALL RIGHTS RESERVED
 #include "desc.h"
 #include "bt.h"
 #include "filter.h"
+#include "fprog.h"
+#include "bitmap.h"
+#include "rowstore.h"
+#include "aof_row.h"
+#include "evict.h"
+#include "mmtbl.h"
 #include "index.h"
 #include "range.h"
 #include "cr8tblas.h"
@@ -80,7 +86,8 @@ aobj_cmp *OP_CMP[NOP] = {NULL, aobjEQ, aobjNE, aobjLT, aobjLE, aobjGT, aobjGE,
                             NULL,         NULL,  NULL};
 /* NOTE ranges (<,<=,>,>=) comparison functions are opposite of intuition */
 
-char *RangeType[5] = {"ERROR", "SINGLE_PK", "RANGE", "IN", "SINGLE_FK"};
+char *RangeType[6] = {"ERROR", "SINGLE_PK", "RANGE", "IN", "SINGLE_FK",
+                      "BITMAP"};
 
 /* PROTOTYPES */
 static int updateAction(cli *c, char *u_vallist, aobj *u_apk, int u_tmatch);
@@ -107,47 +114,35 @@ static void addRowSizeReply(cli *c, int tmatch, bt *btr, int len) {
   printf("SINGLE ROW UPDATE: exists: %d miss: %d upx: %d\n",                 \
          exists, dwm.miss, upx);
 
-uchar insertCommit(cli  *c,      sds     uset,   sds     vals,
-                   int   ncols,  int     tmatch, int     matches,
-                   int   inds[], int     pcols,  list   *cmatchl,
-                   bool  repl,   uint32  upd,    uint32 *tsize,
-                   bool  parse,  sds    *key) {
-    CMATCHS_FROM_CMATCHL twoint cofsts[ncols];
-    for (int i = 0; i < ncols; i++) cofsts[i].i = cofsts[i].j = -1;
+static bool pkToAobj(cli *c, char *pk, int pklen, uchar pktyp, aobj *apk) {
+    apk->type       = apk->enc = pktyp; apk->empty = 0;
+    if        C_IS_I(pktyp) {
+        long l      = atol(pk);                            /* OK: DELIM: \0 */
+        if (l >= TWO_POW_32) { addReply(c, shared.uint_pkbig);       return 0; }
+        apk->i      = (int)l;
+    } else if C_IS_L(pktyp) apk->l = strtoul(pk, NULL, 10);/* OK: DELIM: \0 */
+      else if C_IS_X(pktyp) {
+          bool r = parseU128(pk, &apk->x);
+          if (!r) { addReply(c, shared.u128_parse);                  return 0; }
+    } else if C_IS_F(pktyp) apk->f = atof(pk);             /* OK: DELIM: \0 */
+      else if C_IS_S(pktyp) {
+        apk->s      = pk; apk->len = pklen; apk->freeme = 0;/* caller frees pk*/
+    } else assert(!"insertCommit ERROR");
+    return 1;
+}
+static uchar insertRow(cli    *c,      sds     uset,    char   *mvals,
+                       twoint  cofsts[], char   *pk,      int     pklen,
+                       bool    ai,       int     ncols,   int     tmatch,
+                       int     matches,  int     inds[],  bool    repl,
+                       uint32  upd,      uint32 *tsize) {
     aobj     apk; initAobj(&apk);
     bool     ret    = INS_ERR;    /* presume failure */
     void    *nrow   = NULL;       /* B4 GOTO */
-    sds      pk     = NULL;
-    int      pklen  = 0;                            // NEEDED? use sdslen(pk)
     r_tbl_t *rt     = &Tbl[tmatch];
     bt      *btr    = getBtr(tmatch);
-    int      lncols = ncols;
-    if (rt->lrud) lncols--; if (rt->lfu) lncols--; // INSERT CANT have LRU/LFU
-    bool     ai     = 0;    // AUTO-INCREMENT
-    char    *mvals  = parseRowVals(vals, &pk, &pklen, ncols, cofsts, tmatch,
-                                   pcols, ics, lncols, &ai); // ERR NOW GOTO
     if (!mvals) { addReply(c, shared.insertcolumn);                goto insc_e;}
-    if (parse) { // used in cluster-mode to get sk's value
-        int skl = cofsts[rt->sk].j - cofsts[rt->sk].i;
-        sds sk  = rt->sk ? sdsnewlen(mvals + cofsts[rt->sk].i, skl) : pk;
-        *key    = sdscatprintf(sdsempty(), "%s=%s.%s", 
-                               sk, rt->name, rt->col[rt->sk].name);
-        return ret;
-    }
     int      pktyp  = rt->col[0].type;
-    apk.type        = apk.enc = pktyp; apk.empty = 0;
-    if        C_IS_I(pktyp) {
-        long l      = atol(pk);                            /* OK: DELIM: \0 */
-        if (l >= TWO_POW_32) { addReply(c, shared.uint_pkbig);     goto insc_e;}
-        apk.i       = (int)l;
-    } else if C_IS_L(pktyp) apk.l = strtoul(pk, NULL, 10); /* OK: DELIM: \0 */
-      else if C_IS_X(pktyp) {
-          bool r = parseU128(pk, &apk.x); 
-          if (!r) { addReply(c, shared.u128_parse);                goto insc_e;}
-    } else if C_IS_F(pktyp) apk.f = atof(pk);              /* OK: DELIM: \0 */
-      else if C_IS_S(pktyp) {
-        apk.s       = pk; apk.len = pklen; apk.freeme = 0; /* pk freed below */
-    } else assert(!"insertCommit ERROR");
+    if (!pkToAobj(c, pk, pklen, pktyp, &apk))                      goto insc_e;
     int    len      = 0;
     dwm_t  dwm      = btFindD(btr, &apk);
     void  *orow     = dwm.k;
@@ -183,7 +178,9 @@ uchar insertCommit(cli  *c,      sds     uset,   sds     vals,
         }
         //printf("repl: %d orow: %p upd: %d miss: %d exists: %d key: ",
         //     repl, orow, upd, dwm.miss, exists); dumpAobj(printf, &apk);
-        len = repl ? btReplace(btr, &apk, nrow) : btAdd(btr, &apk, nrow);
+        len = (repl && orow) ? btReplace(btr, &apk, nrow) :
+                               btAdd    (btr, &apk, nrow);
+        aofRowLog(tmatch, AOFROW_PUT, &apk, nrow);
         UPDATE_AUTO_INC(pktyp, &apk)
         ret = INS_INS;            /* negate presumed failure */
     }
@@ -200,6 +197,241 @@ insc_e:
     releaseAobj(&apk);
     return ret;
 }
+uchar insertCommit(cli  *c,      sds     uset,   sds     vals,
+                   int   ncols,  int     tmatch, int     matches,
+                   int   inds[], int     pcols,  list   *cmatchl,
+                   bool  repl,   uint32  upd,    uint32 *tsize,
+                   bool  parse,  sds    *key) {
+    CMATCHS_FROM_CMATCHL twoint cofsts[ncols];
+    for (int i = 0; i < ncols; i++) cofsts[i].i = cofsts[i].j = -1;
+    sds      pk     = NULL;
+    int      pklen  = 0;                            // NEEDED? use sdslen(pk)
+    r_tbl_t *rt     = &Tbl[tmatch];
+    int      lncols = insertableColCount(tmatch);
+    bool     ai     = 0;    // AUTO-INCREMENT
+    char    *mvals  = parseRowVals(vals, &pk, &pklen, ncols, cofsts, tmatch,
+                                   pcols, ics, lncols, &ai);
+    if (mvals && parse) { // used in cluster-mode to get sk's value
+        int skl = cofsts[rt->sk].j - cofsts[rt->sk].i;
+        sds sk  = rt->sk ? sdsnewlen(mvals + cofsts[rt->sk].i, skl) : pk;
+        *key    = sdscatprintf(sdsempty(), "%s=%s.%s", 
+                               sk, rt->name, rt->col[rt->sk].name);
+        return INS_ERR;
+    }
+    return insertRow(c, uset, mvals, cofsts, pk, pklen, ai, ncols, tmatch,
+                     matches, inds, repl, upd, tsize);
+}
+
+// MULTI_ROW_INSERT MULTI_ROW_INSERT MULTI_ROW_INSERT MULTI_ROW_INSERT
+/* NOTE: a multi-row INSERT is applied as a batch: every row is parsed &
+         checked (PK dups in the batch & in the table) before anything is
+         written, the new rows are then added to each index sorted by that
+         index's key & to the table sorted by PK (sorted btree inserts walk
+         the same hot path). An error leaves the table untouched */
+typedef struct ins_row {
+    char   *pk;    int     pklen;
+    aobj    apk;
+    char   *mvals; twoint *cofsts;
+    void   *nrow;
+} irow_t;
+typedef struct ins_key {
+    aobj    k;     irow_t *ir;
+} ikey_t;
+
+static int irowPKCmp(const void *a, const void *b) {
+    return aobjKeyCmp(&(*(irow_t **)a)->apk, &(*(irow_t **)b)->apk);
+}
+static int ikeyCmp(const void *a, const void *b) {
+    return aobjKeyCmp(&((ikey_t *)a)->k, &((ikey_t *)b)->k);
+}
+static bool sortableIndex(r_ind_t *ri) {
+    return !ri->virt && !ri->fname && !ri->hlt && !ri->icol.nlo &&
+           ri->icol.cmatch > 0;
+}
+/* add every row to index[imatch] in index-key order, ROLLBACK on failure */
+static bool batchAddToIndex(cli *c, bt *btr, irow_t **irs, int nrows,
+                            int imatch, int tmatch) {
+    r_ind_t *ri = &Index[imatch];
+    if (!sortableIndex(ri)) {
+        for (int k = 0; k < nrows; k++) {
+            if (!addToIndex(c, btr, &irs[k]->apk, irs[k]->nrow, imatch)) {
+                for (int j = 0; j < k; j++) {
+                    delFromIndex(btr, &irs[j]->apk, irs[j]->nrow, imatch, 0);
+                }
+                return 0;
+            }
+        }
+        return 1;
+    }
+    ikey_t *iks = malloc(sizeof(ikey_t) * nrows);            /* FREE ME 203 */
+    for (int k = 0; k < nrows; k++) {
+        iks[k].ir = irs[k];
+        iks[k].k  = getCol(btr, irs[k]->nrow, ri->icol, &irs[k]->apk,
+                           tmatch, NULL);
+    }
+    qsort(iks, nrows, sizeof(ikey_t), ikeyCmp);
+    bool ok = 1;
+    for (int k = 0; k < nrows; k++) {
+        irow_t *ir = iks[k].ir;
+        if (!addToIndex(c, btr, &ir->apk, ir->nrow, imatch)) {
+            for (int j = 0; j < k; j++) {
+                ir = iks[j].ir;
+                delFromIndex(btr, &ir->apk, ir->nrow, imatch, 0);
+            }
+            ok = 0; break;
+        }
+    }
+    for (int k = 0; k < nrows; k++) releaseAobj(&iks[k].k);
+    free(iks);                                               /* FREED 203 */
+    return ok;
+}
+static bool insertBatch(cli *c,       int   tmatch, sds *tups,   int nrows,
+                        int  ncols,   int   matches, int inds[], int pcols,
+                        icol_t *ics,  uint32 *tsize) {
+    r_tbl_t *rt     = &Tbl[tmatch];
+    bt      *btr    = getBtr(tmatch);
+    uchar    pktyp  = rt->col[0].type;
+    int      lncols = insertableColCount(tmatch);
+    uint128  ainc   = rt->ainc;
+    bool     ret    = 0;
+    int      nidx   = 0;  /* indexes w/ the batch in them (for ROLLBACK) */
+    irow_t  *rows   = calloc(nrows, sizeof(irow_t));         /* FREE ME 204 */
+    irow_t **irs    = malloc(sizeof(irow_t *) * nrows);      /* FREE ME 205 */
+    twoint  *cofsts = malloc(sizeof(twoint) * nrows * ncols);/* FREE ME 206 */
+    for (int k = 0; k < nrows; k++) { /* PARSE: every row, nothing written */
+        irow_t *ir = &rows[k]; irs[k] = ir;
+        ir->cofsts = cofsts + (k * ncols); initAobj(&ir->apk);
+        for (int i = 0; i < ncols; i++) ir->cofsts[i].i = ir->cofsts[i].j = -1;
+        bool ai    = 0;
+        ir->mvals  = parseRowVals(tups[k], &ir->pk, &ir->pklen, ncols,
+                                  ir->cofsts, tmatch, pcols, ics, lncols, &ai);
+        if (!ir->mvals) { addReply(c, shared.insertcolumn);       goto insb_e; }
+        if (!pkToAobj(c, ir->pk, ir->pklen, pktyp, &ir->apk))     goto insb_e;
+        UPDATE_AUTO_INC(pktyp, &ir->apk) // next AUTO-INC as if row-by-row
+        if (rt->dirty && !ai) { // INSERT on DIRTY w/ PK declation PROHIBITED
+            addReply(c, shared.insert_dirty_pkdecl);              goto insb_e;
+        }
+    }
+    qsort(irs, nrows, sizeof(irow_t *), irowPKCmp);
+    for (int k = 0; k < nrows; k++) { /* PK must be new (batch & table) */
+        if (k && !aobjKeyCmp(&irs[k - 1]->apk, &irs[k]->apk)) {
+            addReply(c, shared.insert_ovrwrt);                    goto insb_e;
+        }
+        dwm_t dwm = btFindD(btr, &irs[k]->apk);
+        if ((dwm.k || dwm.miss) && !IS_GHOST(btr, dwm.k)) {
+            addReply(c, shared.insert_ovrwrt);                    goto insb_e;
+        }
+    }
+    for (int k = 0; k < nrows; k++) {
+        irow_t *ir = irs[k];
+        ir->nrow   = createRow(c, &ir->apk, btr, tmatch, ncols, ir->mvals,
+                               ir->cofsts);
+        if (!ir->nrow) /* e.g. (UINT_COL > 4GB) error */          goto insb_e;
+    }
+    for (; nidx < matches; nidx++) {
+        if (Index[inds[nidx]].hlt) continue;
+        if (!batchAddToIndex(c, btr, irs, nrows, inds[nidx], tmatch)) {
+                                                                  goto insb_e;
+        }
+    }
+    lua_getglobal (server.lua, "run_ALL_AQ"); // set ALL LuaTables
+    DXDB_lua_pcall(server.lua, 0, 0, 0);
+    for (int k = 0; k < nrows; k++) {
+        irow_t *ir = irs[k];
+        if (rt->nltrgr) {
+            runLuaTriggerInsertIndexes(c, btr, &ir->apk, ir->nrow,
+                                       matches, inds);
+        }
+        int len = btAdd(btr, &ir->apk, ir->nrow);
+        aofRowLog(tmatch, AOFROW_PUT, &ir->apk, ir->nrow);
+        if (tsize) *tsize = *tsize + len;
+        server.dirty++;
+    }
+    ret = 1;
+
+insb_e:
+    if (!ret) {
+        for (int i = 0; i < nidx; i++) { /* ROLLBACK previous ADD-INDEXes */
+            if (Index[inds[i]].hlt) continue;
+            for (int k = 0; k < nrows; k++) {
+                delFromIndex(btr, &irs[k]->apk, irs[k]->nrow, inds[i], 0);
+            }
+        }
+        rt->ainc = ainc;
+        lua_getglobal (server.lua, "reset_AQ");
+        DXDB_lua_pcall(server.lua, 0, 0, 0);
+    }
+    for (int k = 0; k < nrows; k++) {
+        irow_t *ir = &rows[k];
+        if (ir->nrow && NORM_BT(btr)) free(ir->nrow);        /* FREED 023 */
+        if (ir->pk)                   free(ir->pk);          /* FREED 021 */
+        releaseAobj(&ir->apk);
+    }
+    free(cofsts); free(irs); free(rows);               /* FREED 204,205,206 */
+    return ret;
+}
+static bool batchableInsert(int tmatch, int nrows) {
+    r_tbl_t *rt = &Tbl[tmatch];
+    return nrows > 1 && NORM_BT(getBtr(tmatch)) && !rt->hashy;
+}
+/* "(..),(..),(..)" -> one sds per tuple in tups[] (tups == NULL: count only)
+   NOTE: a malformed tail stays in one tuple, parseRowVals() rejects it */
+static int splitTuples(char *s, sds *tups) {
+    int n = 0;
+    while (1) {
+        char *e = get_next_insert_tuple(s);
+        char *x = e; if (x) SKIP_SPACES(x)
+        if (!e || (*x && *x != ',')) {
+            if (tups) tups[n] = sdsnew(s);
+            return n + 1;
+        }
+        if (tups) tups[n] = sdsnewlen(s, e - s);
+        n++; if (!*x) return n;
+        s = x + 1;
+    }
+}
+/* RETURNS: number of tuples in argv[beg, end), when every argv is a single
+   tuple tups[] points at the argv[]s (*cpy = 0) */
+static int splitInsertTuples(robj **argv, int beg, int end, sds **tups,
+                             bool *cpy) {
+    int ntups = 0;
+    for (int i = beg; i < end; i++) ntups += splitTuples(argv[i]->ptr, NULL);
+    *cpy      = (ntups != (end - beg));
+    *tups     = malloc(sizeof(sds) * (ntups ? ntups : 1));  /* FREE ME 207 */
+    int k     = 0;
+    for (int i = beg; i < end; i++) {
+        if (*cpy) k += splitTuples(argv[i]->ptr, *tups + k);
+        else      (*tups)[k++] = argv[i]->ptr;
+    }
+    return ntups;
+}
+static void releaseInsertTuples(sds *tups, int ntups, bool cpy) {
+    if (cpy) for (int k = 0; k < ntups; k++) sdsfree(tups[k]);
+    free(tups);                                              /* FREED 207 */
+}
+static uchar insertTuples(cli  *c,       sds     uset,   sds    *tups,
+                          int   ntups,   int     ncols,  int     tmatch,
+                          int   matches, int     inds[], int     pcols,
+                          list *cmatchl, bool    repl,   uint32  upd,
+                          uint32 *tsize, bool    parse,  sds    *key,
+                          int    *nok) {
+    uchar ret = INS_ERR; int k = 0;
+    if (!repl && !upd && !parse && batchableInsert(tmatch, ntups)) {
+        CMATCHS_FROM_CMATCHL
+        ret = insertBatch(c, tmatch, tups, ntups, ncols, matches, inds, pcols,
+                          ics, tsize) ? INS_INS : INS_ERR;
+        release_ics(ics, cmatchl->len);
+        if (ret != INS_ERR) k = ntups;
+    } else { /* row by row */
+        for (; k < ntups; k++) {
+            ret = insertCommit(c, uset, tups[k], ncols, tmatch, matches, inds,
+                               pcols, cmatchl, repl, upd, tsize, parse, key);
+            if (ret == INS_ERR) break;
+        }
+    }
+    if (nok) *nok = k; /* rows written */
+    return ret;
+}
 #define DEBUG_INSERT_ACTION_1 \
   for (int i = 0; i < c->argc; i++) \
     printf("INSERT: cargv[%d]: %s\n", i, c->argv[i]->ptr);
@@ -251,6 +483,7 @@ static bool insertColDeclParse(cli *c,       robj **argv, int tmatch, int *valc,
 }
 void insertParse(cli *c, robj **argv, bool repl, int tmatch,
                  bool parse, sds *key) {
+    MMT_RO_CHECK_OR_REPLY(tmatch,)
     resetTCNames(tmatch); MATCH_INDICES(tmatch)
     r_tbl_t *rt      = &Tbl[tmatch];
     int      ncols   = rt->col_count; /* NOTE: need space for LRU */
@@ -278,18 +511,41 @@ void insertParse(cli *c, robj **argv, bool repl, int tmatch,
     uchar ret    = INS_ERR; uint32 tsize = 0;
     ncols       += rt->tcols; // ADD in HASHABILITY columns
     sds   uset   = upd ? argv[upd]->ptr : NULL;
-    for (int i = valc + 1; i < largc; i++) {
-        ret = insertCommit(c, uset, argv[i]->ptr, ncols, tmatch, matches, inds,
-                           pcols, cmatchl, repl, upd, print ? &tsize : NULL,
-                           parse, key);
-        if (ret == INS_ERR)                        goto insprserr;
-    }
+    sds  *tups; bool cpy;
+    int   ntups  = splitInsertTuples(argv, valc + 1, largc, &tups, &cpy);
+    ret          = insertTuples(c, uset, tups, ntups, ncols, tmatch, matches,
+                                inds, pcols, cmatchl, repl, upd,
+                                print ? &tsize : NULL, parse, key, NULL);
+    releaseInsertTuples(tups, ntups, cpy);
+    if (ret == INS_ERR)                            goto insprserr;
     if (print) addRowSizeReply(c, tmatch, getBtr(tmatch), tsize);
     else       addReply(c, shared.ok);
 
 insprserr:
     RELEASE_CS_LS_LIST
 }
+/* NOTE: used by PREPARED INSERT/REPLACE -> vals[] bound per column, *mbuf
+         receives the comma-delimited VALUES text (for AOF/replication) */
+uchar insertBound(cli  *c,     int     tmatch, bool    repl,
+                  int   pcols, icol_t *ics,    char  **vals,
+                  uint32 *vlens, int   nvals,  sds    *mbuf) {
+    MMT_RO_CHECK_OR_REPLY(tmatch, INS_ERR)
+    resetTCNames(tmatch); MATCH_INDICES(tmatch)
+    r_tbl_t *rt     = &Tbl[tmatch];
+    int      ncols  = rt->col_count;
+    int      lncols = insertableColCount(tmatch);
+    twoint   cofsts[ncols];
+    for (int i = 0; i < ncols; i++) cofsts[i].i = cofsts[i].j = -1;
+    sds      pk     = NULL;
+    int      pklen  = 0;
+    bool     ai     = 0;    // AUTO-INCREMENT
+    char    *mvals  = bindRowVals(vals, vlens, nvals, mbuf, &pk, &pklen, ncols,
+                                  cofsts, tmatch, pcols, ics, lncols, &ai);
+    uchar    ret    = insertRow(c, NULL, mvals, cofsts, pk, pklen, ai, ncols,
+                                tmatch, matches, inds, repl, 0, NULL);
+    if (ret != INS_ERR) addReply(c, shared.ok);
+    return ret;
+}
 static void insertAction(cli *c, bool repl) {           //DEBUG_INSERT_ACTION_1
    if (strcasecmp(c->argv[1]->ptr, "INTO")) {
         addReply(c, shared.insertsyntax_no_into); return;
@@ -307,12 +563,101 @@ static void insertAction(cli *c, bool repl) {           //DEBUG_INSERT_ACTION_1
 void insertCommand (cli *c) { insertAction(c, 0); }
 void replaceCommand(cli *c) { insertAction(c, 1); }
 
+// LOAD_DATA LOAD_DATA LOAD_DATA LOAD_DATA LOAD_DATA LOAD_DATA LOAD_DATA
+/* LOAD DATA INFILE filename INTO TABLE tbl
+   NOTE: filename is read by the server, one row per line, the line is the
+         VALUES tuple w/o its parens (e.g. 1,'some text',3.14). Rows are
+         INSERTed in batches of LOAD_DATA_BATCH (a batch is all or nothing),
+         each batch goes to AOF/slaves as an INSERT of its rows */
+#define LOAD_DATA_BATCH 10000
+static void propagateInsertTuples(cli *c, sds tname, sds *tups, int ntups) {
+    if (!server.appendonly && !listLength(server.slaves)) return;
+    int    argc = 4 + ntups;
+    robj **argv = zmalloc(sizeof(robj *) * argc);
+    argv[0]     = createStringObject("INSERT", 6);
+    argv[1]     = createStringObject("INTO",   4);
+    argv[2]     = createStringObject(tname,    sdslen(tname));
+    argv[3]     = createStringObject("VALUES", 6);
+    for (int k = 0; k < ntups; k++) {
+        argv[4 + k] = createStringObject(tups[k], sdslen(tups[k]));
+    }
+    rcommand *cmd = lookupCommandByCString("insert");
+    if (server.appendonly) feedAppendOnlyFile(cmd, c->db->id, argv, argc);
+    if (listLength(server.slaves)) {
+        replicationFeedSlaves(server.slaves, c->db->id, argv, argc);
+    }
+    server.alc.stat_num_dirty_commands++; /* slaves count the INSERTs */
+    for (int i = 0; i < argc; i++) decrRefCount(argv[i]);
+    zfree(argv);
+}
+static bool loadDataBatch(cli *c,       int   tmatch, sds  tname,
+                          sds *tups,    int   ntups,  int  matches,
+                          int  inds[],  list *cmatchl) {
+    r_tbl_t *rt  = &Tbl[tmatch];
+    int      nok;
+    uchar    ret = insertTuples(c, NULL, tups, ntups, rt->col_count, tmatch,
+                                matches, inds, 0, cmatchl, 0, 0, NULL, 0, NULL,
+                                &nok);
+    if (nok) propagateInsertTuples(c, tname, tups, nok);
+    for (int k = 0; k < ntups; k++) sdsfree(tups[k]);
+    return (ret != INS_ERR);
+}
+void loadDataCommand(cli *c) {
+    if (strcasecmp(c->argv[1]->ptr, "DATA") ||
+        strcasecmp(c->argv[2]->ptr, "INFILE") ||
+        strcasecmp(c->argv[4]->ptr, "INTO")   ||
+        strcasecmp(c->argv[5]->ptr, "TABLE")) {
+        addReply(c, shared.load_data_syntax);                         return;
+    }
+    int      len   = sdslen(c->argv[6]->ptr);
+    char    *tn    = rem_backticks(c->argv[6]->ptr, &len); /* Mysql compliant */
+    TABLE_CHECK_OR_REPLY(tn,)
+    MMT_RO_CHECK_OR_REPLY(tmatch,)
+    FILE    *fp    = fopen(c->argv[3]->ptr, "r");
+    if (!fp) { addReply(c, shared.load_data_file);                    return; }
+    resetTCNames(tmatch); MATCH_INDICES(tmatch)
+    list    *cmatchl = listCreate(); cmatchl->free = v_destroyIC;
+    sds      tname   = sdsnewlen(tn, len);                    /* FREE ME 208 */
+    sds     *tups    = malloc(sizeof(sds) * LOAD_DATA_BATCH); /* FREE ME 209 */
+    int      ntups   = 0;
+    long     nrows   = 0;
+    bool     ok      = 1;
+    char     buf[4096];
+    sds      tup     = NULL;
+    while (fgets(buf, sizeof(buf), fp)) {
+        int blen = strlen(buf);
+        if (!tup) tup = sdsnewlen("(", 1);
+        tup      = sdscatlen(tup, buf, blen);
+        if (buf[blen - 1] != '\n' && !feof(fp)) continue; /* long line */
+        tup      = sdstrim(tup, "\r\n");
+        if (sdslen(tup) == 1) { sdsfree(tup); tup = NULL; continue; } //EMPTY
+        tups[ntups++] = sdscatlen(tup, ")", 1); tup = NULL;
+        if (ntups == LOAD_DATA_BATCH) {
+            ok = loadDataBatch(c, tmatch, tname, tups, ntups, matches, inds,
+                               cmatchl);
+            if (!ok) break;
+            nrows += ntups; ntups = 0;
+        }
+    }
+    if (ok && ntups) {
+        ok = loadDataBatch(c, tmatch, tname, tups, ntups, matches, inds,
+                           cmatchl);
+        if (ok) nrows += ntups;
+    }
+    if (tup) sdsfree(tup);
+    fclose(fp);
+    free(tups); sdsfree(tname);                           /* FREED 208,209 */
+    listRelease(cmatchl);
+    if (ok) addReplyLongLong(c, nrows);
+}
+
 //TODO move to orderby.c
 void init_wob(wob_t *wb) {
     bzero(wb, sizeof(wob_t)); wb->lim = wb->ofst = -1;
 }
 void destroy_wob(wob_t *wb) {
-    for (uint32 i = 0; i < wb->nob; i++) releaseIC(&wb->obc[i]);
+    for (uint32 i = 0; i < wb->nob;  i++) releaseIC(&wb->obc[i]);
+    for (uint32 i = 0; i < wb->ngby; i++) releaseIC(&wb->gbc[i]);
     if (wb->ovar) sdsfree(wb->ovar);
 }
 
@@ -321,6 +666,7 @@ void destroy_wob(wob_t *wb) {
 #define WB_LIM_OFST_SIZE 16 /* sizeof(long) *2 */
 
 int getSizeWB(wob_t *wb) {
+    if (wb->ngby) return -1;          // GROUP BY not serialisable
     if (!wb->nob) return sizeof(int); // nob
     //        nob      +      [obc,obt,asc]      + [lim + ofst]
     return sizeof(int) + (WB_CTA_SIZE * wb->nob) + WB_LIM_OFST_SIZE;
@@ -375,7 +721,9 @@ void destroyFlist(list **flist) {
 }
 void destroy_check_sql_where_clause(cswc_t *w) {
     releaseFilterD_KL(&w->wf);                           /* DESTROYED 065 */
+    destroyFProg     (&w->fprog);
     destroyFlist     (&w->flist);
+    if (w->bmap) { rbmDestroy(w->bmap); w->bmap = NULL; } /* FREED 220 */
     if (w->lvr) sdsfree(w->lvr);
 }
 
@@ -430,7 +778,7 @@ bool sqlSelectBinary(cli  *c,     int     tmatch, bool   cstar, icol_t *ics,
     } else {                         /* SQL_SINGLE_LKP */
         bt    *btr   = getBtr(w->wf.tmatch);
         aobj  *apk   = &w->wf.akey;
-        dwm_t  dwm   = btFindD(btr, apk);
+        dwm_t  dwm   = evictFindD(tmatch, apk);
         if (dwm.miss) { addReply(c, shared.dirty_miss);             return 1; }
         if (cstar)    { addReply(c, shared.cone);                   return 1; }
         void  *rrow  = dwm.k;
@@ -438,7 +786,7 @@ bool sqlSelectBinary(cli  *c,     int     tmatch, bool   cstar, icol_t *ics,
         //printf("rrow: %p gost: %d\n", (void *)rrow, gost);
         if (gost || !rrow) { addReply(c, shared.czero);             return 1; }
         bool   hf    = 0;
-        bool   ret   = passFilts(btr, apk, rrow, w->flist, tmatch, &hf);
+        bool   ret   = passWFilts(w, btr, apk, rrow, tmatch, &hf);
         if (hf)                                                     return 0;
         if (!ret) { addReply(c, shared.czero);                      return 1; }
         uchar ost = OR_NONE;
@@ -462,8 +810,40 @@ bool sqlSelectBinary(cli  *c,     int     tmatch, bool   cstar, icol_t *ics,
     }
     return 1;
 }
+bool sqlAggrBinary(cli *c, aggr_t *ag, cswc_t *w, wob_t *wb) {
+    if (!validateAggr(c, ag, wb))                                   return 0;
+    if (c->Prepare) { prepareTemplate(c);                           return 1; }
+    if (c->Explain) { explainAggr(c, w, wb, ag);                    return 1; }
+    if (w->wtype != SQL_SINGLE_LKP && w->wf.imatch == -1) {
+        addReply(c, shared.rangequery_index_not_found);             return 0;
+    }
+    c->LruColInSelect = c->LfuColInSelect = 0;
+    iaggrAction(c, w, wb, ag);
+    return 1;
+}
+static bool sqlAggrInnards(cli *c,     sds clist, sds from, sds tlist,
+                           sds  where, sds wclause, bool chk) {
+    aggr_t ag; int tmatch = -1; bool ret = 0;
+    if (!parseAggrSelect(c, 0, NULL, &tmatch, &ag, clist, from, tlist, where,
+                         chk))                                      goto aggr_e;
+    cswc_t w; wob_t wb;
+    init_check_sql_where_clause(&w, tmatch, wclause); init_wob(&wb);
+    wb.aggr = 1;
+    parseWCplusQO(c, &w, &wb, SQL_SELECT);
+    if (w.wtype != SQL_ERR_LKP && leftoverParsingReply(c, w.lvr)) {
+        ret = sqlAggrBinary(c, &ag, &w, &wb);
+    }
+    destroy_wob(&wb); destroy_check_sql_where_clause(&w);
+
+aggr_e:
+    releaseAggr(&ag);
+    return ret;
+}
 bool sqlSelectInnards(cli *c,       sds  clist, sds from, sds tlist, sds where,
                       sds  wclause, bool chk,   bool need_cn) {
+    if (isAggrSelect(clist)) {
+        return sqlAggrInnards(c, clist, from, tlist, where, wclause, chk);
+    }
     CREATE_CS_LS_LIST(1)
     bool cstar = 0; bool join = 0; int qcols = 0; int tmatch  = -1;
     if (!parseSelect(c, 0, NULL, &tmatch, cmatchl, ls, &qcols, &join, &cstar,
@@ -483,6 +863,13 @@ bool sqlSelectInnards(cli *c,       sds  clist, sds from, sds tlist, sds where,
     parseWCplusQO(c, &w, &wb, SQL_SELECT);
     if (w.wtype == SQL_ERR_LKP)                                     goto sel_e;
     if (!leftoverParsingReply(c, w.lvr))                            goto sel_e;
+    if (wb.ngby) { /* GROUP BY w/o aggregate functions */
+        aggr_t ag;
+        if (aggrFromICS(c, &ag, tmatch, cstar, ics, qcols)) {
+            ret = sqlAggrBinary(c, &ag, &w, &wb);
+        }
+        releaseAggr(&ag);                                           goto sel_e;
+    }
     ret = sqlSelectBinary(c, tmatch, cstar, ics, qcols, &w, &wb,
                           need_cn, &lfca);
 
@@ -496,13 +883,16 @@ sel_e:
 void sqlSelectCommand(redisClient *c) {
     if (c->argc == 2) { selectCommand(c); return; } // REDIS SELECT command
     if (c->argc != 6) { addReply(c, shared.selectsyntax); return; }
+    bool async = rsAsyncBegin(c); /* ROWSTORE: evicted rows -> IO thread */
     sqlSelectInnards(c, c->argv[1]->ptr, c->argv[2]->ptr, c->argv[3]->ptr,
                         c->argv[4]->ptr, c->argv[5]->ptr, 1, 0);
+    if (async) rsAsyncEnd(c);
 }
 
 /* DELETE DELETE DELETE DELETE DELETE DELETE DELETE DELETE DELETE DELETE */
 bool deleteInnards(cli *c, sds tlist, sds wclause) {
     TABLE_CHECK_OR_REPLY(tlist,0)
+    MMT_RO_CHECK_OR_REPLY(tmatch,0)
     cswc_t w; wob_t wb; bool ret = 0;
     init_check_sql_where_clause(&w, tmatch, wclause); init_wob(&wb);
     parseWCplusQO(c, &w, &wb, SQL_DELETE);
@@ -515,6 +905,7 @@ bool deleteInnards(cli *c, sds tlist, sds wclause) {
         }
         ideleteAction(c, &w, &wb);
     } else {                         /* SQL_SINGLE_DELETE */
+        rsFaultIn(w.wf.tmatch, &w.wf.akey); /* ROWSTORE: evicted -> back in */
         MATCH_INDICES(w.wf.tmatch)
         int del = deleteRow(w.wf.tmatch, &w.wf.akey, matches, inds);
         if (del == -1) addReply(c, shared.deletemiss);
@@ -609,7 +1000,12 @@ static bool isUpdatingIndex(int matches, int   inds[], icol_t chit[],
                 }
             }
         } else if (chit[ri->icol.cmatch].cmatch != -1) {
-            ret = 1; if UNIQ(ri->cnstr) *u_up = 1;
+            ret = 1; if (UNIQ(ri->cnstr) || HASHS(ri->cnstr)) *u_up = 1;
+        } else if (ri->icov.cmatch != -1 &&      // [PK -> INCLUDE] REWRITTEN
+                   chit[ri->icov.cmatch].cmatch != -1) {
+            ret = 1;
+        } else if (indexWCColHit(ri, chit)) {    // PARTIAL: row enters|leaves
+            ret = 1;
         }
     }
     return ret;
@@ -617,6 +1013,7 @@ static bool isUpdatingIndex(int matches, int   inds[], icol_t chit[],
 int updateInnards(cli *c,      int   tmatch, sds vallist, sds wclause,
                   bool fromup, aobj *u_apk) {
     //printf("updateInnards: vallist: %s wclause: %s\n", vallist, wclause);
+    MMT_RO_CHECK_OR_REPLY(tmatch, -1)
     CREATE_CS_LS_LIST(0);
     list   *mvalsl  = listCreate(); list *mvlensl = listCreate();
     int     qcols   = parseUpdateColListReply(c,      tmatch, vallist, cmatchl,
@@ -676,7 +1073,7 @@ int updateInnards(cli *c,      int   tmatch, sds vallist, sds wclause,
             if (ovwrPKUp(c, pkupc, mvals, mvlens, pktyp, btr))   goto upc_end;
         }
         aobj  *apk    = &w.wf.akey;
-        dwm_t  dwm    = btFindD(btr, apk);
+        dwm_t  dwm    = evictFindD(w.wf.tmatch, apk);
         void  *rrow   = dwm.k;
         bool   gost   = IS_GHOST(btr, rrow);
         bool   exists = (rrow || dwm.miss) && !gost;
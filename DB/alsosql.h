@@ -31,6 +31,7 @@ ALL RIGHTS RESERVED
 #include "redis.h"
 
 #include "aobj.h"
+#include "aggr.h"
 #include "common.h"
 
 #define getBtr(tmatch) Tbl[tmatch].btr
@@ -67,8 +68,12 @@ void releaseLFCA(lfca_t *lfca);
 
 void insertParse(cli *c,     robj **argv, bool repl, int tmatch,
                  bool parse, sds   *key);
+uchar insertBound(cli    *c,     int     tmatch, bool    repl,
+                  int     pcols, icol_t *ics,    char  **vals,
+                  uint32 *vlens, int     nvals,  sds    *mbuf);
 void insertCommand   (redisClient *c);
 void replaceCommand  (redisClient *c);
+void loadDataCommand (redisClient *c);
 void sqlSelectCommand(redisClient *c);
 void updateCommand   (redisClient *c);
 void deleteCommand   (redisClient *c);
@@ -86,6 +91,7 @@ uchar insertCommit(cli  *c,      sds     uset,   sds     vals,
 bool sqlSelectBinary(cli  *c,     int     tmatch, bool   cstar, icol_t *ics,
                      int   qcols, cswc_t *w,      wob_t *wb,    bool    need_cn,
                      lfca_t *lfca);
+bool sqlAggrBinary   (cli *c, aggr_t *ag, cswc_t *w, wob_t *wb);
 bool sqlSelectInnards(cli *c, sds clist, sds from, sds tbl_list, sds where,
                       sds  wclause, bool chk, bool need_cn);
 
@@ -237,7 +237,7 @@ list *cloneAobjList(list *ll) {
     return l2;
 }
 
-static char SFA_buf[64];
+static __thread char SFA_buf[64];
 static char *strFromAobj(aobj *a, int *len) {
     //printf("strFromAobj: a: "); dumpAobj(printf, a);
     if        (C_IS_S(a->type)) {
@@ -376,6 +376,23 @@ bool aobjLT(aobj *a, aobj *b) { return (aobjCmp(a, b) <  0); }
 bool aobjLE(aobj *a, aobj *b) { return (aobjCmp(a, b) <= 0); }
 bool aobjGT(aobj *a, aobj *b) { return (aobjCmp(a, b) >  0); }
 bool aobjGE(aobj *a, aobj *b) { return (aobjCmp(a, b) >= 0); }
+int aobjKeyCmp(aobj *a, aobj *b) { // same ordering as the btree's
+    if (a->empty || b->empty) return (int)b->empty - (int)a->empty;
+    if        C_IS_S(a->type) {
+        int len = (a->len < b->len) ? a->len : b->len;
+        int ret = strncmp(a->s, b->s, len);
+        return ret ? ret : ((a->len == b->len) ? 0 :
+                            ((a->len < b->len) ? -1 : 1));
+    } else if C_IS_F(a->type) {
+        return (a->f == b->f) ? 0 : ((a->f > b->f) ? 1 : -1);
+    } else if C_IS_L(a->type) {
+        return (a->l == b->l) ? 0 : ((a->l > b->l) ? 1 : -1);
+    } else if C_IS_X(a->type) {
+        return (a->x == b->x) ? 0 : ((a->x > b->x) ? 1 : -1);
+    } else {
+        return (a->i == b->i) ? 0 : ((a->i > b->i) ? 1 : -1);
+    }
+}
 
 int getSizeAobj(aobj *a) { //TODO support FLOAT,STRING
     if (!C_IS_NUM(a->type)) return -1; // ONLY NUM()s supported
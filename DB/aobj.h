@@ -77,6 +77,7 @@ bool aobjLT(aobj *a, aobj *b);
 bool aobjLE(aobj *a, aobj *b);
 bool aobjGT(aobj *a, aobj *b);
 bool aobjGE(aobj *a, aobj *b);
+int  aobjKeyCmp(aobj *a, aobj *b);
 
 //USED for PREPARE/EXECUTE
 int getSizeAobj(aobj *a);
@@ -36,6 +36,7 @@ ALL RIGHTS RESERVED
 #include "index.h"
 #include "colparse.h"
 #include "find.h"
+#include "mmtbl.h"
 #include "alsosql.h"
 #include "common.h"
 #include "aof_alsosql.h"
@@ -53,6 +54,15 @@ static bool SQLappendOnlyDumpIndices(FILE *fp, int tmatch) {
         r_ind_t *ri = &Index[inds[i]];
         if (ri->virt || ri->hlt || ri->fname) continue;
         sds      s  = dumpSQL_Index(NULL, rt, ri, tmatch, 1);
+        if (ri->persist) {
+            s = sdscatprintf(s, "ALTER INDEX %s SET PERSIST;\n", ri->name);
+        }
+        if (fwrite(s, strlen(s), 1, fp) == 0) return 0;
+        sdsfree(s);
+    }
+    if (rt->dirty) { /* AFTER the rows: DIRTY tables reject explicit PKs */
+        sds s = sdscatprintf(sdsempty(), "ALTER TABLE %s SET DIRTY;\n",
+                             rt->name);
         if (fwrite(s, strlen(s), 1, fp) == 0) return 0;
         sdsfree(s);
     }
@@ -63,10 +73,21 @@ bool appendOnlyDumpIndices(FILE *fp, int tmatch) {
     if (server.alc.SQL_AOF) return SQLappendOnlyDumpIndices(fp, tmatch);
     //printf("appendOnlyDumpIndices: fp: %p tmatch: %d\n", fp, tmatch);
     char cmd_INDEX[]  = "*6\r\n$6\r\nCREATE\r\n$5\r\nINDEX\r\n";
+    char cmd_CINDEX[] = "*8\r\n$6\r\nCREATE\r\n$5\r\nINDEX\r\n";
+    char cmd_XINDEX[] = "*10\r\n$6\r\nCREATE\r\n$5\r\nINDEX\r\n";
     char cmd_UINDEX[] = "*7\r\n$6\r\nCREATE\r\n$6\r\nUNIQUE\r\n$5\r\nINDEX\r\n";
+    char cmd_HINDEX[] = "*9\r\n$6\r\nCREATE\r\n$6\r\nUNIQUE\r\n$5\r\nINDEX\r\n";
     char cmd_LUAT[]   = "*6\r\n$6\r\nCREATE\r\n$10\r\nLUATRIGGER\r\n";
     char cmd_LUAT_D[] = "*7\r\n$6\r\nCREATE\r\n$10\r\nLUATRIGGER\r\n";
     char c_on[]       = "$2\r\nON\r\n";
+    char c_include[]  = "$7\r\nINCLUDE\r\n";
+    char c_where[]    = "$5\r\nWHERE\r\n";
+    char c_bitmap[]   = "$5\r\nUSING\r\n$6\r\nBITMAP\r\n";
+    char c_hash[]     = "$5\r\nUSING\r\n$4\r\nHASH\r\n";
+    char cmd_PRST[]   = "*5\r\n$5\r\nALTER\r\n$5\r\nINDEX\r\n";
+    char c_prst[]     = "$3\r\nSET\r\n$7\r\nPERSIST\r\n";
+    char cmd_DIRTY[]  = "*5\r\n$5\r\nALTER\r\n$5\r\nTABLE\r\n";
+    char c_dirty[]    = "$3\r\nSET\r\n$5\r\nDIRTY\r\n";
     r_tbl_t *rt    = &Tbl[tmatch];
     sds      tname = rt->name;
     MATCH_INDICES(tmatch)
@@ -77,6 +98,10 @@ bool appendOnlyDumpIndices(FILE *fp, int tmatch) {
 
         char *cmd;
         if (ri->hlt) cmd = (luat->del.ncols) ? cmd_LUAT_D : cmd_LUAT;
+        else if BMAP(ri->cnstr)                    cmd = cmd_CINDEX;
+        else if HASHI(ri->cnstr)                   cmd = cmd_HINDEX;
+        else if (ri->icov.cmatch != -1 && ri->pwc) cmd = cmd_XINDEX;
+        else if (ri->icov.cmatch != -1 || ri->pwc) cmd = cmd_CINDEX;
         else         cmd = UNIQ(ri->cnstr)   ? cmd_UINDEX : cmd_INDEX;
         if (fwrite(cmd, strlen(cmd), 1, fp) == 0)                     return 0;
 
@@ -113,11 +138,44 @@ bool appendOnlyDumpIndices(FILE *fp, int tmatch) {
         } else {                /* NORMAL INDEX */
             sds cname = rt->col[ri->icol.cmatch].name;
             //TODO FIXME sdsprint lo
-            sds c_w_p = sdscatprintf(sdsempty(), "(%s)", cname); //DEST 074
+            sds c_w_p = ri->xop ? catIndexExpr(sdsnew("("), ri) : //DEST 074
+                                  sdscatprintf(sdsempty(), "(%s", cname);
+            c_w_p     = sdscatlen(c_w_p, ")", 1);
             if (fwriteBulkString(fp, c_w_p, sdslen(c_w_p)) == -1)     return 0;
             sdsfree(c_w_p);                              /* DESTROYED 074 */
+            if BMAP(ri->cnstr) {         /* BITMAP: USING BITMAP */
+                if (fwrite(c_bitmap, sizeof(c_bitmap) - 1, 1, fp) == 0)
+                                                                      return 0;
+            }
+            if HASHI(ri->cnstr) {        /* HASH: USING HASH */
+                if (fwrite(c_hash, sizeof(c_hash) - 1, 1, fp) == 0)   return 0;
+            }
+            if (ri->icov.cmatch != -1) { /* COVERING: INCLUDE (col) */
+                if (fwrite(c_include, sizeof(c_include) - 1, 1, fp) == 0)
+                                                                      return 0;
+                cname = rt->col[ri->icov.cmatch].name;
+                c_w_p = sdscatprintf(sdsempty(), "(%s)", cname); //DEST 074
+                if (fwriteBulkString(fp, c_w_p, sdslen(c_w_p)) == -1) return 0;
+                sdsfree(c_w_p);                          /* DESTROYED 074 */
+            }
+            if (ri->pwc) {               /* PARTIAL: WHERE pred */
+                if (fwrite(c_where, sizeof(c_where) - 1, 1, fp) == 0) return 0;
+                s = ri->pwc;
+                if (fwriteBulkString(fp, s, sdslen(s)) == -1)         return 0;
+            }
+        }
+        if (ri->persist) {              /* ALTER INDEX name SET PERSIST */
+            if (fwrite(cmd_PRST, sizeof(cmd_PRST) - 1, 1, fp) == 0)   return 0;
+            s = ri->name;
+            if (fwriteBulkString(fp, s, sdslen(s)) == -1)             return 0;
+            if (fwrite(c_prst, sizeof(c_prst) - 1, 1, fp) == 0)       return 0;
         }
     }
+    if (rt->dirty) { /* ALTER TABLE name SET DIRTY (AFTER the rows) */
+        if (fwrite(cmd_DIRTY, sizeof(cmd_DIRTY) - 1, 1, fp) == 0)     return 0;
+        if (fwriteBulkString(fp, tname, sdslen(tname)) == -1)         return 0;
+        if (fwrite(c_dirty, sizeof(c_dirty) - 1, 1, fp) == 0)         return 0;
+    }
     return 1;
 }
 
@@ -186,6 +244,15 @@ bool appendOnlyDumpTable(FILE *fp, bt *btr, int tmatch) {
     //printf("appendOnlyDumpTable: tmatch: %d\n", tmatch);
     r_tbl_t *rt    = &Tbl[tmatch];
     sds      tname = rt->name;
+    if (rt->mm) { /* MMAP: the file holds the ROWs -> re-attach it */
+        char mcmd[] = "*6\r\n$6\r\nCREATE\r\n$5\r\nTABLE\r\n";
+        if (fwrite(mcmd, sizeof(mcmd) - 1, 1, fp) == 0)               return 0;
+        if (fwriteBulkString(fp, tname, sdslen(tname)) == -1)         return 0;
+        if (fwriteBulkString(fp, "FROM", 4) == -1)                    return 0;
+        if (fwriteBulkString(fp, "MMAP", 4) == -1)                    return 0;
+        sds fname = rt->mm->fname;
+        return fwriteBulkString(fp, fname, sdslen(fname)) != -1;
+    }
     /* Dump Table definition */
     char cmd[] = "*4\r\n$6\r\nCREATE\r\n$5\r\nTABLE\r\n";
     if (fwrite(cmd,sizeof(cmd)-1,1,fp) == 0)                          return 0;
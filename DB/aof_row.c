@@ -0,0 +1,290 @@
+/*
+ * This file implements AOFROW (binary AOF records of SQL row writes)
+ *
+
+AGPL License
+
+Copyright (c) 2011 Russell Sullivan <jaksprats AT gmail DOT com>
+ALL RIGHTS RESERVED
+
+   This file is part of ALCHEMY_DATABASE
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Affero General Public License as
+    published by the Free Software Foundation, either version 3 of the
+    License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Affero General Public License for more details.
+
+    You should have received a copy of the GNU Affero General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#define _DEFAULT_SOURCE /* pthread_sigmask(), fdatasync() */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <unistd.h>
+#include <errno.h>
+#include <signal.h>
+#include <pthread.h>
+
+#include "redis.h"
+#include "zmalloc.h"
+
+#include "bt.h"
+#include "row.h"
+#include "index.h"
+#include "find.h"
+#include "lru.h"
+#include "rowstore.h"
+#include "alsosql.h"
+#include "query.h"
+#include "common.h"
+#include "aof_row.h"
+
+extern r_tbl_t *Tbl;
+extern r_ind_t *Index;
+
+/* AOFROW: w/ "appendonly yes" an INSERT, UPDATE, DELETE or REPLACE is fed to
+     the AOF as [AOFROW tablename records] instead of its SQL text. records
+     is a run of [op][klen][PK bytes][rlen][row stream] (op 'D': rlen is 0)
+     captured where the command writes its rows (insertRow(), updateRow(),
+     deleteRow()) -> replay skips the SQL parser, the WHERE clause and the
+     row's re-encoding. A command whose row images outweigh its SQL text
+     (e.g. an UPDATE w/ a WHERE hitting many rows) stays SQL text.
+   NOTE: rows are captured per call() (ArlStack is indexed by call() depth,
+         EXEC & LUA nest calls). A command that writes a table whose rows can
+         not be replayed from their streams (LuaTable columns, LUATRIGGERs,
+         HASH tables, OTHER_BT) or writes 2+ tables is fed as SQL text
+   NOTE: "sqlappendonly" AOFs & slaves still get the SQL text
+   GROUP COMMIT: beforeSleep() flushes the AOF once per event loop pass (one
+     write() [& for "appendfsync always" one fdatasync()] for every client
+     served in that pass). w/ "aof_fsync_async yes" the "appendfsync
+     everysec" fdatasync() runs in a thread (on a dup()ed fd) so the event
+     loop never waits on the disk, one still running when the next is due
+     postpones it */
+#define AOFROW_MAX_DEPTH 16
+#define AOFROW_HDR       (1 + sizeof(uint32)) /* [op][klen] */
+
+typedef struct aof_row_log {
+    sds    buf;    /* NOTE: reused by every command at this depth */
+    int    tmatch; /* -1 -> no rows yet */
+    bool   bad;    /* a row AOFROW can not replay -> SQL text */
+    ulong  nrows;
+} arl_t;
+
+static arl_t  ArlStack[AOFROW_MAX_DEPTH];
+static int    ArlDepth = 0;
+static sds    ArlKey   = NULL; /* replay: PK bytes */
+
+static ulong AofRowCmds = 0; static ulong AofRowRows  = 0;
+static ulong AofSqlCmds = 0; static ulong AofFedCmds  = 0;
+static ulong AofFsyncs  = 0; static ulong AofBgFsyncs = 0;
+static ulong AofFsyncPostponed = 0;
+
+static pthread_mutex_t AofMutex  = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t  AofCond   = PTHREAD_COND_INITIALIZER;
+static int             AofSyncFd = -1; /* dup()ed fd the thread fsyncs */
+static bool            AofThread = 0;
+
+// CAPTURE CAPTURE CAPTURE CAPTURE CAPTURE CAPTURE CAPTURE CAPTURE CAPTURE
+static bool aofRowable(int tmatch) {
+    r_tbl_t *rt  = &Tbl[tmatch];
+    bt      *btr = getBtr(tmatch);
+    return NORM_BT(btr) && !rt->haslo && !rt->nltrgr && !rt->hashy;
+}
+static arl_t *aofRowCurr() {
+    if (!ArlDepth || ArlDepth > AOFROW_MAX_DEPTH) return NULL;
+    return &ArlStack[ArlDepth - 1];
+}
+static void aofRowReset(arl_t *l) {
+    if (l->buf) l->buf = sdscpylen(l->buf, "", 0);
+    l->tmatch = -1; l->bad = 0; l->nrows = 0;
+}
+void aofRowBegin() { /* call() entry */
+    if (++ArlDepth <= AOFROW_MAX_DEPTH) aofRowReset(&ArlStack[ArlDepth - 1]);
+}
+void aofRowEnd() {   /* call() exit */
+    if (ArlDepth) ArlDepth--;
+}
+void aofRowLog(int tmatch, uchar op, aobj *apk, void *row) {
+    if (!server.appendonly || server.alc.SQL_AOF || !server.alc.AofBinary) {
+                                                                  return;
+    }
+    arl_t  *l    = aofRowCurr();
+    if (!l || l->bad)                                             return;
+    if ((l->tmatch != -1 && l->tmatch != tmatch) || !aofRowable(tmatch)) {
+        l->bad = 1;                                               return;
+    }
+    if (!l->buf) l->buf = sdsempty();
+    l->tmatch    = tmatch;
+    sds     key  = setAccessKey(apk);
+    uint32  klen = sdslen(key);
+    uint32  rlen = row ? getRowMallocSize(row) : 0;
+    l->buf       = sdscatlen(l->buf, &op,   1);
+    l->buf       = sdscatlen(l->buf, &klen, sizeof(uint32));
+    l->buf       = sdscatlen(l->buf, key,   klen);
+    l->buf       = sdscatlen(l->buf, &rlen, sizeof(uint32));
+    if (rlen) l->buf = sdscatlen(l->buf, row, rlen);
+    l->nrows++;
+}
+/* RETURNS: 1 if buf got the command's AOFROW record (else: SQL text)
+   NOTE: tlen is the SQL text's size, a WHERE touching many rows is smaller
+         as SQL text -> it stays SQL text */
+bool aofRowFeed(sds *buf, bool crud, size_t tlen) {
+    AofFedCmds++;
+    arl_t *l  = aofRowCurr();
+    bool   ok = crud && l && !l->bad && l->nrows && sdslen(l->buf) <= tlen;
+    if (ok) {
+        sds tname = Tbl[l->tmatch].name;
+        *buf = sdscatprintf(*buf, "*3\r\n$6\r\nAOFROW\r\n$%lu\r\n%s\r\n"
+                                  "$%lu\r\n", (ulong)sdslen(tname), tname,
+                                                (ulong)sdslen(l->buf));
+        *buf = sdscatlen(*buf, l->buf, sdslen(l->buf));
+        *buf = sdscatlen(*buf, "\r\n", 2);
+        AofRowCmds++; AofRowRows += l->nrows;
+    } else if (crud) AofSqlCmds++;
+    if (l) aofRowReset(l); /* LOAD DATA feeds an INSERT per batch */
+    return ok;
+}
+
+// REPLAY REPLAY REPLAY REPLAY REPLAY REPLAY REPLAY REPLAY REPLAY REPLAY
+static dwm_t aofRowFind(int tmatch, aobj *apk) { /* EVICTed -> fault-in */
+    bt    *btr = getBtr(tmatch);
+    dwm_t  dwm = btFindD(btr, apk);
+    if (dwm.miss && rsFaultIn(tmatch, apk)) dwm = btFindD(btr, apk);
+    return dwm;
+}
+/* RETURNS: 1 OK, 0 MISS, -1 UNIQUE VIOLATION (already replied) */
+static int aofRowPut(cli *c,       int tmatch, aobj *apk, void *row,
+                     int matches,  int inds[]) {
+    r_tbl_t *rt   = &Tbl[tmatch];
+    bt      *btr  = getBtr(tmatch);
+    dwm_t    dwm  = aofRowFind(tmatch, apk);
+    if (dwm.miss)                                                 return 0;
+    void    *orow = IS_GHOST(btr, dwm.k) ? NULL : dwm.k;
+    if (orow) runDeleteIndexes(btr, apk, orow, matches, inds, 0);
+    if (!runFailableInsertIndexes(c, btr, apk, row, matches, inds)) {
+        if (orow) runFailableInsertIndexes(c, btr, apk, orow, matches, inds);
+                                                                  return -1;
+    }
+    if (orow) btReplace(btr, apk, row);
+    else {    btAdd    (btr, apk, row); UPDATE_AUTO_INC(rt->col[0].type, apk) }
+    server.dirty++;
+    return 1;
+}
+static int aofRowDel(int tmatch, aobj *apk, int matches, int inds[]) {
+    dwm_t dwm = aofRowFind(tmatch, apk);
+    if (dwm.miss)                                                 return 0;
+    deleteRow(tmatch, apk, matches, inds); /* NOTE: not there is OK */
+    return 1;
+}
+void aofrowCommand(cli *c) {
+    int      tmatch = find_table(c->argv[1]->ptr);
+    if (tmatch == -1) { addReply(c, shared.nonexistenttable);     return; }
+    if (!aofRowable(tmatch)) { addReply(c, shared.aofrow_syntax); return; }
+    r_tbl_t *rt     = &Tbl[tmatch];
+    sds      recs   = c->argv[2]->ptr;
+    uchar   *p      = (uchar *)recs;
+    uchar   *end    = p + sdslen(recs);
+    long     card   = 0;
+    if (!ArlKey) ArlKey = sdsempty();
+    MATCH_INDICES(tmatch)
+    while (p < end) {
+        uint32 klen, rlen; uchar op = *p;
+        if ((ulong)(end - p) < AOFROW_HDR)                    goto aofrow_err;
+        memcpy(&klen, p + 1, sizeof(uint32));      p += AOFROW_HDR;
+        if ((ulong)(end - p) < klen + sizeof(uint32))         goto aofrow_err;
+        ArlKey = sdscpylen(ArlKey, (char *)p, klen); p += klen;
+        memcpy(&rlen, p, sizeof(uint32));          p += sizeof(uint32);
+        if ((ulong)(end - p) < rlen)                          goto aofrow_err;
+        aobj apk; initAccessPK(&apk, ArlKey, rt->col[0].type);
+        int  r;
+        if        (op == AOFROW_PUT && rlen && getRowMallocSize(p) == rlen) {
+            r = aofRowPut(c, tmatch, &apk, p, matches, inds);
+        } else if (op == AOFROW_DEL && !rlen) {
+            r = aofRowDel(tmatch, &apk, matches, inds);
+        } else { releaseAobj(&apk);                           goto aofrow_err; }
+        releaseAobj(&apk); p += rlen;
+        if (r == -1)                                                  return;
+        if (!r) {
+            addReply(c, (op == AOFROW_PUT) ? shared.updatemiss :
+                                             shared.deletemiss);      return;
+        }
+        card++;
+    }
+    addReplyLongLong(c, card);
+    return;
+
+aofrow_err:
+    addReply(c, shared.aofrow_syntax);
+}
+
+// GROUP_COMMIT GROUP_COMMIT GROUP_COMMIT GROUP_COMMIT GROUP_COMMIT
+static void *aofFsyncThread(void *arg) {
+    (void)arg; // compiler warning
+    pthread_detach(pthread_self());
+    pthread_mutex_lock(&AofMutex);
+    while (1) {
+        if (AofSyncFd == -1) {
+            pthread_cond_wait(&AofCond, &AofMutex);                continue;
+        }
+        int fd = AofSyncFd;
+        pthread_mutex_unlock(&AofMutex);
+        aof_fsync(fd); close(fd);
+        pthread_mutex_lock(&AofMutex);
+        AofSyncFd = -1;
+    }
+    return NULL;
+}
+static bool aofFsyncInit() {
+    if (AofThread)                                                return 1;
+    sigset_t  mask, omask; pthread_t thread;
+    sigemptyset(&mask);
+    sigaddset(&mask, SIGCHLD); sigaddset(&mask, SIGHUP);
+    sigaddset(&mask, SIGPIPE);
+    pthread_sigmask(SIG_SETMASK, &mask, &omask);
+    int err = pthread_create(&thread, NULL, aofFsyncThread, NULL);
+    pthread_sigmask(SIG_SETMASK, &omask, NULL);
+    if (!err) { AofThread = 1;                                    return 1; }
+    server.alc.AofFsyncAsync = 0; /* -> fdatasync() in the event loop */
+    redisLog(REDIS_WARNING, "AOF: fsync thread: %s", strerror(err));
+    return 0;
+}
+/* RETURNS: 0 -> postponed (last everysec fdatasync() still running) */
+bool aofRowFsync(int fd, bool everysec) {
+    if (!everysec || !server.alc.AofFsyncAsync || !aofFsyncInit()) {
+        aof_fsync(fd); AofFsyncs++;                               return 1;
+    }
+    pthread_mutex_lock(&AofMutex);
+    bool busy = (AofSyncFd != -1);
+    int  dfd  = busy ? -1 : dup(fd);
+    if (dfd != -1) { AofSyncFd = dfd; pthread_cond_signal(&AofCond); }
+    pthread_mutex_unlock(&AofMutex);
+    if (busy) { AofFsyncPostponed++;                              return 0; }
+    if (dfd == -1) aof_fsync(fd); /* dup() failed */
+    else           AofBgFsyncs++;
+    AofFsyncs++;
+    return 1;
+}
+
+sds genAofRowInfoString(sds info) {
+    double per = AofFsyncs ? (double)AofFedCmds / (double)AofFsyncs : 0.0;
+    return sdscatprintf(info, "aof_binary:%s\r\n"
+                              "aof_row_commands:%lu\r\n"
+                              "aof_row_records:%lu\r\n"
+                              "aof_sql_commands:%lu\r\n"
+                              "aof_fsyncs:%lu\r\n"
+                              "aof_fsyncs_async:%lu\r\n"
+                              "aof_fsyncs_postponed:%lu\r\n"
+                              "aof_commands_per_fsync:%.2f\r\n",
+                        server.alc.AofBinary ? "yes" : "no",
+                        AofRowCmds, AofRowRows, AofSqlCmds, AofFsyncs,
+                        AofBgFsyncs, AofFsyncPostponed, per);
+}
@@ -0,0 +1,47 @@
+/*
+ * This file implements AOFROW (binary AOF records of SQL row writes)
+ *
+
+AGPL License
+
+Copyright (c) 2011 Russell Sullivan <jaksprats AT gmail DOT com>
+ALL RIGHTS RESERVED
+
+   This file is part of ALCHEMY_DATABASE
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Affero General Public License as
+    published by the Free Software Foundation, either version 3 of the
+    License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Affero General Public License for more details.
+
+    You should have received a copy of the GNU Affero General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __ALC_AOF_ROW__H
+#define __ALC_AOF_ROW__H
+
+#include "redis.h"
+
+#include "query.h"
+#include "common.h"
+
+#define AOFROW_PUT 'P' /* full row image, INSERT or OVERWRITE */
+#define AOFROW_DEL 'D'
+
+void aofRowBegin   ();
+void aofRowEnd     ();
+void aofRowLog     (int tmatch, uchar op, aobj *apk, void *row);
+bool aofRowFeed    (sds *buf, bool crud, size_t tlen);
+bool aofRowFsync   (int fd, bool everysec);
+
+void aofrowCommand (cli *c);
+
+sds  genAofRowInfoString(sds info);
+
+#endif /* __ALC_AOF_ROW__H */
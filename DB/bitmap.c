@@ -0,0 +1,436 @@
+/*
+ * This file implements BITMAP indexes (compressed bitmaps of PKs)
+ *
+
+AGPL License
+
+Copyright (c) 2011 Russell Sullivan <jaksprats AT gmail DOT com>
+ALL RIGHTS RESERVED
+
+   This file is part of ALCHEMY_DATABASE
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Affero General Public License as
+    published by the Free Software Foundation, either version 3 of the
+    License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Affero General Public License for more details.
+
+    You should have received a copy of the GNU Affero General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <assert.h>
+
+#include "dict.h"
+#include "redis.h"
+
+#include "query.h"
+#include "common.h"
+#include "bitmap.h"
+
+/* NOTE:
+    A BITMAP index (CREATE INDEX ... USING BITMAP) maps each distinct value
+    of a low-cardinality column to a roaring-style bitmap of the PKs having
+    that value. The PK space is cut into 65536 wide chunks (PK >> 16), each
+    non-empty chunk is a container: a sorted ushort16 ARRAY (sparse, upto
+    RBM_ARRAY_MAX entries) or a 65536 bit BITS array (dense).
+    WHERE x = 1 AND y IN (2,3) w/ BITMAPs on x & y is answered by ANDing
+    x[1] w/ (y[2] OR y[3]) -> the rows are fetched in PK order by iterating
+    the result, the per-row filters on x & y are never run.
+*/
+
+// GLOBALS
+extern r_tbl_t *Tbl;
+
+#define RBM_HI(v) ((v) >> 16)
+#define RBM_LO(v) ((ushort16)((v) & 0xFFFF))
+#define RBM_BIT_IS_SET(bits, lo) (bits[(lo) >> 6] &  (1UL << ((lo) & 63)))
+#define RBM_SET_BIT(bits, lo)     bits[(lo) >> 6] |= (1UL << ((lo) & 63))
+#define RBM_CLR_BIT(bits, lo)     bits[(lo) >> 6] &= ~(1UL << ((lo) & 63))
+
+// CONTAINER CONTAINER CONTAINER CONTAINER CONTAINER CONTAINER CONTAINER
+static void releaseContainer(rbc_t *c) {
+    if (c->arr)  free(c->arr);                           /* FREED 217 */
+    if (c->bits) free(c->bits);                          /* FREED 218 */
+    c->arr = NULL; c->bits = NULL;
+}
+static long findLo(rbc_t *c, ushort16 lo, bool *hit) { /* ARRAY: bsearch */
+    long l = 0, h = (long)c->card - 1;
+    while (l <= h) {
+        long m = (l + h) / 2;
+        if      (c->arr[m] == lo) { *hit = 1; return m; }
+        else if (c->arr[m] <  lo) l = m + 1;
+        else                      h = m - 1;
+    }
+    *hit = 0; return l;
+}
+static void arrToBits(rbc_t *c) {
+    c->bits = malloc(RBM_NWORDS * sizeof(ulong));        /* FREE ME 218 */
+    bzero(c->bits, RBM_NWORDS * sizeof(ulong));
+    for (uint32 i = 0; i < c->card; i++) RBM_SET_BIT(c->bits, c->arr[i]);
+    free(c->arr); c->arr = NULL; c->cap = 0;             /* FREED 217 */
+}
+static void bitsToArr(rbc_t *c) {
+    c->cap = c->card ? c->card : 1;
+    c->arr = malloc(c->cap * sizeof(ushort16));          /* FREE ME 217 */
+    uint32 n = 0;
+    for (uint32 w = 0; w < RBM_NWORDS; w++) {
+        ulong word = c->bits[w];
+        while (word) {
+            c->arr[n++] = (ushort16)((w << 6) + __builtin_ctzl(word));
+            word       &= word - 1;
+        }
+    }
+    free(c->bits); c->bits = NULL;                       /* FREED 218 */
+}
+static uint32 countBits(ulong *bits) {
+    uint32 card = 0;
+    for (uint32 w = 0; w < RBM_NWORDS; w++) card += __builtin_popcountl(bits[w]);
+    return card;
+}
+static bool cAdd(rbc_t *c, ushort16 lo) {
+    if (c->bits) {
+        if (RBM_BIT_IS_SET(c->bits, lo)) return 0;
+        RBM_SET_BIT(c->bits, lo); c->card++; return 1;
+    }
+    bool hit; long pos = findLo(c, lo, &hit);
+    if (hit)                             return 0;
+    if (c->card == RBM_ARRAY_MAX) { /* full -> dense */
+        arrToBits(c); RBM_SET_BIT(c->bits, lo); c->card++; return 1;
+    }
+    if (c->card == c->cap) {
+        c->cap = c->cap ? c->cap * 2 : 4;
+        c->arr = realloc(c->arr, c->cap * sizeof(ushort16));
+    }
+    memmove(c->arr + pos + 1, c->arr + pos, (c->card - pos) * sizeof(ushort16));
+    c->arr[pos] = lo; c->card++;
+    return 1;
+}
+static bool cDel(rbc_t *c, ushort16 lo) {
+    if (c->bits) {
+        if (!RBM_BIT_IS_SET(c->bits, lo)) return 0;
+        RBM_CLR_BIT(c->bits, lo); c->card--;
+        if (c->card < RBM_ARRAY_MAX / 2) bitsToArr(c); /* hysteresis */
+        return 1;
+    }
+    bool hit; long pos = findLo(c, lo, &hit);
+    if (!hit)                             return 0;
+    memmove(c->arr + pos, c->arr + pos + 1,
+            (c->card - pos - 1) * sizeof(ushort16));
+    c->card--;
+    return 1;
+}
+static void cClone(rbc_t *d, rbc_t *s) {
+    *d = *s;
+    if (s->bits) {
+        d->bits = malloc(RBM_NWORDS * sizeof(ulong));    /* FREE ME 218 */
+        memcpy(d->bits, s->bits, RBM_NWORDS * sizeof(ulong));
+    } else {
+        d->cap  = s->card ? s->card : 1;
+        d->arr  = malloc(d->cap * sizeof(ushort16));     /* FREE ME 217 */
+        memcpy(d->arr, s->arr, s->card * sizeof(ushort16));
+    }
+}
+static void cAnd(rbc_t *d, rbc_t *a, rbc_t *b) { /* d = a AND b */
+    bzero(d, sizeof(rbc_t)); d->hi = a->hi;
+    if (a->bits && b->bits) {
+        d->bits = malloc(RBM_NWORDS * sizeof(ulong));    /* FREE ME 218 */
+        for (uint32 w = 0; w < RBM_NWORDS; w++) d->bits[w] = a->bits[w] & b->bits[w];
+        d->card = countBits(d->bits);
+        if (d->card <= RBM_ARRAY_MAX) bitsToArr(d);
+        return;
+    }
+    if (a->bits) { rbc_t *t = a; a = b; b = t; } /* a is ARRAY */
+    d->cap = a->card ? a->card : 1;
+    d->arr = malloc(d->cap * sizeof(ushort16));          /* FREE ME 217 */
+    if (b->bits) {
+        for (uint32 i = 0; i < a->card; i++) {
+            if (RBM_BIT_IS_SET(b->bits, a->arr[i])) d->arr[d->card++] = a->arr[i];
+        }
+    } else {                                             /* merge */
+        uint32 i = 0, j = 0;
+        while (i < a->card && j < b->card) {
+            if      (a->arr[i] < b->arr[j]) i++;
+            else if (a->arr[i] > b->arr[j]) j++;
+            else { d->arr[d->card++] = a->arr[i]; i++; j++; }
+        }
+    }
+}
+static void cOr(rbc_t *a, rbc_t *b) { /* a |= b */
+    if (a->bits || b->bits || (a->card + b->card) > RBM_ARRAY_MAX) {
+        if (!a->bits) arrToBits(a);
+        if (b->bits) {
+            for (uint32 w = 0; w < RBM_NWORDS; w++) a->bits[w] |= b->bits[w];
+        } else {
+            for (uint32 i = 0; i < b->card; i++) RBM_SET_BIT(a->bits, b->arr[i]);
+        }
+        a->card = countBits(a->bits);
+        return;
+    }
+    uint32    cap = a->card + b->card, n = 0, i = 0, j = 0;
+    ushort16 *arr = malloc(cap * sizeof(ushort16));      /* FREE ME 217 */
+    while (i < a->card || j < b->card) {
+        if      (j == b->card || (i < a->card && a->arr[i] < b->arr[j]))
+            arr[n++] = a->arr[i++];
+        else if (i == a->card || b->arr[j] < a->arr[i])  arr[n++] = b->arr[j++];
+        else { arr[n++] = a->arr[i]; i++; j++; }
+    }
+    free(a->arr);                                        /* FREED 217 */
+    a->arr = arr; a->cap = cap; a->card = n;
+}
+
+// BITMAP BITMAP BITMAP BITMAP BITMAP BITMAP BITMAP BITMAP BITMAP BITMAP
+rbm_t *rbmCreate() {
+    rbm_t *b = malloc(sizeof(rbm_t));                    /* FREE ME 216 */
+    bzero(b, sizeof(rbm_t));
+    return b;
+}
+void rbmDestroy(rbm_t *b) {
+    if (!b) return;
+    for (uint32 i = 0; i < b->nc; i++) releaseContainer(&b->c[i]);
+    if (b->c) free(b->c);
+    free(b);                                             /* FREED 216 */
+}
+rbm_t *rbmClone(rbm_t *b) {
+    rbm_t *n = rbmCreate();
+    n->nc    = n->cap = b->nc; n->card = b->card;
+    if (b->nc) n->c = malloc(b->nc * sizeof(rbc_t));
+    for (uint32 i = 0; i < b->nc; i++) cClone(&n->c[i], &b->c[i]);
+    return n;
+}
+static long findHi(rbm_t *b, ulong hi, bool *hit) {
+    long l = 0, h = (long)b->nc - 1;
+    while (l <= h) {
+        long m = (l + h) / 2;
+        if      (b->c[m].hi == hi) { *hit = 1; return m; }
+        else if (b->c[m].hi <  hi) l = m + 1;
+        else                       h = m - 1;
+    }
+    *hit = 0; return l;
+}
+static void pushContainer(rbm_t *b, long pos, rbc_t *c) {
+    if (b->nc == b->cap) {
+        b->cap = b->cap ? b->cap * 2 : 1;
+        b->c   = realloc(b->c, b->cap * sizeof(rbc_t));
+    }
+    memmove(b->c + pos + 1, b->c + pos, (b->nc - pos) * sizeof(rbc_t));
+    b->c[pos] = *c; b->nc++;
+}
+bool rbmAdd(rbm_t *b, ulong v) {
+    bool hit; long pos = findHi(b, RBM_HI(v), &hit);
+    if (!hit) {
+        rbc_t c; bzero(&c, sizeof(rbc_t)); c.hi = RBM_HI(v);
+        pushContainer(b, pos, &c);
+    }
+    if (!cAdd(&b->c[pos], RBM_LO(v))) return 0;
+    b->card++; return 1;
+}
+bool rbmDel(rbm_t *b, ulong v) {
+    bool hit; long pos = findHi(b, RBM_HI(v), &hit);
+    if (!hit || !cDel(&b->c[pos], RBM_LO(v))) return 0;
+    b->card--;
+    if (!b->c[pos].card) {
+        releaseContainer(&b->c[pos]);
+        memmove(b->c + pos, b->c + pos + 1, (b->nc - pos - 1) * sizeof(rbc_t));
+        b->nc--;
+    }
+    return 1;
+}
+rbm_t *rbmAnd(rbm_t *a, rbm_t *b) {
+    rbm_t  *d = rbmCreate();
+    uint32  i = 0, j = 0;
+    while (i < a->nc && j < b->nc) {
+        if      (a->c[i].hi < b->c[j].hi) i++;
+        else if (a->c[i].hi > b->c[j].hi) j++;
+        else {
+            rbc_t c; cAnd(&c, &a->c[i], &b->c[j]); i++; j++;
+            if (!c.card) { releaseContainer(&c); continue; }
+            d->card += c.card; pushContainer(d, d->nc, &c);
+        }
+    }
+    return d;
+}
+void rbmOr(rbm_t *a, rbm_t *b) {
+    for (uint32 j = 0; j < b->nc; j++) {
+        bool hit; long pos = findHi(a, b->c[j].hi, &hit);
+        if (hit) {
+            a->card -= a->c[pos].card;
+            cOr(&a->c[pos], &b->c[j]);
+        } else {
+            rbc_t c; cClone(&c, &b->c[j]); pushContainer(a, pos, &c);
+        }
+        a->card += a->c[pos].card;
+    }
+}
+ulong rbmBytes(rbm_t *b) {
+    ulong size = sizeof(rbm_t) + b->cap * sizeof(rbc_t);
+    for (uint32 i = 0; i < b->nc; i++) {
+        rbc_t *c = &b->c[i];
+        size    += c->bits ? RBM_NWORDS * sizeof(ulong) :
+                             c->cap     * sizeof(ushort16);
+    }
+    return size;
+}
+
+// ITERATOR ITERATOR ITERATOR ITERATOR ITERATOR ITERATOR ITERATOR ITERATOR
+static void startContainer(rbmi_t *it) {
+    if (it->ci < 0 || it->ci >= (long)it->b->nc) return;
+    rbc_t *c = &it->b->c[it->ci];
+    it->pos  = it->asc ? -1 : (c->bits ? (RBM_NWORDS * 64) : (long)c->card);
+}
+static long nextSetBit(ulong *bits, long from) {
+    if (from >= RBM_NWORDS * 64) return -1;
+    long  w    = from >> 6;
+    ulong word = bits[w] & (~0UL << (from & 63));
+    while (1) {
+        if (word) return (w << 6) + __builtin_ctzl(word);
+        if (++w == RBM_NWORDS) return -1;
+        word = bits[w];
+    }
+}
+static long prevSetBit(ulong *bits, long from) {
+    if (from < 0) return -1;
+    long  w    = from >> 6;
+    ulong word = bits[w] & (~0UL >> (63 - (from & 63)));
+    while (1) {
+        if (word) return (w << 6) + 63 - __builtin_clzl(word);
+        if (!w--) return -1;
+        word = bits[w];
+    }
+}
+void rbmIterInit(rbmi_t *it, rbm_t *b, bool asc) {
+    it->b  = b; it->asc = asc;
+    it->ci = asc ? 0 : (long)b->nc - 1;
+    startContainer(it);
+}
+#define RBM_ITER_NEXT_CONTAINER \
+  { it->ci += it->asc ? 1 : -1; startContainer(it); }
+bool rbmNext(rbmi_t *it, ulong *v) {
+    while (it->ci >= 0 && it->ci < (long)it->b->nc) {
+        rbc_t *c = &it->b->c[it->ci];
+        long   p;
+        if (c->bits) {
+            p = it->asc ? nextSetBit(c->bits, it->pos + 1) :
+                          prevSetBit(c->bits, it->pos - 1);
+        } else {
+            p = it->asc ? it->pos + 1 : it->pos - 1;
+            if (p >= (long)c->card) p = -1;
+        }
+        if (p >= 0) {
+            it->pos = p;
+            *v      = (c->hi << 16) | (c->bits ? (ulong)p : c->arr[p]);
+            return 1;
+        }
+        RBM_ITER_NEXT_CONTAINER
+    }
+    return 0;
+}
+void rbmSkip(rbmi_t *it, ulong n) { /* OFFSET: whole containers by card */
+    while (n && it->ci >= 0 && it->ci < (long)it->b->nc) {
+        rbc_t *c    = &it->b->c[it->ci];
+        if (c->bits) {
+            bool fresh = it->asc ? (it->pos == -1) :
+                                   (it->pos == RBM_NWORDS * 64);
+            if (fresh && c->card <= n) {
+                n -= c->card; RBM_ITER_NEXT_CONTAINER continue;
+            }
+            ulong v; if (!rbmNext(it, &v)) break;
+            n--;
+        } else {
+            ulong left = (ulong)(it->asc ? ((long)c->card - 1 - it->pos) : it->pos);
+            if (left <= n) { n -= left; RBM_ITER_NEXT_CONTAINER continue; }
+            it->pos += it->asc ? (long)n : -(long)n;
+            n        = 0;
+        }
+    }
+}
+
+void dumpBitmap(printer *prn, rbm_t *b) {
+    if (!b) { (*prn)("\t\tBITMAP: NULL\n"); return; }
+    (*prn)("\t\tBITMAP: card: %lu nc: %u bytes: %lu\n",
+            b->card, b->nc, rbmBytes(b));
+    for (uint32 i = 0; i < b->nc; i++) {
+        rbc_t *c = &b->c[i];
+        (*prn)("\t\t\tcontainer: hi: %lu %s card: %u\n",
+                c->hi, c->bits ? "BITS" : "ARRAY", c->card);
+    }
+}
+
+// BITMAP_INDEX BITMAP_INDEX BITMAP_INDEX BITMAP_INDEX BITMAP_INDEX
+unsigned int dictSdsHash(const void *key);
+int          dictSdsKeyCompare(void *privdata, const void *key1,
+                               const void *key2);
+void         dictSdsDestructor(void *privdata, void *val);
+
+static void dictRbmDestructor(void *privdata, void *val) {
+    (void) privdata; rbmDestroy((rbm_t *)val);
+}
+static dictType bitmapIndexDictType = {
+    dictSdsHash,                /* hash function */
+    NULL,                       /* key dup */
+    NULL,                       /* val dup */
+    dictSdsKeyCompare,          /* key compare */
+    dictSdsDestructor,          /* key destructor */
+    dictRbmDestructor           /* val destructor */
+};
+
+dict *bitmapIndexCreate() {
+    return dictCreate(&bitmapIndexDictType, NULL);       /* FREE ME 219 */
+}
+void bitmapIndexDestroy(dict **bmd) {
+    if (*bmd) { dictRelease(*bmd); *bmd = NULL; }        /* FREED 219 */
+}
+
+static sds BmKey = NULL; /* lookup key: column value's raw bytes */
+static sds setBitmapKey(r_ind_t *ri, aobj *a) {
+    uchar ctype = Tbl[ri->tmatch].col[ri->icol.cmatch].type;
+    if (!BmKey) BmKey = sdsempty();
+    if        C_IS_I(ctype) {
+        uint32 i = C_IS_I(a->type) ? a->i : (uint32)a->l;
+        BmKey    = sdscpylen(BmKey, (char *)&i, sizeof(uint32));
+    } else if C_IS_L(ctype) {
+        ulong  l = C_IS_L(a->type) ? a->l : (ulong)a->i;
+        BmKey    = sdscpylen(BmKey, (char *)&l, sizeof(ulong));
+    } else {  /* C_IS_S */
+        BmKey    = sdscpylen(BmKey, a->s, a->len);
+    }
+    return BmKey;
+}
+#define BMAP_PK(apk) (C_IS_I((apk)->type) ? (ulong)(apk)->i : (apk)->l)
+
+void bitmapIndexAdd(r_ind_t *ri, aobj *acol, aobj *apk) {
+    sds    key = setBitmapKey(ri, acol);
+    rbm_t *b   = dictFetchValue(ri->bmd, key);
+    if (!b) { b = rbmCreate(); ASSERT_OK(dictAdd(ri->bmd, sdsdup(key), b)); }
+    rbmAdd(b, BMAP_PK(apk));
+}
+void bitmapIndexDel(r_ind_t *ri, aobj *acol, aobj *apk) {
+    sds    key = setBitmapKey(ri, acol);
+    rbm_t *b   = dictFetchValue(ri->bmd, key);
+    if (!b) return;
+    rbmDel(b, BMAP_PK(apk));
+    if (!b->card) dictDelete(ri->bmd, key);
+}
+rbm_t *bitmapIndexGet(r_ind_t *ri, aobj *acol) {
+    return dictFetchValue(ri->bmd, setBitmapKey(ri, acol));
+}
+ulong bitmapIndexBytes(r_ind_t *ri) {
+    if (!ri->bmd) return 0;
+    ulong         size = sizeof(dict) +
+                         dictSlots(ri->bmd) * sizeof(dictEntry *);
+    dictEntry    *de;
+    dictIterator *di   = dictGetIterator(ri->bmd);
+    while((de = dictNext(di))) {
+        sds key = dictGetEntryKey(de);
+        size   += sizeof(dictEntry) + sdslen(key) + rbmBytes(dictGetEntryVal(de));
+    } dictReleaseIterator(di);
+    return size;
+}
@@ -0,0 +1,83 @@
+/*
+ * This file implements BITMAP indexes (compressed bitmaps of PKs)
+ *
+
+AGPL License
+
+Copyright (c) 2011 Russell Sullivan <jaksprats AT gmail DOT com>
+ALL RIGHTS RESERVED
+
+   This file is part of ALCHEMY_DATABASE
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Affero General Public License as
+    published by the Free Software Foundation, either version 3 of the
+    License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Affero General Public License for more details.
+
+    You should have received a copy of the GNU Affero General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __ALC_BITMAP__H
+#define __ALC_BITMAP__H
+
+#include "dict.h"
+#include "redis.h"
+
+#include "query.h"
+#include "common.h"
+
+#define RBM_ARRAY_MAX 4096 /* ARRAY container -> BITS container above this */
+#define RBM_NWORDS    1024 /* BITS container: 65536 bits                    */
+
+typedef struct rbm_container {  /* holds all PKs w/ the same (PK >> 16)     */
+    ulong     hi;               /* PK >> 16                                 */
+    uint32    card;             /* number of PKs in container               */
+    uint32    cap;              /* ARRAY: allocated slots, BITS: 0          */
+    ushort16 *arr;              /* ARRAY: sorted (PK & 0xFFFF)              */
+    ulong    *bits;             /* BITS:  RBM_NWORDS words                  */
+} rbc_t;
+
+typedef struct roaring_bitmap { /* containers sorted by hi                  */
+    uint32  nc;
+    uint32  cap;
+    ulong   card;
+    rbc_t  *c;
+} rbm_t;
+
+typedef struct rbm_iterator {
+    rbm_t *b;
+    bool   asc;
+    long   ci;                  /* current container                        */
+    long   pos;                 /* ARRAY: slot, BITS: bit                   */
+} rbmi_t;
+
+rbm_t *rbmCreate ();
+void   rbmDestroy(rbm_t *b);
+rbm_t *rbmClone  (rbm_t *b);
+bool   rbmAdd    (rbm_t *b, ulong v);
+bool   rbmDel    (rbm_t *b, ulong v);
+rbm_t *rbmAnd    (rbm_t *a, rbm_t *b);
+void   rbmOr     (rbm_t *a, rbm_t *b);
+ulong  rbmBytes  (rbm_t *b);
+
+void   rbmIterInit(rbmi_t *it, rbm_t *b, bool asc);
+bool   rbmNext    (rbmi_t *it, ulong *v);
+void   rbmSkip    (rbmi_t *it, ulong n);
+
+void   dumpBitmap (printer *prn, rbm_t *b);
+
+/* BITMAP INDEX: dict[column value] -> rbm_t of PKs */
+dict  *bitmapIndexCreate ();
+void   bitmapIndexDestroy(dict **bmd);
+void   bitmapIndexAdd    (r_ind_t *ri, aobj *acol, aobj *apk);
+void   bitmapIndexDel    (r_ind_t *ri, aobj *acol, aobj *apk);
+rbm_t *bitmapIndexGet    (r_ind_t *ri, aobj *acol);
+ulong  bitmapIndexBytes  (r_ind_t *ri);
+
+#endif /* __ALC_BITMAP__H */
@@ -29,6 +29,7 @@ ALL RIGHTS RESERVED
 #include <string.h>
 #include <assert.h>
 #include <strings.h>
+#include <limits.h>
 
 #include "redis.h" /* defines REDIS_BTREE */
 
@@ -38,6 +39,7 @@ ALL RIGHTS RESERVED
 #include "index.h"
 #include "query.h"
 #include "stream.h"
+#include "mmtbl.h"
 #include "common.h"
 
 extern r_tbl_t *Tbl;
@@ -179,6 +181,10 @@ bt *createIndexNode(uchar ktype, uchar obctype) {                /* INODE_BT */
     }
     return bt_create(cmp, TRANS_ONE, &bts, 0);
 }
+/* COVERING INDEX NODE: [PK -> INCLUDE col] (packed like a 2 column table) */
+bt *createCoverNode(uchar pktyp, uchar vtype, int imatch) {
+    return createOBT(pktyp, vtype, imatch, BT_COVER);
+}
 bt *createIndexBT(uchar ktype, int imatch) {
     return createIBT(ktype, imatch, BTREE_INDEX);
 }
@@ -221,7 +227,8 @@ static int abt_replace(bt *btr, aobj *akey, void *val) {
 }
 static void *abt_find(bt *btr, aobj *akey) {
     DECLARE_BT_KEY(akey, 0)
-    uchar *stream = bt_find(btr, btkey, akey);
+    mmt_t *mm     = MMT(btr);
+    uchar *stream = mm ? mmtFind(mm, btr, btkey) : bt_find(btr, btkey, akey);
     destroyBTKey(btkey, med);                            /* FREED 026 */
     return parseStream(stream, btr);
 }
@@ -234,7 +241,10 @@ static bool abt_exist(bt *btr, aobj *akey) { //NOTE: Evicted Indexes are NULL
 static dwm_t abt_find_d(bt *btr, aobj *akey) { //NOTE: use for dirty tables
     dwm_t dwme; bzero(&dwme, sizeof(dwm_t));
     DECLARE_BT_KEY(akey, dwme)
-    dwm_t  dwm = findnodekey(btr, btr->root, btkey, akey);
+    mmt_t *mm  = MMT(btr);
+    dwm_t  dwm = dwme;
+    if (mm) dwm.k = mmtFind(mm, btr, btkey); /* MMAP: never DIRTY */
+    else    dwm   = findnodekey(btr, btr->root, btkey, akey);
     destroyBTKey(btkey, med);                            // FREED 026
     dwm.k      = parseStream(dwm.k, btr);
     return dwm;
@@ -252,6 +262,10 @@ static bool abt_evict(bt *btr, aobj *akey) {
     destroyBTKey(btkey, med);                            // FREED 026
     return destroyStream(btr, stream);                   // DESTROYED 027
 }
+static void abt_touch(bt *btr, aobj *akey) {
+    DECLARE_BT_KEY(akey,)
+    bt_touch(btr, btkey); destroyBTKey(btkey, med);      // FREED 026
+}
 static uint32 abt_get_dr(bt *btr, aobj *akey) {
     DECLARE_BT_KEY(akey, 0)
     uint32 dr = bt_get_dr(btr, btkey, akey); destroyBTKey(btkey, med);
@@ -267,6 +281,30 @@ static uint32 abt_insert(bt *btr, aobj *akey, void *val) {
     bt_insert(btr, stream, 0);                           /* FREE ME 028 */
     return ssize;
 }
+/* FAULT-IN: splits the DR covering akey, inserts val, akey inherits the rest */
+static bool abt_prev(bt *btr, aobj *akey, aobj *aprev) {
+    DECLARE_BT_KEY(akey, 0)
+    uchar *stream = bt_prev(btr, btkey);
+    destroyBTKey(btkey, med);                            /* FREED 026 */
+    if (!stream) return 0;
+    convertStream2Key(stream, aprev, btr);
+    return 1;
+}
+static bool abt_unevict(bt *btr, aobj *akey, void *val, uint32 left) {
+    uint32 kdr;
+    {
+        DECLARE_BT_KEY(akey, 0)
+        int ret = bt_unevict_dr(btr, btkey, left, &kdr);
+        destroyBTKey(btkey, med);                        // FREED 026
+        if (ret == -1) return 0; // IN BTREE
+    }
+    abt_insert(btr, akey, val);
+    if (kdr) {
+        DECLARE_BT_KEY(akey, 1)
+        bt_set_dr(btr, btkey, kdr); destroyBTKey(btkey, med); // FREED 026
+    }
+    return 1;
+}
 bt *abt_resize(bt *obtr, uchar trans) {              // printf("abt_resize\n");
     bts_t bts;
     memcpy(&bts, &obtr->s, sizeof(bts_t)); /* copy flags */
@@ -289,11 +327,20 @@ int   btReplace(bt *btr, aobj *apk, void *val) {
                                       return abt_replace(btr, apk, val); }
 void *btFind   (bt *btr, aobj *apk) { return abt_find   (btr, apk); }
 int   btDelete (bt *btr, aobj *apk) { return abt_del    (btr, apk); }
+//NOTE: btTouch() marks apk's ROW changed (DELTA) after an in place write
+void  btTouch  (bt *btr, aobj *apk) {        abt_touch  (btr, apk); }
 
 // DIRTY DIRTY DIRTY DIRTY DIRTY DIRTY DIRTY DIRTY DIRTY DIRTY DIRTY DIRTY
 dwm_t btFindD  (bt *btr, aobj *apk) { return abt_find_d(btr, apk); }
 //NOTE: btFindD() must precede btEvict()
 bool  btEvict  (bt *btr, aobj *apk) { return abt_evict (btr, apk); }
+//NOTE: btPrevKey() RETURNS 0 if apk has no predecessor (dirty_left's span)
+bool  btPrevKey(bt *btr, aobj *apk, aobj *aprev) {
+                                      return abt_prev(btr, apk, aprev);  }
+//NOTE: btUnevict() RETURNS 0 if apk is NOT covered by an evicted span
+//      left: evicted PKs between apk's predecessor & apk
+bool  btUnevict(bt *btr, aobj *apk, void *val, uint32 left) {
+                                return abt_unevict(btr, apk, val, left); }
 
 /* INDEX INDEX INDEX INDEX INDEX INDEX INDEX INDEX INDEX INDEX INDEX INDEX */
 void  btIndAdd   (bt *ibtr, aobj *ikey, bt *nbtr) {
@@ -329,6 +376,16 @@ int  btIndNodeDelete(bt *nbtr, aobj *apk, aobj *ocol) {
 int  btIndNodeEvict(bt *nbtr, aobj *apk, aobj *ocol) {       //DEBUG_INODE_EVICT
     abt_evict(nbtr, ocol ? ocol : apk); return nbtr->numkeys;
 }
+void btIndNodeUnevict(bt *nbtr, aobj *apk, aobj *ocol) { // whole DR -> pred
+    bt     *btr  = nbtr; uint32 kdr;
+    aobj   *akey = ocol ? ocol : apk;
+    DECLARE_BT_KEY(akey,)
+    if (!bt_unevict_dr(nbtr, btkey, UINT_MAX, &kdr)) { // LOST: DR went right
+        bt_steal_dr(nbtr); // INODE scans MISS on any DR, position is moot
+    }
+    destroyBTKey(btkey, med);                            // FREED 026
+    btIndNodeAdd(NULL, nbtr, apk, ocol);
+}
 
 // HELPER HELPER HELPER HELPER HELPER HELPER HELPER HELPER HELPER HELPER
 uint32  btGetDR  (bt *btr, aobj *akey) { return abt_get_dr(btr, akey); }
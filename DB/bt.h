@@ -47,6 +47,7 @@ bt *createIndexBT  (uchar ktype, int imatch);
 bt *createMCI_IBT  (list *clist, int imatch, uchar dtype);
 bt *createDBT      (uchar ktype, int tmatch);
 bt *createIndexNode(uchar pktyp, bool hasobc);
+bt *createCoverNode(uchar pktyp, uchar vtype, int imatch);
 
 #define DECLARE_BT_KEY(akey, ret)                                          \
     bool  med; uint32 ksize;                                               \
@@ -61,6 +62,7 @@ bt *createIndexNode(uchar pktyp, bool hasobc);
 #define BTREE_MCI_MID  4
 #define BT_MCI_UNIQ    5
 #define BT_SIMP_UNIQ   6
+#define BT_COVER       7
 
 /* INT Inodes have been optimised */
 #define INODE_I(btr) \
@@ -78,6 +80,7 @@ bt *createIndexNode(uchar pktyp, bool hasobc);
 
 #define SIMP_UNIQ(btr) (btr->s.btype == BT_SIMP_UNIQ)
 #define MCI_UNIQ(btr)  (btr->s.btype == BT_MCI_UNIQ)
+#define COVERI(btr)    (btr->s.btype == BT_COVER)
 
 #define OBYI(btr) (btr->s.bflag & BTFLAG_OBC)
 
@@ -176,7 +179,10 @@ void  *btFind   (bt *btr, aobj *apk);
 dwm_t  btFindD  (bt *btr, aobj *apk);
 int    btReplace(bt *btr, aobj *apk, void *val);
 int    btDelete (bt *btr, aobj *apk);
+void   btTouch  (bt *btr, aobj *apk);
 bool   btEvict  (bt *btr, aobj *apk);
+bool   btPrevKey(bt *btr, aobj *apk, aobj *aprev);
+bool   btUnevict(bt *btr, aobj *apk, void *val, uint32 left);
 
 void  btIndAdd   (bt *ibtr, aobj *ikey, bt  *nbtr);
 bt   *btIndFind  (bt *ibtr, aobj *ikey);
@@ -189,6 +195,7 @@ bool  btIndNodeExist  (        bt *nbtr, aobj *apk);
 int   btIndNodeDelete (        bt *nbtr, aobj *apk, aobj *ocol);
 void  btIndNodeDeleteD(        bt *nbtr, aobj *apk, aobj *ocol);
 int   btIndNodeEvict  (        bt *nbtr, aobj *apk, aobj *ocol);
+void  btIndNodeUnevict(        bt *nbtr, aobj *apk, aobj *ocol);
 
 // HELPER HELPER HELPER HELPER HELPER HELPER HELPER HELPER HELPER HELPER
 uint32  btGetDR    (bt *btr, aobj *akey);
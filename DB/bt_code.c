@@ -67,6 +67,12 @@ ALL RIGHTS RESERVED
 // GLOBALS
 extern r_ind_t *Index;
 
+/* DELTA: a btn's epoch is BtEpoch at its last write, rdb_delta.c bumps
+          BtEpoch when it forks a base snapshot -> btn's w/ (epoch > base)
+          changed since the base (i.e. they are in the next delta) */
+uint32 BtEpoch = 1;
+#define STAMP_BTN(x) (x)->epoch = BtEpoch;
+
 /* PROTOYPES */
 static void      release_dirty_stream(bt *btr, bt_n *x);
 static int       real_log2           (unsigned int a, int nbits);
@@ -151,6 +157,7 @@ static bt_n *allocbtreenode(bt *btr, bool leaf, char dirty) {
     bt_increment_used_memory(btr, msize);
     x->leaf       = -1;
     x->dirty      = dirty;
+    x->epoch      = BtEpoch;
     if (dirty != -1) alloc_ds(btr, x, nsize, dirty);
     return x;
 }
@@ -238,8 +245,8 @@ static inline int real_log2(unsigned int a, int nbits) {
  * ~58 million calls to log2.  Using a lookup table IS NECESSARY!
  -> memory usage of this is trivial, like less than 1KB */
 static inline int _log2(unsigned int a, int nbits) {
-    static char   *table   = NULL;
-    static uint32  alloced = 0;
+    static __thread char   *table   = NULL; /* per-thread: rdb_pload.c */
+    static __thread uint32  alloced = 0;
     uint32 i;
     if (a >= alloced) {
         table = realloc(table, (a + 1) * sizeof *table);
@@ -422,7 +429,7 @@ static void setBTKeyRaw(bt *btr, bt_n *x, int i, void *src) { //PRIVATE
     if      ISVOID(btr) *dest                  = src;   
     else if ISUINT(btr) *(int *)((long *)dest) = (int)(long)src;
     else                memcpy(dest, src, btr->s.ksize);
-    //DEBUG_SET_KEY
+    STAMP_BTN(x)        //DEBUG_SET_KEY
 }
 static bt_n *setBTKey(bt *btr,  bt_n *dx, int di,  bt_n *sx, int si,
                       bool drt, bt_n *pd, int pdi, bt_n *ps, int psi) {
@@ -461,35 +468,42 @@ static void mvXKeys(bt *btr, bt_n   **dx, int di,
         memcpy(dk, sk, ks);
         if (forward) i--; else i++;
     }
+    STAMP_BTN(*dx)
 }
 static inline void mvXNodes(bt *btr, bt_n *x, int xofst,
                                      bt_n *z, int zofst, int num) {
   memmove(NODES(btr, x) + xofst, NODES(btr, z) + zofst, (num) * VOIDSIZE);
 }
 
-//NOTE: trimBTN*() do not ever dirty btn's -- TODO they could UN-dirty
-static bt_n *trimBTN(bt *btr, bt_n *x, bool drt, bt_n *p, int pi) {
+//NOTE: trimBTN*() do not ever dirty btn's -- they UN-dirty the vacated slots
+//      (a stale DR past x->n resurfaces when a later insert reuses the slot)
+static bt_n *trimBTN(bt *btr, bt_n *x, bt_n *p, int pi) {
   //DEBUG_TRIM_BTN
-    if (drt) x = zeroDR(btr, x, x->n, p, pi);
-    x->n--; return x;
+    x = zeroDR(btr, x, x->n - 1, p, pi);
+    x->n--; STAMP_BTN(x) return x;
 }
-static bt_n *trimBTN_n(bt *btr, bt_n *x, int n, bool drt, bt_n *p, int pi) {
-    if (drt) {
-        for (int i = x->n; i >= (x->n - n); i--) x = zeroDR(btr, x, i, p, pi);
-    }
-    x->n -= n; return x;
+static bt_n *trimBTN_n(bt *btr, bt_n *x, int n, bt_n *p, int pi) {
+    for (int i = x->n - 1; i >= (x->n - n); i--) x = zeroDR(btr, x, i, p, pi);
+    x->n -= n; STAMP_BTN(x) return x;
 }
 
 // INSERT INSERT INSERT INSERT INSERT INSERT INSERT INSERT INSERT INSERT
-static void btreesplitchild(bt *btr, bt_n *x, int i, bt_n *y, bt_n *p, int pi) {
+/* NOTE: moving a DR up into a clean x realloc's x -> RETURNS x
+         (xp, xpi): x's parent, (x, i): y's parent */
+static bt_n *btreesplitchild(bt *btr, bt_n *x,  int i, bt_n *y,
+                                      bt_n *xp, int xpi) {
     ushort16  t = btr->t;
     bt_n     *z = allocbtreenode(btr, y->leaf, y->dirty); //TODO dirtymath
     z->leaf     = y->leaf; /* duplicate leaf setting */
+    for (int j = x->n; j > i; j--) {      // move nodes in parent down one
+        NODES(btr, x)[j + 1] = NODES(btr, x)[j];
+    }
+    NODES(btr, x)[i + 1] = z; // store new node b4 DRs move (z may realloc)
     for (int j = 0; j < t - 1; j++) {
-        z = setBTKey(btr, z, j, y, j + t, 1, p, pi, p, pi);
+        z = setBTKey(btr, z, j, y, j + t, 1, x, i + 1, x, i);
     }
     z->scion = get_scion_range(btr, z, 0, t - 1); decr_scion(y, z->scion);
-    z->n     = t - 1; y = trimBTN_n(btr, y, t - 1, 0, p, pi);
+    z->n     = t - 1; y = trimBTN_n(btr, y, t - 1, x, i);
     if (!y->leaf) { // if it's an internal node, copy the ptr's too 
         for (int j = 0; j < t; j++) {
             uint32_t scion   = NODES(btr, y)[j + t]->scion;
@@ -497,16 +511,13 @@ static void btreesplitchild(bt *btr, bt_n *x, int i, bt_n *y, bt_n *p, int pi) {
             NODES(btr, z)[j] = NODES(btr, y)[j + t];
         }
     }
-    for (int j = x->n; j > i; j--) {      // move nodes in parent down one
-        NODES(btr, x)[j + 1] = NODES(btr, x)[j];
-    }
-    NODES(btr, x)[i + 1] = z;             // store new node 
     for (int j = x->n - 1; j >= i; j--) { // adjust the keys from previous move
-        x = setBTKey(btr, x, j + 1, x, j, 1, p, pi, p, pi);
+        x = setBTKey(btr, x, j + 1, x, j, 1, xp, xpi, xp, xpi);
     }
     decr_scion(y, 1 + getDR(btr, y, y->n - 1)); //NEXT LINE: store new key
-    x = setBTKey(btr, x, i, y, y->n - 1, 1, p, pi, p, pi); x->n++;
-    trimBTN(btr, y, 0, p, pi);
+    x = setBTKey(btr, x, i, y, y->n - 1, 1, xp, xpi, x, i); x->n++;
+    trimBTN(btr, y, x, i);
+    return x;
 }
 
 #define GETN(btr) ((2 * btr->t) - 1)
@@ -523,7 +534,7 @@ static void bt_insertnonfull(bt  *btr, bt_n *x, bt_data_t k, bt_n *p, int pi,
     } else { /* not leaf */
         int i = findkindex(btr, x, k, NULL, NULL) + 1;
         if (NODES(btr, x)[i]->n == GETN(btr)) { // if next node is full
-            btreesplitchild(btr, x, i, NODES(btr, x)[i], x, i);
+            x = btreesplitchild(btr, x, i, NODES(btr, x)[i], p, pi);
             if (btr->cmp(k, KEYS(btr, x, i)) > 0) i++;
         }
         bt_insertnonfull(btr, NODES(btr, x)[i], k, x, i, dr); incr_scion(x, 1);
@@ -540,7 +551,7 @@ void bt_insert(bt *btr, bt_data_t k, uint32 dr) {
         s->n             = 0;
         incr_scion(s, r->scion);
         NODES(btr, s)[0] = r;
-        btreesplitchild(btr, s, 0, r, p, pi);
+        s                = btreesplitchild(btr, s, 0, r, p, pi);
         p                = r = s;
         btr->numnodes++;
     }
@@ -572,8 +583,9 @@ void *case_2c_ptr = NULL;
 
 #define CREATE_RETURN_DELETED_KEY(btr, kp, dr)        \
   dwd_t dwd; bzero(&dwd, sizeof(dwd_t)); dwd.dr = dr; \
-  if BIG_BT(btr) memcpy(BT_DelBuf, kp, btr->s.ksize); \
-  dwd.k  = BIG_BT(btr) ? BT_DelBuf : kp;
+  bool  cpk = BIG_BT(btr) || INODE_X(btr); /* U128 */ \
+  if (cpk) memcpy(BT_DelBuf, kp, btr->s.ksize);       \
+  dwd.k  = cpk ? BT_DelBuf : kp;
 
 #define DK_NONE 0
 #define DK_2A   1
@@ -626,7 +638,7 @@ static dwd_t deletekey(bt   *btr, bt_n *x,  bt_data_t k,     int    s, bool drt,
         } else if (dr) decr_scion(x, dr); // CASE: DELETE CASE2A/B
         if (!rgst) { // IF NO REPLACE_W_GHOST -> Remove from BTREE
             mvXKeys(btr, &x, i, &x, i + 1, (x->n - i - 1), ks, p, pi, p, pi);
-            x      = trimBTN(btr, x, drt, p, pi);
+            x      = trimBTN(btr, x, p, pi);
         }
         return dwd;
     }
@@ -698,7 +710,7 @@ static dwd_t deletekey(bt   *btr, bt_n *x,  bt_data_t k,     int    s, bool drt,
             y->n += z->n;
             mvXKeys (btr, &x, i, &x, i + 1,   (x->n - i - 1), ks, p, pi, p, pi);
             mvXNodes(btr, x, i + 1, x, i + 2, (x->n - i - 1));
-            x = trimBTN(btr, x, drt, p, pi);
+            x = trimBTN(btr, x, p, pi);
             bt_free_btreenode(btr, z);
             ADD_BP(plist, x, i)
             //printf("CASE2C key: "); printKey(btr, x, i);
@@ -732,7 +744,7 @@ static dwd_t deletekey(bt   *btr, bt_n *x,  bt_data_t k,     int    s, bool drt,
                 incr_scion(xp, dscion); decr_scion(y, dscion);
                 NODES(btr, xp)[0] = NODES(btr, y)[y->n];
             }
-            y  = trimBTN(btr, y, drt, x, i - 1);
+            y  = trimBTN(btr, y, x, i - 1);
         } else if (i < x->n && (y = NODES(btr, x)[i + 1])->n >= btr->t) {
             //printf("CASE3A2 key: "); printKey(btr, x, i);
             /* right sibling has t keys */                 //DEBUG_DEL_CASE_3a2
@@ -747,7 +759,7 @@ static dwd_t deletekey(bt   *btr, bt_n *x,  bt_data_t k,     int    s, bool drt,
             }
             mvXKeys(btr, &y, 0, &y, 1, y->n - 1, ks, x, i + 1, x, i + 1);
             if (!y->leaf) mvXNodes(btr, y, 0, y, 1, y->n);
-            y  = trimBTN(btr, y, drt, x, i + 1);
+            y  = trimBTN(btr, y, x, i + 1);
         }
         /* Case 3b:
          * If xp and all of xp's siblings have t - 1 keys, merge xp with
@@ -767,7 +779,7 @@ static dwd_t deletekey(bt   *btr, bt_n *x,  bt_data_t k,     int    s, bool drt,
             y->n += xp->n;
             mvXKeys (btr, &x, i - 1, &x, i, (x->n - i), ks, p, pi, p, pi);
             mvXNodes(btr, x, i, x, i + 1, (x->n - i));
-            x = trimBTN(btr, x, drt, p, pi);
+            x = trimBTN(btr, x, p, pi);
             bt_free_btreenode(btr, xp);
             xp = y; i--; // i-- for parent-arg in recursion (below)
         } else if (i < x->n && (y = NODES(btr, x)[i + 1])->n == btr->t - 1) {
@@ -784,7 +796,7 @@ static dwd_t deletekey(bt   *btr, bt_n *x,  bt_data_t k,     int    s, bool drt,
             xp->n += y->n;
             mvXKeys (btr, &x, i, &x, i + 1, (x->n - i - 1), ks, p, pi, p, pi);
             mvXNodes(btr, x, i + 1, x, i + 2, (x->n - i - 1));
-            x = trimBTN(btr, x, drt, p, pi);
+            x = trimBTN(btr, x, p, pi);
             bt_free_btreenode(btr, y);
         }
     } //printf("RECURSE CASE 3\n");
@@ -803,7 +815,7 @@ static dwd_t remove_key(bt *btr, bt_data_t k, bool drt) {
     case_2c_ptr = NULL;                                       //DEBUG_DEL_START
     bt_n  *p    = btr->root; int pi = 0;
     list  *plist; // NOTE: plist stores ancestor line during recursive delete
-    if (drt) {
+    if (drt || INODE(btr)) { // INODE DELETE passes its DR on (incrPrevDR())
         plist = listCreate(); plist->free = free_bp; ADD_BP(plist, p, pi)//FR110
     } else plist = NULL;
     dwd_t dwd   = deletekey(btr, btr->root, k, DK_NONE, drt, p, pi, plist);
@@ -925,12 +937,25 @@ bt_data_t *bt_find_loc(bt *btr, bt_data_t k) { /* pointer to BT ROW */
     bt_n *x  = btr->root;
     while (x) {
         i = findkindex(btr, x, k, &r, NULL);
-        if (i >= 0 && r == 0) return &OKEYS(btr, x)[i];
+        if (i >= 0 && r == 0) { /* caller writes the ROW */
+            STAMP_BTN(x) return &OKEYS(btr, x)[i];
+        }
         if (x->leaf)          return NULL;
         x = NODES(btr, x)[i + 1];
     }
     return NULL;
 }
+/* DELTA: k's ROW was overwritten in place (UPDATE OVERWRITE, LRU, LFU) */
+void bt_touch(bt *btr, bt_data_t k) {
+    int   r = -1;
+    bt_n *x = btr->root;
+    while (x) {
+        int i = findkindex(btr, x, k, &r, NULL);
+        if (i >= 0 && r == 0) { STAMP_BTN(x) return; }
+        if (x->leaf)          return;
+        x = NODES(btr, x)[i + 1];
+    }
+}
 
 static bt_data_t findminkey(bt *btr, bt_n *x) {
     if (x->leaf) return KEYS(btr, x, 0);
@@ -957,6 +982,95 @@ uint32 bt_get_dr(bt *btr, bt_data_t k, aobj *akey) {
     return getDR(btr, dwm.x, dwm.i);
 }
 
+// UNEVICT UNEVICT UNEVICT UNEVICT UNEVICT UNEVICT UNEVICT UNEVICT UNEVICT
+/* NOTE: an evicted key is counted in its predecessor's DR (or in
+         btr->dirty_left when it has no predecessor). bt_unevict_dr() takes
+         the key back out of that count, the caller then bt_insert()s it and
+         hands it the rest of the span w/ bt_set_dr(): the predecessor keeps
+         "left" (the span's evicted keys below k, the caller knows them),
+         k gets the rest -> [pred:DR=left] [k:DR=dr-1-left]
+         EVICT leaves scions alone (the evicted key is still counted where
+         it was), so moving DR around does not touch them either & k's
+         insertion path is decremented up front (bt_insert() re-adds it)
+         NOTE: a DELETE that rebalances can drop a neighbour's DR, k's count
+               is then already gone (LOST) -> k goes back in w/ DR=0 */
+#define BT_MAX_DEPTH 64
+typedef struct bt_path {
+    bt_n *x [BT_MAX_DEPTH];
+    int   ci[BT_MAX_DEPTH]; /* child slot descended into */
+} btp_t;
+
+/* RETURNS: depth of k's node (-1 -> k not in btr), *ki: k's slot
+            *pd & *pi: depth & slot of k's predecessor (*pd = -1 -> none) */
+static int findpath(bt *btr, bt_data_t k, btp_t *bp, int *ki,
+                    int *pd, int *pi) {
+    int   r = -1, d = 0;
+    bt_n *x = btr->root; *pd = -1;
+    while (x) {
+        assert(d < BT_MAX_DEPTH);
+        int i    = findkindex(btr, x, k, &r, NULL);
+        bp->x[d] = x;
+        if (i >= 0 && !r) { *ki = i;           return d;  }
+        if (i >= 0)       { *pd = d; *pi = i;             }
+        if (x->leaf)                           return -1;
+        bp->ci[d] = i + 1; x = NODES(btr, x)[i + 1]; d++;
+    }
+    return -1;
+}
+static void setpathdr(bt *btr, btp_t *bp, int d, int i, uint32 dr) {
+    bt_n *p  = d ? bp->x[d - 1]  : btr->root;
+    int   pi = d ? bp->ci[d - 1] : 0;
+    bp->x[d] = overwriteDR(btr, bp->x[d], i, dr, p, pi);
+}
+bt_data_t bt_prev(bt *btr, bt_data_t k) { /* k's predecessor (NULL->none) */
+    btp_t bp; int ki, pd, pi;
+    if (!btr->root || !btr->numkeys)                    return NULL;
+    findpath(btr, k, &bp, &ki, &pd, &pi);
+    return (pd == -1) ? NULL : KEYS(btr, bp.x[pd], pi);
+}
+/* RETURNS: -1 k is IN btr, 0 no DR covers k (LOST), 1 k's count taken out */
+int bt_unevict_dr(bt *btr, bt_data_t k, uint32 left, uint32 *kdr) {
+    btp_t bp; int ki, pd, pi; *kdr = 0;
+    if (!btr->root)                                     return 0;
+    if (findpath(btr, k, &bp, &ki, &pd, &pi) != -1)     return -1;
+    uint32 dr = (pd == -1) ? btr->dirty_left : getDR(btr, bp.x[pd], pi);
+    if (!dr)                                            return 0;
+    if (left > dr - 1) left = dr - 1;
+    if (pd == -1) btr->dirty_left = left;               // LEFT of MIN KEY
+    else          setpathdr(btr, &bp, pd, pi, left);
+    *kdr = dr - 1 - left;
+    int   r = -1;
+    bt_n *x = btr->root; // NOTE: setpathdr() may have realloced a node
+    while (x) {
+        decr_scion(x, 1);
+        if (x->leaf) break;
+        x = NODES(btr, x)[findkindex(btr, x, k, &r, NULL) + 1];
+    }
+    return 1;
+}
+static bool stealdr(bt *btr, bt_n *x) {
+    for (int i = 0; i < x->n; i++) {
+        uint32 dr = getDR(btr, x, i); // NOTE: x is dirty -> no realloc
+        if (dr) { __setDR(btr, x, i, dr - 1); decr_scion(x, 1); return 1; }
+    }
+    if (x->leaf) return 0;
+    for (int i = 0; i <= x->n; i++) {
+        if (stealdr(btr, NODES(btr, x)[i])) { decr_scion(x, 1); return 1; }
+    }
+    return 0;
+}
+/* NOTE: takes one evicted key out of ANY DR (dirty_left first)
+         USE: a LOST count in an INODE, where only the total matters */
+bool bt_steal_dr(bt *btr) {
+    if (btr->dirty_left) { btr->dirty_left--;          return 1; }
+    return btr->root ? stealdr(btr, btr->root) : 0;
+}
+void bt_set_dr(bt *btr, bt_data_t k, uint32 dr) {
+    btp_t bp; int ki, pd, pi;
+    int   d = findpath(btr, k, &bp, &ki, &pd, &pi);
+    if (d != -1) setpathdr(btr, &bp, d, ki, dr);
+}
+
 // CLONE CLONE CLONE CLONE CLONE CLONE CLONE CLONE CLONE CLONE CLONE CLONE
 void bt_to_bt_insert(bt *nbtr, bt *obtr, bt_n *x) {
     for (int i = 0; i < x->n; i++) {
@@ -969,6 +1083,54 @@ void bt_to_bt_insert(bt *nbtr, bt *obtr, bt_n *x) {
         }}
 }
 
+// BULK_LOAD BULK_LOAD BULK_LOAD BULK_LOAD BULK_LOAD BULK_LOAD BULK_LOAD
+/* NOTE: builds an EMPTY & CLEAN btr bottom-up from n SORTED key slots (ksize
+         bytes each, exactly as they sit in a bt_n) -> used by RDB LOAD.
+         Keys are spread evenly: L = ceil((n+1)/(m+1)) leaves get [t-1,m] keys
+         each, the L-1 keys in between go up a level as separators, parents
+         get ceil(N/(m+1)) even groups of [t,m+1] children, until 1 is left */
+void bt_bulk_load(bt *btr, uchar *slots, uint32 n) {
+    assert(!btr->numkeys && !btr->dirty);
+    if (!n) return;
+    uint32  m    = GETN(btr);
+    uint32  ks   = btr->s.ksize;
+    uint32  nn   = (n + m + 1) / (m + 1);                /* number of leaves */
+    bt_n  **nds  = malloc(sizeof(bt_n *) * nn);          // FREE ME 234
+    uint32 *seps = malloc(sizeof(uint32) * nn);          // FREE ME 235
+    bt_free_btreenode(btr, btr->root); btr->numnodes = 0;
+    uint32  q    = (n - nn + 1) / nn, r = (n - nn + 1) % nn, k = 0;
+    for (uint32 j = 0; j < nn; j++) {                    /* LEAVES */
+        bt_n   *x   = allocbtreenode(btr, 1, -1);
+        uint32  cnt = q + (j < r);
+        x->leaf     = 1; x->n = cnt; x->scion = cnt;
+        memcpy(AKEYS(btr, x, 0), slots + (size_t)k * ks, (size_t)cnt * ks);
+        k          += cnt;
+        if (j != nn - 1) seps[j] = k++;
+        nds[j]      = x;
+    }
+    while (nn > 1) {                                     /* LEVEL UP */
+        uint32 np = (nn + m) / (m + 1), ci = 0;
+        q         = nn / np; r = nn % np;
+        for (uint32 p = 0; p < np; p++) { /* NOTE: in-place, p < ci */
+            bt_n   *x = allocbtreenode(btr, 0, -1);
+            uint32  g = q + (p < r);
+            x->leaf   = 0; x->n = g - 1;
+            for (uint32 c = 0; c < g; c++, ci++) {
+                NODES(btr, x)[c] = nds[ci]; incr_scion(x, nds[ci]->scion);
+                if (c == g - 1) continue;
+                memcpy(AKEYS(btr, x, c), slots + (size_t)seps[ci] * ks, ks);
+                incr_scion(x, 1);
+            }
+            if (p != np - 1) seps[p] = seps[ci - 1];
+            nds[p] = x;
+        }
+        nn = np;
+    }
+    btr->root    = nds[0];
+    btr->numkeys = n;
+    free(nds); free(seps);                               // FREED 234, 235
+}
+
 // DESTRUCTOR DESTRUCTOR DESTRUCTOR DESTRUCTOR DESTRUCTOR DESTRUCTOR
 static void destroy_bt_node(bt *btr, bt_n *x) {
     for (int i = 0; i < x->n; i++) {
@@ -34,9 +34,12 @@ ALL RIGHTS RESERVED
 #include "stream.h"
 #include "aobj.h"
 #include "query.h"
+#include "mmtbl.h"
 #include "common.h"
 #include "bt_iterator.h"
 
+extern r_tbl_t *Tbl;
+
 #define DUMP_CURR_KEY                                                     \
   { void *curr = KEYS(iter->btr, iter->bln->self, iter->bln->ik);         \
     aobj  key; convertStream2Key(curr, &key, iter->btr);                  \
@@ -51,8 +54,9 @@ ALL RIGHTS RESERVED
   btSIter *siter = createIterator(btr, asc ? l : lrev, asc ? n : nrev);
 
 #define MAX_NUM_ITERS 64
-static int     WhichIter = 0;
-static btSIter BT_Iterators[MAX_NUM_ITERS]; /* avoid malloc()s */
+/* NOTE: per-thread stacks -> RDB load builds indexes on threads */
+static __thread int     WhichIter = 0;
+static __thread btSIter BT_Iterators[MAX_NUM_ITERS]; /* avoid malloc()s */
 
 bt_ll_n *get_new_iter_child(btIterator *iter) { //printf("get_newiterchild\n");
     assert(iter->num_nodes < MAX_BTREE_DEPTH);
@@ -221,6 +225,7 @@ static btSIter *createIterator(bt *btr, iter_single *itl, iter_single *itn) {
     siter->scan    = 0;
     siter->ktype   = btr->s.ktype;
     siter->which   = WhichIter;
+    siter->mm      = NULL;
     WhichIter++;                                         // PUSH ON STACK 01
     initAobj(&siter->key);
     siter->be.key  = &(siter->key); siter->be.val = NULL;
@@ -260,17 +265,58 @@ static bool streamToBTEntry(uchar *stream, btSIter *siter, bt_n *x, int i) {
     //DUMP_STREAM_TO_BT_ENTRY
     return 1;
 }
+// MMAP_ITERATOR MMAP_ITERATOR MMAP_ITERATOR MMAP_ITERATOR MMAP_ITERATOR
+/* MMAP tables (mmtbl.c) have no bt_n's -> the position is a ROW number,
+   ROWs are never missed (MMAP tables can not be DIRTY) */
+static long mmtSeekKey(bt *btr, aobj *akey, bool asc) {
+    bool med; uint32 ksize;
+    char *bkey = createBTKey(akey, &med, &ksize, btr);  /* FREE ME 032 */
+    if (!bkey) return -1;
+    long  r    = mmtSeek(MMT(btr), btr, bkey, asc);
+    destroyBTKey(bkey, med);                            /* DESTROYED 032 */
+    return r;
+}
+static btSIter *mmtIter(bt *btr, long r, aobj *high, bool asc, bool scan) {
+    CR8ITER8R(btr, asc, iter_leaf, iter_leaf_rev, iter_node, iter_node_rev);
+    siter->mm   = MMT(btr); siter->scan = scan;
+    setHigh(siter, high, btr->s.ktype);
+    if (r < 0 || r >= (long)siter->mm->nrows) return siter; /* empty */
+    siter->mr   = r; siter->mp = 0; siter->empty = 0;
+    void *e     = mmtRow(siter->mm, btr, r, &siter->mp);
+    streamToBTEntry(e, siter, NULL, 0);                 /* peek */
+    return siter;
+}
+static void *mmtNext(btSIter *siter, bool asc) {
+    if (siter->x.finished) return NULL;
+    void *e = mmtRow(siter->mm, siter->x.btr, siter->mr, &siter->mp);
+    if (!e) { siter->x.finished = 1; return NULL; }
+    siter->mr += asc ? 1 : -1;
+    return e;
+}
+
 btSIter *btGetRangeIter(bt *btr, aobj *alow, aobj *ahigh, bool asc) {
+    if (MMT(btr)) {
+        if (!btr->numkeys)                     return NULL;
+        long     r     = mmtSeekKey(btr, asc ? alow : ahigh, asc);
+        btSIter *siter = mmtIter(btr, r, asc ? ahigh : alow, asc, 0);
+        if (siter->empty) { btReleaseRangeIterator(siter); return NULL; }
+        return siter;
+    }
     if (!btr->root || !btr->numkeys)           return NULL;
     bool med; uint32 ksize;                 //bt_dumptree(btr, btr->ktype);
     CR8ITER8R(btr, asc, iter_leaf, iter_leaf_rev, iter_node, iter_node_rev);
     setHigh(siter, asc ? ahigh : alow, btr->s.ktype);
     char    *bkey  = createBTKey(asc ? alow : ahigh, &med, &ksize, btr); //D032
-    if (!bkey)                                 return NULL;
+    if (!bkey) {         btReleaseRangeIterator(siter); return NULL; }
     bt_n *x  = NULL; int i = -1;
     uchar *stream = setIter(btr, bkey, siter, asc ? alow : ahigh, &x, &i, asc);
     destroyBTKey(bkey, med);                                /* DESTROYED 032 */
-    if (!streamToBTEntry(stream, siter, x, i)) return NULL;
+    if (!stream && siter->missed) { // II_L_MISS: iterator is @ the MIN KEY
+        x = siter->x.bln->self; i = siter->x.bln->ik; stream = KEYS(btr, x, i);
+    }
+    if (!streamToBTEntry(stream, siter, x, i)) { // e.g. off end of B-tree
+        btReleaseRangeIterator(siter);                      return NULL;
+    }
     return siter;
 }
 btEntry *btRangeNext(btSIter *siter, bool asc) { //printf("btRangeNext\n");
@@ -278,12 +324,13 @@ btEntry *btRangeNext(btSIter *siter, bool asc) { //printf("btRangeNext\n");
     //if (siter) printf("btRangeNext: empty: %d\n", siter->empty);
     if (!siter || siter->empty) return NULL;
     bt_n *x  = NULL; int i = -1;
-    uchar *stream = btNext(siter, &x, &i, asc);
+    uchar *stream = siter->mm ? mmtNext(siter, asc) :
+                                btNext (siter, &x, &i, asc);
     if (!streamToBTEntry(stream, siter, x, i)) return NULL;
     if        (C_IS_I(siter->ktype) || C_IS_L(siter->ktype)) {
         ulong l = C_IS_I(siter->ktype) ? (ulong)(siter->key.i) : siter->key.l;
         if (l == siter->x.high)  siter->x.finished = 1;       /* exact match */
-        if (!asc) {
+        if (!asc && x) {
             //printf("btRangeNext: DESC: l: %lu dr: %u\n", 
             //       l, getDR(siter->x.btr, x, i));
             l += getDR(siter->x.btr, x, i);
@@ -296,7 +343,7 @@ btEntry *btRangeNext(btSIter *siter, bool asc) { //printf("btRangeNext\n");
     } else if (C_IS_X(siter->ktype)) {
         uint128 xx = siter->key.x;
         if (xx == siter->x.highx)  siter->x.finished = 1;      /* exact match */
-        if (!asc) {
+        if (!asc && x) {
             xx += getDR(siter->x.btr, x, i);
         }
         bool over = asc ? (xx > siter->x.highx) : (xx < siter->x.highx);
@@ -316,29 +363,38 @@ btEntry *btRangeNext(btSIter *siter, bool asc) { //printf("btRangeNext\n");
 
 // FULL_BTREE_ITERATOR FULL_BTREE_ITERATOR FULL_BTREE_ITERATOR
 bool assignMinKey(bt *btr, aobj *akey) {       //TODO combine w/ setIter()
-    void *e = bt_min(btr); if (!e)   return 0; //      iter can be initialised
-    convertStream2Key(e, akey, btr); return 1; //      w/ this lookup
+    mmt_t *mm = MMT(btr);                      //      iter can be initialised
+    void  *e  = mm ? mmtMin(mm, btr) : bt_min(btr); // w/ this lookup
+    if (!e)                          return 0;
+    convertStream2Key(e, akey, btr); return 1;
 }
 bool assignMaxKey(bt *btr, aobj *akey) {
-    void *e = bt_max(btr); if (!e)   return 0;
+    mmt_t *mm = MMT(btr);
+    void  *e  = mm ? mmtMax(mm, btr) : bt_max(btr);
+    if (!e)                          return 0;
     convertStream2Key(e, akey, btr); return 1;
 }
-static cswc_t W; // iterators dont care about w.wf.alow/ahigh
+static __thread cswc_t W; // iterators dont care about w.wf.alow/ahigh
 btSIter *btGetFullRangeIter(bt *btr, bool asc, cswc_t *w) {
-    if (!btr->root || !btr->numkeys)                      return NULL;
+    mmt_t *mm = MMT(btr);
+    if ((!mm && !btr->root) || !btr->numkeys)             return NULL;
     if (!w) w = &W; aobj *aL = &w->wf.alow, *aH = &w->wf.ahigh;
     if (!assignMinKey(btr, aL) || !assignMaxKey(btr, aH)) return NULL;
+    if (mm) return mmtIter(btr, asc ? 0 : (long)mm->nrows - 1,
+                           asc ? aH : aL, asc, 1);
     bool med; uint32 ksize;
     CR8ITER8R(btr, asc, iter_leaf, iter_leaf_rev, iter_node, iter_node_rev);
     siter->scan = 1;
     setHigh(siter, asc ? aH : aL, btr->s.ktype);
     char *bkey  = createBTKey(asc ? aL : aH, &med, &ksize, btr); //DEST 030
-    if (!bkey)                                            return NULL;
+    if (!bkey) {             btReleaseRangeIterator(siter); return NULL; }
     bt_n *x  = NULL; int i = -1;
     uchar *stream = setIter(btr, bkey, siter, asc ? aL : aH, &x, &i, asc);
     destroyBTKey(bkey, med);                             /* DESTROYED 030 */
     if (!stream && siter->missed)                         return siter;//IILMISS
-    if (!streamToBTEntry(stream, siter, x, i))            return NULL;
+    if (!streamToBTEntry(stream, siter, x, i)) {
+        btReleaseRangeIterator(siter);                    return NULL;
+    }
     if (btr->dirty_left) siter->missed = 1; // FULL means 100% FULL
     return siter;
 }
@@ -543,6 +599,12 @@ static bool XthIterFind(btSIter *siter, aobj *alow, aobj *ahigh,
   printf("btGetXthIter: ofst: %ld asc: %d\n", ofst, asc);
 btSIter *btGetXthIter(bt *btr, aobj *alow, aobj *ahigh, long oofst, bool asc) {
     ulong ofst = (ulong)oofst;                             //DEBUG_GET_XTH_ITER
+    if (MMT(btr)) {
+        if (!btr->numkeys)           return NULL;
+        long r = mmtSeekKey(btr, asc ? alow : ahigh, asc);
+        if (r != -1) r += asc ? oofst : -oofst;
+        return mmtIter(btr, r, asc ? ahigh : alow, asc, 0);
+    }
     if (!btr->root || !btr->numkeys) return NULL;
     CR8ITER8R(btr, asc, iter_leaf, iter_leaf_rev, iter_node, iter_node_rev);
     setHigh(siter, asc ? ahigh : alow, btr->s.ktype);
@@ -633,9 +695,12 @@ static bool btScionFind(btSIter *siter, bt_n *x, ulong ofst, bt *btr, bool asc,
 }
 btSIter *btGetFullXthIter(bt *btr, long oofst, bool asc, cswc_t *w, long lim) {
     ulong ofst = (ulong)oofst;
-    if (!btr->root || !btr->numkeys)                      return NULL;
+    mmt_t *mm  = MMT(btr);
+    if ((!mm && !btr->root) || !btr->numkeys)             return NULL;
     if (!w) w = &W; aobj *aL = &w->wf.alow, *aH = &w->wf.ahigh;
     if (!assignMinKey(btr, aL) || !assignMaxKey(btr, aH)) return NULL;
+    if (mm) return mmtIter(btr, asc ? oofst : (long)mm->nrows - 1 - oofst,
+                           asc ? aH : aL, asc, 1);
     CR8ITER8R(btr, asc, iter_leaf, iter_leaf_rev, iter_node, iter_node_rev);
     setHigh(siter, asc ? aH : aL, btr->s.ktype);
     if (btScionFind(siter, btr->root, ofst, btr, asc, w, lim)) siter->empty = 0;
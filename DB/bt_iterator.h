@@ -79,6 +79,9 @@ typedef struct btSIter { // btIterator 500+ bytes -> STACK (globals) ALLOCATE
     int        which; // which BT_Iterators[] slot
     btEntry    be;
     aobj       key;    // static AOBJ for be.key
+    struct mmt *mm;    // MMAP: table's pages (x is unused)
+    long       mr;     // MMAP: next ROW
+    uint32     mp;     // MMAP: page of the last ROW
 } btSIter;
 
 #define II_FAIL       -1
@@ -78,6 +78,10 @@ bt_data_t  bt_min     (struct btree *btr);
 bt_data_t  bt_find    (struct btree *btr, bt_data_t k, aobj *akey);
 bt_data_t *bt_find_loc(struct btree *btr, bt_data_t k);
 
+// DELTA DELTA DELTA DELTA DELTA DELTA DELTA DELTA DELTA DELTA DELTA DELTA
+extern uint32 BtEpoch; /* every write to a btn stamps it w/ BtEpoch */
+void      bt_touch   (struct btree *btr, bt_data_t k); /* ROW written in place*/
+
 // DIRTY DIRTY DIRTY DIRTY DIRTY DIRTY DIRTY DIRTY DIRTY DIRTY DIRTY DIRTY
 struct btreenode *addDStoBTN(struct btree *btr, struct btreenode *x, 
                              struct btreenode *p, int pi, char dirty);
@@ -85,6 +89,11 @@ struct btreenode *addDStoBTN(struct btree *btr, struct btreenode *x,
 uint32    getDR          (struct btree *btr, struct btreenode *x, int i);
 uint32    bt_get_dr      (struct btree *btr, bt_data_t k, aobj *akey);
 bt_data_t bt_evict       (struct btree *btr, bt_data_t k);
+bt_data_t bt_prev        (struct btree *btr, bt_data_t k);
+int       bt_unevict_dr  (struct btree *btr, bt_data_t k, uint32 left,
+                          uint32 *kdr);
+bool      bt_steal_dr    (struct btree *btr);
+void      bt_set_dr      (struct btree *btr, bt_data_t k, uint32 dr);
 bool      bt_exist       (struct btree *btr, bt_data_t k, aobj *akey);
 void      bt_delete_d    (struct btree *btr, bt_data_t k, aobj *akey,
                                              bt_data_t stream);
@@ -111,6 +120,9 @@ int  bt_find_closest_slot(struct btree *btr, struct btreenode *x, bt_data_t k);
 void bt_to_bt_insert(struct btree *nbtr,
                      struct btree *obtr, struct btreenode *x);
 
+// BULK_LOAD BULK_LOAD BULK_LOAD BULK_LOAD BULK_LOAD BULK_LOAD BULK_LOAD
+void bt_bulk_load(struct btree *btr, uchar *slots, uint32 n);
+
 // DESTRUCTOR DESTRUCTOR DESTRUCTOR DESTRUCTOR DESTRUCTOR DESTRUCTOR
 void bt_destroy   (struct btree *btr);
 void bt_release   (struct btree *btr, struct btreenode *x);
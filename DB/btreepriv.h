@@ -74,8 +74,9 @@ typedef struct btree { // 60 Bytes -> 64B
 } __attribute__ ((packed)) bt;
 
 //#define BTREE_DEBUG
-typedef struct btreenode { // 9 bytes -> 16 bytes
+typedef struct btreenode { // 13 bytes -> 16 bytes
     unsigned int   scion;       /* 4 billion max scion */
+    unsigned int   epoch;       /* DELTA: BtEpoch of the last write to btn */
     unsigned short n;           /* 16 thousand max entries (per bt_n)*/
     unsigned char  leaf;
     // DIRTY: -1->CLEAN,   0->TreeDirty but BTN_clean, 
@@ -45,6 +45,7 @@ ALL RIGHTS RESERVED
 #include "debug.h"
 #include "ddl.h"
 #include "parser.h"
+#include "lexer.h"
 #include "bt_iterator.h"
 #include "find.h"
 #include "alsosql.h"
@@ -256,6 +257,41 @@ char *parseRowVals(sds vals,  char   **pk,       int  *pklen,
     else if         (numc != lncols) return NULL;
     return mvals;
 }
+/* NOTE: PREPARED INSERTs bind each value directly (no tokenising), the
+         values are laid out comma delimited in *mbuf (the AOF/replication
+         VALUES text) w/ string columns \' delimited (as createRow expects) */
+char *bindRowVals(char  **vals,  uint32  *vlens,    int   nvals,
+                  sds    *mbuf,  char   **pk,       int  *pklen,
+                  int     ncols, twoint   cofsts[], int   tmatch,
+                  int     pcols, icol_t  *ics,      int   lncols, bool *ai) {
+    r_tbl_t *rt = &Tbl[tmatch];
+    if (pcols) { if (nvals != pcols)  return NULL; }
+    else if         (nvals != lncols) return NULL;
+    for (int k = 0; k < nvals; k++) {
+        int cmatch  = pcols ? ics[k].cmatch : k;
+        if (cmatch < 0 || cmatch >= ncols) return NULL;
+        uchar ctype = rt->col[cmatch].type;
+        if (C_IS_N(ctype))                 return NULL; // NO HASHABILITY
+        char   *v   = vals[k]; uint32 vlen = vlens[k];
+        bool    q   = (vlen > 1 && v[0] == '\'' && v[vlen - 1] == '\'');
+        if (k) *mbuf = sdscatlen(*mbuf, ",", 1);
+        cofsts[cmatch].i = sdslen(*mbuf);
+        if (C_IS_S(ctype) && !q) {
+            *mbuf = sdscatlen(*mbuf, "'", 1);
+            *mbuf = sdscatlen(*mbuf, v, vlen);
+            *mbuf = sdscatlen(*mbuf, "'", 1);
+        } else *mbuf = sdscatlen(*mbuf, v, vlen);
+        cofsts[cmatch].j = sdslen(*mbuf);
+        if (!cmatch) { /* PK */
+            if (C_IS_S(ctype) && q) { v++; vlen -= 2; }
+            *pklen = (int)vlen;
+            if (!assign_pk(tmatch, pklen, pk, v, ai)) return NULL;
+        }
+    }
+    /* NOTE: create PK if none exists for NUM pks */
+    if (!*pklen) { if (!assign_pk(tmatch, pklen, pk, NULL, ai)) return NULL; }
+    return *mbuf;
+}
 
 // JTA_SERIALISATION JTA_SERIALISATION JTA_SERIALISATION JTA_SERIALISATION
 int getJTASize() {
@@ -421,62 +457,55 @@ static bool addJoinAlias(redisClient *c, char *tkn, char *space, int len) {
     return 1;
 }
 // PARSE_ALL_SELECTs PARSE_ALL_SELECTs PARSE_ALL_SELECTs PARSE_ALL_SELECTs
+/* NOTE: comma separated lists are lexed ONCE, then walked item by item */
+#define LEX_CSL(tkn)                                             \
+    lex_t lx; lexSQL(&lx, tkn, strlen(tkn));                     \
+    int   li  = 0; char *s; int len; bool ret = 1;
+#define NEXT_CSL_ITEM lexNextItem(&lx, &li, lx.n, 0, &s, &len) != -1
+
 bool parseCSLJoinTable(cli  *c, char  *tkn, list *ts, list  *jans) {
-    while (1) {
-        int len; SKIP_SPACES(tkn) char *nextc = get_next_nonparaned_comma(tkn);
-        if (nextc) {
-            char *endc = nextc - 1; REV_SKIP_SPACES(endc); len = endc - tkn + 1;
-        } else len = strlen(tkn);
+    LEX_CSL(tkn)
+    while (NEXT_CSL_ITEM) {
         int   jan   = -1;
-        char *alias = _strnchr(tkn, ' ', len);
+        char *alias = _strnchr(s, ' ', len);
         if (alias) {
-            if (!addJoinAlias(c, tkn, alias, len)) return 0;
-            len     = alias - tkn;
+            if (!addJoinAlias(c, s, alias, len)) { ret = 0; break; }
+            len     = alias - s;
             jan     = server.alc.CurrClient->LastJTAmatch;// from addJoinAlias()
         }
-        int   tm    = find_table_n(tkn, len);
-        if (tm == -1) { addReply(c, shared.nonexistenttable); return 0; }
+        int   tm    = find_table_n(s, len);
+        if (tm == -1) { addReply(c, shared.nonexistenttable); ret = 0; break; }
         if (!alias) jan = server.alc.CurrClient->LastJTAmatch;// find_table_n()
         listAddNodeTail(ts,   VOIDINT tm); listAddNodeTail(jans, VOIDINT jan);
-        if (!nextc) break; tkn = nextc + 1;
     }
-    return 1;
+    releaseLex(&lx); return ret;
 }
 bool parseCSLJoinColumns(cli  *c,     char  *tkn,  bool  exact,
                          list *ts,    list  *jans, list *js,
                          int  *qcols, bool  *cstar) {
-    while (1) {
-        int len; SKIP_SPACES(tkn) char *nextc = get_next_nonparaned_comma(tkn);
-        if (nextc) {
-            char *endc = nextc - 1; REV_SKIP_SPACES(endc); len = endc - tkn + 1;
-        } else len = strlen(tkn);
-        if (!parseJCols(c, tkn, len, ts, jans, js, qcols, cstar, exact)) {
-            return 0;
+    LEX_CSL(tkn)
+    while (NEXT_CSL_ITEM) {
+        if (!parseJCols(c, s, len, ts, jans, js, qcols, cstar, exact)) {
+            ret = 0; break;
         }
-        if (!nextc) break; tkn = nextc + 1;
     }
-    return 1;
+    releaseLex(&lx); return ret;
 }
 bool parseCSLSelect(cli  *c,         char  *tkn,
                     bool  exact,     bool   isi,
                     int   tmatch,    list  *cs,        list   *ls,
                     int  *qcols,     bool  *cstar) {//printf("parseCSLSelct\n");
-    while (1) {
-        int len; SKIP_SPACES(tkn) char *nextc = get_next_nonparaned_comma(tkn);
-        if (nextc) {
-            char *endc = nextc - 1; REV_SKIP_SPACES(endc); len = endc - tkn + 1;
-        } else len = strlen(tkn);
-        if (!parseSelCol(tmatch, tkn, len, cs, ls, qcols, cstar, exact, isi)) {
-            addReply(c, shared.nonexistentcolumn); return 0;
+    LEX_CSL(tkn)
+    while (NEXT_CSL_ITEM) {
+        if (!parseSelCol(tmatch, s, len, cs, ls, qcols, cstar, exact, isi)) {
+            addReply(c, shared.nonexistentcolumn); ret = 0; break;
         }
-        if (!nextc) break; tkn = nextc + 1;
     }
-    return 1;
+    releaseLex(&lx); return ret;
 }
-bool parseSelect(cli  *c,     bool    is_scan, bool *no_wc, int  *tmatch,
-                 list *cs,    list   *ls,      int  *qcols, bool *join,
-                 bool *cstar, char   *cl,      char *from,  char *tlist,
-                 char *where, bool    chk) {
+static bool parseSelectFrom(cli  *c,      bool  is_scan, bool *no_wc,
+                            int  *tmatch, bool *join,    char *from,
+                            char *tlist,  char *where,   bool  chk) {
     if (chk) {
         if (strcasecmp(from, "FROM")) {
             addReply(c, shared.selectsyntax_nofrom); return 0;
@@ -490,9 +519,122 @@ bool parseSelect(cli  *c,     bool    is_scan, bool *no_wc, int  *tmatch,
     *join = 0;
     *tmatch = find_table_n(tlist, get_token_len(tlist));
     if (*tmatch == -1) { addReply(c, shared.nonexistenttable); return 0; }
+    return 1;
+}
+bool parseSelect(cli  *c,     bool    is_scan, bool *no_wc, int  *tmatch,
+                 list *cs,    list   *ls,      int  *qcols, bool *join,
+                 bool *cstar, char   *cl,      char *from,  char *tlist,
+                 char *where, bool    chk) {
+    if (!parseSelectFrom(c, is_scan, no_wc, tmatch, join, from, tlist, where,
+                         chk))                                      return 0;
+    if (*join)                                                      return 1;
     return parseCSLSelect(c, cl, 0, 0, *tmatch, cs, ls, qcols, cstar);
 }
 
+// AGGREGATES AGGREGATES AGGREGATES AGGREGATES AGGREGATES AGGREGATES
+static char *AggrFuncs[5] = {"COUNT", "SUM", "MIN", "MAX", "AVG"};
+
+/* "SUM( x )" -> AGGR_SUM, arg: "x" */
+static uchar getAggrFunc(char *tkn, int len, char **arg, int *alen) {
+    for (int i = 0; i < 5; i++) {
+        int nlen = strlen(AggrFuncs[i]);
+        if (len <= nlen + 1 || strncasecmp(tkn, AggrFuncs[i], nlen)) continue;
+        char *p   = tkn + nlen; SKIP_SPACES(p)
+        char *end = tkn + len - 1;
+        if (*p != '(' || *end != ')' || p >= end)                  continue;
+        p++;  SKIP_SPACES(p)
+        end--; while (end >= p && ISBLANK(*end)) end--;
+        *arg = p; *alen = end - p + 1;
+        return (uchar)(AGGR_COUNT + i);
+    }
+    return AGGR_NONE;
+}
+static char *nextSelToken(char *tkn, int *len, char **nextc) {
+    SKIP_SPACES(tkn) *nextc = get_next_nonparaned_comma(tkn);
+    char *endc = *nextc ? *nextc - 1 : tkn + strlen(tkn) - 1;
+    REV_SKIP_SPACES(endc) *len = endc - tkn + 1;
+    return tkn;
+}
+/* NOTE: a lone "COUNT(*)" is NOT an aggregate select, it is the cstar path */
+bool isAggrSelect(char *cl) {
+    if (!strchr(cl, '(')) return 0; /* no "FUNC(" -> skip the column scan */
+    bool agg = 0; bool cstar = 0; int n = 0;
+    while (1) {
+        int len; char *nextc; char *arg; int alen;
+        cl = nextSelToken(cl, &len, &nextc);
+        if (getAggrFunc(cl, len, &arg, &alen) != AGGR_NONE) {
+            agg = 1; if (len == 8 && !strncasecmp(cl, "COUNT(*)", 8)) cstar = 1;
+        }
+        n++;
+        if (!nextc) break; cl = nextc + 1;
+    }
+    return agg && !(n == 1 && cstar);
+}
+static bool parseAggrCol(cli *c, agc_t *ac, int tmatch, char *tkn, int len) {
+    char *arg; int alen;
+    ac->func  = getAggrFunc(tkn, len, &arg, &alen);
+    if (ac->func == AGGR_NONE) { arg = tkn; alen = len; }
+    ac->cname = (ac->func == AGGR_NONE) ? sdsnewlen(tkn, len) : /* "SUM(x)" */
+                    sdscatprintf(sdsempty(), "%s(%.*s)",
+                                 AggrFuncs[ac->func - AGGR_COUNT], alen, arg);
+    if (ac->func == AGGR_COUNT && alen == 1 && *arg == '*') {
+        ac->star = 1;                                               return 1;
+    }
+    if (!alen || *arg == '*') { addReply(c, shared.aggr_syntax);    return 0; }
+    ac->ic    = find_column_n(tmatch, arg, alen);
+    if (ac->ic.cmatch < 0) { addReply(c, shared.nonexistentcolumn); return 0; }
+    ac->ctype = Tbl[tmatch].col[ac->ic.cmatch].type;
+    if ((ac->func == AGGR_SUM || ac->func == AGGR_AVG) &&
+        !C_IS_NUM(ac->ctype) && !C_IS_F(ac->ctype)) {
+        addReply(c, shared.aggr_sum_text);                          return 0;
+    }
+    return 1;
+}
+bool parseAggrSelect(cli  *c,     bool    is_scan, bool *no_wc, int *tmatch,
+                     aggr_t *ag,  char   *cl,      char *from,  char *tlist,
+                     char *where, bool    chk) {
+    bzero(ag, sizeof(aggr_t)); bool join = 0;
+    if (!parseSelectFrom(c, is_scan, no_wc, tmatch, &join, from, tlist, where,
+                         chk))                                      return 0;
+    if (join) { addReply(c, shared.aggr_join);                      return 0; }
+    int   n   = 0; char *tkn = cl; 
+    while (1) {
+        int len; char *nextc; nextSelToken(tkn, &len, &nextc); n++;
+        if (!nextc) break; tkn = nextc + 1;
+    }
+    initAggr(ag, *tmatch, n);
+    tkn = cl;
+    for (int i = 0; i < n; i++) {
+        int len; char *nextc;
+        tkn = nextSelToken(tkn, &len, &nextc);
+        if (!parseAggrCol(c, &ag->cols[i], *tmatch, tkn, len))     return 0;
+        if (nextc) tkn = nextc + 1;
+    }
+    setAggrRegs(ag);
+    return 1;
+}
+/* SELECT k, x FROM t WHERE ... GROUP BY k, x -> DISTINCT groups */
+bool aggrFromICS(cli    *c,   aggr_t *ag,    int tmatch, bool cstar,
+                 icol_t *ics, int     qcols) {
+    initAggr(ag, tmatch, qcols);
+    for (int i = 0; i < qcols; i++) {
+        agc_t *ac = &ag->cols[i];
+        if (cstar) {
+            ac->func = AGGR_COUNT; ac->star = 1; ac->cname = sdsnew("COUNT(*)");
+            continue;
+        }
+        if (ics[i].cmatch < 0) { addReply(c, shared.aggr_not_grouped); return 0; }
+        cloneIC(&ac->ic, &ics[i]);
+        ac->ctype = Tbl[tmatch].col[ics[i].cmatch].type;
+        ac->cname = sdsdup(Tbl[tmatch].col[ics[i].cmatch].name);
+        for (uint32 j = 0; j < ics[i].nlo; j++) {
+            ac->cname = sdscatprintf(ac->cname, ".%s", ics[i].lo[j]);
+        }
+    }
+    setAggrRegs(ag);
+    return 1;
+}
+
 // UPDATE UPDATE UPDATE UPDATE UPDATE UPDATE UPDATE UPDATE UPDATE UPDATE
 int parseUpdateColListReply(cli  *c,  int   tmatch, char *vallist,
                             list *cs, list *vals,   list *vlens) {
@@ -916,52 +1058,41 @@ bool parseColType(cli *c, sds type, uchar *ctype) {
     }
     return 1;
 }
+/* "(cname ctype [ignored], ...)" lexed ONCE: columns are the paren-depth-1
+   items between the outer parens, "cname" is the item's first token */
 bool parseCreateTable(cli    *c,      list *ctypes,  list *cnames,
                       int    *ccount, sds   cdecl) {
-    char *tkn = cdecl;                         SKIP_SPACES(tkn)
-    char *endc  = cdecl + sdslen(cdecl) - 1; REV_SKIP_SPACES(endc)
-    if (!*tkn || *tkn != '(' || *endc != ')') {
-        addReply(c, shared.createsyntax); return 0;
+    lex_t lx; lexSQL(&lx, cdecl, sdslen(cdecl));
+    int   end = lx.n - 1;
+    if (lx.n < 2 || lx.t[0].type   != LTK_LPAREN ||
+                    lx.t[end].type != LTK_RPAREN || lx.t[end].depth) {
+        addReply(c, shared.createsyntax); releaseLex(&lx); return 0;
     }
-    tkn++; SKIP_SPACES(tkn)
-    list *cl = listCreate();                             // FREE 138
-    while (1) {
-        int len; SKIP_SPACES(tkn) char *nextc = get_next_nonparaned_comma(tkn);
-        if (nextc) {
-            char *endc = nextc - 1; REV_SKIP_SPACES(endc); len = endc - tkn + 1;
-        } else len = strlen(tkn);
-        listAddNodeTail(cl, sdsnewlen(tkn, len));
-        if (!nextc) break; tkn = nextc + 1;
-    }
-    bool      ret = 1;
-    listIter *li = listGetIterator(cl, AL_START_HEAD); listNode *ln; // B4 goto
-    while((ln = listNext(li))) {
-        uchar  ctype;
-        sds    s     = ln->value;       //printf("CREATE TABLE: tkn: %s\n", s);
-        char  *tk    = s;
-        int    clen  = get_token_len(tk); tk = rem_backticks(tk, &clen);
-        sds    cname = sdsnewlen(tk, clen);
+    bool  ret = 1; int i = 1; char *s; int len; int ntk;
+    while ((ntk = lexNextItem(&lx, &i, end, 1, &s, &len)) != -1) {
+        uchar  ctype;                    //printf("CREATE TABLE: tkn: %s\n", s);
+        if (ntk < 2) { /* need [cname, ctype] */
+            addReply(c, shared.cr8tablesyntax); ret = 0;             break;
+        }
+        ltk_t *tk    = &lx.t[i - ntk - 1];
+        int    clen  = tk->len;
+        char  *cn    = rem_backticks(s, &clen);
+        sds    cname = sdsnewlen(cn, clen);
         if (!strcasecmp(cname, "LRU") || !strcasecmp(cname, "LFU")) {
-            addReply(c, shared.kw_cname); ret = 0;       goto pcr8tbl_end;
+            addReply(c, shared.kw_cname); sdsfree(cname); ret = 0; break;
         }
         listAddNodeTail(cnames, cname);
-        tk         = next_token(tk); // parse ctype
-        if (!tk) {
-            addReply(c, shared.cr8tablesyntax); ret = 0; goto pcr8tbl_end;
-        }
-        sds   type = sdsnewlen(tk, sdslen(s) - (tk - s)); // FREE 070
-        bool   ok  = parseColType(c, type, &ctype);
+        char  *ts    = (tk + 1)->s; // parse ctype
+        sds    type  = sdsnewlen(ts, len - (ts - s));      // FREE 070
+        bool   ok    = parseColType(c, type, &ctype);
         sdsfree(type);                                     // FREED 070
-        if (!ok) { ret = 0;                              goto pcr8tbl_end; }
+        if (!ok) { ret = 0;                                          break; }
         if (!ctypes->len && (C_IS_P(ctype) || C_IS_O(ctype))) {
-            addReply(c, shared.unsupported_pk); ret = 0; goto pcr8tbl_end;
+            addReply(c, shared.unsupported_pk); ret = 0;             break;
         }
         listAddNodeTail(ctypes, VOIDINT ctype); INCR(*ccount);
     }
-
-pcr8tbl_end:
-    listReleaseIterator(li);
-    cl->free = v_sdsfree; listRelease(cl);              // FREED 138
+    releaseLex(&lx);
     return ret;
 }
 
@@ -1087,6 +1218,43 @@ void setDMBcard_cnames(cli  *c,    cswc_t *w,    icol_t *ics, int qcols,
     }
     setDeferredMultiBulkSDS(c, rlen, trows);
 }
+static sds getAggrQueriedCnames(aggr_t *ag) {
+    if LREDIS {
+        CLEAR_LUA_STACK
+        lua_getglobal(server.lua, server.alc.OutputLuaFunc_Cnames);
+        for (int i = 0; i < ag->ncols; i++) {
+            lua_pushstring(server.lua, ag->cols[i].cname);
+        }
+        int ret = DXDB_lua_pcall(server.lua, ag->ncols, 1, 0);
+        sds s   = ret ? sdsempty() :
+                        sdsnewlen((char*)lua_tostring(server.lua, -1),
+                                  lua_strlen(server.lua, -1));
+        CLEAR_LUA_STACK return s;
+    }
+    sds s = sdsempty();
+    if OREDIS s = sdscatprintf(s, "*%d\r\n", ag->ncols);
+    for (int i = 0; i < ag->ncols; i++) {
+        sds cname = ag->cols[i].cname;
+        if OREDIS s = sdscatprintf(s, "$%lu\r\n", sdslen(cname));
+        s = sdscatlen(s, cname, sdslen(cname));
+        if      OREDIS                s = sdscatlen(s, "\r\n", 2);
+        else if (i != ag->ncols - 1)  s = sdscatlen(s, ", ", 2);
+    }
+    return s;
+}
+/* NOTE: zero GROUPs still reply the header row (not a nil multi-bulk) */
+void setDMB_Aggr_card_cnames(cli *c, aggr_t *ag, long card, void *rlen) {
+    sds trows = LREDIS ? startOutput(card) :
+                         sdscatprintf(sdsempty(), "*%ld\r\n", card + 1);
+    sds s     = getAggrQueriedCnames(ag);                    // FREE 198
+    if (OREDIS || LREDIS) {
+        trows = sdscatlen   (trows, s, sdslen(s));
+    } else {
+        trows = sdscatprintf(trows, "$%lu\r\n%s\r\n", sdslen(s), s);
+    }
+    sdsfree(s);                                              // FREED 198
+    setDeferredMultiBulkSDS(c, rlen, trows);
+}
 void setDMB_Join_card_cnames(cli *c, jb_t *jb, long card, void *rlen) {
     //TODO handle this in Lua: OutputLuaFunc_Start()
     sds trows = startOutput(card);
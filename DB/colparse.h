@@ -30,6 +30,7 @@ ALL RIGHTS RESERVED
 
 #include "btreepriv.h"
 #include "alsosql.h"
+#include "aggr.h"
 #include "query.h"
 #include "common.h"
 
@@ -45,6 +46,10 @@ char *parse_insert_val_list_nextc(char *start, uchar ctype);
 char *parseRowVals(sds vals,  char   **pk,        int  *pklen,
                    int ncols, twoint   cofsts[],  int   tmatch,
                    int pcols, icol_t  *ics,       int   lncols, bool *ai);
+char *bindRowVals (char  **vals,  uint32  *vlens,    int   nvals,
+                   sds    *mbuf,  char   **pk,       int  *pklen,
+                   int     ncols, twoint   cofsts[], int   tmatch,
+                   int     pcols, icol_t  *ics,      int   lncols, bool *ai);
 
 // HELPERS
 void init_ics   (icol_t *ics, list *cmatchl);
@@ -83,6 +88,14 @@ bool parseSelect(cli  *c,     bool    is_scan, bool *no_wc, int  *tmatch,
                  bool *cstar, char   *cl,      char *from,  char *tlist, 
                  char *where, bool    chk);
 
+// AGGREGATES
+bool isAggrSelect   (char *cl);
+bool parseAggrSelect(cli  *c,     bool    is_scan, bool *no_wc, int *tmatch,
+                     aggr_t *ag,  char   *cl,      char *from,  char *tlist,
+                     char *where, bool    chk);
+bool aggrFromICS    (cli  *c,     aggr_t *ag,      int   tmatch, bool cstar,
+                     icol_t *ics, int     qcols);
+
 // UPDATE
 int parseUpdateColListReply(cli  *c,  int   tmatch, char *vallist,
                             list *cs, list *vals,   list *vlens);
@@ -115,5 +128,6 @@ void outputColumnNames(cli *c,     int     tmatch, bool cstar, icol_t *ics,
 void setDMBcard_cnames(cli  *c,    cswc_t *w,    icol_t *ics, int qcols,
                        long  card, void   *rlen, lfca_t *lfca);
 void setDMB_Join_card_cnames(cli *c, jb_t *jb, long card, void *rlen);
+void setDMB_Aggr_card_cnames(cli *c, aggr_t *ag, long card, void *rlen);
 
 #endif /*__ALSOSQL_COLPARSE__H */ 
@@ -82,6 +82,7 @@ typedef int printer(const char *format, ...);
 #define SQL_RANGE_LKP       2
 #define SQL_IN_LKP          3
 #define SQL_SINGLE_FK_LKP   4
+#define SQL_BITMAP_LKP      5
 
 #define NUM_ACCESS_TYPES 2 /* CREATE TABLE AS [SELECT,SCAN] */
 
@@ -92,6 +93,7 @@ typedef int printer(const char *format, ...);
 #define MAX_JOIN_INDXS         30 /* CAREFUL: tied to logic in qo.c */
 #define MAX_JOIN_COLS         128
 #define MAX_ORDER_BY_COLS      16
+#define MAX_GROUP_BY_COLS      16
 
 #define INDEX_DELIM     "index"
 #define LRUINDEX_DELIM  "lru"
@@ -113,11 +115,18 @@ typedef int printer(const char *format, ...);
 
 #define CONSTRAINT_NONE   0
 #define CONSTRAINT_UNIQUE 1
-#define UNIQ(cnstr) (cnstr == CONSTRAINT_UNIQUE)
+#define CONSTRAINT_BITMAP 2 /* NOT a constraint: CREATE INDEX ... USING BITMAP */
+#define CONSTRAINT_HASH   3 /* UNIQUE + CREATE UNIQUE INDEX ... USING HASH */
+#define CONSTRAINT_HASHS  4 /* USING HASH on TEXT: NORMAL BT, UNIQUE via hash */
+#define UNIQ(cnstr)  (cnstr == CONSTRAINT_UNIQUE || cnstr == CONSTRAINT_HASH)
+#define BMAP(cnstr)  (cnstr == CONSTRAINT_BITMAP)
+#define HASHI(cnstr) (cnstr == CONSTRAINT_HASH   || cnstr == CONSTRAINT_HASHS)
+#define HASHS(cnstr) (cnstr == CONSTRAINT_HASHS)
 
 #define OREDIS (server.alc.OutputMode == OUTPUT_PURE_REDIS)
 #define EREDIS (server.alc.OutputMode == OUTPUT_EMBEDDED)
 #define LREDIS (server.alc.OutputMode == OUTPUT_LUA)
+#define BREDIS (server.alc.OutputMode == OUTPUT_BINARY)
 
 #define FK_RQ(wtype) !(wtype == SQL_SINGLE_FK_LKP)
 
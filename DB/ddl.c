@@ -42,6 +42,10 @@ ALL RIGHTS RESERVED
 #include "lru.h"
 #include "lfu.h"
 #include "cr8tblas.h"
+#include "plan_cache.h"
+#include "rowstore.h"
+#include "evict.h"
+#include "mmtbl.h"
 #include "parser.h"
 #include "colparse.h"
 #include "find.h"
@@ -56,7 +60,7 @@ ALL RIGHTS RESERVED
 extern uint32   Tbl_HW; extern dict *TblD; extern list *DropT;
 extern r_ind_t *Index;
 
-extern char *RangeType[5];
+extern char *RangeType[6];
 
 // GLOBALS
 int      Num_tbls;
@@ -84,6 +88,7 @@ void initTable(r_tbl_t *rt) { // NOTE: also used in rdbLoadBT
     rt->vimatch = rt->lruc      = rt->lrui       = rt->sk         = \
                   rt->fk_cmatch = rt->fk_otmatch = rt->fk_ocmatch = \
                   rt->lfuc      = rt->lfui       = -1;
+    rt->cepoch  = BtEpoch; /* DELTA: not in an older BASE snapshot */
 }
 static void addTable() { //printf("addTable: Tbl_HW: %d\n", Tbl_HW);
     Tbl_HW++;
@@ -172,13 +177,34 @@ static void newTable(cli *c, list *ctypes, list *cnames, int ccount, sds tname){
     sds  pkname  = rt->col[0].name;
     sds  iname   = P_SDS_EMT "%s_%s_%s", rt->name, pkname, INDEX_DELIM); //D073
     DECLARE_ICOL(pkic, 0) DECLARE_ICOL(ic, -1)
-    newIndex(c, iname, tmatch, pkic, NULL, 0, 1, 0, NULL, ic, 0, 0, 0,
-             NULL, NULL, NULL);
+    newIndex(c, iname, tmatch, pkic, NULL, 0, 1, 0, NULL, ic, ic, 0, 0, 0,
+             NULL, NULL, NULL, NULL, NULL, 0, 0);
     sdsfree(iname);                                      /* DESTROYED 073 */
 }
 
 inline void v_sdsfree(void *v) { sdsfree((sds)v); }
 
+/* CREATE TABLE tbl FROM MMAP file -> columns & ROWs come from the file */
+static void createTableMmap(cli *c, sds tname) {
+    sds    err = NULL;
+    mmt_t *mm  = mmtOpen(c->argv[5]->ptr, &err);
+    if (!mm) { addReplySds(c, err);                                 return; }
+    list *cnames = listCreate(); cnames->free = v_sdsfree;
+    list *ctypes = listCreate();
+    for (uint32 i = 0; i < mm->ncols; i++) {
+        listAddNodeTail(cnames, sdsdup(mm->cnames[i]));
+        listAddNodeTail(ctypes, VOIDINT mm->ctypes[i]);
+    }
+    newTable(c, ctypes, cnames, mm->ncols, tname);
+    listRelease(cnames); listRelease(ctypes);
+    int tmatch = find_table(tname);
+    if (tmatch == -1) { mmtClose(mm);                               return; }
+    if (!mmtAttach(tmatch, mm)) { /* BT flavor mismatch -> corrupt file */
+        redisLog(REDIS_WARNING, "MMAP: %s: BT type mismatch, table: %s empty",
+                 mm->fname, tname);
+        mmtClose(mm);
+    }
+}
 static void createTable(redisClient *c) { //printf("createTable\n");
     char *tn    = c->argv[2]->ptr;
     int   tlen  = sdslen(c->argv[2]->ptr);
@@ -191,6 +217,11 @@ static void createTable(redisClient *c) { //printf("createTable\n");
         !strncasecmp(c->argv[3]->ptr, "SCAN ",   5)) { sdsfree(tname);//DESTD089
         createTableSelect(c); return;
     }
+    if (c->argc == 6 && !strcasecmp(c->argv[3]->ptr, "FROM") &&
+                        !strcasecmp(c->argv[4]->ptr, "MMAP")) {
+        createTableMmap(c, tname); sdsfree(tname);                 //DESTD089
+        return;
+    }
     list *cnames = listCreate(); cnames->free = v_sdsfree;
     list *ctypes = listCreate();
     int  ccount = 0;
@@ -224,6 +255,7 @@ void createCommand(redisClient *c) { //printf("createCommand\n");
 unsigned long emptyTable(cli *c, int tmatch) {
     r_tbl_t *rt      = &Tbl[tmatch];
     if (!rt->name) return 0;                 /* already deleted */
+    invalidatePlanCache();
     dictDelete(TblD, rt->name); sdsfree(rt->name);
     MATCH_INDICES(tmatch)
     ulong    deleted = 0;
@@ -235,6 +267,10 @@ unsigned long emptyTable(cli *c, int tmatch) {
     bt_destroy(rt->btr);
     listRelease(rt->ilist);                                          //DESTD 088
     dictRelease(rt->cdict);                                          //DESTD 090
+    dropAccesses(rt);
+    rsDropTable (rt);
+    evrDropTable(rt);
+    mmtDropTable(rt);
     initTable(rt);
     if (tmatch == (Num_tbls - 1)) Num_tbls--; // if last -> reuse
     else {                                    // else put on DropT for reuse
@@ -275,6 +311,7 @@ static bool checkRepeatCnames(cli *c, int tmatch, sds cname) {
 }
 // addColumn(): Used by ALTER TABLE & LRU & HASHABILITY
 void addColumn(int tmatch, char *cname, int ctype) {
+    invalidatePlanCache();
     r_tbl_t *rt        = &Tbl[tmatch];
     int      col_count = rt->col_count;
     rt->col_count++;
@@ -306,8 +343,28 @@ void addColumn(int tmatch, char *cname, int ctype) {
     4.) ALTER Tablename ADD SHARDKEY Columnname
     5.) ALTER Tablename ADD FOREIGN KEY FKname REFERENCES Tablename (Columnname)
 */
+/* ALTER INDEX indexname SET [PERSIST|NOPERSIST] -> BT saved in the RDB */
+static void alterIndex(cli *c) {
+    bool prst;
+    if      (!strcasecmp(c->argv[4]->ptr, "PERSIST"))   prst = 1;
+    else if (!strcasecmp(c->argv[4]->ptr, "NOPERSIST")) prst = 0;
+    else { addReply(c, shared.altersyntax);                             return;}
+    if (c->argc > 5 || strcasecmp(c->argv[3]->ptr, "SET")) {
+        addReply(c, shared.altersyntax);                                return;
+    }
+    int imatch = match_partial_index_name(c->argv[2]->ptr);
+    if (imatch == -1) { addReply(c, shared.nonexistentindex);           return;}
+    r_ind_t *ri = &Index[imatch];
+    if (prst && (ri->virt || ri->luat || ri->fname || ri->icol.nlo ||
+                 BMAP(ri->cnstr) || HASHI(ri->cnstr))) {
+        addReply(c, shared.indexpersistill);                            return;
+    }
+    if (ri->persist != prst) { ri->persist = prst; server.dirty++; }
+    addReply(c, shared.ok);
+}
 void alterCommand(cli *c) {
     bool altc = 0, altsk = 0, altfk = 0, althsh = 0, altdrt = 0;;
+    if (!strcasecmp(c->argv[1]->ptr, "INDEX")) { alterIndex(c);         return;}
     if (strcasecmp(c->argv[1]->ptr, "TABLE")) {
         addReply(c, shared.altersyntax);                                return;
     }
@@ -328,6 +385,9 @@ void alterCommand(cli *c) {
     char  *tname = rem_backticks(c->argv[2]->ptr, &len); /* Mysql compliant */
     TABLE_CHECK_OR_REPLY(tname,)
     if (OTHER_BT(getBtr(tmatch))) { addReply(c, shared.alter_other);    return;}
+    if ((altdrt || altc) && Tbl[tmatch].mm) {
+        addReply(c, shared.mmt_readonly);                               return;
+    }
     if        (altdrt) {
         if (!C_IS_NUM(Tbl[tmatch].col[0].type)) {
             addReply(c, shared.dirtypk);                                return;
@@ -338,6 +398,7 @@ void alterCommand(cli *c) {
         btr->dirty        = 1; // allocbtreenode() w/ dirty-stream-ptrs
         // If table was just created, add DS to it (will be inherited)
         if (btr->numnodes == 1) addDStoBTN(btr, btr->root, btr->root, 0, 0);
+        server.dirty++; /* AOF & slaves: their EVICTs need a DIRTY table */
     } else if (altc) {
         if (c->argc < 7) { addReply(c, shared.altersyntax);             return;}
         if (!checkRepeatCnames(c, tmatch, c->argv[5]->ptr))             return;
@@ -38,16 +38,20 @@ ALL RIGHTS RESERVED
 #include "qo.h"
 #include "join.h"
 #include "filter.h"
+#include "fprog.h"
+#include "bitmap.h"
 #include "index.h"
 #include "parser.h"
 #include "colparse.h"
 #include "find.h"
 #include "query.h"
 #include "alsosql.h"
+#include "wc.h"
+#include "ddl.h"
 #include "common.h"
 #include "debug.h"
 
-extern char    *RangeType[5];
+extern char    *RangeType[6];
 extern r_tbl_t *Tbl;
 extern r_ind_t *Index;
 
@@ -79,10 +83,8 @@ void setDeferredMultiBulkSDS(redisClient *c, void *node, sds s) {
 }
 void resetDeferredMultiBulk_ToError(redisClient *c, void *node, sds error) {
     if (!node) return; /* Abort when addDeferredMultiBulkLength not called. */
-    listRelease(c->reply);
-    c->reply = listCreate();
-    listSetFreeMethod(c->reply, decrRefCount);
-    listSetDupMethod (c->reply, dupClientReplyValue);
+    listNode *ln = (listNode*)node; /* drop THIS reply, keep pipelined ones */
+    while (ln) { listNode *nx = ln->next; listDelNode(c->reply, ln); ln = nx; }
     robj *r  = createStringObject(error, sdslen(error));
     listAddNodeTail(c->reply, r);
 }
@@ -149,6 +151,22 @@ void explainRQ(cli *c,     cswc_t *w,  wob_t *wb, bool cstar,
     qr_t    q;
     setQueued(w, wb, &q);
     dumpQueued(queueOutput, w, wb, &q, 0);
+    if (isCoveredSelect(w, &q, cstar, ics, qcols)) {
+        (*queueOutput)("\t\tCOVERING INDEX: %s\n", Index[w->wf.imatch].name);
+    }
+    dumpQueueOutput(c);
+}
+void explainAggr(cli *c, cswc_t *w, wob_t *wb, aggr_t *ag) {
+    initQueueOutput();
+    (*queueOutput)("QUERY: ");
+    for (int i = 0; i < c->argc; i++) {
+        (*queueOutput)("%s ", (char *)c->argv[i]->ptr);
+    } (*queueOutput)("\n");
+    dumpW(queueOutput, w); dumpWB(queueOutput, wb);
+    dumpAggr(queueOutput, ag, wb, w);
+    qr_t    q;
+    setQueued(w, wb, &q);
+    dumpQueued(queueOutput, w, wb, &q, 0);
     dumpQueueOutput(c);
 }
 void explainJoin(cli *c, jb_t *jb) {
@@ -175,6 +193,95 @@ void explainCommand(redisClient *c) {
     c->Explain = 0;
 }
 
+// PARSEBENCH PARSEBENCH PARSEBENCH PARSEBENCH PARSEBENCH PARSEBENCH
+/* NOTE: parses (no execution) a statement N times & replies statements/sec
+    PARSEBENCH N SELECT cl FROM tbl WHERE wc
+    PARSEBENCH N INSERT INTO tbl VALUES (vals)
+    PARSEBENCH N CREATE TABLE tbl (cdecl)                                  */
+static bool benchSelect(cli *c, robj **argv, long n) {
+    for (long k = 0; k < n; k++) {
+        CREATE_CS_LS_LIST(1)
+        bool cstar = 0; bool join = 0; int qcols = 0; int tmatch = -1;
+        if (!parseSelect(c, 0, NULL, &tmatch, cmatchl, ls, &qcols, &join,
+                         &cstar, argv[0]->ptr, argv[1]->ptr, argv[2]->ptr,
+                         argv[3]->ptr, 1)) {
+            RELEASE_CS_LS_LIST                                   return 0;
+        }
+        if (join) {
+            RELEASE_CS_LS_LIST addReply(c, shared.parsebench_syntax); return 0;
+        }
+        cswc_t w; wob_t wb;
+        init_check_sql_where_clause(&w, tmatch, argv[4]->ptr); init_wob(&wb);
+        uchar prs = parseWC(c, &w, &wb, NULL, NULL);
+        if (prs == PRS_GEN_ERR) addReply(c, shared.selectsyntax);
+        destroy_wob(&wb); destroy_check_sql_where_clause(&w);
+        RELEASE_CS_LS_LIST
+        if (prs != PRS_OK)                                       return 0;
+    }
+    return 1;
+}
+static bool benchInsert(cli *c, robj **argv, long n) {
+    if (strcasecmp(argv[0]->ptr, "INTO") || strcasecmp(argv[2]->ptr, "VALUES")) {
+        addReply(c, shared.parsebench_syntax);                   return 0;
+    }
+    TABLE_CHECK_OR_REPLY(argv[1]->ptr, 0)
+    r_tbl_t *rt     = &Tbl[tmatch];
+    if (rt->hashy) { /* HASHABILITY parsing adds columns to the table */
+        addReply(c, shared.parsebench_syntax);                   return 0;
+    }
+    int      ncols  = rt->col_count;
+    int      lncols = insertableColCount(tmatch);
+    uint128  ainc   = rt->ainc; /* AUTO_INCREMENT PKs are NOT committed */
+    bool     ok     = 1;
+    for (long k = 0; k < n; k++) {
+        twoint cofsts[ncols];
+        for (int i = 0; i < ncols; i++) cofsts[i].i = cofsts[i].j = -1;
+        char *pk = NULL; int pklen = 0; bool ai = 0;
+        char *mvals = parseRowVals(argv[3]->ptr, &pk, &pklen, ncols, cofsts,
+                                   tmatch, 0, NULL, lncols, &ai);
+        if (pk) free(pk);                                /* FREED 021 */
+        if (!mvals) { addReply(c, shared.insertsyntax); ok = 0;   break; }
+    }
+    rt->ainc = ainc;
+    return ok;
+}
+static bool benchCreateTable(cli *c, robj **argv, long n) {
+    if (strcasecmp(argv[0]->ptr, "TABLE")) {
+        addReply(c, shared.parsebench_syntax);                   return 0;
+    }
+    for (long k = 0; k < n; k++) {
+        list *cnames = listCreate(); cnames->free = v_sdsfree;
+        list *ctypes = listCreate();
+        int   ccount = 0;
+        bool  ok     = parseCreateTable(c, ctypes, cnames, &ccount,
+                                        argv[2]->ptr);
+        listRelease(cnames); listRelease(ctypes);
+        if (!ok)                                                 return 0;
+    }
+    return 1;
+}
+void parsebenchCommand(redisClient *c) {
+    long n = strtol(c->argv[1]->ptr, NULL, 10);
+    if (n <= 0) { addReply(c, shared.parsebench_syntax);         return; }
+    char      *stype = c->argv[2]->ptr;
+    robj     **argv  = c->argv + 3;
+    int        nargs = c->argc - 3;
+    bool       ok;
+    long long  beg   = ustime();
+    if      (!strcasecmp(stype, "SELECT") && nargs == 5) {
+        ok = benchSelect     (c, argv, n);
+    } else if (!strcasecmp(stype, "INSERT") && nargs == 4) {
+        ok = benchInsert     (c, argv, n);
+    } else if (!strcasecmp(stype, "CREATE") && nargs == 3) {
+        ok = benchCreateTable(c, argv, n);
+    } else { addReply(c, shared.parsebench_syntax);              return; }
+    if (!ok)                                                     return;
+    long long  dur   = ustime() - beg; if (!dur) dur = 1;
+    addReplySds(c, sdscatprintf(sdsempty(),
+                   "+PARSEBENCH: %s: %ld statements in %lld usecs (%.0f/sec)\r\n",
+                   stype, n, dur, ((double)n * 1000000.0) / (double)dur));
+}
+
 // DEBUG DEBUG DEBUG DEBUG DEBUG DEBUG DEBUG DEBUG DEBUG DEBUG DEBUG DEBUG
 // DEBUG DEBUG DEBUG DEBUG DEBUG DEBUG DEBUG DEBUG DEBUG DEBUG DEBUG DEBUG
 void dumpIC(printer *prn, icol_t *ic) {
@@ -232,6 +339,12 @@ void dumpWB(printer *prn, wob_t *wb) {
             (*prn)("\t\t\tasc[%d]: %d\n", i, wb->asc[i]);
         }
     }
+    if (wb->ngby) {
+        (*prn)("\t\tngby:   %d\n", wb->ngby);
+        for (uint32 i = 0; i < wb->ngby; i++) {
+            (*prn)("\t\t\tgbc[%d]: %d\n", i, wb->gbc[i].cmatch);
+        }
+    }
     if (wb->lim  != -1) (*prn)("\t\tlim:    %ld\n", wb->lim);
     if (wb->ofst != -1) (*prn)("\t\tofst:   %ld\n", wb->ofst);
     dumpSds(prn, wb->ovar,  "\t\tovar:    %s\n");
@@ -240,6 +353,8 @@ void dumpW(printer *prn, cswc_t *w) {
     (*prn)("\tSTART dumpW: type: %d (%s)\n", w->wtype, RangeType[w->wtype]);
     dumpFilter(prn, &w->wf, "\t");
     dumpFL(prn, "\t\t", "FLIST", w->flist);
+    dumpFProg(prn, w->fprog);
+    if (w->bmap) dumpBitmap(prn, w->bmap);
     (*prn)("\tEND dumpW\n");
 }
 
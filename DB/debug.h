@@ -30,14 +30,17 @@ ALL RIGHTS RESERVED
 #include "redis.h"
 
 #include "query.h"
+#include "aggr.h"
 #include "common.h"
 
 long MAX(long a, long b);
 long MIN(long a, long b);
 
 void explainRQ(cli *c, cswc_t *w, wob_t *wb, bool cstr, int qcols, icol_t *ics);
+void explainAggr(cli *c, cswc_t *w, wob_t *wb, aggr_t *ag);
 void explainJoin   (cli *c, jb_t *jb);
 void explainCommand(cli *c);
+void parsebenchCommand(cli *c);
 
 // QUEUE_PRINTF_TO_CLIENT QUEUE_PRINTF_TO_CLIENT QUEUE_PRINTF_TO_CLIENT
 void initQueueOutput();
@@ -38,8 +38,11 @@ ALL RIGHTS RESERVED
 #include "bt.h"
 #include "bt_iterator.h"
 #include "index.h"
+#include "bitmap.h"
+#include "hash.h"
 #include "colparse.h"
 #include "find.h"
+#include "mmtbl.h"
 #include "alsosql.h"
 #include "aobj.h"
 #include "common.h"
@@ -78,10 +81,11 @@ sds createAlterTableFullText(r_tbl_t *rt, r_ind_t *ri, int cmatch, bool nl) {
     return s;
 }
 sds dumpSQL_Index(char *mtname, r_tbl_t *rt, r_ind_t *ri, int tmatch, bool nl) {
-    bool text_ind = C_IS_S(rt->col[ri->icol.cmatch].type);
+    bool text_ind = C_IS_S(rt->col[ri->icol.cmatch].type) && !HASHS(ri->cnstr);
     if (text_ind) return createAlterTableFullText(rt, ri, ri->icol.cmatch, nl);
     else {
-        char *cmd   = UNIQ(ri->cnstr) ? "CREATE UNIQUE INDEX" : "CREATE INDEX";
+        char *cmd   = (UNIQ(ri->cnstr) || HASHS(ri->cnstr)) ?
+                                       "CREATE UNIQUE INDEX" : "CREATE INDEX";
         char *tname = mtname ? mtname : rt->name;
         sds   s     = sdscatprintf(sdsempty(), "%s %s ON %s ",
                                               cmd, ri->name, tname);
@@ -94,6 +98,7 @@ sds dumpSQL_Index(char *mtname, r_tbl_t *rt, r_ind_t *ri, int tmatch, bool nl) {
             sds c_w_p = sdscatprintf(sdsempty(), "(%s)", cname); //DEST 074
             s = sdscatlen(s, c_w_p, sdslen(c_w_p));
             sdsfree(c_w_p);                              /* DESTROYED 074 */
+            if HASHI(ri->cnstr) s = sdscatlen(s, " USING HASH", 11);
         }
         s = nl ? sdscatlen(s, ";\n", 2) : sdscatlen(s, ";", 1) ;
         return s;
@@ -111,10 +116,14 @@ void sqlDumpCommand(redisClient *c) {
     else if ((c->argc > 3)) {
         sds arg3 = c->argv[3]->ptr;
         if ((strcasecmp(c->argv[2]->ptr, "TO") ||
-            (strcasecmp(arg3, "MYSQL") && strcasecmp(arg3, "FILE")))) err = 1;
-        else if (!strcasecmp(arg3, "FILE") && (c->argc < 5)) err = 1;
+            (strcasecmp(arg3, "MYSQL") && strcasecmp(arg3, "FILE") &&
+             strcasecmp(arg3, "MMAP")))) err = 1;
+        else if (strcasecmp(arg3, "MYSQL") && (c->argc < 5)) err = 1;
     }
     if (err) { addReply(c, shared.dump_syntax); return; }
+    if (c->argc == 5 && !strcasecmp(c->argv[3]->ptr, "MMAP")) {
+        mmtDumpTable(c, tmatch, c->argv[4]->ptr); return;
+    }
 
     bt       *btr     = getBtr(tmatch);
     r_tbl_t *rt       = &Tbl[tmatch];
@@ -244,6 +253,8 @@ ull get_sum_all_index_size_for_table(int tmatch) {
         r_ind_t *ri = &Index[inds[i]];
         if (!ri->virt && !ri->hlt && !ri->fname) {
             bt *ibtr = getIBtr(inds[i]); isize += ibtr->msize;
+            if BMAP(ri->cnstr) isize += bitmapIndexBytes(ri);
+            if (ri->hsh)       isize += alc_ihash_size(ri->hsh);
         }
     }
     return isize;
@@ -331,15 +342,23 @@ void descCommand(redisClient *c) {
                 ull      isize   = 0;
                 if (!ri->virt && !ri->hlt && !ri->fname) {
                     bt *ibtr = getIBtr(imatch); isize = ibtr->msize;
+                    if BMAP(ri->cnstr) isize += bitmapIndexBytes(ri);
+                    if (ri->hsh)       isize += alc_ihash_size(ri->hsh);
                 }
                 sds idesc = NULL; // DEST 051
                 if      (ri->clist)    idesc = getMCIlist(ri->clist, tmatch);
                 else if (ri->icol.nlo) idesc = getLOIlist(imatch);
+                else if (ri->xop)      idesc = catIndexExpr(
+                                                 sdsnew("EXPRESSION: ("), ri);
+                if (ri->xop)           idesc = sdscatlen(idesc, ")", 1);
                 r->ptr = sdscatprintf(r->ptr, 
                                       "%s%s%sINDEX: %s%s%s [BYTES: %lld]",
                                         loops     ? ", "       : " - ", 
-                                        ri->cnstr ? " UNIQUE " : "",
-                                        ri->done  ? ""         : " PARTIAL ",
+                                        HASHI(ri->cnstr) ? " UNIQUE HASH " :
+                                        UNIQ(ri->cnstr) ? " UNIQUE " :
+                                        BMAP(ri->cnstr) ? " BITMAP " : "",
+                                        ri->done  ? ""         :
+                                        ri->bg    ? " BUILDING " : " PARTIAL ",
                                         ri->name,
                                         idesc     ? " "        : "",
                                         idesc     ? idesc      : "",
@@ -352,6 +371,15 @@ void descCommand(redisClient *c) {
                                           rt->col[ri->obc.cmatch].name);
                     //TODO FIXME dump "lo"
                 }
+                if (ri->icov.cmatch != -1) {
+                    r->ptr = sdscatprintf(r->ptr, " - INCLUDE %s%s",
+                                          rt->col[ri->icov.cmatch].name,
+                                          ri->cvmiss ? " (NOT COVERING)" : "");
+                }
+                if (ri->pwc) {
+                    r->ptr = sdscatprintf(r->ptr, " - WHERE %s", ri->pwc);
+                }
+                if (ri->persist) r->ptr = sdscatprintf(r->ptr, " - PERSIST");
                 if (!ri->done) outputPartialIndex(tmatch, imatch, r);
                 loops++;
             } listReleaseIterator(li);
@@ -412,6 +440,14 @@ void descCommand(redisClient *c) {
         robj *r    = createObject(REDIS_STRING, desc);
         addReplyBulk(c, r); decrRefCount(r); card++;
     }
+    if (rt->mm) {
+        mmt_t *mm   = rt->mm;
+        sds    desc = sdscatprintf(sdsempty(),
+                          "MMAP: [FILE: %s PAGES: %u BYTES: %lu] - READ-ONLY",
+                           mm->fname, mm->npages, (ulong)mm->size);
+        robj  *r    = createObject(REDIS_STRING, desc);
+        addReplyBulk(c, r); decrRefCount(r); card++;
+    }
 
     setDeferredMultiBulkLength(c, rlen, card);
     dump_bt_mem_profile(btr);
@@ -28,25 +28,219 @@ ALL RIGHTS RESERVED
 #include <string.h>
 #include <strings.h>
 #include <unistd.h>
+#include <limits.h>
+#include <errno.h>
 
 #include "redis.h"
+#include "zmalloc.h"
 
 #include "query.h"
 #include "bt.h"
 #include "btree.h"
+#include "bt_iterator.h"
 #include "parser.h"
 #include "stream.h"
 #include "index.h"
 #include "find.h"
 #include "alsosql.h"
 #include "common.h"
+#include "rowstore.h"
 #include "evict.h"
 
 /* EVICT TODO LIST:
      1.) Table must be NUM PK & auto-inc
 */
-extern r_tbl_t  *Tbl;
-extern r_ind_t  *Index;
+extern r_tbl_t  *Tbl;   extern int Num_tbls;
+extern r_ind_t  *Index; extern int Num_indx;
+
+/* lrlf: also drop the row's LRU/LFU index entry (evicted rows are never
+         accessed again, so the index's oldest entries stay evictable) */
+static bool evictRow(int tmatch, aobj *apk, bool lrlf) {
+    r_tbl_t *rt   = &Tbl[tmatch];
+    bt      *btr  = getBtr(tmatch);
+    dwm_t    dwm  = btFindD(btr, apk);
+    void    *rrow = dwm.k;
+    bool     gost = IS_GHOST(btr, rrow);
+    //printf("EVICT: K: %p MISS: %d gost: %d\n", dwm.k, dwm.miss, gost);
+    if (!rrow || dwm.miss || gost)                                return 0;
+    MATCH_INDICES(tmatch)
+    if (matches) { // EVICT indexes
+        for (int j = 0; j < matches; j++) {
+            r_ind_t *ri  = &Index[inds[j]];
+            if (ri->virt || ri->hlt || ri->fname)                 continue;
+            ulong    pre = ri->btr->msize;
+            if      (ri->lru || ri->lfu) {
+                if (!lrlf)                                        continue;
+                delFromIndex(btr, apk, rrow, inds[j], 0);
+            } else evictFromIndex(btr, apk, rrow, inds[j]);
+            rt->nebytes += (pre - ri->btr->msize);
+        }}
+    //printf("EVICT indexes done\n");
+    if (rt->haslo) {
+        for (int j = 0; j < rt->col_count; j++) {
+            if C_IS_O(rt->col[j].type) deleteLuaTable(tmatch, j, apk);
+        }}
+    if (!rsPut(tmatch, apk, rrow, lrlf)) rt->rsmiss = 1; // ROWSTORE: fault-in
+    ulong pre = rt->btr->msize;
+    btEvict(btr, apk);
+    rt->nebytes += (pre - rt->btr->msize);
+    rt->nerows++;
+    return 1;
+}
+
+// EVICTED_RANGES EVICTED_RANGES EVICTED_RANGES EVICTED_RANGES EVICTED_RANGES
+/* NOTE: rt->evr holds sorted, disjoint & non-adjacent [lo, hi] PK spans that
+         have NO row in the table's btree (EVICTed or never INSERTed). The DR
+         spans in the btree stay the authority (rt->evr is not in the RDB),
+         rt->evr answers "is this PK evicted" in O(log(nevr)) w/o a btree
+         descent. A row faulted back in by the ROWSTORE punches its PK out */
+#define EVR_PK(rt, apk) \
+  (C_IS_I((rt)->col[0].type) ? (ulong)(apk)->i : (apk)->l)
+
+/* RETURNS: last span w/ (lo <= k), -1 if none */
+static int evrFind(r_tbl_t *rt, ulong k) {
+    int l = 0, h = (int)rt->nevr - 1, r = -1;
+    while (l <= h) {
+        int m = (l + h) / 2;
+        if (rt->evr[m].lo <= k) { r = m; l = m + 1; } else h = m - 1;
+    }
+    return r;
+}
+static void evrAdd(r_tbl_t *rt, ulong lo, ulong hi) {
+    int i = evrFind(rt, lo);
+    if      (i == -1)                                             i = 0;
+    else if (rt->evr[i].hi != ULONG_MAX && rt->evr[i].hi + 1 < lo) i++;
+    int j = i; // spans [i, j) overlap or touch [lo, hi] -> merged into one
+    while (j < (int)rt->nevr &&
+           (hi == ULONG_MAX || rt->evr[j].lo <= hi + 1)) {
+        if (rt->evr[j].lo < lo) lo = rt->evr[j].lo;
+        if (rt->evr[j].hi > hi) hi = rt->evr[j].hi;
+        j++;
+    }
+    if (j == i) {
+        size_t sz = sizeof(evr_t) * (rt->nevr + 1);
+        rt->evr   = zrealloc(rt->evr, sz);                   // FREE ME 228
+        memmove(&rt->evr[i + 1], &rt->evr[i], sizeof(evr_t) * (rt->nevr - i));
+        rt->nevr++;
+    } else if (j > i + 1) {
+        memmove(&rt->evr[i + 1], &rt->evr[j], sizeof(evr_t) * (rt->nevr - j));
+        rt->nevr -= (j - i - 1);
+    }
+    rt->evr[i].lo = lo; rt->evr[i].hi = hi;
+}
+static bool evrCovers(int tmatch, aobj *apk) {
+    r_tbl_t *rt = &Tbl[tmatch];
+    if (!rt->nevr) return 0;
+    ulong    k  = EVR_PK(rt, apk);
+    int      i  = evrFind(rt, k);
+    return (i != -1 && k <= rt->evr[i].hi);
+}
+bool evrCoversRange(int tmatch, aobj *alow, aobj *ahigh) {
+    r_tbl_t *rt = &Tbl[tmatch];
+    if (!rt->nevr) return 0;
+    ulong    lo = EVR_PK(rt, alow), hi = EVR_PK(rt, ahigh);
+    int      i  = evrFind(rt, lo);
+    return (i != -1 && lo <= hi && hi <= rt->evr[i].hi);
+}
+/* apk is back in the btree (ROWSTORE fault-in, PK UPDATE) */
+void evrPunch(int tmatch, aobj *apk) {
+    r_tbl_t *rt = &Tbl[tmatch];
+    if (!rt->nevr) return;
+    ulong    k  = EVR_PK(rt, apk);
+    int      i  = evrFind(rt, k);
+    if (i == -1 || k > rt->evr[i].hi) return;
+    evr_t    e  = rt->evr[i];
+    if        (e.lo == e.hi) {
+        memmove(&rt->evr[i], &rt->evr[i + 1],
+                sizeof(evr_t) * (rt->nevr - i - 1));
+        rt->nevr--;
+    } else if (k == e.lo) { rt->evr[i].lo++;
+    } else if (k == e.hi) { rt->evr[i].hi--;
+    } else { // split
+        size_t sz = sizeof(evr_t) * (rt->nevr + 1);
+        rt->evr   = zrealloc(rt->evr, sz);                   // FREE ME 228
+        memmove(&rt->evr[i + 2], &rt->evr[i + 1],
+                sizeof(evr_t) * (rt->nevr - i - 1));
+        rt->nevr++;
+        rt->evr[i].hi     = k - 1;
+        rt->evr[i + 1].lo = k + 1; rt->evr[i + 1].hi = e.hi;
+    }
+}
+void evrDropTable(r_tbl_t *rt) {
+    if (rt->evr) zfree(rt->evr);                         // FREED 228
+    rt->evr = NULL; rt->nevr = 0;
+}
+/* btFindD() + ROWSTORE fault-in, a PK in an EVICT RANGE span is a MISS
+   w/o a btree descent. NOTE: dwm.[x,i,p,pi] are not set on that MISS */
+dwm_t evictFindD(int tmatch, aobj *apk) {
+    bt    *btr = getBtr(tmatch);
+    dwm_t  dwm;
+    if (evrCovers(tmatch, apk) && !rsFaultIn(tmatch, apk)) {
+        bzero(&dwm, sizeof(dwm_t)); dwm.miss = 1;              return dwm;
+    }
+    dwm = btFindD(btr, apk);
+    if (!dwm.k && rsFaultIn(tmatch, apk)) dwm = btFindD(btr, apk);
+    return dwm;
+}
+
+// EVICT_RANGE EVICT_RANGE EVICT_RANGE EVICT_RANGE EVICT_RANGE EVICT_RANGE
+static bool parseEvictPK(sds s, uchar pktyp, ulong *pk) {
+    char *end;
+    if (*s < '0' || *s > '9')                          return 0;
+    errno = 0; *pk = strtoul(s, &end, 10);
+    if (*end || errno)                                 return 0;
+    if (C_IS_I(pktyp) && *pk >= TWO_POW_32)            return 0;
+    return 1;
+}
+/* EVICT tbl RANGE lo hi: every row w/ a PK in [lo, hi] goes (indexes &
+   ROWSTORE as per single PK EVICT), the btree collapses the run into ONE DR
+   on lo's predecessor (dirty_left if none) & frees the emptied nodes.
+   [lo, hi] (clipped to AUTO_INC, GHOSTs split it) is added to rt->evr
+   NOTE: PKs are collected 1st, evictRow() can not run under an iterator */
+static void evictRange(cli *c, int tmatch) {
+    r_tbl_t *rt    = &Tbl[tmatch];
+    bt      *btr   = getBtr(tmatch);
+    uchar    pktyp = rt->col[0].type;
+    ulong    lo, hi;
+    if (c->argc != 5 || (!C_IS_I(pktyp) && !C_IS_L(pktyp)) ||
+        !parseEvictPK(c->argv[3]->ptr, pktyp, &lo)         ||
+        !parseEvictPK(c->argv[4]->ptr, pktyp, &hi) || lo > hi) {
+        addReply(c, shared.evict_range);                             return;
+    }
+    aobj     alow, ahigh; initAobjZeroNum(&alow, pktyp);
+                          initAobjZeroNum(&ahigh, pktyp);
+    if C_IS_I(pktyp) { alow.i = (uint32)lo; ahigh.i = (uint32)hi; }
+    else             { alow.l = lo;         ahigh.l = hi;         }
+    ulong   *pks   = NULL; long npks = 0, apks = 0;
+    btEntry *be;
+    btSIter *bi    = btGetRangeIter(btr, &alow, &ahigh, 1);
+    if (bi) {
+        while ((be = btRangeNext(bi, 1))) {
+            ulong k = EVR_PK(rt, (aobj *)be->key);
+            if (k < lo) continue; // MISS @ lo -> iterator starts @ its span
+            if (npks == apks) {
+                apks = apks ? apks * 2 : 64;
+                pks  = zrealloc(pks, sizeof(ulong) * apks); // FREE ME 229
+            }
+            pks[npks++] = k;
+        } btReleaseRangeIterator(bi);
+    }
+    long     card  = 0;
+    ulong    beg   = lo;
+    bool     run   = 1; // beg is valid (pk + 1 did not wrap)
+    aobj     apk;  initAobjZeroNum(&apk, pktyp);
+    for (long i = 0; i < npks; i++) {
+        if C_IS_I(pktyp) apk.i = (uint32)pks[i]; else apk.l = pks[i];
+        if (evictRow(tmatch, &apk, 0)) { card++;                   continue; }
+        if (run && pks[i] > beg) evrAdd(rt, beg, pks[i] - 1); // GHOST stays
+        if (pks[i] == ULONG_MAX) run = 0; else beg = pks[i] + 1;
+    }
+    if (pks) zfree(pks);                                 // FREED 229
+    ulong    end   = ((uint128)hi > rt->ainc) ? (ulong)rt->ainc : hi;
+    if (run && beg <= end) evrAdd(rt, beg, end); // AUTO_INC: no new PK <= end
+    server.dirty++; /* -> AOF & slaves (rt->evr spans too) */
+    addReplyLongLong(c, card);
+}
 
 void evictCommand(cli *c) {
     int      len   = sdslen(c->argv[1]->ptr);
@@ -58,39 +252,128 @@ void evictCommand(cli *c) {
     bt   *btr   = getBtr(tmatch);
     if OTHER_BT(btr) { addReply(c, shared.evict_other);               return; }
     if (!(C_IS_NUM(btr->s.ktype))) { addReply(c, shared.evict_other); return; }
+    if (!strcasecmp(c->argv[2]->ptr, "RANGE")) { evictRange(c, tmatch); return;}
     long  card   = 0;
     for (int i = 2; i < c->argc; i++) {
         sds    pk   = c->argv[i]->ptr;
         aobj apk; initAobjFromStr(&apk, pk, sdslen(pk), btr->s.ktype);
-        printf("\n\nEVICT: tbl: %s[%d] apk: ", tname, tmatch);
-        dumpAobj(printf, &apk);
-        dwm_t  dwm  = btFindD(btr, &apk);
-        void  *rrow = dwm.k;
-        bool   gost = IS_GHOST(btr, rrow);
-        printf("EVICT: K: %p MISS: %d gost: %d\n", dwm.k, dwm.miss, gost);
-        if (!rrow || dwm.miss || gost)                            continue;
-        MATCH_INDICES(tmatch)
-        if (matches) { // EVICT indexes
-            for (int j = 0; j < matches; j++) {
-                r_ind_t *ri  = &Index[inds[j]];
-                if (ri->virt || ri->hlt || ri->lru || ri->lfu ||
-                    ri->fname)                                    continue;
-                ulong    pre = ri->btr->msize;
-                evictFromIndex(btr, &apk, rrow, inds[j]);
-                rt->nebytes += (pre - ri->btr->msize);
-            }}
-        printf("EVICT indexes done\n");
-        if (Tbl[tmatch].haslo) {
-            r_tbl_t *rt = &Tbl[tmatch];
-            for (int j = 0; j < rt->col_count; j++) {
-                if C_IS_O(rt->col[j].type) deleteLuaTable(tmatch, j, &apk);
-            }}
-        ulong pre = rt->btr->msize;
-        btEvict(btr, &apk); card++; releaseAobj(&apk);
-        rt->nebytes += (pre - rt->btr->msize);
-        printf("\n\n"); fflush(NULL);
+        //printf("EVICT: tbl: %s[%d] apk: ", tname, tmatch);
+        //dumpAobj(printf, &apk);
+        if (evictRow(tmatch, &apk, 0)) card++;
+        releaseAobj(&apk);
     }
-    rt->nerows += card;
-    printf("nerows: %ld nebytes: %ld\n\n", rt->nerows, rt->nebytes);
+    //printf("nerows: %ld nebytes: %ld\n\n", rt->nerows, rt->nebytes);
+    if (card) server.dirty++; /* -> AOF & slaves */
     addReplyLongLong(c, card);
 }
+
+// AUTO_EVICT AUTO_EVICT AUTO_EVICT AUTO_EVICT AUTO_EVICT AUTO_EVICT
+/* NOTE: with "maxmemory" set, evictTimeProc() evicts DIRTY tables' coldest
+         rows (oldest LRUINDEX entries, else lowest LFUINDEX entries) until
+         alcUsedMemory() is back under the limit. Each round every eligible
+         table gives up at most EVICT_TABLE_QUOTA rows (no single table is
+         emptied while others stay untouched), rounds run until the
+         "evict_slice_ms" deadline, then the event loop serves clients */
+#define EVICT_TABLE_QUOTA 64
+
+static ulong AutoEvRows   = 0;
+static ulong AutoEvBytes  = 0;
+static ulong AutoEvCycles = 0;
+
+/* btrees malloc() their nodes but add them to zmalloc's used_memory */
+ulong alcUsedMemory() {
+    return zmalloc_used_memory();
+}
+static int evictIndex(int tmatch) { /* -1 -> table can NOT be auto-evicted */
+    r_tbl_t *rt  = &Tbl[tmatch];
+    if (!rt->name || !rt->dirty)                 return -1;
+    bt      *btr = getBtr(tmatch);
+    if (OTHER_BT(btr) || !C_IS_NUM(btr->s.ktype)) return -1;
+    if (rt->lrud)                                return rt->lrui;
+    if (rt->lfu)                                 return rt->lfui;
+    return -1;
+}
+/* RETURNS: number of PKs (coldest first) copied into apks[] */
+static int getColdest(int imatch, aobj apks[], int max) {
+    int      n    = 0;
+    btEntry *be, *nbe;
+    bt      *ibtr = getIBtr(imatch);
+    btSIter *bi   = btGetFullRangeIter(ibtr, 1, NULL);
+    if (!bi) return 0;
+    while (n < max && (be = btRangeNext(bi, 1))) {
+        btSIter *nbi = btGetFullRangeIter((bt *)be->val, 1, NULL);
+        if (!nbi) continue;
+        while (n < max && (nbe = btRangeNext(nbi, 1))) {
+            aobjClone(&apks[n], (aobj *)nbe->key); n++;
+        } btReleaseRangeIterator(nbi);
+    } btReleaseRangeIterator(bi);
+    return n;
+}
+/* a round goes to AOF/slaves as "EVICT tbl pk,,,," (the EVICT command) */
+static void propagateEvict(int tmatch, robj **argv, int argc) {
+    if (argc == 2) return;
+    rcommand *cmd  = lookupCommandByCString("evict");
+    int       dbid = server.alc.RestClient->db->id;
+    argv[0]        = createStringObject("EVICT", 5);
+    argv[1]        = createStringObject(Tbl[tmatch].name,
+                                        sdslen(Tbl[tmatch].name));
+    if (server.appendonly) feedAppendOnlyFile(cmd, dbid, argv, argc);
+    if (listLength(server.slaves)) {
+        replicationFeedSlaves(server.slaves, dbid, argv, argc);
+    }
+    server.alc.stat_num_dirty_commands++; /* slaves count the EVICTs */
+    for (int i = 0; i < argc; i++) decrRefCount(argv[i]);
+}
+/* RETURNS: rows evicted */
+static long evictTableRound(int tmatch, int imatch) {
+    aobj  apks[EVICT_TABLE_QUOTA];
+    robj *argv[2 + EVICT_TABLE_QUOTA];
+    bool  prop = server.appendonly || listLength(server.slaves);
+    int   n    = getColdest(imatch, apks, EVICT_TABLE_QUOTA);
+    long  ev   = 0;
+    ulong pre  = Tbl[tmatch].nebytes;
+    for (int i = 0; i < n; i++) {
+        if (evictRow(tmatch, &apks[i], 1)) {
+            if (prop) {
+                argv[2 + ev] = createObject(REDIS_STRING,
+                                            createSDSFromAobj(&apks[i]));
+            }
+            ev++;
+        }
+        releaseAobj(&apks[i]);
+    }
+    if (prop) propagateEvict(tmatch, argv, 2 + ev);
+    AutoEvRows  += ev;
+    AutoEvBytes += (Tbl[tmatch].nebytes - pre);
+    return ev;
+}
+int evictTimeProc(struct aeEventLoop *eventLoop, lolo id, void *cdata) {
+    (void)eventLoop; (void)id; (void)cdata; // compiler warnings
+    if (!server.maxmemory || alcUsedMemory() <= server.maxmemory) return 100;
+    long long deadline = ustime() + (server.alc.EvictSlice * 1000);
+    AutoEvCycles++;
+    while (1) {
+        long ev = 0;
+        for (int tmatch = 0; tmatch < Num_tbls; tmatch++) {
+            int imatch = evictIndex(tmatch);
+            if (imatch == -1) continue;
+            ev += evictTableRound(tmatch, imatch);
+        }
+        if (!ev)                                        return 100; // NADA
+        if (alcUsedMemory() <= server.maxmemory)        return 100;
+        if (ustime() >= deadline)                       return 1;
+    }
+}
+sds genEvictInfoString(sds info) {
+    ulong nevr = 0;
+    for (int tmatch = 0; tmatch < Num_tbls; tmatch++) {
+        if (Tbl[tmatch].name) nevr += Tbl[tmatch].nevr;
+    }
+    return sdscatprintf(info, "alchemy_used_memory:%lu\r\n"
+                              "evict_auto_rows:%lu\r\n"
+                              "evict_auto_bytes:%lu\r\n"
+                              "evict_auto_cycles:%lu\r\n"
+                              "evict_ranges:%lu\r\n",
+                        alcUsedMemory(), AutoEvRows, AutoEvBytes,
+                        AutoEvCycles, nevr);
+}
@@ -28,8 +28,19 @@ ALL RIGHTS RESERVED
 
 #include "redis.h"
 
+#include "btree.h"
+#include "query.h"
 #include "common.h"
 
 void evictCommand(redisClient *c);
 
+dwm_t evictFindD    (int tmatch, aobj *apk);
+bool  evrCoversRange(int tmatch, aobj *alow, aobj *ahigh);
+void  evrPunch      (int tmatch, aobj *apk);
+void  evrDropTable  (r_tbl_t *rt);
+
+ulong alcUsedMemory      ();
+int   evictTimeProc      (struct aeEventLoop *eventLoop, lolo id, void *cdata);
+sds   genEvictInfoString (sds info);
+
 #endif /*__A_CACHE__H */ 
@@ -46,7 +46,8 @@ ALL RIGHTS RESERVED
 extern r_tbl_t *Tbl;
 extern r_ind_t *Index;
 
-extern char *OP_Desc[];
+extern char     *OP_Desc[];
+extern aobj_cmp *OP_CMP[7];
 
 void initFilter(f_t *flt) {
     bzero(flt, sizeof(f_t));
@@ -64,6 +65,7 @@ static void releaseFilterInnards(f_t *flt, bool le) {
     if (flt->high) { sdsfree(flt->high);    flt->high = NULL; }
     releaseIC(&flt->ic);
     releaseAobj(&flt->akey); releaseAobj(&flt->alow); releaseAobj(&flt->ahigh);
+    destroyINSet  (&flt->ins); /* before INL, STRING slots point into it */
     destroyINLlist(&flt->inl);
     if (le) releaseLUE(&flt->le);
 }
@@ -90,6 +92,7 @@ f_t *cloneFilter(f_t *oflt) {
     //TODO FIXME clone "ic.lo"
     flt->op     = oflt->op;
     flt->iss    = oflt->iss;
+    flt->nin    = oflt->nin;
     if (oflt->key)  flt->key  = sdsdup(oflt->key);
     if (oflt->low)  flt->low  = sdsdup(oflt->low);
     if (oflt->high) flt->high = sdsdup(oflt->high);
@@ -99,6 +102,8 @@ f_t *cloneFilter(f_t *oflt) {
     if (oflt->inl) {
         oflt->inl->dup = vcloneAobj;
         flt->inl       = listDup(oflt->inl);
+        flt->ins       = createINSet(flt->inl, oflt->ins ? oflt->ins->ctype :
+                                                           COL_TYPE_NONE);
     }
     if (oflt->klist) flt->klist = listDup(oflt->klist);
     //TODO cloneLUE
@@ -124,6 +129,125 @@ void convertFilterListToAobj(list *flist) {
     } listReleaseIterator(li);
 }
 
+// IN_SET IN_SET IN_SET IN_SET IN_SET IN_SET IN_SET IN_SET IN_SET IN_SET
+/* NOTE:
+    IN() lists are walked per row w/ OP_CMP[EQ] -> O(N) per row.
+    The INL is hashed at parse time into an open-addressing (linear probe)
+    set, NUMs & FLOATs keyed on their value (as a uint128), STRINGs keyed on
+    their bytes. STRING EQ is strncmp(key, col, keylen) [i.e. a key matches
+    any column it is a prefix of], so a STRING lookup probes the column's
+    prefixes of each distinct key length in the set.
+*/
+static uint32 hashINNum(uint128 x) {
+    ulong h = (ulong)x ^ (ulong)(x >> 64);
+    h ^= h >> 33; h *= 0xff51afd7ed558ccdUL; h ^= h >> 33;
+    return (uint32)h;
+}
+static bool getINNum(aobj *a, uint128 *x) {
+    if      (C_IS_I(a->type)) *x = a->i;
+    else if (C_IS_L(a->type)) *x = a->l;
+    else if (C_IS_X(a->type)) *x = a->x;
+    else if (C_IS_F(a->type)) {
+        if (a->f != a->f) return 0;          /* NaN never matches */
+        float f = (a->f == 0.0) ? 0.0 : a->f; /* -0.0 == 0.0 */
+        uint32 u; memcpy(&u, &f, sizeof(float)); *x = u;
+    } else return 0;
+    return 1;
+}
+static bool addINNum(ins_t *ins, uint128 x) {
+    uint32 i = hashINNum(x) & ins->mask;
+    while (ins->used[i]) {
+        if (ins->nkeys[i] == x) return 0;
+        i = (i + 1) & ins->mask;
+    }
+    ins->used[i] = 1; ins->nkeys[i] = x; ins->nvals++;
+    return 1;
+}
+static bool findINStr(ins_t *ins, char *s, uint32 len) {
+    uint32 i = dictGenHashFunction((uchar *)s, len) & ins->mask;
+    while (ins->used[i]) {
+        aobj *k = ins->skeys[i];
+        if (k->len == len && !memcmp(k->s, s, len)) return 1;
+        i = (i + 1) & ins->mask;
+    }
+    return 0;
+}
+static void addINStr(ins_t *ins, aobj *a) {
+    if (findINStr(ins, a->s, a->len)) return;
+    uint32 i = dictGenHashFunction((uchar *)a->s, a->len) & ins->mask;
+    while (ins->used[i]) i = (i + 1) & ins->mask;
+    ins->used[i] = 1; ins->skeys[i] = a; ins->nvals++;
+    uint32 j = 0;
+    while (j < ins->nlens && ins->lens[j] != a->len) j++;
+    if (j == ins->nlens) ins->lens[ins->nlens++] = a->len;
+}
+ins_t *createINSet(list *inl, uchar ctype) {
+    if (!inl || !listLength(inl))                   return NULL;
+    if (!C_IS_NUM(ctype) && !C_IS_F(ctype) && !C_IS_S(ctype)) return NULL;
+    listNode *ln;
+    uint32    n   = listLength(inl), nslots = 8;
+    while (nslots < n * 2) nslots *= 2;  /* load factor <= 0.5 */
+    ins_t    *ins = malloc(sizeof(ins_t));               /* FREE ME 185 */
+    bzero(ins, sizeof(ins_t));
+    ins->ctype    = ctype;
+    ins->mask     = nslots - 1;
+    ins->used     = calloc(nslots, sizeof(uchar));       /* FREE ME 186 */
+    if (C_IS_S(ctype)) {
+        ins->skeys = malloc(sizeof(aobj *) * nslots);    /* FREE ME 187 */
+        ins->lens  = malloc(sizeof(uint32) * n);         /* FREE ME 188 */
+    } else {
+        ins->nkeys = malloc(sizeof(uint128) * nslots);   /* FREE ME 187 */
+    }
+    listIter *li  = listGetIterator(inl, AL_START_HEAD);
+    while((ln = listNext(li))) {
+        aobj *a = ln->value; uint128 x;
+        if (a->type != ctype) { destroyINSet(&ins); break; } /* linear */
+        if      (C_IS_S(ctype))    addINStr(ins, a);
+        else if (getINNum(a, &x))  addINNum(ins, x);
+    } listReleaseIterator(li);
+    return ins;
+}
+void destroyINSet(ins_t **ins) {
+    if (!*ins) return;
+    free((*ins)->used);                                  /* FREED 186 */
+    if ((*ins)->skeys) free((*ins)->skeys);              /* FREED 187 */
+    if ((*ins)->nkeys) free((*ins)->nkeys);              /* FREED 187 */
+    if ((*ins)->lens)  free((*ins)->lens);               /* FREED 188 */
+    free(*ins);                                          /* FREED 185 */
+    *ins = NULL;
+}
+bool inINSet(ins_t *ins, aobj *a) { /* NOTE: a->type must be ins->ctype */
+    if (C_IS_S(ins->ctype)) {
+        for (uint32 j = 0; j < ins->nlens; j++) {
+            uint32 len = ins->lens[j];
+            if (!len)                       return 1; /* '' prefixes ALL */
+            if (len > a->len || !a->s)      continue;
+            if (findINStr(ins, a->s, len))  return 1;
+        }
+        return 0;
+    }
+    uint128 x;
+    if (!getINNum(a, &x)) return 0;
+    uint32  i = hashINNum(x) & ins->mask;
+    while (ins->used[i]) {
+        if (ins->nkeys[i] == x) return 1;
+        i = (i + 1) & ins->mask;
+    }
+    return 0;
+}
+bool passINL(f_t *flt, aobj *a) { /* [NOT] IN() */
+    bool hit = 0;
+    if (flt->ins && a->type == flt->ins->ctype) hit = inINSet(flt->ins, a);
+    else {
+        listNode *ln;
+        listIter *li = listGetIterator(flt->inl, AL_START_HEAD);
+        while((ln = listNext(li))) {
+            if ((hit = (*OP_CMP[EQ])((aobj *)ln->value, a))) break;
+        } listReleaseIterator(li);
+    }
+    return flt->nin ? !hit : hit;
+}
+
 // SERIALISE_FLT SERIALISE_FLT SERIALISE_FLT SERIALISE_FLT SERIALISE_FLT
 int getSizeFLT(f_t *flt) { //NOTE: only single NUM lookup compilation supported 
     if (flt->inl || flt->low)           return -1; //TODO support [IN, RQ]
@@ -189,7 +313,8 @@ void dumpFilter(printer *prn, f_t *flt, char *prfx) {
                                                             Tbl[t].col[c].name);
     //TODO dump ic.lo
     (*prn)("\t%s\timatch: %d (%s)\n", prfx, i, (i == -1) ? "" : Index[i].name);
-    (*prn)("\t%s\top:     %d (%s)\n", prfx, flt->op, OP_Desc[flt->op]);
+    (*prn)("\t%s\top:     %d (%s%s)\n", prfx, flt->op, flt->nin ? "NOT " : "",
+           OP_Desc[flt->op]);
     if (flt->key) {
         (*prn)("\t%s\tkey:    %s\n",      prfx, flt->key);
         (*prn)("\t%s\t", prfx);                  dumpAobj(prn, &flt->akey);
@@ -210,6 +335,8 @@ void dumpFilter(printer *prn, f_t *flt, char *prfx) {
     }
     if (flt->inl) {
         (*prn)("\t%s\tinl len: %d\n", prfx, flt->inl->len);
+        if (flt->ins) (*prn)("\t%s\tins: nvals: %u nslots: %u\n",
+                             prfx, flt->ins->nvals, flt->ins->mask + 1);
         listNode *ln;
         listIter *li = listGetIterator(flt->inl, AL_START_HEAD);
         while((ln = listNext(li))) {
@@ -43,6 +43,23 @@ void *vcloneFilter(void *oflt);
 
 void convertFilterListToAobj(list *flist);
 
+/* IN() lists: typed open-addressing hash set, built at parse time */
+typedef struct in_set {
+    uchar     ctype;
+    uint32    nvals;
+    uint32    mask;   /* nslots - 1 (nslots is a power of 2)            */
+    uchar    *used;
+    uint128  *nkeys;  /* [INT,LONG,U128,FLOAT] slots                    */
+    aobj    **skeys;  /* STRING slots (referential -> flt->inl)         */
+    uint32    nlens;  /* STRING: distinct key lengths (prefix compare)  */
+    uint32   *lens;
+} ins_t;
+
+ins_t *createINSet (list   *inl, uchar ctype);
+void   destroyINSet(ins_t **ins);
+bool   inINSet     (ins_t  *ins, aobj *a);
+bool   passINL     (f_t    *flt, aobj *a);
+
 #define CTYPE_FROM_FLT(flt)                                              \
   ((flt->ic.cmatch   < -1) ? COL_TYPE_FUNC                :              \
    (flt->ic.fimatch != -1) ? Index[flt->ic.fimatch].dtype :              \
@@ -41,6 +41,7 @@ ALL RIGHTS RESERVED
 #include "range.h"
 #include "bt.h"
 #include "common.h"
+#include "index.h"
 #include "find.h"
 
 // GLOBALS
@@ -92,6 +93,39 @@ int find_index(int tmatch, icol_t ic) {
 int find_partial_index(int tmatch, icol_t ic) { // Used by INDEX CURSORs
     return _find_index(tmatch, ic, 1);
 }
+int find_expr_index(int tmatch, sds cname) { // e.g. "col%10", "LEFT(col,3)"
+    r_tbl_t *rt = &Tbl[tmatch];
+    if (!rt->ilist) return -1;
+    sds bname; uchar xop; ulong xarg;
+    if (!parseIndexExpr(cname, sdslen(cname), &bname, &xop, &xarg)) return -1;
+    ci_t *ci = dictFetchValue(rt->cdict, bname); sdsfree(bname); // FREED 213
+    if (!ci) return -1;
+    int       imatch = -1;
+    listNode *ln;
+    listIter *li     = listGetIterator(rt->ilist, AL_START_HEAD);
+    while((ln = listNext(li))) {
+        int      im = (int)(long)ln->value;
+        r_ind_t *ri = &Index[im];
+        if (ri->xop == xop && ri->xarg == xarg && ri->done &&
+            ri->icol.cmatch == (ci->cmatch - 1)) { imatch = im; break; }
+    } listReleaseIterator(li);
+    return imatch;
+}
+int find_bitmap_index(int tmatch, int cmatch) { // BITMAP indexes
+    r_tbl_t *rt = &Tbl[tmatch];
+    if (!rt->ilist || cmatch < 1) return -1;
+    int       imatch = -1;
+    listNode *ln;
+    listIter *li     = listGetIterator(rt->ilist, AL_START_HEAD);
+    while((ln = listNext(li))) {
+        int      im = (int)(long)ln->value;
+        r_ind_t *ri = &Index[im];
+        if (BMAP(ri->cnstr) && ri->done && ri->icol.cmatch == cmatch) {
+            imatch = im; break;
+        }
+    } listReleaseIterator(li);
+    return imatch;
+}
 
 int _match_index(int tmatch, list *indl, bool prtl) {
     listNode *ln; 
@@ -102,11 +136,12 @@ int _match_index(int tmatch, list *indl, bool prtl) {
     while((ln = listNext(li))) {
         int      imatch = (int)(long)ln->value;
         r_ind_t *ri     = &Index[imatch];
-        if (!prtl && !ri->done) continue;
+        if (!prtl && !ri->done && !ri->bg) continue; // BACKGROUND -> CRUD
         if (prtl) listAddNodeTail(indl, VOIDINT imatch);
         else { // \/ UNIQ can fail, must be 1st
-            if (UNIQ(ri->cnstr)) listAddNodeHead(indl, VOIDINT imatch);
-            else                 listAddNodeTail(indl, VOIDINT imatch);
+            if (UNIQ(ri->cnstr) || HASHS(ri->cnstr)) {
+                listAddNodeHead(indl, VOIDINT imatch);
+            } else listAddNodeTail(indl, VOIDINT imatch);
         }
         matches++;
     } listReleaseIterator(li);
@@ -199,6 +234,8 @@ static icol_t check_special_column(int tmatch, sds cname) {
             }
             sdsfree(cn);                                           // FREED 143
         }
+    } else if ((ic.fimatch = find_expr_index(tmatch, cname)) != -1) {
+        // ExpressionIndex Lookup -> like a LuaFunctionIndex (cmatch: -1)
     } else if (rt->fdict) { // Check: LuaFunctionIndex Lookup
         char *lprn = strchr(cname, '(');
         if (lprn && ((lprn - cname) < (uint32)(sdslen(cname) - 1)) &&
@@ -238,3 +275,10 @@ int get_all_cols(int tmatch, list *cs, bool lru2, bool lfu2) {
     if (!lru2 && rt->lrud) ret--; if (!lfu2 && rt->lfu)  ret--;
     return ret;
 }
+int insertableColCount(int tmatch) { /* INSERT CANT have LRU/LFU */
+    r_tbl_t *rt  = &Tbl[tmatch];
+    int      ret = rt->col_count;
+    if (rt->lrud) ret--;
+    if (rt->lfu)  ret--;
+    return ret;
+}
@@ -42,6 +42,8 @@ int match_index     (int tmatch, list *indl);
 int match_index_name(sds iname);
 
 int find_partial_index      (int tmatch, icol_t ic); // Used by INDEX CURSORs
+int find_expr_index         (int tmatch, sds cname); // ExpressionIndexes
+int find_bitmap_index       (int tmatch, int cmatch);// BITMAP indexes
 int match_partial_index     (int tmatch, list *indl);//RDBSAVE partial indexes 2
 int match_partial_index_name(sds iname); // Used by DROP INDEX|LUATRIGGER
 
@@ -93,6 +95,7 @@ icol_t find_column_n  (int tmatch, char *column, int len);
     }
 
 int get_all_cols(int tmatch, list *cmatchl, bool lru2, bool lfu2);
+int insertableColCount(int tmatch);
 
 #define INIT_ICOL(ic, cm) \
   bzero(&ic, sizeof(icol_t)); ic.fimatch = -1; ic.cmatch = cm;
@@ -0,0 +1,238 @@
+/*
+ * This file implements compiled WHERE clause filter programs
+ *
+
+AGPL License
+
+Copyright (c) 2011 Russell Sullivan <jaksprats AT gmail DOT com>
+ALL RIGHTS RESERVED
+
+   This file is part of ALCHEMY_DATABASE
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Affero General Public License as
+    published by the Free Software Foundation, either version 3 of the
+    License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Affero General Public License for more details.
+
+    You should have received a copy of the GNU Affero General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <assert.h>
+
+#include "redis.h"
+
+#include "row.h"
+#include "range.h"
+#include "aobj.h"
+#include "filter.h"
+#include "query.h"
+#include "common.h"
+#include "fprog.h"
+
+/* NOTE:
+    passFilts() walks the flist for every row: a getCol() per filter (the
+    same column decoded N times for N filters on it), an OP_CMP[] function
+    pointer per compare & a linked-list walk per IN().
+    compileFilters() runs ONCE at plan time & flattens the flist into an
+    array of insns: each distinct column becomes a register (fetched lazily,
+    at most once per row), constants are pre-converted to native values,
+    [NOT] IN() lists probe the filter's hash set (built by pWC_IN) and the
+    opcode is specialised on [column-type, op] so runFProg() is a single
+    switch. STRING (prefix compare), LUAO & FUNC use the generic aobj path.
+*/
+
+// GLOBALS
+extern r_tbl_t  *Tbl;
+extern char     *OP_Desc[];
+extern aobj_cmp *OP_CMP[7];
+
+static char *FT_Desc[5] = {"GEN", "INT", "LONG", "U128", "FLOAT"};
+
+// COMPILE COMPILE COMPILE COMPILE COMPILE COMPILE COMPILE COMPILE COMPILE
+static uchar getFT(uchar ctype) {
+    if      (C_IS_I(ctype)) return FT_I;
+    else if (C_IS_L(ctype)) return FT_L;
+    else if (C_IS_X(ctype)) return FT_X;
+    else if (C_IS_F(ctype)) return FT_F;
+    else                    return FT_GEN;
+}
+static void setFval(fval_t *v, aobj *a, uchar ft) {
+    bzero(v, sizeof(fval_t));
+    if      (ft == FT_I) v->i = a->i;
+    else if (ft == FT_L) v->l = a->l;
+    else if (ft == FT_X) v->x = a->x;
+    else if (ft == FT_F) v->f = a->f;
+}
+static bool sameIC(icol_t *ic1, icol_t *ic2) {
+    if (ic1->cmatch != ic2->cmatch || ic1->fimatch != ic2->fimatch ||
+        ic1->nlo    != ic2->nlo)                                 return 0;
+    for (uint32 i = 0; i < ic1->nlo; i++) {
+        if (strcmp(ic1->lo[i], ic2->lo[i]))                      return 0;
+    }
+    return 1;
+}
+static uint32 getFReg(fprog_t *fp, icol_t *ic) {
+    for (uint32 i = 0; i < fp->nreg; i++) {
+        if (sameIC(&fp->reg[i], ic)) return i;
+    }
+    fp->reg[fp->nreg] = *ic; /* NOTE: lo[] referential, flist outlives fp */
+    return fp->nreg++;
+}
+
+static void compileFilter(fprog_t *fp, finsn_t *in, f_t *flt) {
+    bzero(in, sizeof(finsn_t));
+    in->flt = flt;
+    if (flt->op == LFUNC && !flt->inl && flt->alow.type == COL_TYPE_NONE &&
+        flt->akey.type == COL_TYPE_NONE) {
+        in->opc = FOPC(FT_GEN, LFUNC); return;
+    }
+    in->reg = getFReg(fp, &flt->ic);
+    if        (flt->inl) { /* hash set lookup -> no typed opcode */
+        in->opc   = FOPC(FT_GEN, IN);
+    } else if (flt->alow.type != COL_TYPE_NONE) {
+        uchar ft  = (flt->alow.type == flt->ahigh.type) ?
+                                          getFT(flt->alow.type) : FT_GEN;
+        in->ctype = flt->alow.type;
+        in->opc   = FOPC(ft, RQ);
+        setFval(&in->k, &flt->alow,  ft);
+        setFval(&in->h, &flt->ahigh, ft);
+    } else if (flt->akey.type != COL_TYPE_NONE) {
+        uchar ft  = getFT(flt->akey.type);
+        in->ctype = flt->akey.type;
+        in->opc   = FOPC(ft, flt->op);
+        setFval(&in->k, &flt->akey,  ft);
+    } else assert(!"compileFilter ERROR");
+}
+fprog_t *compileFilters(list *flist, int tmatch) {
+    if (!flist || !listLength(flist)) return NULL;
+    listNode *ln;
+    uint32    nf  = listLength(flist);
+    fprog_t  *fp  = malloc(sizeof(fprog_t));             /* FREE ME 182 */
+    bzero(fp, sizeof(fprog_t));
+    fp->tmatch    = tmatch;
+    fp->reg       = malloc(sizeof(icol_t)  * nf);        /* FREE ME 183 */
+    fp->insn      = malloc(sizeof(finsn_t) * nf);        /* FREE ME 184 */
+    listIter *li  = listGetIterator(flist, AL_START_HEAD);
+    while((ln = listNext(li))) {
+        f_t *flt = ln->value;
+        if (flt->tmatch != tmatch) continue; /* same skip as passFilts() */
+        compileFilter(fp, &fp->insn[fp->ninsn++], flt);
+    } listReleaseIterator(li);
+    return fp;
+}
+void destroyFProg(fprog_t **fp) {
+    if (!*fp) return;
+    free((*fp)->reg);                                    /* FREED 183 */
+    free((*fp)->insn);                                   /* FREED 184 */
+    free(*fp);                                           /* FREED 182 */
+    *fp = NULL;
+}
+
+// RUN RUN RUN RUN RUN RUN RUN RUN RUN RUN RUN RUN RUN RUN RUN RUN RUN RUN
+#define FCASES(T, FLD)                                                    \
+  case FOPC(T, EQ): ret = (a->FLD == in->k.FLD);                  break;  \
+  case FOPC(T, NE): ret = (a->FLD != in->k.FLD);                  break;  \
+  case FOPC(T, GT): ret = (a->FLD >  in->k.FLD);                  break;  \
+  case FOPC(T, GE): ret = (a->FLD >= in->k.FLD);                  break;  \
+  case FOPC(T, LT): ret = (a->FLD <  in->k.FLD);                  break;  \
+  case FOPC(T, LE): ret = (a->FLD <= in->k.FLD);                  break;  \
+  case FOPC(T, RQ): ret = (a->FLD >= in->k.FLD && a->FLD <= in->h.FLD); \
+                                                                  break;
+
+static bool runGenInsn(finsn_t *in, aobj *a) {
+    f_t  *flt = in->flt;
+    uchar op  = in->opc & 0xF;
+    if      (op == IN) return passINL(flt, a);
+    else if (op == RQ) {
+        return (*OP_CMP[GE])(&flt->alow, a) && (*OP_CMP[LE])(&flt->ahigh, a);
+    } else             return (*OP_CMP[op])(&flt->akey, a);
+}
+bool runFProg(fprog_t *fp, bt *btr, aobj *apk, void *rrow, bool *hf) {
+    uint32 nr = fp->nreg ? fp->nreg : 1; /* LUA only filters -> no regs */
+    aobj   ra[nr];
+    bool   rf[nr]; bzero(rf, sizeof(bool) * nr);
+    bool   ret = 1;
+    for (uint32 j = 0; ret && j < fp->ninsn; j++) {
+        finsn_t *in = &fp->insn[j];
+        if (in->opc == FOPC(FT_GEN, LFUNC)) {
+            ret = runLuaFilter(&in->flt->le, btr, apk, rrow, fp->tmatch, hf);
+            continue;
+        }
+        aobj *a = &ra[in->reg];
+        if (!rf[in->reg]) {
+            *a = getCol(btr, rrow, fp->reg[in->reg], apk, fp->tmatch, NULL);
+            rf[in->reg] = 1;
+        }
+        if (a->type != in->ctype) { ret = runGenInsn(in, a); continue; }
+        switch (in->opc) {
+            FCASES(FT_I, i)
+            FCASES(FT_L, l)
+            FCASES(FT_X, x)
+            FCASES(FT_F, f)
+            default: ret = runGenInsn(in, a); break;
+        }
+    }
+    for (uint32 i = 0; i < fp->nreg; i++) if (rf[i]) releaseAobj(&ra[i]);
+    return ret;
+}
+
+// EXPLAIN EXPLAIN EXPLAIN EXPLAIN EXPLAIN EXPLAIN EXPLAIN EXPLAIN EXPLAIN
+static void dumpFval(printer *prn, fval_t *v, uchar ft) {
+    if      (ft == FT_I) (*prn)("%u",  v->i);
+    else if (ft == FT_L) (*prn)("%lu", v->l);
+    else if (ft == FT_F) (*prn)(FLOAT_FMT, v->f);
+    else if (ft == FT_X) {
+        char buf[64]; SPRINTF_128(buf, 64, v->x) (*prn)("%s", buf);
+    }
+}
+static void dumpGenKey(printer *prn, f_t *flt, sds s) {
+    if (s) (*prn)("'%s'", s); else dumpAobj(prn, &flt->akey);
+}
+void dumpFProg(printer *prn, fprog_t *fp) {
+    if (!fp) return;
+    (*prn)("\t\tFILTER PROGRAM: tmatch: %d nreg: %u ninsn: %u\n",
+            fp->tmatch, fp->nreg, fp->ninsn);
+    for (uint32 i = 0; i < fp->nreg; i++) {
+        int cmatch = fp->reg[i].cmatch;
+        (*prn)("\t\t\tR%u: c: %d (%s)\n", i, cmatch,
+               (cmatch < 0) ? "" : Tbl[fp->tmatch].col[cmatch].name);
+    }
+    for (uint32 j = 0; j < fp->ninsn; j++) {
+        finsn_t *in = &fp->insn[j];
+        uchar    ft = in->opc >> 4; uchar op = in->opc & 0xF;
+        if (in->opc == FOPC(FT_GEN, LFUNC)) {
+            (*prn)("\t\t\t%u: LUA %s()\n", j, in->flt->le.fname); continue;
+        }
+        (*prn)("\t\t\t%u: %s_%s R%u ", j, FT_Desc[ft],
+               (op == RQ) ? "BETWEEN" : (op != IN) ? OP_Desc[op] :
+                in->flt->nin ? "NOT_IN" : "IN",
+               in->reg);
+        if (op == IN) {
+            ins_t *ins = in->flt->ins;
+            if (ins) (*prn)("[HASH nvals: %u nslots: %u]",
+                            ins->nvals, ins->mask + 1);
+            else     (*prn)("[LIST len: %d]", listLength(in->flt->inl));
+        } else if (op == RQ) {
+            if (ft) {
+                dumpFval(prn, &in->k, ft); (*prn)(" AND ");
+                dumpFval(prn, &in->h, ft);
+            } else {
+                (*prn)("'%s' AND '%s'", in->flt->low, in->flt->high);
+            }
+        } else {
+            if (ft) dumpFval(prn, &in->k, ft);
+            else    dumpGenKey(prn, in->flt, in->flt->key);
+        }
+        (*prn)("\n");
+    }
+}
@@ -0,0 +1,75 @@
+/*
+ * This file implements compiled WHERE clause filter programs
+ *
+
+AGPL License
+
+Copyright (c) 2011 Russell Sullivan <jaksprats AT gmail DOT com>
+ALL RIGHTS RESERVED
+
+   This file is part of ALCHEMY_DATABASE
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Affero General Public License as
+    published by the Free Software Foundation, either version 3 of the
+    License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Affero General Public License for more details.
+
+    You should have received a copy of the GNU Affero General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __ALCHEMY_FPROG__H
+#define __ALCHEMY_FPROG__H
+
+#include "adlist.h"
+#include "redis.h"
+
+#include "btreepriv.h"
+#include "query.h"
+#include "xdb_common.h"
+#include "common.h"
+
+/* OPCODE: (FT_TYPE << 4) | enum OP -> one switch case per [type,op] */
+#define FT_GEN  0 /* aobj compare via OP_CMP[] (STRING, LUAO, FUNC)   */
+#define FT_I    1
+#define FT_L    2
+#define FT_X    3
+#define FT_F    4
+#define FOPC(t, op) (((t) << 4) | (op))
+
+typedef union filter_val {
+    uint32   i;
+    ulong    l;
+    uint128  x;
+    float    f;
+} fval_t;
+
+typedef struct filter_insn {
+    uchar    opc;    /* FOPC(type, op)                                  */
+    uchar    ctype;  /* COL_TYPE_* the opcode was specialised for       */
+    uint32   reg;    /* column register the insn tests                  */
+    fval_t   k;      /* pre-converted KEY (or LOW of BETWEEN)           */
+    fval_t   h;      /* pre-converted HIGH of BETWEEN                   */
+    f_t     *flt;    /* source filter (generic ops, LUA, EXPLAIN)       */
+} finsn_t;
+
+typedef struct filter_prog {
+    int      tmatch;
+    uint32   nreg;   /* distinct columns fetched (once) per row         */
+    icol_t  *reg;
+    uint32   ninsn;
+    finsn_t *insn;
+} fprog_t;
+
+fprog_t *compileFilters(list *flist, int tmatch);
+void     destroyFProg  (fprog_t **fp);
+bool     runFProg      (fprog_t *fp,  bt *btr, aobj *apk, void *rrow,
+                        bool    *hf);
+void     dumpFProg     (printer *prn, fprog_t *fp);
+
+#endif /* __ALCHEMY_FPROG__H */
@@ -392,3 +392,116 @@ uint32 alc_hash16_fetch(ushort16 key, ahash16 *ht) {
     }
     return 0;
 }
+
+// INCREMENTAL_HASH INCREMENTAL_HASH INCREMENTAL_HASH INCREMENTAL_HASH
+__inline__ static ulong ihash_mix(ulong k) { /* murmur3 fmix64 */
+    k ^= k >> 33; k *= 0xff51afd7ed558ccdUL;
+    k ^= k >> 33; k *= 0xc4ceb9fe1a85ec53UL;
+    k ^= k >> 33;
+    return k;
+}
+static bool iht_init(iht_t *t, uint32 nentries) {
+    uint32 n = 8; while (n < nentries) n <<= 1;
+    size_t size = n * sizeof(ihash_entry);
+    t->entries  = (ihash_entry *)malloc(size); if (!t->entries) return 0;
+    bzero(t->entries, size);
+    t->nentries = n; t->nused = 0;
+    return 1;
+}
+static ihash_entry *iht_find(iht_t *t, ulong key) {
+    uint32 mask = t->nentries - 1, i = ihash_mix(key) & mask;
+    while (1) {
+        ihash_entry *e = t->entries + i;
+        if (e->st == IHASH_EMPTY)                        return NULL;
+        if (e->st == IHASH_FULL && e->key == key)        return e;
+        i = (i + 1) & mask;
+    }
+}
+static void iht_add(iht_t *t, ulong key, ulong val) { /* key NOT in t */
+    uint32 mask = t->nentries - 1, i = ihash_mix(key) & mask;
+    while (t->entries[i].st == IHASH_FULL) i = (i + 1) & mask;
+    ihash_entry *e = t->entries + i;
+    if (e->st == IHASH_EMPTY) t->nused++; /* reusing DEAD: same nused */
+    e->st = IHASH_FULL; e->key = key; e->val = val;
+}
+
+ihash *alc_ihash_make(uint32 nentries) {
+    ihash *ht = (ihash *)malloc(sizeof(ihash)); if (!ht) return NULL;
+    bzero(ht, sizeof(ihash));
+    if (!iht_init(&ht->t[0], nentries)) { free(ht); return NULL; }
+    ht->ridx  = -1;
+    return ht;
+}
+void alc_ihash_destroy(ihash *ht) {
+    if (!ht) return;
+    if (ht->t[0].entries) free(ht->t[0].entries);
+    if (ht->t[1].entries) free(ht->t[1].entries);
+    free(ht);
+}
+ulong alc_ihash_size(ihash *ht) {
+    return sizeof(ihash) +
+           ((ulong)ht->t[0].nentries + ht->t[1].nentries) * sizeof(ihash_entry);
+}
+
+static void ihash_step(ihash *ht, uint32 nsteps) { /* move t[0] -> t[1] */
+    iht_t *t0 = &ht->t[0];
+    for (; nsteps && ht->ridx < (long)t0->nentries; nsteps--, ht->ridx++) {
+        ihash_entry *e = t0->entries + ht->ridx;
+        if (e->st == IHASH_FULL) {
+            iht_add(&ht->t[1], e->key, e->val); e->st = IHASH_DEAD;
+        }
+    }
+    if (ht->ridx == (long)t0->nentries) { /* DONE: t[1] becomes t[0] */
+        free(t0->entries);
+        ht->t[0] = ht->t[1]; bzero(&ht->t[1], sizeof(iht_t));
+        ht->ridx = -1;
+    }
+}
+#define DEBUG_IREHASH                                       \
+  printf("ihash rehash: nvalid: %u from: %u to: %u\n",      \
+          ht->nvalid, ht->t[0].nentries, ht->t[1].nentries);
+
+static int ihash_grow(ihash *ht) { /* sized by nvalid (DEADs are dropped) */
+    if (!iht_init(&ht->t[1], MAX(8, ht->nvalid * 4))) return ERR_OOM;
+    ht->ridx = 0;                                           //DEBUG_IREHASH
+    return 0;
+}
+
+int alc_ihash_insert(ulong key, ulong val, ihash *ht) {
+    if (ht->ridx != -1) {
+        ihash_step(ht, IHASH_STEP);
+        if (ht->ridx != -1 && (ht->t[1].nused + 1) * 2 > ht->t[1].nentries) {
+            ihash_step(ht, ht->t[0].nentries);             /* t[1] too full */
+        }
+    }
+    ihash_entry *e = iht_find(&ht->t[0], key);
+    if (!e && ht->ridx != -1) e = iht_find(&ht->t[1], key);
+    if (e) { e->val = val;                                 return 0; }
+    if (ht->ridx == -1 && (ht->t[0].nused + 1) * 2 > ht->t[0].nentries) {
+        if (ihash_grow(ht))                                return ERR_OOM;
+    }
+    iht_add((ht->ridx == -1) ? &ht->t[0] : &ht->t[1], key, val);
+    ht->nvalid++;
+    return 0;
+}
+bool alc_ihash_delete(ulong key, ihash *ht) {
+    if (ht->ridx != -1) ihash_step(ht, IHASH_STEP);
+    ihash_entry *e = iht_find(&ht->t[0], key);
+    if (!e && ht->ridx != -1) e = iht_find(&ht->t[1], key);
+    if (!e)                                                return 0;
+    e->st = IHASH_DEAD; ht->nvalid--;
+    return 1;
+}
+bool alc_ihash_fetch(ulong key, ulong *val, ihash *ht) {
+    ihash_entry *e = iht_find(&ht->t[0], key);
+    if (!e && ht->ridx != -1) e = iht_find(&ht->t[1], key);
+    if (!e)                                                return 0;
+    *val = e->val;
+    return 1;
+}
+/* TEXT keys are their FNV-1a 64-bit hash: callers MUST verify a hit */
+ulong alc_ihash_str(char *s, uint32 len) {
+    ulong h = 14695981039346656037UL;
+    for (uint32 i = 0; i < len; i++) { h ^= (uchar)s[i]; h *= 1099511628211UL; }
+    return h;
+}
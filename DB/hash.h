@@ -55,4 +55,39 @@ int      alc_hash16_insert(ushort16 key, uint32 val, ahash16 *ht);
 void     alc_hash16_delete(ushort16 key,             ahash16 *ht);
 uint32   alc_hash16_fetch (ushort16 key,             ahash16 *ht);
 
+
+// NOTE: ihash is open-addressing (linear probing) [ulong -> ulong] w/ an
+//       INCREMENTAL rehash: growing allocates t[1] & every subsequent
+//       insert/delete moves IHASH_STEP slots from t[0] -> no O(N) pauses
+#define IHASH_EMPTY 0
+#define IHASH_FULL  1
+#define IHASH_DEAD  2 /* deleted: keeps the probe chain intact */
+#define IHASH_STEP  64
+
+typedef struct ihash_entry { // 17 BYTES
+    uchar st;
+    ulong key;
+    ulong val;
+} __attribute__ ((packed)) ihash_entry;
+
+typedef struct ihash_table {
+    ihash_entry *entries;
+    uint32       nentries;  /* power of 2 */
+    uint32       nused;     /* FULL + DEAD -> load factor */
+} iht_t;
+
+typedef struct ihash {
+    iht_t  t[2];            /* t[1] only in use during a rehash */
+    long   ridx;            /* rehash cursor into t[0] (-1: not rehashing) */
+    uint32 nvalid;
+} ihash;
+
+ihash *alc_ihash_make   (uint32 nentries);
+void   alc_ihash_destroy(ihash *ht);
+ulong  alc_ihash_size   (ihash *ht);
+int    alc_ihash_insert (ulong key, ulong val,  ihash *ht);
+bool   alc_ihash_delete (ulong key,             ihash *ht);
+bool   alc_ihash_fetch  (ulong key, ulong *val, ihash *ht);
+ulong  alc_ihash_str    (char *s,  uint32 len); /* TEXT -> ihash key */
+
 #endif // ALC_HASH
@@ -47,9 +47,14 @@ ALL RIGHTS RESERVED
 #include "orderby.h"
 #include "luatrigger.h"
 #include "colparse.h"
+#include "plan_cache.h"
+#include "bitmap.h"
+#include "hash.h"
 #include "stream.h"
 #include "find.h"
 #include "alsosql.h"
+#include "filter.h"
+#include "wc.h"
 #include "aobj.h"
 #include "common.h"
 #include "index.h"
@@ -63,6 +68,9 @@ extern r_tbl_t  *Tbl;
 extern uint32    Ind_HW; extern dict *IndD; extern list *DropI;
 extern char     *Col_type_defs[];
 extern dictType  sdsDictType;
+extern char      PLUS;   extern char MINUS;
+extern char      MULT;   extern char DIVIDE;
+extern char      MODULO;
 
 // GLOBALS
 int      Num_indx;
@@ -94,8 +102,11 @@ static dp_t init_dp(bt *ibtr, aobj *acol, bt *nbtr) {
   printf("iAdd: acol: "); dumpAobj(printf, acol); \
   printf("iAdd: apk:  "); dumpAobj(printf, apk);
 
-static lxk LX_iAdd; static xlk XL_iAdd; static uxk UX_iAdd; static xuk XU_iAdd;
-static xxk XX_iAdd; static ulk UL_iAdd; static luk LU_iAdd; static llk LL_iAdd;
+/* NOTE: __thread -> RDB load builds indexes on threads (rdb_pload.c) */
+static __thread lxk LX_iAdd; static __thread xlk XL_iAdd;
+static __thread uxk UX_iAdd; static __thread xuk XU_iAdd;
+static __thread xxk XX_iAdd; static __thread ulk UL_iAdd;
+static __thread luk LU_iAdd; static __thread llk LL_iAdd;
 #define OBT_IADD_UNIQ(sptr, aobjpart) \
   { sptr.val = apk->aobjpart; btAdd(ibtr, acol, &sptr); }
 
@@ -117,9 +128,16 @@ void iAddUniq(bt *ibtr, uchar pktyp, aobj *apk, aobj *acol) { // OBYI uses also
 static bool iAdd(cli  *c,   bt    *ibtr,  aobj *acol,
                  aobj *apk, uchar  pktyp, aobj *ocol, int imatch) {//DEBUG_IADD
     r_ind_t *ri   = &Index[imatch];
+    if (HASHS(ri->cnstr) && btIndFind(ibtr, acol)) { // TEXT HASH: UNIQUE
+        if (c) { addReply(c, shared.uviol); }                    return 0;
+    }
     if (UNIQ(ri->cnstr)) { // SINGLE COLUMN UNIQUE INDEX
-        if (btFind(ibtr, acol)) { if (c) addReply(c, shared.uviol); return 0; }
+        ulong pk;
+        bool  hit = ri->hsh ? alc_ihash_fetch(HASH_IVAL(acol), &pk, ri->hsh) :
+                              (btFind(ibtr, acol) != NULL);
+        if (hit) { if (c) addReply(c, shared.uviol); return 0; }
         iAddUniq(ibtr, pktyp, apk, acol);
+        if (ri->hsh) alc_ihash_insert(HASH_IVAL(acol), HASH_IVAL(apk), ri->hsh);
     } else {               // SINGLE COLUMN NORMAL INDEX
         bt *nbtr = btIndFind(ibtr, acol);
         if (!nbtr) {
@@ -131,9 +149,26 @@ static bool iAdd(cli  *c,   bt    *ibtr,  aobj *acol,
         ulong size1  = nbtr->msize;
         if (!btIndNodeAdd(c, nbtr, apk, ocol)) return 0;
         ibtr->msize += (nbtr->msize - size1); // ibtr inherits nbtr
+        if HASHS(ri->cnstr) { /* slot taken -> collision: lookups use ibtr */
+            ulong pk, hk = HASH_KEY(acol);
+            if (alc_ihash_fetch(hk, &pk, ri->hsh)) ri->hcoll++;
+            else alc_ihash_insert(hk, HASH_IVAL(apk), ri->hsh);
+        }
     }
     return 1;
 }
+static void iAddCover(bt   *ibtr,  aobj *acol, aobj *apk, uchar pktyp,
+                      aobj *icv,   int   imatch) {
+    bt *nbtr = btIndFind(ibtr, acol);
+    if (!nbtr) {
+        nbtr         = createCoverNode(pktyp, icv->type, imatch);
+        btIndAdd(ibtr, acol, nbtr);
+        ibtr->msize += nbtr->msize;           // ibtr inherits nbtr
+    }
+    ulong size1  = nbtr->msize;
+    iAddUniq(nbtr, icv->type, icv, apk);      // [PK -> INCLUDE]
+    ibtr->msize += (nbtr->msize - size1);     // ibtr inherits nbtr
+}
 static void destroy_index(bt *ibtr, bt_n *n, int imatch) {
     r_ind_t *ri = &Index[imatch];
     if (ri->clist)       { destroy_mci(ibtr, ibtr->root, imatch, 0); return; }
@@ -151,8 +186,10 @@ static void destroy_index(bt *ibtr, bt_n *n, int imatch) {
 static void iRem(bt   *ibtr, aobj *acol, aobj *apk, aobj *ocol, int imatch,
                  bool  gost) {
     r_ind_t *ri   = &Index[imatch];
-    if (UNIQ(ri->cnstr)) btDelete(ibtr, acol);
-    else {
+    if (UNIQ(ri->cnstr)) {
+        btDelete(ibtr, acol);
+        if (ri->hsh) alc_ihash_delete(HASH_IVAL(acol), ri->hsh);
+    } else {
         bt  *nbtr    = btIndFind(ibtr, acol);
         ulong  size1 = nbtr->msize;
         int  nkeys   = btIndNodeDelete(nbtr, apk, ocol);
@@ -162,12 +199,18 @@ static void iRem(bt   *ibtr, aobj *acol, aobj *apk, aobj *ocol, int imatch,
             else      btIndDelete(ibtr, acol);
             ibtr->msize -= nbtr->msize; bt_destroy(nbtr);
         }
+        if HASHS(ri->cnstr) { /* only the slot's owner leaves the ihash */
+            ulong pk, hk = HASH_KEY(acol);
+            if (alc_ihash_fetch(hk, &pk, ri->hsh) && pk == HASH_IVAL(apk)) {
+                alc_ihash_delete(hk, ri->hsh);
+            }
+        }
     }
 }
 //TODO test iEvict w/ SIMP_UNIQ()
 //TODO refactor iEvict() into iRem()
 static void iEvict(bt *ibtr, aobj *acol, aobj *apk, aobj *ocol) {
-    printf("iEvict apk: "); dumpAobj(printf, apk);
+    //printf("iEvict apk: "); dumpAobj(printf, apk);
     bt  *nbtr    = btIndFind     (ibtr, acol);
     ulong  size1 = nbtr->msize;
     int  nkeys   = btIndNodeEvict(nbtr, apk, ocol);
@@ -306,7 +349,7 @@ static void iRemMCI(bt   *btr, aobj *apk, int imatch, void *rrow, aobj *ocol,
 }
 //TODO refactor iEvictMCI() into iRemMCI
 static void iEvictMCI(bt *btr, aobj *apk, int imatch, void *rrow, aobj *ocol) {
-    printf("iEvictMCI\n");
+    //printf("iEvictMCI\n");
     bt      *nbtr  = NULL; // compiler warning
     r_ind_t *ri    = &Index[imatch];
     dp_t     dpl[ri->nclist];
@@ -338,15 +381,187 @@ static void iEvictMCI(bt *btr, aobj *apk, int imatch, void *rrow, aobj *ocol) {
         { i--; nbtr = ibtr; } /* go one step HIGHER in dpl[] - trickle-up */
     }
 }
+/* BACKGROUND build: PKs past ri->bgpk have not been scanned yet, the scan
+                    will index them -> CRUD must only maintain [MIN, bgpk] */
+#define BG_UNSCANNED(ri, apk) \
+  ((ri)->bg && ((ri)->bgpk.empty || aobjKeyCmp(apk, &(ri)->bgpk) > 0))
+
+/* PARTIAL_INDEX & EXPRESSION_INDEX */
+/* NOTE: "CREATE INDEX i ON t (col) WHERE pred" indexes ONLY the rows passing
+         pred (KEY & BETWEEN predicates on t's columns, ANDed), the planner
+         picks it for queries whose WHERE clause contains pred verbatim.
+         "(col%10)" & "(LEFT(col,3))" index an expression evaluated in C per
+         CRUD [+,-,*,/,% on INT|LONG (unsigned wrap), LEFT() on TEXT], queries
+         name the expression in the WHERE clause (e.g. "col%10 = 3") */
+static bool getExprArg(char *s, int len, ulong *arg) {
+    while (len && ISBLANK(*s))         { s++; len--; }
+    while (len && ISBLANK(s[len - 1]))   len--;
+    if (!len || len > 18) return 0; /* 18 digits can not overflow a ulong */
+    ulong n = 0;
+    for (int i = 0; i < len; i++) {
+        if (!ISDIGIT(s[i])) return 0;
+        n = (n * 10) + (s[i] - '0');
+    }
+    *arg = n; return 1;
+}
+/* SYNTAX: "col OP NUM" (OP: [+,-,*,/,%]) OR "LEFT(col,NUM)" */
+bool parseIndexExpr(char *s, int len, sds *cname, uchar *xop, ulong *xarg) {
+    char *cn, *arg; int clen, alen;
+    if (len > 6 && !strncasecmp(s, "LEFT(", 5) && s[len - 1] == ')') {
+        cn = s + 5; clen = 0;
+        while (clen < (len - 6) && cn[clen] != ',') clen++;
+        if (cn[clen] != ',')       return 0;
+        arg  = cn + clen + 1; alen = (s + len - 1) - arg;
+        *xop = IXPR_LEFT;
+    } else {
+        clen = 0;
+        while (clen < len && s[clen] && !strchr("+-*/%", s[clen])) clen++;
+        if (clen == len || !s[clen]) return 0;
+        cn   = s; arg = s + clen + 1; alen = len - clen - 1;
+        *xop = (uchar)s[clen];
+    }
+    if (!getExprArg(arg, alen, xarg)) return 0;
+    while (clen && ISBLANK(*cn))          { cn++; clen--; }
+    while (clen && ISBLANK(cn[clen - 1]))   clen--;
+    if (!clen)                        return 0;
+    *cname = sdsnewlen(cn, clen);                        // FREE 213
+    return 1;
+}
+sds catIndexExpr(sds s, r_ind_t *ri) {
+    sds cname = Tbl[ri->tmatch].col[ri->icol.cmatch].name;
+    if (ri->xop == IXPR_LEFT) return sdscatprintf(s, "LEFT(%s,%lu)",
+                                                  cname, ri->xarg);
+    else                      return sdscatprintf(s, "%s%c%lu",
+                                                  cname, ri->xop, ri->xarg);
+}
+void applyIndexExpr(r_ind_t *ri, aobj *a) {
+    if (!ri->xop || a->empty) return;
+    if (ri->xop == IXPR_LEFT) {
+        if (a->len > ri->xarg) a->len = (uint32)ri->xarg;
+        return;
+    }
+    char  x = (char)ri->xop;
+    ulong n = ri->xarg;
+    ulong v = C_IS_I(a->type) ? (ulong)a->i : a->l;
+    if      (x == PLUS)   v += n;
+    else if (x == MINUS)  v -= n;
+    else if (x == MULT)   v *= n;
+    else if (x == DIVIDE) v /= n;
+    else if (x == MODULO) v %= n;
+    if C_IS_I(a->type) a->i = (uint32)v;
+    else               a->l = v;
+}
+/* RETURNS: pwc's filters (NULL & replies on error, c is NULL on rdbLoad) */
+list *parseIndexWC(cli *c, int tmatch, sds pwc) {
+    cswc_t w; wob_t wb; list *pflist = NULL;
+    init_check_sql_where_clause(&w, tmatch, pwc); init_wob(&wb);
+    uchar prs = parseWC(c, &w, &wb, NULL, NULL);
+    if (prs == PRS_NEST_ERR)                                  goto piwc_end;
+    bool  ok  = (prs == PRS_OK && w.flist && !w.lvr && !wb.nob &&
+                 !wb.ngby && wb.lim == -1 && wb.ofst == -1);
+    if (ok) {
+        listNode *ln;
+        listIter *li = listGetIterator(w.flist, AL_START_HEAD);
+        while((ln = listNext(li))) {
+            f_t *flt = ln->value;
+            if (flt->op == LFUNC   || flt->op == IN     || flt->op == NONE ||
+                flt->inl           || flt->nin          ||
+                flt->ic.cmatch < 0 || flt->ic.nlo       ||
+                flt->ic.fimatch != -1) { ok = 0; break; }
+        } listReleaseIterator(li);
+    }
+    if (!ok) { if (c) addReply(c, shared.indexwcerr);       goto piwc_end; }
+    convertFilterListToAobj(w.flist);
+    pflist  = w.flist; w.flist = NULL;                   // FREE 212
+
+piwc_end:
+    destroy_check_sql_where_clause(&w); destroy_wob(&wb);
+    return pflist;
+}
+/* RETURNS: UPDATE changes a column pwc reads -> row may enter|leave index */
+bool indexWCColHit(r_ind_t *ri, icol_t chit[]) {
+    if (!ri->pflist) return 0;
+    listNode *ln; bool hit = 0;
+    listIter *li = listGetIterator(ri->pflist, AL_START_HEAD);
+    while((ln = listNext(li))) {
+        f_t *flt = ln->value;
+        if (chit[flt->ic.cmatch].cmatch != -1) { hit = 1; break; }
+    } listReleaseIterator(li);
+    return hit;
+}
+static bool passIndexWC(r_ind_t *ri, bt *btr, aobj *apk, void *rrow) {
+    bool hf = 0;
+    return passFilts(btr, apk, rrow, ri->pflist, ri->tmatch, &hf);
+}
+static bool sameIndexWC(f_t *p, f_t *flt) {
+    if (p->ic.cmatch != flt->ic.cmatch || p->op     != flt->op  ||
+        flt->ic.nlo  || flt->inl       || flt->nin)         return 0;
+    if (p->key) return flt->key && !sdscmp(p->key, flt->key);
+    return flt->low && !sdscmp(p->low,  flt->low) &&
+                       !sdscmp(p->high, flt->high);
+}
+static bool flistHasIndexWC(list *flist, r_ind_t *ri) {
+    listNode *pln, *ln; bool all = 1;
+    listIter *pli = listGetIterator(ri->pflist, AL_START_HEAD);
+    while((pln = listNext(pli))) {
+        bool      hit = 0;
+        listIter *li  = listGetIterator(flist, AL_START_HEAD);
+        while((ln = listNext(li))) {
+            if (sameIndexWC(pln->value, ln->value)) { hit = 1; break; }
+        } listReleaseIterator(li);
+        if (!hit) { all = 0; break; }
+    } listReleaseIterator(pli);
+    return all;
+}
+/* WHERE contains a PARTIAL index's pred verbatim -> filter uses the index */
+void usePartialIndexes(list *flist) {
+    if (!flist) return;
+    listNode *ln;
+    listIter *li = listGetIterator(flist, AL_START_HEAD);
+    while((ln = listNext(li))) {
+        f_t *flt = ln->value;
+        if (flt->ic.cmatch < 0 || flt->ic.nlo || flt->nin ||
+            (flt->op != EQ && flt->op != RQ && flt->op != IN))   continue;
+        r_tbl_t  *rt  = &Tbl[flt->tmatch];
+        if (!rt->ilist)                                          continue;
+        listNode *iln;
+        listIter *ili = listGetIterator(rt->ilist, AL_START_HEAD);
+        while((iln = listNext(ili))) {
+            int      imatch = (int)(long)iln->value;
+            r_ind_t *ri     = &Index[imatch];
+            if (!ri->pflist || !ri->done ||
+                ri->icol.cmatch != flt->ic.cmatch)               continue;
+            if (flistHasIndexWC(flist, ri)) { flt->imatch = imatch; break; }
+        } listReleaseIterator(ili);
+    } listReleaseIterator(li);
+}
+bool hasPartialIndex(int tmatch, int cmatch) {
+    r_tbl_t *rt = &Tbl[tmatch];
+    if (!rt->ilist || cmatch < 0) return 0;
+    listNode *ln; bool hit = 0;
+    listIter *li = listGetIterator(rt->ilist, AL_START_HEAD);
+    while((ln = listNext(li))) {
+        r_ind_t *ri = &Index[(int)(long)ln->value];
+        if (ri->pflist && ri->icol.cmatch == cmatch) { hit = 1; break; }
+    } listReleaseIterator(li);
+    return hit;
+}
+
+static bool _addToIndex(cli *c, bt *btr, aobj *apk, void *rrow, int imatch);
 static bool iAddStream(cli *c, bt *btr, uchar *stream, int imatch) {
     aobj apk;    convertStream2Key(stream, &apk, btr);
     void *rrow = parseStream(stream, btr);
-    bool  ret  = addToIndex(c, btr, &apk, rrow, imatch); releaseAobj(&apk);
+    bool  ret  = _addToIndex(c, btr, &apk, rrow, imatch); releaseAobj(&apk);
     return ret;
 }
 bool addToIndex(cli *c, bt *btr, aobj *apk, void *rrow, int imatch) {
+    if (BG_UNSCANNED(&Index[imatch], apk)) return 1;
+    return _addToIndex(c, btr, apk, rrow, imatch);
+}
+static bool _addToIndex(cli *c, bt *btr, aobj *apk, void *rrow, int imatch) {
     r_ind_t *ri    = &Index[imatch];
     if (ri->virt || ri->fname)                                       return 1;
+    if (ri->pflist && !passIndexWC(ri, btr, apk, rrow))              return 1;
     bt      *ibtr  = getIBtr(imatch);
     if (ri->hlt) { luatAdd(btr, ri->luat, apk, imatch, rrow);        return 1; }
     int      pktyp = Tbl[ri->tmatch].col[0].type;
@@ -358,10 +573,22 @@ bool addToIndex(cli *c, bt *btr, aobj *apk, void *rrow, int imatch) {
             if (!iAddMCI(c, btr, apk, pktyp, imatch, rrow, &ocol))   return 0;
             releaseAobj(&ocol);
         }
+    } else if BMAP(ri->cnstr) {
+        aobj acol = getCol(btr, rrow, ri->icol, apk, ri->tmatch, NULL);
+        if (!acol.empty) bitmapIndexAdd(ri, &acol, apk);
+        releaseAobj(&acol);
     } else {
         aobj acol = getCol(btr, rrow, ri->icol, apk, ri->tmatch, NULL);
+        applyIndexExpr(ri, &acol);
         if (!acol.empty) {
-            if (ri->obc.cmatch == -1) { // NORMAL
+            if (ri->icov.cmatch != -1) { // COVERING
+                aobj icv = getCol(btr, rrow, ri->icov, apk, ri->tmatch, NULL);
+                if (icv.empty) { /* NOT storable -> SELECTs use the rows */
+                    ri->cvmiss = 1; initAobj(&icv);
+                    icv.type   = Tbl[ri->tmatch].col[ri->icov.cmatch].type;
+                }
+                iAddCover(ibtr, &acol, apk, pktyp, &icv, imatch);
+            } else if (ri->obc.cmatch == -1) { // NORMAL
                 if (ri->lfu) acol.l = (ulong)(floor(log2((dbl)acol.l))) + 1;
                 if (!iAdd(c, ibtr, &acol, apk, pktyp, NULL, imatch)) return 0;
             } else {             // OBY
@@ -377,6 +604,8 @@ bool addToIndex(cli *c, bt *btr, aobj *apk, void *rrow, int imatch) {
 void delFromIndex(bt *btr, aobj *apk, void *rrow, int imatch, bool gost) {
     r_ind_t *ri   = &Index[imatch];
     if (ri->virt || ri->fname)                                        return;
+    if (BG_UNSCANNED(ri, apk))                                        return;
+    if (ri->pflist && !passIndexWC(ri, btr, apk, rrow))               return;
     bt      *ibtr = getIBtr(imatch);
     if (ri->hlt) { luatDel(btr, ri->luat, apk, imatch, rrow);         return; }
     if (ri->clist) {
@@ -385,8 +614,13 @@ void delFromIndex(bt *btr, aobj *apk, void *rrow, int imatch, bool gost) {
             aobj ocol = getCol(btr, rrow, ri->obc, apk, ri->tmatch, NULL);
             iRemMCI(btr, apk, imatch, rrow, &ocol, gost); releaseAobj(&ocol);
         }
+    } else if BMAP(ri->cnstr) {
+        aobj acol = getCol(btr, rrow, ri->icol, apk, ri->tmatch, NULL);
+        if (!acol.empty) bitmapIndexDel(ri, &acol, apk);
+        releaseAobj(&acol);
     } else {
         aobj acol = getCol(btr, rrow, ri->icol, apk, ri->tmatch, NULL);
+        applyIndexExpr(ri, &acol);
         if (!acol.empty) {
             if (ri->obc.cmatch == -1) { // NORMAL
                 if (ri->lfu) acol.l = (ulong)(floor(log2((dbl)acol.l))) + 1;
@@ -399,10 +633,12 @@ void delFromIndex(bt *btr, aobj *apk, void *rrow, int imatch, bool gost) {
     }
 }
 void evictFromIndex(bt *btr, aobj *apk, void *rrow, int imatch) {
-    printf("Evict: imatch: %d apk: ", imatch); dumpAobj(printf, apk);
+    //printf("Evict: imatch: %d apk: ", imatch); dumpAobj(printf, apk);
     r_ind_t *ri   = &Index[imatch];
-    if (ri->virt || ri->fname)                                       return;
+    if (ri->virt || ri->fname || BG_UNSCANNED(ri, apk))              return;
+    if (ri->pflist && !passIndexWC(ri, btr, apk, rrow))              return;
     if (ri->hlt) { printf("TODO: EVICT call its own LuatTrigger\n"); return; }
+    if (BMAP(ri->cnstr) || HASHI(ri->cnstr)) return; /* PK stays -> MISS */
     bt      *ibtr = getIBtr(imatch);
     if (ri->clist) { // MCI
         if (ri->obc.cmatch == -1) iEvictMCI(btr, apk, imatch, rrow, NULL);//NORM
@@ -412,6 +648,7 @@ void evictFromIndex(bt *btr, aobj *apk, void *rrow, int imatch) {
         }
     } else {
         aobj acol = getCol(btr, rrow, ri->icol, apk, ri->tmatch, NULL);
+        applyIndexExpr(ri, &acol);
         if (!acol.empty) {
             if (ri->obc.cmatch == -1) { // NORMAL
                 if (ri->lfu) acol.l = (ulong)(floor(log2((dbl)acol.l))) + 1;
@@ -423,6 +660,42 @@ void evictFromIndex(bt *btr, aobj *apk, void *rrow, int imatch) {
         } releaseAobj(&acol);
     }
 }
+/* FAULT-IN (rowstore.c) undoes evictFromIndex(): a NULLed INODE (TOTAL
+   EVICTION) is re-populated & the PK leaves the INODE's evicted count */
+static void iUnevict(bt   *ibtr, aobj *acol, aobj *apk, uchar pktyp,
+                     aobj *ocol) {
+    bt *nbtr = btIndFind(ibtr, acol);
+    if (!nbtr) {
+        uchar otype  = ocol ? ocol->type : COL_TYPE_NONE;
+        nbtr         = createIndexNode(pktyp, otype);
+        if (btIndExist(ibtr, acol)) btReplace(ibtr, acol, nbtr); // NULLed
+        else                        btIndAdd (ibtr, acol, nbtr);
+        ibtr->msize += nbtr->msize;           // ibtr inherits nbtr
+    }
+    ulong size1  = nbtr->msize;
+    btIndNodeUnevict(nbtr, apk, ocol);
+    ibtr->msize += (nbtr->msize - size1);     // ibtr inherits nbtr
+}
+//NOTE: MCI, UNIQUE & COVERING indexes can NOT be un-evicted (rsFaultable())
+void unevictToIndex(bt *btr, aobj *apk, void *rrow, int imatch) {
+    r_ind_t *ri    = &Index[imatch];
+    if (ri->virt || ri->fname || BG_UNSCANNED(ri, apk))              return;
+    if (ri->pflist && !passIndexWC(ri, btr, apk, rrow))              return;
+    if (ri->hlt || BMAP(ri->cnstr) || HASHI(ri->cnstr))              return;
+    bt      *ibtr  = getIBtr(imatch);
+    uchar    pktyp = Tbl[ri->tmatch].col[0].type;
+    aobj     acol  = getCol(btr, rrow, ri->icol, apk, ri->tmatch, NULL);
+    applyIndexExpr(ri, &acol);
+    if (!acol.empty) {
+        if (ri->obc.cmatch == -1) { // NORMAL
+            if (ri->lfu) acol.l = (ulong)(floor(log2((dbl)acol.l))) + 1;
+            iUnevict(ibtr, &acol, apk, pktyp, NULL);
+        } else {                    // OBY
+            aobj ocol = getCol(btr, rrow, ri->obc, apk, ri->tmatch, NULL);
+            iUnevict(ibtr, &acol, apk, pktyp, &ocol); releaseAobj(&ocol);
+        }
+    } releaseAobj(&acol);
+}
 //NOTE: upIndex() called from LRU/LFU
 bool upIndex(cli *c, bt *ibtr, aobj *aopk,  aobj *ocol,
                                aobj *anpk,  aobj *ncol,  int pktyp,
@@ -474,6 +747,97 @@ static long buildNewIndex(cli *c, int  tmatch, int imatch, long limit) {
     long  card = buildIndex(c, btr, imatch, limit);
     return card;
 }
+
+/* BACKGROUND_INDEX_BUILD BACKGROUND_INDEX_BUILD BACKGROUND_INDEX_BUILD */
+/* NOTE: "CREATE INDEX ... BACKGROUND" indexes the table in PK order, a time
+         bounded slice per indexBuildTimeProc() tick, ri->bgpk is the cursor.
+         CRUD maintains the already scanned PKs (see BG_UNSCANNED), the planner
+         ignores the index (!ri->done) until the scan reaches the end */
+static int IndexBuilds = 0; /* number of BACKGROUND builds in progress */
+
+#define INDEX_BUILD_CHECK_ROWS 256 /* rows between deadline checks */
+
+static void setBuildCursor(r_ind_t *ri, aobj *apk) {
+    releaseAobj(&ri->bgpk);                                  // FREED 210
+    memcpy(&ri->bgpk, apk, sizeof(aobj)); ri->bgpk.ic = NULL;
+    if (C_IS_S(apk->type)) { /* apk points into the row's stream -> copy */
+        ri->bgpk.s      = malloc(apk->len);                  // FREE ME 210
+        memcpy(ri->bgpk.s, apk->s, apk->len); ri->bgpk.freeme = 1;
+    }
+}
+static void finishBackgroundBuild(int imatch) {
+    r_ind_t *ri = &Index[imatch];
+    ri->bg      = 0; ri->done = 1; ri->ofst = -1;
+    releaseAobj(&ri->bgpk);                                  // FREED 210
+    IndexBuilds--;
+    invalidatePlanCache(); /* the planner can use the index now */
+    redisLog(REDIS_NOTICE, "CREATE INDEX BACKGROUND: %s done", ri->name);
+}
+static void startBackgroundBuild(int imatch) {
+    r_ind_t *ri = &Index[imatch];
+    ri->bg      = 1; ri->done = 0; ri->ofst = 0; /* ofst -> rows scanned */
+    initAobj(&ri->bgpk);
+    IndexBuilds++;
+    if (!getBtr(ri->tmatch)->numkeys) finishBackgroundBuild(imatch);
+}
+/* RETURNS: 1 when the deadline hit before the scan reached the table's end */
+static bool buildIndexSlice(int imatch, long long deadline) {
+    r_ind_t *ri  = &Index[imatch];
+    bt      *btr = getBtr(ri->tmatch);
+    aobj     alow, ahigh; initAobj(&alow); initAobj(&ahigh);
+    btSIter *bi  = NULL;
+    if (assignMaxKey(btr, &ahigh) && /* cursor past MAX -> nothing left */
+        (ri->bgpk.empty || aobjKeyCmp(&ri->bgpk, &ahigh) < 0)) {
+        if (ri->bgpk.empty) {
+            if (assignMinKey(btr, &alow)) {
+                bi = btGetRangeIter(btr, &alow,     &ahigh, 1);
+            }
+        } else  bi = btGetRangeIter(btr, &ri->bgpk, &ahigh, 1);
+    }
+    btEntry *be; long n = 0; bool more = 0, ok = 1;
+    while ((be = btRangeNext(bi, 1)) != NULL) {
+        if (!ri->bgpk.empty && aobjKeyCmp(be->key, &ri->bgpk) <= 0) continue;
+        if (!_addToIndex(NULL, btr, be->key, be->val, imatch)) { ok = 0; break;}
+        setBuildCursor(ri, be->key); ri->ofst++; n++;
+        if (!(n % INDEX_BUILD_CHECK_ROWS) && ustime() >= deadline) {
+            more = 1; break;
+        }
+    } btReleaseRangeIterator(bi);
+    releaseAobj(&alow); releaseAobj(&ahigh);
+    if (!ok) { /* e.g. UNIQUE violation -> the index can NOT be built */
+        redisLog(REDIS_WARNING, "CREATE INDEX BACKGROUND: %s FAILED -> DROPPED",
+                                ri->name);
+        emptyIndex(NULL, imatch); return 0;
+    }
+    if (!more) finishBackgroundBuild(imatch);
+    return more;
+}
+int indexBuildTimeProc(struct aeEventLoop *eventLoop, lolo id, void *cdata) {
+    (void)eventLoop; (void)id; (void)cdata; // compiler warnings
+    if (!IndexBuilds) return 100;
+    long long deadline = ustime() + (server.alc.IndexBuildSlice * 1000);
+    for (int imatch = 0; imatch < Num_indx; imatch++) {
+        r_ind_t *ri = &Index[imatch];
+        if (!ri->name || !ri->bg) continue;
+        if (buildIndexSlice(imatch, deadline)) break; /* slice used up */
+    }
+    return IndexBuilds ? 1 : 100; /* 1ms between slices -> clients run */
+}
+sds genIndexBuildInfoString(sds info) {
+    info = sdscatprintf(info, "index_builds_in_progress:%d\r\n", IndexBuilds);
+    for (int imatch = 0; imatch < Num_indx; imatch++) {
+        r_ind_t *ri = &Index[imatch];
+        if (!ri->name || !ri->bg) continue;
+        bt     *btr  = getBtr(ri->tmatch);
+        double  perc = btr->numkeys ?
+                       ((double)ri->ofst / (double)btr->numkeys) * 100.00 : 0.0;
+        info = sdscatprintf(info,
+                       "index_build_%s:table=%s,scanned=%ld,rows=%u,pct=%.2f\r\n",
+                        ri->name, Tbl[ri->tmatch].name, ri->ofst,
+                        btr->numkeys, (perc > 100.0) ? 100.0 : perc);
+    }
+    return info;
+}
 static void addIndex() { //printf("addIndex: Ind_HW: %d\n", Ind_HW);
     Ind_HW++;
     r_ind_t *indxs = malloc(sizeof(r_ind_t) * Ind_HW);
@@ -514,11 +878,14 @@ bool runLuaFunctionIndexFunc(cli *c, sds iconstrct, sds tname, sds  iname) {
 }
 int newIndex(cli    *c,     sds    iname, int  tmatch,    icol_t ic,
              list   *clist, uchar  cnstr, bool virt,      bool   lru,
-             luat_t *luat,  icol_t obc,   bool prtl,      bool   lfu,
-             uchar   dtype, sds    fname, sds  iconstrct, sds idestrct) {
+             luat_t *luat,  icol_t obc,   icol_t icov,    bool   prtl,
+             bool    lfu,   uchar  dtype, sds    fname,   sds    iconstrct,
+             sds     idestrct, list *pflist, sds   pwc,     uchar  xop,
+             ulong   xarg) {
     if (ic.nlo > 1) {
         addReply(c, shared.nested_dni); return -1;
     }
+    invalidatePlanCache();
     int imatch;
     if (!DropI && Num_indx >= (int)Ind_HW) addIndex();
     if (DropI) {
@@ -533,18 +900,22 @@ int newIndex(cli    *c,     sds    iname, int  tmatch,    icol_t ic,
     ri->name    = sdsdup(iname);                     // FREE 055
     ri->tmatch  = tmatch; cloneIC(&ri->icol, &ic); ri->clist = clist;
     ri->virt    = virt;   ri->cnstr = cnstr;       ri->lru   = lru;
-    ri->obc     = obc;    ri->lfu   = lfu;
+    ri->obc     = obc;    ri->lfu   = lfu;         ri->icov  = icov;
     if (fname)     ri->fname     = sdsdup(fname);          // FREE 162
     if (iconstrct) ri->iconstrct = sdsdup(iconstrct);      // FREE 167
     if (idestrct)  ri->idestrct  = sdsdup(idestrct);       // FREE 166
+    if (pwc)       ri->pwc       = sdsdup(pwc);            // FREE 214
+    ri->pflist  = pflist; ri->xop   = xop;         ri->xarg  = xarg;
     ri->hlt     = luat ? 1 :  0;
     ri->done    = prtl ? 0 :  1; 
     ri->dtype   = (ic.cmatch == -1 || dtype) ? dtype : rt->col[ic.cmatch].type;
     ri->ofst    = prtl ? 1 : -1;// NOTE: PKs start at 1 (not 0)
     if (!rt->ilist) rt->ilist  = listCreate();           // DESTROY 088
     listAddNodeTail(rt->ilist, VOIDINT imatch);
-    if (ri->icol.cmatch != -1) {
-        rt->col[ri->icol.cmatch].imatch = imatch;
+    if (ri->icol.cmatch != -1) { /* PARTIAL, EXPR & BITMAP: NOT the col's index */
+        if (!pflist && !xop && !BMAP(cnstr)) {
+            rt->col[ri->icol.cmatch].imatch = imatch;
+        }
         ci_t *ci = dictFetchValue(rt->cdict, rt->col[ri->icol.cmatch].name);
         if (!ci->ilist) ci->ilist = listCreate();        // FREE 148
         listAddNodeTail(ci->ilist, VOIDINT imatch);
@@ -572,6 +943,13 @@ int newIndex(cli    *c,     sds    iname, int  tmatch,    icol_t ic,
             i++;
         } listReleaseIterator(li);
     } else if (ri->icol.cmatch != -1) rt->col[ri->icol.cmatch].indxd = 1;
+    if (ri->icov.cmatch != -1) rt->col[ri->icov.cmatch].indxd = 1; // NO OVRWR
+    if (pflist) { listNode *ln; /* pwc's columns: NO OVRWR */
+        listIter *li = listGetIterator(pflist, AL_START_HEAD);
+        while((ln = listNext(li))) {
+            f_t *flt = ln->value; rt->col[flt->ic.cmatch].indxd = 1;
+        } listReleaseIterator(li);
+    }
     if      (virt) rt->vimatch = imatch;
     else if (ri->hlt) {
         ri->luat = luat; luat->num = imatch;
@@ -587,10 +965,11 @@ int newIndex(cli    *c,     sds    iname, int  tmatch,    icol_t ic,
             ri->btr = createMCI_IBT(ri->clist, imatch, ri->dtype);
         } else if UNIQ(ri->cnstr) {
             ri->btr = createU_S_IBT(ri->dtype, imatch, pktyp);
-        } else { // Normal & LRU/LFU
+        } else { // Normal & LRU/LFU & BITMAP (stays empty)
             ri->btr = createIndexBT(ri->dtype, imatch);
         }
-
+        if BMAP (ri->cnstr) ri->bmd = bitmapIndexCreate();
+        if HASHI(ri->cnstr) ri->hsh = alc_ihash_make(0);   // FREE 221
     }
     ASSERT_OK(dictAdd(IndD, sdsdup(ri->name), VOIDINT(imatch + 1)));
     if (!virt && !lru && !lfu && !luat && !prtl && !fname) {
@@ -615,12 +994,14 @@ bool addC2MCI(cli *c, icol_t ic, list *clist) {
     listAddNodeTail(clist, VOIDINT mic);
     return 1;
 }
-static bool ICommit(cli   *c,    sds iname,     sds  tname, sds   cname,
-                    uchar cnstr, sds obcname,   long limit, uchar dtype,
-                    sds   fname, sds iconstrct, sds idestrct) {
-    DECLARE_ICOL(ic, -1) DECLARE_ICOL(obc, -1)
+static bool ICommit(cli   *c,    sds iname,     sds  tname,    sds   cname,
+                    uchar cnstr, sds obcname,   long limit,    uchar dtype,
+                    sds   fname, sds iconstrct, sds  idestrct, bool  bg,
+                    sds   icovname, sds pwc,       bool prst) {
+    DECLARE_ICOL(ic, -1) DECLARE_ICOL(obc, -1) DECLARE_ICOL(icov, -1)
     bool     ret     = 0;
-    list    *clist   = NULL;
+    list    *clist   = NULL, *pflist = NULL;
+    sds      xcname  = NULL; uchar xop = 0; ulong xarg = 0;
     bool     prtl    = (limit != -1);
     int      tmatch  = find_table(tname);
     if (tmatch == -1) { addReply(c, shared.nonexistenttable);    goto icom_end;}
@@ -630,6 +1011,9 @@ static bool ICommit(cli   *c,    sds iname,     sds  tname, sds   cname,
         addReply(c, shared.indexcursorerr);                      goto icom_end;
     }
     bool  new   = 1; // Used in Index Cursors
+    if (!fname && parseIndexExpr(cname, sdslen(cname), &xcname, &xop, &xarg)) {
+        cname = xcname; /* EXPRESSION: index ON the expression's column */
+    }
     char *nextc = fname ? NULL : strchr(cname, ',');
     if (fname) { // NOOP
     } else if (nextc) {    /* Multiple Column Index */
@@ -683,7 +1067,7 @@ static bool ICommit(cli   *c,    sds iname,     sds  tname, sds   cname,
                         if (!icol_cmp(nic, oic)) { match = 0; break; }
                     } listReleaseIterator(nli); listReleaseIterator(oli);
                     if (match) {
-                        if (prtl && !ri->done) {
+                        if (prtl && !ri->done && !ri->bg) {
                             new = 0;
                             if (strcmp(ri->name, iname)) {
                                 addReply(c, shared.indexcursorerr);
@@ -701,7 +1085,7 @@ static bool ICommit(cli   *c,    sds iname,     sds  tname, sds   cname,
         if (ic.cmatch <= -1) {
             addReply(c, shared.indextargetinvalid);              goto icom_end;
         }
-        if UNIQ(cnstr) {/*NOTE: RESTRICTION: UNIQUE MCI both cols -> NUM */
+        if (UNIQ(cnstr) && !HASHI(cnstr)) {/*NOTE: UNIQUE both cols -> NUM */
             if ((!C_IS_NUM(rt->col[ic.cmatch].type) && !C_IS_NUM(dtype)) ||
                 !C_IS_NUM(rt->col[0].type)) {
                 addReply(c, shared.uniq_simp_index_nums);        goto icom_end;
@@ -709,8 +1093,10 @@ static bool ICommit(cli   *c,    sds iname,     sds  tname, sds   cname,
         }
         for (int i = 0; i < Num_indx; i++) { /* already indxd? */
             r_ind_t *ri = &Index[i];
-            if (ri->name && ri->tmatch == tmatch && !icol_cmp(&ri->icol, &ic)) {
-                if (prtl && !ri->done) {
+            if (ri->name && ri->tmatch == tmatch && !icol_cmp(&ri->icol, &ic) &&
+                !ri->pwc && !pwc && ri->xop == xop && ri->xarg == xarg &&
+                BMAP(ri->cnstr) == BMAP(cnstr)) {
+                if (prtl && !ri->done && !ri->bg) {
                     new = 0;
                     if (strcmp(ri->name, iname)) {
                         addReply(c, shared.indexcursorerr);      goto icom_end;
@@ -729,10 +1115,68 @@ static bool ICommit(cli   *c,    sds iname,     sds  tname, sds   cname,
              addReply(c, shared.indexobcill);                    goto icom_end;
         }
     }
+    if (icovname) { /* COVERING: single col, [INT|LONG|U128] PK & INCLUDE */
+        icov = find_column(tmatch, icovname);
+        if (icov.cmatch == -1) {
+            addReply(c, shared.indexcovererr);                   goto icom_end;
+        }
+        if (!icov.cmatch || UNIQ(cnstr) || clist || fname || obcname ||
+            ic.nlo || dtype != COL_TYPE_NONE || !icol_cmp(&icov, &ic) ||
+            !C_IS_NUM(rt->col[icov.cmatch].type) ||
+            !C_IS_NUM(rt->col[0].type)) {
+             addReply(c, shared.indexcoverill);                  goto icom_end;
+        }
+    }
+    if (xop) { /* EXPRESSION: [+,-,*,/,%] on [INT|LONG], LEFT() on TEXT */
+        uchar ctype = rt->col[ic.cmatch].type;
+        bool  lft   = (xop == IXPR_LEFT);
+        if (UNIQ(cnstr) || obcname || icovname || prtl || pwc || ic.nlo ||
+            dtype != COL_TYPE_NONE                                        ||
+            ( lft && (!C_IS_S(ctype) || !xarg))                           ||
+            (!lft && !C_IS_I(ctype) && !C_IS_L(ctype))                    ||
+            ((xop == (uchar)DIVIDE || xop == (uchar)MODULO) && !xarg)) {
+             addReply(c, shared.indexexprill);                   goto icom_end;
+        }
+    }
+    if (pwc) { /* PARTIAL: single [NUM|TEXT] col, NO cursors */
+        if (UNIQ(cnstr) || clist || fname || obcname || prtl || ic.nlo ||
+            dtype != COL_TYPE_NONE || C_IS_O(rt->col[ic.cmatch].type)) {
+             addReply(c, shared.indexwcill);                     goto icom_end;
+        }
+        if (!(pflist = parseIndexWC(c, tmatch, pwc)))           goto icom_end;
+    }
+    if HASHI(cnstr) { /* HASH: UNIQUE [INT|LONG|TEXT] col, [INT|LONG] PK */
+        uchar ctype = (ic.cmatch > 0) ? rt->col[ic.cmatch].type : COL_TYPE_NONE;
+        uchar pktyp = rt->col[0].type;
+        if (clist || fname || obcname || prtl || ic.nlo                   ||
+            dtype != COL_TYPE_NONE                                        ||
+            (!C_IS_I(ctype) && !C_IS_L(ctype) && !C_IS_S(ctype))          ||
+            (!C_IS_I(pktyp) && !C_IS_L(pktyp))) {
+             addReply(c, shared.indexhashill);                   goto icom_end;
+        }
+        if C_IS_S(ctype) cnstr = CONSTRAINT_HASHS; /* NORMAL BT + ihash */
+    }
+    if BMAP(cnstr) { /* BITMAP: single [INT|LONG|TEXT] col, [INT|LONG] PK */
+        uchar ctype = (ic.cmatch > 0) ? rt->col[ic.cmatch].type : COL_TYPE_NONE;
+        uchar pktyp = rt->col[0].type;
+        if (clist || fname || obcname || icovname || pwc || xop || prtl  ||
+            ic.nlo || dtype != COL_TYPE_NONE                              ||
+            (!C_IS_I(ctype) && !C_IS_L(ctype) && !C_IS_S(ctype))          ||
+            (!C_IS_I(pktyp) && !C_IS_L(pktyp))) {
+             addReply(c, shared.indexbitmapill);                 goto icom_end;
+        }
+    }
+    if (prst && (fname || ic.nlo || BMAP(cnstr) || HASHI(cnstr))) {
+        addReply(c, shared.indexpersistill);                     goto icom_end;
+    }
     if (new) {
-        if ((newIndex(c,   iname, tmatch, ic,    clist, cnstr, 0, 0, NULL,
-                      obc, prtl,  0,      dtype, fname,
-                      iconstrct, idestrct)) == -1)               goto icom_end;
+        int imatch = newIndex(c,   iname, tmatch, ic,    clist, cnstr, 0, 0,
+                              NULL, obc, icov, (prtl || bg), 0, dtype, fname,
+                              iconstrct, idestrct, pflist, pwc, xop, xarg);
+        pflist     = NULL; /* newIndex() owns it [emptyIndex() on error] */
+        if (imatch == -1)                                        goto icom_end;
+        Index[imatch].persist = prst;
+        if (bg) startBackgroundBuild(imatch);
     }
     if (prtl) {
         int imatch = find_partial_index(tmatch, ic);
@@ -744,12 +1188,14 @@ static bool ICommit(cli   *c,    sds iname,     sds  tname, sds   cname,
     addReply(c, shared.ok); ret = 1;
 
 icom_end:
-    releaseIC(&ic); releaseIC(&obc);
+    releaseIC(&ic); releaseIC(&obc); releaseIC(&icov);
+    destroyFlist(&pflist);                               // FREED 212
+    if (xcname) sdsfree(xcname);                         // FREED 213
     return ret;
 }
 void createIndex(redisClient *c) {
     if (c->argc < 6) { addReply(c, shared.index_wrong_nargs);         return; }
-    int targ, coln; bool cnstr;
+    int targ, coln; uchar cnstr;
     if (!strcasecmp(c->argv[1]->ptr, "UNIQUE")) {
         cnstr = CONSTRAINT_UNIQUE; coln = 6; targ = 5;
         if (c->argc < 7) { addReply(c, shared.index_wrong_nargs);     return; }
@@ -760,20 +1206,41 @@ void createIndex(redisClient *c) {
         addReply(c, shared.createsyntax);                             return;
     }
     sds iname = c->argv[coln - 3]->ptr;
-    if (match_index_name(iname) != -1) {
+    int pim   = match_partial_index_name(iname);
+    if (pim != -1 && (Index[pim].done || Index[pim].bg)) {
         addReply(c, shared.nonuniqueindexnames);                      return;
     }
+    int  argc = c->argc; /* trailing BACKGROUND -> build via cron */
+    bool bg   = 0, prst = 0; /* trailing PERSIST -> BT saved in the RDB */
+    while (argc > (coln + 1)) {
+        char *opt = c->argv[argc - 1]->ptr;
+        if      (!bg   && !strcasecmp(opt, "BACKGROUND")) bg   = 1;
+        else if (!prst && !strcasecmp(opt, "PERSIST"))    prst = 1;
+        else break;
+        argc--;
+    }
+    if (bg && server.loading) bg = 0; /* AOF replay -> index ready w/ data */
     char *token = c->argv[coln]->ptr;
     char *end   = strrchr(token + sdslen(token) - 1, ')');
     if (!end || (*token != '(')) { addReply(c, shared.createsyntax);  return; }
     token++; SKIP_SPACES(token);
     sds  obcname = NULL, fname = NULL, iconstrct = NULL, idestrct = NULL;
+    sds  icovname = NULL, pwc = NULL;
     sds cname = sdsnewlen(token, (end - token));         // FREE 158
+    if (argc > (coln + 2) && !strcasecmp(c->argv[coln + 1]->ptr, "USING")) {
+        char *itype = c->argv[coln + 2]->ptr;
+        if        (!strcasecmp(itype, "BITMAP") && !UNIQ(cnstr)) {
+            cnstr = CONSTRAINT_BITMAP;
+        } else if (!strcasecmp(itype, "HASH")   &&  UNIQ(cnstr)) {
+            cnstr = CONSTRAINT_HASH;
+        } else { addReply(c, shared.createsyntax);             goto cr8i_end; }
+        coln += 2;
+    }
 
     uchar  dtype = COL_TYPE_NONE;
     char  *dn    = strchr(cname, '.');
     if (dn) {
-        if (c->argc < (coln + 2)) {
+        if (argc < (coln + 2)) {
             addReply(c, shared.createsyntax_dn);               goto cr8i_end;
         }
         coln++;
@@ -784,10 +1251,27 @@ void createIndex(redisClient *c) {
     bool findex = (cname[sdslen(cname) - 1] == ')' &&
                    cname[sdslen(cname) - 2] == '(');
     long limit  = -1;
+    if (!findex && argc > (coln + 2) &&
+        !strcasecmp(c->argv[coln + 1]->ptr, "INCLUDE")) { /* COVERING */
+        char *itkn = c->argv[coln + 2]->ptr;
+        char *iend = strrchr(itkn, ')');
+        if (*itkn != '(' || !iend) {
+            addReply(c, shared.createsyntax);                  goto cr8i_end;
+        }
+        itkn++; SKIP_SPACES(itkn)
+        iend--; while (iend >= itkn && ISBLANK(*iend)) iend--;
+        icovname = sdsnewlen(itkn, (iend + 1 - itkn));     // FREE 211
+        coln    += 2;
+    }
+    if (!findex && argc > (coln + 2) &&
+        !strcasecmp(c->argv[coln + 1]->ptr, "WHERE")) {   /* PARTIAL */
+        pwc   = sdsdup(c->argv[coln + 2]->ptr);             // FREE 215
+        coln += 2;
+    }
     if (findex) {
         char *prn = strchr(cname, '(');
         fname     = sdsnewlen(cname, (prn - cname));     // FREE 159
-        if (c->argc < (coln + 3)) {
+        if (argc < (coln + 3)) {
             addReply(c, shared.create_findex);                 goto cr8i_end;
         }
         coln++;
@@ -797,10 +1281,10 @@ void createIndex(redisClient *c) {
         coln++;
         iconstrct  = sdsdup(c->argv[coln]->ptr);           // FREE 160;
         coln++;
-        if (c->argc > coln) idestrct = sdsdup(c->argv[coln]->ptr); // FREE 165
-    } else if (c->argc > (coln + 1)) {
+        if (argc > coln) idestrct = sdsdup(c->argv[coln]->ptr); // FREE 165
+    } else if (argc > (coln + 1)) {
         if (strcasecmp(c->argv[coln + 1]->ptr, "ORDER") &&
-            (c->argc == (coln + 4))) { 
+            (argc == (coln + 4))) { 
             if (strcasecmp(c->argv[coln + 1]->ptr, "ORDER") || 
                 strcasecmp(c->argv[coln + 2]->ptr, "BY")) {
                 addReply(c, shared.createsyntax);              goto cr8i_end;
@@ -808,9 +1292,9 @@ void createIndex(redisClient *c) {
                 coln += 3; obcname = sdsdup(c->argv[coln]->ptr); // FREE 161
             }
         }
-        if (c->argc > (coln + 1)) {
+        if (argc > (coln + 1)) {
             bool ok = 0;
-            if (c->argc == (coln + 3)) {
+            if (argc == (coln + 3)) {
                 if (!strcasecmp(c->argv[coln + 1]->ptr, "LIMIT")) {
                     limit = strtoul(c->argv[coln + 2]->ptr, NULL, 10);
                     if (limit > 0) ok = 1;
@@ -819,17 +1303,20 @@ void createIndex(redisClient *c) {
             if (!ok) { addReply(c, shared.createsyntax);       goto cr8i_end; }
         }
     }
-    if (limit != -1 && fname) {
+    if ((limit != -1 || bg) && fname) {
         addReply(c, shared.create_findex);                     goto cr8i_end;
     }
+    if (limit != -1 && bg) { addReply(c, shared.createsyntax); goto cr8i_end; }
     ICommit(c, iname, c->argv[targ]->ptr, cname, cnstr, obcname, limit, dtype,
-            fname, iconstrct, idestrct);
+            fname, iconstrct, idestrct, bg, icovname, pwc, prst);
 
 cr8i_end:
     if (fname)     sdsfree(fname);                       // FREED 158
     if (iconstrct) sdsfree(iconstrct);                   // FREED 159
     if (idestrct)  sdsfree(idestrct);                    // FREED 165
     if (obcname)   sdsfree(obcname);                     // FREED 161
+    if (icovname)  sdsfree(icovname);                    // FREED 211
+    if (pwc)       sdsfree(pwc);                         // FREED 215
     sdsfree(cname);                                      // FREED 158
 }
 
@@ -906,6 +1393,7 @@ static void emptyLuaTableElementIndex(int imatch) {
 void emptyIndex(cli *c, int imatch) {
     r_ind_t *ri = &Index[imatch];
     if (!ri->name) return; /* previously deleted */
+    invalidatePlanCache();
     r_tbl_t *rt = &Tbl[ri->tmatch];
     if (ri->idestrct) {
         runLuaFunctionIndexFunc(c, ri->idestrct, rt->name, ri->name);
@@ -913,9 +1401,15 @@ void emptyIndex(cli *c, int imatch) {
     }
     if (ri->fname)     sdsfree(ri->fname);               // FREED 162
     if (ri->iconstrct) sdsfree(ri->iconstrct);           // FREED 167
+    if (ri->pwc)       sdsfree(ri->pwc);                 // FREED 214
+    destroyFlist(&ri->pflist);                           // FREED 212
+    bitmapIndexDestroy(&ri->bmd);                        // FREED 219
+    alc_ihash_destroy (ri->hsh); ri->hsh = NULL;         // FREED 221
     dictDelete(IndD, ri->name); sdsfree(ri->name);       /* DESTROYED 055 */
     if (ri->icol.cmatch != -1) {
-        rt->col[ri->icol.cmatch].imatch = -1;
+        if (rt->col[ri->icol.cmatch].imatch == imatch) {
+            rt->col[ri->icol.cmatch].imatch = -1;
+        }
         listNode *ln = listSearchKey(rt->ilist, VOIDINT imatch);
         listDelNode(rt->ilist, ln);
     }
@@ -935,8 +1429,11 @@ void emptyIndex(cli *c, int imatch) {
         emptyLuaTableElementIndex(imatch);
         //TODO free ri->icol.lo & set to NULL
     }
+    if (ri->bg) IndexBuilds--;
+    releaseAobj(&ri->bgpk);                              // FREED 210
     bzero(ri, sizeof(r_ind_t));
-    ri->tmatch = ri->icol.cmatch = ri->obc.cmatch = ri->ofst = -1;
+    ri->tmatch = ri->icol.cmatch = ri->obc.cmatch = ri->icov.cmatch = -1;
+    ri->ofst   = -1;
     ri->cnstr  = CONSTRAINT_NONE;
     if (imatch == (Num_indx - 1)) Num_indx--; // if last -> reuse
     else {                                    // else put on DropI for reuse
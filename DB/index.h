@@ -35,6 +35,15 @@ ALL RIGHTS RESERVED
 #include "aobj.h"
 #include "common.h"
 
+/* EXPRESSION INDEX: ri->xop is [PLUS,MINUS,MULT,DIVIDE,MODULO] or LEFT() */
+#define IXPR_LEFT 'L'
+
+/* HASH INDEX: [INT|LONG] column values & PKs are the ihash's keys & vals,
+               TEXT column values are keyed by their hash (HASHS: verified) */
+#define HASH_IVAL(a) (C_IS_I((a)->type) ? (ulong)(a)->i : (a)->l)
+#define HASH_KEY(a)  (C_IS_S((a)->type) ? alc_ihash_str((a)->s, (a)->len) : \
+                                          HASH_IVAL(a))
+
 void iAddUniq(bt *ibtr, uchar pktyp, aobj *apk, aobj *acol); // OBYI uses also
 
 sds  getMCIlist(list *clist, int tmatch);        //NOTE: Used in DESC command
@@ -43,17 +52,31 @@ bool addC2MCI  (cli *c, icol_t ic, list *clist); //NOTE: Used in rdbLoad()
 bool runLuaFunctionIndexFunc(cli *c, sds iconstrct, sds tname, sds  iname);
 int  newIndex(cli    *c,     sds    iname, int  tmatch,    icol_t ic,
               list   *clist, uchar  cnstr, bool virt,      bool   lru,
-              luat_t *luat,  icol_t obc,   bool prtl,      bool   lfu,
-              uchar   dtype, sds    fname, sds  iconstrct, sds idestrct);
+              luat_t *luat,  icol_t obc,   icol_t icov,    bool   prtl,
+              bool    lfu,   uchar  dtype, sds    fname,   sds    iconstrct,
+              sds     idestrct, list  *pflist, sds    pwc,     uchar  xop,
+              ulong   xarg);
 void createIndex(cli *c);
 
+bool  parseIndexExpr    (char *s, int len, sds *cname, uchar *xop, ulong *xarg);
+sds   catIndexExpr      (sds   s, r_ind_t *ri);
+void  applyIndexExpr    (r_ind_t *ri, aobj *a);
+list *parseIndexWC      (cli *c, int tmatch, sds pwc);
+bool  indexWCColHit     (r_ind_t *ri, icol_t chit[]);
+void  usePartialIndexes (list *flist);
+bool  hasPartialIndex   (int tmatch, int cmatch);
+
 long buildIndex (cli *c, bt *btr, int imatch, long limit);
 
+int  indexBuildTimeProc(struct aeEventLoop *eventLoop, lolo id, void *cdata);
+sds  genIndexBuildInfoString(sds info);
+
 bool addToIndex (cli *c, bt *btr, aobj *apk,  void *rrow,   int imatch);
 
 void delFromIndex       (bt *btr, aobj *apk,  void *rrow,   int imatch,
                                                                      bool gost);
 void evictFromIndex     (bt *btr, aobj *apk,  void *rrow,   int imatch);
+void unevictToIndex     (bt *btr, aobj *apk,  void *rrow,   int imatch);
 
 bool upIndex    (cli *c, bt *btr, aobj *aopk,  aobj *ocol, 
                                   aobj *anpk,  aobj *ncol,  int pktyp,
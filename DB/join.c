@@ -214,9 +214,12 @@ static bool join_reply(range_t *g, long *card) {
     jb_t *jb  = g->jb;   /* code compaction */
     robj *r   = outputJoinRow(g);
     if (JoinQed) {
-        jb->ob->row = cloneRobj(r);
-        listAddNodeTail(g->co.ll, jb->ob);
-        jb->ob      = cloneOb(jb->ob, jb->wb.nob);       /* DESTROY ME 057 */
+        obsl_t *ob  = jb->ob;
+        ob->row     = cloneRobj(r);
+        jb->ob      = cloneOb(ob, jb->wb.nob);           /* DESTROY ME 057 */
+        if (!addOb2OBList(g->co.ll, ob, g->co.ofree)) {
+            ret = 0; goto join_rep_end; /* CurrError set */
+        }
     } else {
         if (!addReplyJoinRow(g->co.c, r)) { ret = 0; goto join_rep_end; }
     }
@@ -408,6 +411,8 @@ bool joinGeneric(redisClient *c, jb_t *jb) {
     void *rlen        = jb->cstar ? NULL : addDeferredMultiBulkLength(c);
     long  card        = 0;
     if (Op(&g, join_op) == -1) JoinMiss = 1;
+    if (JoinMiss && server.alc.CurrError) {
+                    replaceDMB(c, rlen, server.alc.CurrError); goto join_gen_err;}
     if (JoinMiss) { replaceDMB(c, rlen, shared.dirty_miss);  goto join_gen_err;}
     if (JoinErr)  { replaceDMB(c, rlen, shared.join_qo_err); goto join_gen_err;}
     card              = JoinCard;
@@ -0,0 +1,138 @@
+/*
+ * This file implements a single pass SQL tokenizer (lexer)
+ *
+
+AGPL License
+
+Copyright (c) 2011 Russell Sullivan <jaksprats AT gmail DOT com>
+ALL RIGHTS RESERVED
+
+   This file is part of ALCHEMY_DATABASE
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Affero General Public License as
+    published by the Free Software Foundation, either version 3 of the
+    License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Affero General Public License for more details.
+
+    You should have received a copy of the GNU Affero General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+
+#include "redis.h"
+
+#include "parser.h"
+#include "common.h"
+#include "lexer.h"
+
+/* NOTE: the string parsers (DXDB_strcasestr(), get_next_nonparaned_comma())
+         re-scan the rest of the line for every predicate/column, lexSQL()
+         walks the line ONCE into an ltk_t[] (quote & paren aware) & the
+         parsers [parseWC(), parseCSL*(), parseCreateTable()] walk the tokens */
+
+typedef struct lex_kw {
+    char  *s; uint32 len; uchar kw;
+} lkw_t;
+static lkw_t LexKW[] = { {"AND",     3, LKW_AND},    {"IN",     2, LKW_IN},
+                         {"NOT",     3, LKW_NOT},    {"BETWEEN",7, LKW_BETWEEN},
+                         {"ORDER",   5, LKW_ORDER},  {"GROUP",  5, LKW_GROUP},
+                         {"BY",      2, LKW_BY},     {"LIMIT",  5, LKW_LIMIT},
+                         {"OFFSET",  6, LKW_OFFSET} };
+#define NUM_LEX_KW (sizeof(LexKW) / sizeof(lkw_t))
+
+#define ISOPCHAR(c) (c == '=' || c == '<' || c == '>' || c == '!')
+#define ISDELIM(c)  (!c || ISBLANK(c) || c == '\'' || c == '(' || c == ')' || \
+                      c == ',' || ISOPCHAR(c))
+
+static uchar getLexKW(char *s, uint32 len) {
+    if (len < 2 || len > 7 || !ISALPHA(*s)) return LKW_NONE;
+    for (uint32 i = 0; i < NUM_LEX_KW; i++) {
+        if (LexKW[i].len == len && !strncasecmp(s, LexKW[i].s, len)) {
+            return LexKW[i].kw;
+        }
+    }
+    return LKW_NONE;
+}
+static char *endOfLexString(char *s, char *end) { // s @ opening \'
+    for (char *x = s + 1; x < end; x++) {
+        if (*x != '\'') continue;
+        char *b = x - 1; while (b > s && *b == '\\') b--;
+        if ((x - b - 1) % 2 == 0) return x + 1; /* NOT backslash-escaped */
+    }
+    return end; /* unterminated -> rest of the line */
+}
+static ltk_t *addLexToken(lex_t *lx) {
+    if (lx->n == lx->size) {
+        int    nsize = lx->size * 2;
+        ltk_t *nt    = malloc(sizeof(ltk_t) * nsize);        // FREE ME 202
+        memcpy(nt, lx->t, sizeof(ltk_t) * lx->n);
+        if (lx->t != lx->st) free(lx->t);                    // FREED 202
+        lx->t = nt; lx->size = nsize;
+    }
+    return &lx->t[lx->n++];
+}
+void lexSQL(lex_t *lx, char *s, int len) {
+    lx->t = lx->st; lx->n = 0; lx->size = LEX_STATIC_TOKENS;
+    char     *x     = s; char *end = s + len;
+    ushort16  depth = 0;
+    while (x < end) {
+        bool bsp = 0;
+        while (x < end && ISBLANK(*x)) { x++; bsp = 1; }
+        if (x == end) break;
+        ltk_t *tk = addLexToken(lx);
+        tk->s     = x; tk->bsp = (x != s) && bsp; tk->kw = LKW_NONE;
+        if        (*x == '\'') {
+            tk->type = LTK_STR;    x = endOfLexString(x, end);
+        } else if (*x == '(') {
+            tk->type = LTK_LPAREN; x++;
+        } else if (*x == ')') {
+            tk->type = LTK_RPAREN; x++; if (depth) depth--;
+        } else if (*x == ',') {
+            tk->type = LTK_COMMA;  x++;
+        } else if (ISOPCHAR(*x)) {
+            tk->type = LTK_OP;     while (x < end && ISOPCHAR(*x)) x++;
+        } else {
+            bool neg = (*x == '-' && x + 1 < end && ISDIGIT(x[1]));
+            tk->type = (ISDIGIT(*x) || neg) ? LTK_NUM : LTK_WORD;
+            while (x < end && !ISDELIM(*x)) x++;
+            if (tk->type == LTK_WORD) tk->kw = getLexKW(tk->s, x - tk->s);
+        }
+        tk->len   = x - tk->s;
+        tk->depth = depth;
+        tk->asp   = (x < end && ISBLANK(*x));
+        if (tk->type == LTK_LPAREN) depth++;
+    }
+}
+void releaseLex(lex_t *lx) {
+    if (lx->t != lx->st) { free(lx->t); lx->t = lx->st; }    // FREED 202
+    lx->n = 0;
+}
+/* next ','-delimited item (at depth) in tokens [*i, end) -> [*s, *s + *len)
+   RETURNS: the item's token count, -1 when there are no more items */
+int lexNextItem(lex_t *lx, int *i, int end, ushort16 depth,
+                char **s,  int *len) {
+    if (*i > end) return -1;
+    int j = *i;
+    while (j < end) {
+        if (lx->t[j].type == LTK_COMMA && lx->t[j].depth == depth) break;
+        j++;
+    }
+    int n = j - *i;
+    if (n) {
+        ltk_t *l = &lx->t[j - 1];
+        *s       = lx->t[*i].s; *len = (l->s + l->len) - *s;
+    } else {
+        *s       = (j < lx->n) ? lx->t[j].s : ""; *len = 0;
+    }
+    *i = j + 1; /* past the comma (or past end) */
+    return n;
+}
@@ -0,0 +1,78 @@
+/*
+ * This file implements a single pass SQL tokenizer (lexer)
+ *
+
+AGPL License
+
+Copyright (c) 2011 Russell Sullivan <jaksprats AT gmail DOT com>
+ALL RIGHTS RESERVED
+
+   This file is part of ALCHEMY_DATABASE
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Affero General Public License as
+    published by the Free Software Foundation, either version 3 of the
+    License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Affero General Public License for more details.
+
+    You should have received a copy of the GNU Affero General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __ALCHEMY_LEXER__H
+#define __ALCHEMY_LEXER__H
+
+#include "redis.h"
+
+#include "common.h"
+
+#define LTK_WORD   1 /* names, keywords, "tbl.col", "$1", "*", "1|2" */
+#define LTK_NUM    2 /* [-]digit... */
+#define LTK_STR    3 /* '...' (w/ the quotes) */
+#define LTK_LPAREN 4
+#define LTK_RPAREN 5
+#define LTK_COMMA  6
+#define LTK_OP     7 /* [=,!=,<,<=,>,>=,<>] */
+
+#define LKW_NONE    0
+#define LKW_AND     1
+#define LKW_IN      2
+#define LKW_NOT     3
+#define LKW_BETWEEN 4
+#define LKW_ORDER   5
+#define LKW_GROUP   6
+#define LKW_BY      7
+#define LKW_LIMIT   8
+#define LKW_OFFSET  9
+
+typedef struct sql_token {
+    char     *s;     /* points into the lexed string */
+    uint32    len;
+    uchar     type;
+    uchar     kw;
+    ushort16  depth; /* paren depth, parens have their enclosing depth */
+    bool      bsp;   /* blank before */
+    bool      asp;   /* blank after  */
+} ltk_t;
+
+#define LEX_STATIC_TOKENS 64
+typedef struct sql_lexer {
+    ltk_t  *t;
+    int     n;
+    int     size;
+    ltk_t   st[LEX_STATIC_TOKENS]; /* most statements need no malloc() */
+} lex_t;
+
+/* " KW " -> surrounded by blanks, the way the string parser matched them */
+#define LTK_SPACED_KW(tk, k) ((tk)->kw == k && (tk)->bsp && (tk)->asp)
+
+void lexSQL     (lex_t *lx, char *s, int len);
+void releaseLex (lex_t *lx);
+int  lexNextItem(lex_t *lx, int *i, int end, ushort16 depth,
+                 char **s,  int *len);
+
+#endif /* __ALCHEMY_LEXER__H */
@@ -39,7 +39,10 @@ ALL RIGHTS RESERVED
 #include "stream.h"
 #include "aobj.h"
 #include "query.h"
+#include "rdb_delta.h"
+#include "mmtbl.h"
 #include "common.h"
+#include "lru.h"
 #include "lfu.h"
 
 /* TODO LIST LFU
@@ -68,6 +71,7 @@ void createLfuIndex(cli *c) {
     char  *tname = rem_backticks(c->argv[3]->ptr, &len); /* Mysql compliant */
     TABLE_CHECK_OR_REPLY(tname,)
     if (OTHER_BT(getBtr(tmatch))) { addReply(c, shared.lfu_other); return; }
+    MMT_RO_CHECK_OR_REPLY(tmatch,)
     r_tbl_t *rt  = &Tbl[tmatch];
     if (rt->lfu) { addReply(c, shared.lfu_repeat); return; }
     rt->lfu      = 1;
@@ -77,7 +81,8 @@ void createLfuIndex(cli *c) {
     sds  iname   = P_SDS_EMT "%s_%s", LFUINDEX_DELIM, tname);  // FREE ME 108
     DECLARE_ICOL(lfuic, rt->lfuc) DECLARE_ICOL(ic, -1)
     rt->lfui     = newIndex(c, iname, tmatch, lfuic, NULL, 0, 0, 0, NULL,
-                            ic, 0, 1, 0, NULL, NULL, NULL);// Can NOT fail
+                            ic, ic, 0, 1, 0, NULL, NULL, NULL,
+                            NULL, NULL, 0, 0);                 // Cant fail
     sdsfree(iname);                                            // FREED 108
     addReply(c, shared.ok);
 }
@@ -87,25 +92,21 @@ void createLfuIndex(cli *c) {
          tmatch, lfuc, lfu, c->LfuColInSelect);                             \
   if (apk) dumpAobj(printf, apk); else printf("\n");
 
-void updateLfu(cli *c, int tmatch, aobj *apk, uchar *lfuc, bool lfu) {
-    //DEBUG_UPDATE_LFU
-    if (!lfu)                 return;
-    if (tmatch == -1)         return; /* from JOIN opSelectSort */
-    if (c->LfuColInSelect)    return; /* NOTE: otherwise TOO cyclical */
+void setLfu(cli *c, int tmatch, aobj *apk, uchar *lfuc, ulong nnum) {
     r_tbl_t *rt     = &Tbl[tmatch];
     int      imatch = rt->lfui;
     if (lfuc) {
         ulong   num   = streamLFUToULong(lfuc);
-        ulong   nnum  = num + 1;
-        overwriteLFUcol(lfuc, nnum);
+        if (num == nnum) return;
+        overwriteLFUcol(lfuc, nnum); DELTA_TOUCH(getBtr(tmatch), apk)
         bt     *ibtr  = getIBtr(imatch);
         int     pktyp = rt->col[0].type;
         aobj ocol; initAobjLong(&ocol, num);
         aobj ncol; initAobjLong(&ncol, nnum);
         upIndex(c, ibtr, apk, &ocol, apk, &ncol, pktyp, NULL, NULL, imatch);
         releaseAobj(&ocol); releaseAobj(&ncol);
-    } else { /* LFU empty -> run "UPDATE tbl SET LFU = 1 WHERE PK = apk" */
-        char   *lbuf = "1";
+    } else { /* LFU empty -> run "UPDATE tbl SET LFU = nnum WHERE PK = apk" */
+        char    lbuf[32]; snprintf(lbuf, 32, "%lu", nnum);
         MATCH_INDICES(tmatch)
         int     ncols  = rt->col_count;
         icol_t  chit[ncols]; ue_t    ue   [ncols]; lue_t le[ncols];
@@ -126,6 +127,16 @@ void updateLfu(cli *c, int tmatch, aobj *apk, uchar *lfuc, bool lfu) {
         release_uc(&uc);
     }
 }
+void updateLfu(cli *c, int tmatch, aobj *apk, uchar *lfuc, bool lfu) {
+    //DEBUG_UPDATE_LFU
+    if (!lfu)                 return;
+    if (tmatch == -1)         return; /* from JOIN opSelectSort */
+    if (c->LfuColInSelect)    return; /* NOTE: otherwise TOO cyclical */
+    if (server.alc.LruLfuFlush) { /* APPROX: index updated by cron */
+        queueAccess(&Tbl[tmatch].lfua, apk, 1, 1); return;
+    }
+    setLfu(c, tmatch, apk, lfuc, lfuc ? streamLFUToULong(lfuc) + 1 : 1);
+}
 
 inline bool initLFUCS(int tmatch, icol_t *ics, int qcols) {
     r_tbl_t *rt = &Tbl[tmatch];
@@ -36,6 +36,7 @@ ulong getLfu(ulong num);
 
 void createLfuIndex(cli *c);
 void updateLfu     (cli *c, int tmatch, aobj *apk, uchar *lfuc, bool lfu);
+void setLfu        (cli *c, int tmatch, aobj *apk, uchar *lfuc, ulong nnum);
 
 bool initLFUCS  (int tmatch, icol_t *ics, int qcols);
 bool initL_LFUCS(int tmatch, list *cs);
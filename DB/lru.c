@@ -28,6 +28,7 @@ ALL RIGHTS RESERVED
 #include <string.h>
 #include <strings.h>
 #include <unistd.h>
+#include <assert.h>
 
 #include "sds.h"
 #include "redis.h"
@@ -43,7 +44,10 @@ ALL RIGHTS RESERVED
 #include "alsosql.h"
 #include "aobj.h"
 #include "query.h"
+#include "rdb_delta.h"
+#include "mmtbl.h"
 #include "common.h"
+#include "lfu.h"
 #include "lru.h"
 
 /* TODO LIST LRU
@@ -51,7 +55,7 @@ ALL RIGHTS RESERVED
 */
 
 // GLOBALS
-extern r_tbl_t *Tbl;
+extern r_tbl_t *Tbl;     extern int      Num_tbls;
 extern int      Num_indx; extern r_ind_t *Index;
 
 #define DEBUG_GET_LRU \
@@ -91,6 +95,7 @@ void createLruIndex(cli *c) {
     char    *tname = rem_backticks(c->argv[3]->ptr, &len); /* Mysql compliant */
     TABLE_CHECK_OR_REPLY(tname,)
     if (OTHER_BT(getBtr(tmatch))) { addReply(c, shared.lru_other); return; }
+    MMT_RO_CHECK_OR_REPLY(tmatch,)
     r_tbl_t *rt    = &Tbl[tmatch];
     if (rt->lrud) { addReply(c, shared.lru_repeat); return; }
 
@@ -101,7 +106,8 @@ void createLruIndex(cli *c) {
     sds  iname     = P_SDS_EMT "%s_%s", LRUINDEX_DELIM, tname); /* DEST 072 */
     DECLARE_ICOL(lruic, rt->lruc) DECLARE_ICOL(ic, -1)
     rt->lrui       = newIndex(c, iname, tmatch, lruic, NULL, 0, 0, 1, NULL,
-                              ic, 0, 0, 0, NULL, NULL, NULL); //Cant fail
+                              ic, ic, 0, 0, 0, NULL, NULL, NULL,
+                              NULL, NULL, 0, 0);               //Cant fail
     sdsfree(iname);                                            /*DESTROYED 072*/
     addReply(c, shared.ok);
 }
@@ -111,18 +117,13 @@ void createLruIndex(cli *c) {
          tmatch, lruc, lrud, c? c->LruColInSelect : 0);                      \
   if (apk) dumpAobj(printf, apk); else printf("\n");
 
-void updateLru(cli *c, int tmatch, aobj *apk, uchar *lruc, bool lrud) {
-    //DEBUG_UPDATE_LRU
-    if (!lrud)                return;
-    if (tmatch == -1)         return; /* from JOIN opSelectSort */
-    if (c->LruColInSelect)    return; /* NOTE: otherwise TOO cyclical */
+static void setLru(cli *c, int tmatch, aobj *apk, uchar *lruc, uint32 nltime) {
     r_tbl_t *rt     = &Tbl[tmatch];
     int      imatch = rt->lrui;
-    if (lruc) { //printf("updateLru: LRU -> lruc update\n");
+    if (lruc) { //printf("setLru: LRU -> lruc update\n");
         uint32  oltime = streamLRUToUInt(lruc);
-        uint32  nltime = getLru(tmatch);
         if (oltime == nltime) return;
-        overwriteLRUcol(lruc, nltime);
+        overwriteLRUcol(lruc, nltime); DELTA_TOUCH(getBtr(tmatch), apk)
         bt     *ibtr   = getIBtr(rt->lrui);
         int     pktyp  = rt->col[0].type;
         aobj ocol; initAobjInt(&ocol, oltime);
@@ -130,7 +131,7 @@ void updateLru(cli *c, int tmatch, aobj *apk, uchar *lruc, bool lrud) {
         upIndex(c, ibtr, apk, &ocol, apk, &ncol, pktyp, NULL, NULL, imatch);
         releaseAobj(&ocol); releaseAobj(&ncol);
     } else { /* LRU empty -> run "UPDATE tbl SET LRU = now WHERE PK = apk" */
-        char    lbuf[32]; snprintf(lbuf, 32, "%u", getLru(tmatch));
+        char    lbuf[32]; snprintf(lbuf, 32, "%u", nltime);
         MATCH_INDICES(tmatch)
         int     ncols  = rt->col_count;
         icol_t  chit[ncols]; ue_t    ue   [ncols]; lue_t le[ncols];
@@ -151,6 +152,18 @@ void updateLru(cli *c, int tmatch, aobj *apk, uchar *lruc, bool lrud) {
         release_uc(&uc);
     }
 }
+void updateLru(cli *c, int tmatch, aobj *apk, uchar *lruc, bool lrud) {
+    //DEBUG_UPDATE_LRU
+    if (!lrud)                return;
+    if (tmatch == -1)         return; /* from JOIN opSelectSort */
+    if (c->LruColInSelect)    return; /* NOTE: otherwise TOO cyclical */
+    uint32 nltime = getLru(tmatch);
+    if (lruc && streamLRUToUInt(lruc) == nltime) return;
+    if (server.alc.LruLfuFlush) { /* APPROX: index updated by cron */
+        queueAccess(&Tbl[tmatch].lrua, apk, nltime, 0); return;
+    }
+    setLru(c, tmatch, apk, lruc, nltime);
+}
 
 inline bool initLRUCS(int tmatch, icol_t *ics, int qcols) {
     r_tbl_t *rt = &Tbl[tmatch];
@@ -176,3 +189,125 @@ inline bool initLRUCS_J(jb_t *jb) {
     return 0;
 }
 
+// APPROX_LRU_LFU APPROX_LRU_LFU APPROX_LRU_LFU APPROX_LRU_LFU APPROX_LRU_LFU
+/* NOTE: "CONFIG SET lru_lfu_flush_ms N" (N > 0): SELECTs stop writing to the
+         LRU/LFU index btrees, each row hit records [PK -> newest LRU] in
+         rt->lrua & [PK -> number of accesses] in rt->lfua, flushAccesses()
+         applies them every N ms. The row keeps its INDEXED LRU|LFU value
+         until the flush, so CRUD index maintenance stays exact */
+static ulong NumAccFlushed = 0;
+
+unsigned int dictSdsHash(const void *key);
+int          dictSdsKeyCompare(void *privdata, const void *key1,
+                               const void *key2);
+void         dictSdsDestructor(void *privdata, void *val);
+
+static dictType accessDictType = {
+    dictSdsHash,                /* hash function */
+    NULL,                       /* key dup */
+    NULL,                       /* val dup */
+    dictSdsKeyCompare,          /* key compare */
+    dictSdsDestructor,          /* key destructor */
+    NULL                        /* val destructor */
+};
+
+static sds AccKey = NULL; /* lookup key: PK's raw bytes */
+sds setAccessKey(aobj *apk) {
+    if (!AccKey) AccKey = sdsempty();
+    if      C_IS_I(apk->type) AccKey = sdscpylen(AccKey, (char *)&apk->i,
+                                                 sizeof(uint32));
+    else if C_IS_L(apk->type) AccKey = sdscpylen(AccKey, (char *)&apk->l,
+                                                 sizeof(ulong));
+    else if C_IS_X(apk->type) AccKey = sdscpylen(AccKey, (char *)&apk->x,
+                                                 sizeof(uint128));
+    else if C_IS_F(apk->type) AccKey = sdscpylen(AccKey, (char *)&apk->f,
+                                                 sizeof(float));
+    else /* C_IS_S */         AccKey = sdscpylen(AccKey, apk->s, apk->len);
+    return AccKey;
+}
+void initAccessPK(aobj *apk, sds key, uchar pktyp) {
+    initAobj(apk);
+    if        C_IS_I(pktyp) {
+        uint32  i; memcpy(&i, key, sizeof(uint32));  initAobjInt  (apk, i);
+    } else if C_IS_L(pktyp) {
+        ulong   l; memcpy(&l, key, sizeof(ulong));   initAobjLong (apk, l);
+    } else if C_IS_X(pktyp) {
+        uint128 x; memcpy(&x, key, sizeof(uint128)); initAobjU128 (apk, x);
+    } else if C_IS_F(pktyp) {
+        float   f; memcpy(&f, key, sizeof(float));   initAobjFloat(apk, f);
+    } else {   /* C_IS_S */
+        initAobjString(apk, key, sdslen(key));
+    }
+}
+
+/* sum: LFU -> add accesses, LRU -> keep newest */
+void queueAccess(dict **acc, aobj *apk, ulong val, bool sum) {
+    if (!*acc) *acc = dictCreate(&accessDictType, NULL); // FREE ME 222
+    sds        key = setAccessKey(apk);
+    dictEntry *de  = dictFind(*acc, key);
+    if (!de) { ASSERT_OK(dictAdd(*acc, sdsdup(key), (void *)val)); return; }
+    ulong      ov  = (ulong)dictGetEntryVal(de);
+    de->val        = (void *)(sum ? ov + val : (val > ov) ? val : ov);
+}
+static ulong flushTableAccesses(int tmatch, bool lfu) {
+    r_tbl_t   *rt  = &Tbl[tmatch];
+    dict      *acc = lfu ? rt->lfua : rt->lrua;
+    if (!acc) return 0;
+    if (lfu) rt->lfua = NULL; else rt->lrua = NULL; /* DETACH: no re-queue */
+    cli       *c     = server.alc.RestClient;
+    bt        *btr   = getBtr(tmatch);
+    uchar      pktyp = rt->col[0].type;
+    int        cmatch = lfu ? rt->lfuc : rt->lruc;
+    ulong      n     = 0;
+    dictEntry *de;
+    dictIterator *di = dictGetIterator(acc);
+    while((de = dictNext(di))) {
+        aobj  apk; initAccessPK(&apk, dictGetEntryKey(de), pktyp);
+        ulong val  = (ulong)dictGetEntryVal(de);
+        dwm_t dwm  = btFindD(btr, &apk);
+        void *rrow = dwm.k;   /* DELETED or EVICTED since -> nothing to do */
+        if (rrow && !IS_GHOST(btr, rrow)) {
+            uint32 clen; uchar rflag;
+            uchar *col = getColData(rrow, cmatch, &clen, &rflag);
+            if (!clen) col = NULL;
+            if (lfu) {
+                setLfu(c, tmatch, &apk, col,
+                       col ? streamLFUToULong(col) + val : val);
+            } else if (!col || streamLRUToUInt(col) < (uint32)val) {
+                setLru(c, tmatch, &apk, col, (uint32)val);
+            }
+            n++;
+        }
+        releaseAobj(&apk);
+    } dictReleaseIterator(di);
+    dictRelease(acc);                                        // FREED 222
+    return n;
+}
+void flushAccesses() {
+    for (int tmatch = 0; tmatch < Num_tbls; tmatch++) {
+        r_tbl_t *rt = &Tbl[tmatch];
+        if (!rt->name) continue;
+        NumAccFlushed += flushTableAccesses(tmatch, 0);
+        NumAccFlushed += flushTableAccesses(tmatch, 1);
+    }
+}
+void dropAccesses(r_tbl_t *rt) {
+    if (rt->lrua) { dictRelease(rt->lrua); rt->lrua = NULL; } // FREED 222
+    if (rt->lfua) { dictRelease(rt->lfua); rt->lfua = NULL; } // FREED 222
+}
+int accessFlushTimeProc(struct aeEventLoop *eventLoop, lolo id, void *cdata) {
+    (void)eventLoop; (void)id; (void)cdata; // compiler warnings
+    flushAccesses(); /* also drains what was queued before "SET ... 0" */
+    return server.alc.LruLfuFlush ? server.alc.LruLfuFlush : 100;
+}
+sds genAccessInfoString(sds info) {
+    ulong pending = 0;
+    for (int tmatch = 0; tmatch < Num_tbls; tmatch++) {
+        r_tbl_t *rt = &Tbl[tmatch];
+        if (!rt->name) continue;
+        if (rt->lrua) pending += dictSize(rt->lrua);
+        if (rt->lfua) pending += dictSize(rt->lfua);
+    }
+    return sdscatprintf(info, "lru_lfu_pending:%lu\r\nlru_lfu_flushed:%lu\r\n",
+                        pending, NumAccFlushed);
+}
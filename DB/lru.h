@@ -41,6 +41,15 @@ uint32 getLru(int tmatch);
 void createLruIndex(cli *c);
 void updateLru     (cli *c, int tmatch, aobj *apk, uchar *lruc, bool lrud);
 
+/* APPROX LRU/LFU: SELECT row hits queued, index updated by accessFlushTimeProc */
+sds  setAccessKey       (aobj *apk);              /* PK's raw bytes */
+void initAccessPK       (aobj *apk, sds key, uchar pktyp);
+void queueAccess        (dict **acc, aobj *apk, ulong val, bool sum);
+void flushAccesses      ();
+void dropAccesses       (r_tbl_t *rt);
+int  accessFlushTimeProc(struct aeEventLoop *eventLoop, lolo id, void *cdata);
+sds  genAccessInfoString(sds info);
+
 bool initLRUCS  (int tmatch, icol_t *ics, int qcols);
 bool initL_LRUCS(int tmatch, list *cs);
 bool initLRUCS_J(jb_t *jb);
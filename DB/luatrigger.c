@@ -150,8 +150,8 @@ static void luaTAdd(cli    *c,    sds    trname, int tmatch,
     }
     if (imatch == -1) {
         DECLARE_ICOL(ic, -1)
-        newIndex(c, trname, tmatch, ic, NULL, 0, 0, 0, luat, ic,
-                 0, 0, 0, NULL, NULL, NULL); //Cant fail
+        newIndex(c, trname, tmatch, ic, NULL, 0, 0, 0, luat, ic, ic,
+                 0, 0, 0, NULL, NULL, NULL, NULL, NULL, 0, 0); //Cant fail
     }
     addReply(c, shared.ok);
     return;
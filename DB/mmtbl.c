@@ -0,0 +1,386 @@
+/*
+ * This file implements read-only MMAP (page-backed) SQL tables
+ *
+
+AGPL License
+
+Copyright (c) 2011 Russell Sullivan <jaksprats AT gmail DOT com>
+ALL RIGHTS RESERVED
+
+   This file is part of ALCHEMY_DATABASE
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Affero General Public License as
+    published by the Free Software Foundation, either version 3 of the
+    License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Affero General Public License for more details.
+
+    You should have received a copy of the GNU Affero General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#define _DEFAULT_SOURCE /* fileno() */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <errno.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "redis.h"
+
+#include "btreepriv.h"
+#include "bt.h"
+#include "bt_iterator.h"
+#include "stream.h"
+#include "query.h"
+#include "common.h"
+#include "mmtbl.h"
+
+extern r_tbl_t *Tbl;
+
+/* MMAP TABLES: "DUMP tbl TO MMAP file" writes the table's ROWs in key order
+     into fixed-size pages, "CREATE TABLE tbl FROM MMAP file" maps the file
+     (PROT_READ, MAP_SHARED) & attaches it as a read-only table -> no ROW is
+     deserialised into a bt, "loading" a multi-GB lookup table is an mmap().
+     btFind() & the bt_iterator.c iterators binary-search the sparse index,
+     then the page's ROW offsets, the OS pages the file in & out.
+   FILE:   [HEADER (padded to psize)] [PAGE]* [SPARSE INDEX]
+   HEADER: mmh_t [ctype(1) nlen(4) cname(nlen)]*ncols
+   PAGE:   [n(4)] [rofst(4)]*n [ROW (8-byte aligned)]*n (padded to psize),
+           a ROW bigger than a page gets a page of N*psize
+   ROW:    the bt's slot bytes (as rdbSaveAllRows()): the stream (NORM_BT),
+           the key (OTHER_BT), UU: the (void *) -> bt cmp(), parseStream() &
+           convertStream2Key() run on the mapping unchanged
+   SPARSE INDEX: a mmpi_t [ofst, frow, nrows] per page
+   NOTE: DUMP writes "file.tmp" & rename()s it -> live mappings of "file"
+         stay valid. RDB, AOF & slaves replay the attach by the file's path */
+
+#define MMT_MAGIC     "ALCMMT01"
+#define MMT_PAGE_SIZE 4096
+#define MMT_ALIGN(x)  ((((x) + 7) / 8) * 8)
+
+typedef struct mmt_header {
+    char     magic[8];
+    uint32   psize;
+    uint32   npages;
+    uint32   nrows;
+    uint32   ncols;
+    ulong    dofst; /* first PAGE   */
+    ulong    iofst; /* SPARSE INDEX */
+    ulong    fsize;
+    uchar    ktype;
+    uchar    pad;
+    ushort16 bflag;
+    uchar    pad2[4];
+} mmh_t;
+
+// READ READ READ READ READ READ READ READ READ READ READ READ READ READ
+static inline uchar *pageAddr(mmt_t *mm, uint32 p) {
+    return mm->base + mm->pidx[p].ofst;
+}
+static inline void *pageRow(bt *btr, uchar *pg, uint32 i) {
+    uint32 *rofst = (uint32 *)(pg + sizeof(uint32));
+    uchar  *addr  = pg + rofst[i];
+    if UU(btr) { void *v; memcpy(&v, addr, sizeof(void *)); return v; }
+    return addr; /* NORM_BT: the stream, OTHER_BT: the key */
+}
+static uint32 rowPage(mmt_t *mm, long r, uint32 hint) {
+    if (hint < mm->npages) {
+        mmpi_t *pi = &mm->pidx[hint];
+        if (r >= pi->frow && r < (long)(pi->frow + pi->nrows)) return hint;
+    }
+    uint32 lo = 0, hi = mm->npages - 1;       /* last page w/ (frow <= r) */
+    while (lo < hi) {
+        uint32 mid = (lo + hi + 1) / 2;
+        if (mm->pidx[mid].frow <= r) lo = mid; else hi = mid - 1;
+    }
+    return lo;
+}
+/* NOTE: hint: [IN,OUT] last page used (iterators walk ROWs of one page) */
+void *mmtRow(mmt_t *mm, bt *btr, long r, uint32 *hint) {
+    if (r < 0 || r >= (long)mm->nrows) return NULL;
+    uint32 p = rowPage(mm, r, hint ? *hint : 0); if (hint) *hint = p;
+    return pageRow(btr, pageAddr(mm, p), (uint32)(r - mm->pidx[p].frow));
+}
+/* RETURNS: asc: 1st ROW >= bkey, desc: last ROW <= bkey, -1: no such ROW */
+long mmtSeek(mmt_t *mm, bt *btr, void *bkey, bool asc) {
+    if (!mm->nrows) return -1;
+    long lo = 0, hi = (long)mm->npages - 1, p = -1;
+    while (lo <= hi) {                 /* last page w/ (1st ROW <= bkey) */
+        long mid = (lo + hi) / 2;
+        if (btr->cmp(bkey, pageRow(btr, pageAddr(mm, mid), 0)) >= 0) {
+            p = mid; lo = mid + 1;
+        } else hi = mid - 1;
+    }
+    if (p == -1) return asc ? 0 : -1;                   /* bkey < MIN */
+    mmpi_t *pi = &mm->pidx[p];
+    uchar  *pg = pageAddr(mm, p);
+    lo = 0; hi = pi->nrows;      /* 1st ROW: asc: (>= bkey) desc: (> bkey) */
+    while (lo < hi) {
+        long mid = (lo + hi) / 2;
+        int  x   = btr->cmp(bkey, pageRow(btr, pg, mid));
+        if (asc ? (x <= 0) : (x < 0)) hi = mid; else lo = mid + 1;
+    }
+    long r = (long)pi->frow + lo;
+    if (asc) return (r < (long)mm->nrows) ? r : -1;
+    return r - 1;
+}
+void *mmtFind(mmt_t *mm, bt *btr, void *bkey) {
+    long  r = mmtSeek(mm, btr, bkey, 1); if (r == -1) return NULL;
+    void *e = mmtRow(mm, btr, r, NULL);
+    return btr->cmp(bkey, e) ? NULL : e;
+}
+void *mmtMin(mmt_t *mm, bt *btr) { return mmtRow(mm, btr, 0, NULL); }
+void *mmtMax(mmt_t *mm, bt *btr) {
+    return mmtRow(mm, btr, (long)mm->nrows - 1, NULL);
+}
+
+// ATTACH ATTACH ATTACH ATTACH ATTACH ATTACH ATTACH ATTACH ATTACH ATTACH
+void mmtClose(mmt_t *mm) {
+    if (!mm) return;
+    if (mm->base) munmap(mm->base, mm->size);            // UNMAPPED 242
+    if (mm->cnames) {
+        for (uint32 i = 0; i < mm->ncols; i++) {
+            if (mm->cnames[i]) sdsfree(mm->cnames[i]);
+        }
+        free(mm->cnames);                                // FREED 243
+    }
+    if (mm->ctypes) free(mm->ctypes);                    // FREED 243
+    sdsfree(mm->fname);                                  // FREED 241
+    free(mm);                                            // FREED 240
+}
+static mmt_t *openFail(mmt_t *mm, sds *err, char *why) {
+    *err = sdscatprintf(sdsempty(), "-ERR: MMAP: %s: %s\r\n", mm->fname, why);
+    mmtClose(mm); return NULL;
+}
+static bool parseHeader(mmt_t *mm) {
+    mmh_t *h = (mmh_t *)mm->base;
+    if (memcmp(h->magic, MMT_MAGIC, sizeof(h->magic)) ||
+        h->fsize != mm->size || !h->psize || h->ncols < 2 ||
+        h->dofst < sizeof(mmh_t) || h->dofst > h->iofst ||
+        h->iofst + (ulong)h->npages * sizeof(mmpi_t) != h->fsize) return 0;
+    mm->psize  = h->psize; mm->npages = h->npages; mm->nrows = h->nrows;
+    mm->ktype  = h->ktype; mm->bflag  = h->bflag;
+    mm->pidx   = (mmpi_t *)(mm->base + h->iofst);
+    mm->ctypes = malloc(h->ncols);                       // FREE ME 243
+    mm->cnames = malloc(sizeof(sds) * h->ncols);         // FREE ME 243
+    bzero(mm->cnames, sizeof(sds) * h->ncols);
+    mm->ncols  = h->ncols;
+    uchar *p   = mm->base + sizeof(mmh_t), *end = mm->base + h->dofst;
+    for (uint32 i = 0; i < mm->ncols; i++) {
+        uint32 nlen;
+        if (p + 1 + sizeof(uint32) > end)                       return 0;
+        mm->ctypes[i] = *p; memcpy(&nlen, p + 1, sizeof(uint32));
+        p            += 1 + sizeof(uint32);
+        if (!nlen || nlen > (ulong)(end - p))                   return 0;
+        if (mm->ctypes[i] < COL_TYPE_INT ||
+            mm->ctypes[i] > COL_TYPE_U128)                      return 0;
+        mm->cnames[i] = sdsnewlen(p, nlen); p += nlen;
+    }
+    if (mm->ktype != mm->ctypes[0])                             return 0;
+    ulong frow = 0;
+    for (uint32 i = 0; i < mm->npages; i++) {
+        mmpi_t *pi = &mm->pidx[i];
+        if (pi->ofst < h->dofst || pi->ofst + mm->psize > h->iofst ||
+            pi->frow != frow    || !pi->nrows)                  return 0;
+        frow += pi->nrows;
+    }
+    return frow == mm->nrows;
+}
+mmt_t *mmtOpen(sds fname, sds *err) {
+    mmt_t *mm = malloc(sizeof(mmt_t)); bzero(mm, sizeof(mmt_t)); //FREE ME 240
+    mm->fname = sdsdup(fname);                           // FREE ME 241
+    int fd    = open(fname, O_RDONLY);
+    if (fd == -1) return openFail(mm, err, strerror(errno));
+    struct stat st;
+    if (fstat(fd, &st) == -1 || st.st_size < (off_t)sizeof(mmh_t)) {
+        close(fd); return openFail(mm, err, "not an MMAP table file");
+    }
+    mm->size   = (size_t)st.st_size;
+    void *base = mmap(NULL, mm->size, PROT_READ, MAP_SHARED, fd, 0); //UNMAP242
+    close(fd);                               /* the mapping holds the file */
+    if (base == MAP_FAILED) return openFail(mm, err, strerror(errno));
+    mm->base   = base;
+    if (!parseHeader(mm)) return openFail(mm, err, "not an MMAP table file");
+    if (mm->npages) { /* every lookup starts in the SPARSE INDEX */
+        ulong  pgsz = (ulong)sysconf(_SC_PAGESIZE);
+        uchar *ibeg = (uchar *)((ulong)mm->pidx & ~(pgsz - 1));
+        madvise(ibeg, (mm->base + mm->size) - ibeg, MADV_WILLNEED);
+    }
+    return mm;
+}
+/* NOTE: the bt stays empty, numkeys is the only thing set on it */
+bool mmtAttach(int tmatch, mmt_t *mm) {
+    r_tbl_t *rt  = &Tbl[tmatch];
+    bt      *btr = rt->btr;
+    if (btr->numkeys || btr->s.ktype != mm->ktype ||
+        btr->s.bflag != mm->bflag)                              return 0;
+    rt->mm       = mm;
+    btr->numkeys = mm->nrows;
+    return 1;
+}
+void mmtDropTable(r_tbl_t *rt) {
+    mmtClose(rt->mm); rt->mm = NULL;
+}
+
+// DUMP DUMP DUMP DUMP DUMP DUMP DUMP DUMP DUMP DUMP DUMP DUMP DUMP DUMP
+typedef struct mmt_writer {
+    FILE   *fp;
+    uint32  psize;
+    ulong   ofst;  /* next page's file offset */
+    uint32  nrows; /* ROWs in flushed pages   */
+    uint32  n;     /* current page: ROWs      */
+    uint32 *rofst; /* current page: ROW ofsts */
+    uint32  rmax;
+    uchar  *rbuf;  /* current page: ROWs      */
+    uint32  rlen;
+    uint32  rsize;
+    uchar  *pbuf;  /* page being written      */
+    ulong   psz;
+    mmpi_t *pidx;  /* SPARSE INDEX            */
+    uint32  npages;
+    uint32  pmax;
+} mmw_t;
+
+static uchar *zeroedPage(mmw_t *w, ulong plen) {
+    if (plen > w->psz) {
+        w->pbuf = realloc(w->pbuf, plen); w->psz = plen; // FREE ME 245
+    }
+    bzero(w->pbuf, plen); return w->pbuf;
+}
+static bool writeZeroed(mmw_t *w, uchar *src, ulong len, ulong plen) {
+    uchar *pg = zeroedPage(w, plen); if (len) memcpy(pg, src, len);
+    return fwrite(pg, plen, 1, w->fp) != 0;
+}
+static bool flushPage(mmw_t *w) {
+    if (!w->n) return 1;
+    uint32 hsz  = MMT_ALIGN(sizeof(uint32) * (w->n + 1));
+    ulong  plen = ((hsz + w->rlen + w->psize - 1) / w->psize) * w->psize;
+    uchar *pg   = zeroedPage(w, plen);
+    memcpy(pg, &w->n, sizeof(uint32));
+    for (uint32 i = 0; i < w->n; i++) {
+        uint32 ofst = hsz + w->rofst[i];
+        memcpy(pg + sizeof(uint32) * (i + 1), &ofst, sizeof(uint32));
+    }
+    memcpy(pg + hsz, w->rbuf, w->rlen);
+    if (fwrite(pg, plen, 1, w->fp) == 0)                        return 0;
+    if (w->npages == w->pmax) {
+        w->pmax = w->pmax ? w->pmax * 2 : 64;
+        w->pidx = realloc(w->pidx, sizeof(mmpi_t) * w->pmax); // FREE ME 245
+    }
+    mmpi_t *pi = &w->pidx[w->npages++];
+    pi->ofst   = w->ofst; pi->frow = w->nrows; pi->nrows = w->n;
+    w->ofst   += plen;    w->nrows += w->n;
+    w->n       = 0;       w->rlen   = 0;
+    return 1;
+}
+static bool addRow(mmw_t *w, uchar *row, uint32 rlen) {
+    uint32 need = MMT_ALIGN(sizeof(uint32) * (w->n + 2)) + w->rlen + rlen;
+    if (w->n && need > w->psize && !flushPage(w))               return 0;
+    if (w->n == w->rmax) {
+        w->rmax  = w->rmax ? w->rmax * 2 : 64;
+        w->rofst = realloc(w->rofst, sizeof(uint32) * w->rmax); // FREE ME 245
+    }
+    uint32 alen = MMT_ALIGN(rlen);
+    if (w->rlen + alen > w->rsize) {
+        w->rsize = MMT_ALIGN(w->rlen + alen) * 2;
+        w->rbuf  = realloc(w->rbuf, w->rsize);           // FREE ME 245
+    }
+    memcpy(w->rbuf + w->rlen, row, rlen);
+    bzero (w->rbuf + w->rlen + rlen, alen - rlen);
+    w->rofst[w->n++] = w->rlen; w->rlen += alen;
+    return 1;
+}
+static bool writeHeader(mmw_t *w, r_tbl_t *rt, bt *btr, ulong dofst) {
+    mmh_t h; bzero(&h, sizeof(mmh_t));
+    memcpy(h.magic, MMT_MAGIC, sizeof(h.magic));
+    h.psize = w->psize;   h.npages = w->npages;  h.nrows = w->nrows;
+    h.ncols = rt->col_count;
+    h.dofst = dofst;      h.iofst  = w->ofst;
+    h.fsize = w->ofst + (ulong)w->npages * sizeof(mmpi_t);
+    h.ktype = btr->s.ktype; h.bflag = btr->s.bflag;
+    sds s   = sdsnewlen(&h, sizeof(mmh_t));              // FREE ME 246
+    for (int i = 0; i < rt->col_count; i++) {
+        uint32 nlen = sdslen(rt->col[i].name);
+        s = sdscatlen(s, &rt->col[i].type, 1);
+        s = sdscatlen(s, &nlen, sizeof(uint32));
+        s = sdscatlen(s, rt->col[i].name, nlen);
+    }
+    bool ok = (fseek(w->fp, 0, SEEK_SET) == 0) &&
+              writeZeroed(w, (uchar *)s, sdslen(s), dofst);
+    sdsfree(s);                                          // FREED 246
+    return ok;
+}
+static ulong headerSize(r_tbl_t *rt, uint32 psize) {
+    ulong hlen = sizeof(mmh_t);
+    for (int i = 0; i < rt->col_count; i++) {
+        hlen += 1 + sizeof(uint32) + sdslen(rt->col[i].name);
+    }
+    return ((hlen + psize - 1) / psize) * psize;
+}
+static bool writeTable(mmw_t *w, r_tbl_t *rt, bt *btr) {
+    ulong dofst = headerSize(rt, w->psize);
+    if (!writeZeroed(w, NULL, 0, dofst))                        return 0;
+    w->ofst     = dofst;
+    bool ok     = 1;
+    if (btr->numkeys) {
+        btEntry *be;
+        btSIter *bi = btGetFullRangeIter(btr, 1, NULL);
+        while ((be = btRangeNext(bi, 1))) {
+            uchar *stream  = be->stream;
+            uint32 ssize   = getStreamRowSize(btr, stream);
+            uchar *wstream = UU(btr) ? (uchar *)&stream : stream;
+            if (!addRow(w, wstream, ssize)) { ok = 0; break; }
+        } btReleaseRangeIterator(bi);
+    }
+    if (!ok || !flushPage(w))                                   return 0;
+    if (w->npages &&
+        fwrite(w->pidx, sizeof(mmpi_t) * w->npages, 1, w->fp) == 0) return 0;
+    if (!writeHeader(w, rt, btr, dofst))                        return 0;
+    return fflush(w->fp) == 0 && fsync(fileno(w->fp)) == 0;
+}
+#define MMT_DUMP_SUCCESS \
+  "SUCCESS: MMAPED: %u rows in %u pages (%lu bytes) to file: %s"
+void mmtDumpTable(cli *c, int tmatch, sds fname) {
+    r_tbl_t *rt  = &Tbl[tmatch];
+    bt      *btr = rt->btr;
+    if (rt->dirty || btr->dirty || rt->lrud || rt->lfu || rt->haslo) {
+        addReply(c, shared.mmt_dump);                                 return;
+    }
+    sds   tname = sdscatprintf(sdsempty(), "%s.tmp", fname); // FREE ME 244
+    FILE *fp    = fopen(tname, "w");
+    if (!fp) {
+        addReplySds(c, sdscatprintf(sdsempty(),
+                                    "-ERR failed to open: %s\r\n", tname));
+        sdsfree(tname);                                  // FREED 244
+        return;
+    }
+    mmw_t w; bzero(&w, sizeof(mmw_t));
+    w.fp    = fp; w.psize = MMT_PAGE_SIZE; errno = 0;
+    bool ok = writeTable(&w, rt, btr);
+    if (fclose(fp))                         ok = 0;
+    if (ok && rename(tname, fname) == -1)   ok = 0;
+    if (ok) {
+        ulong fsize = w.ofst + (ulong)w.npages * sizeof(mmpi_t);
+        sds   s     = sdscatprintf(sdsempty(), MMT_DUMP_SUCCESS,
+                                   w.nrows, w.npages, fsize, fname);
+        addReplyMultiBulkLen(c, 1); addReplyBulkCString(c, s); sdsfree(s);
+    } else {
+        addReplySds(c, sdscatprintf(sdsempty(),
+                                    "-ERR: DUMP TO MMAP failed: %s: %s\r\n",
+                                    fname,
+                                    errno ? strerror(errno) : "write error"));
+        unlink(tname);
+    }
+    sdsfree(tname);                                      // FREED 244
+    free(w.rofst); free(w.rbuf); free(w.pbuf); free(w.pidx); // FREED 245
+}
@@ -0,0 +1,80 @@
+/*
+ * This file implements read-only MMAP (page-backed) SQL tables
+ *
+
+AGPL License
+
+Copyright (c) 2011 Russell Sullivan <jaksprats AT gmail DOT com>
+ALL RIGHTS RESERVED
+
+   This file is part of ALCHEMY_DATABASE
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Affero General Public License as
+    published by the Free Software Foundation, either version 3 of the
+    License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Affero General Public License for more details.
+
+    You should have received a copy of the GNU Affero General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __ALC_MMTBL__H
+#define __ALC_MMTBL__H
+
+#include "redis.h"
+
+#include "btreepriv.h"
+#include "query.h"
+#include "common.h"
+
+/* NOTE: only TABLE BTs are MMAP-backed, a TABLE's btr->s.num is its tmatch,
+         users of MMT() must see "extern r_tbl_t *Tbl" */
+#define MMT(btr) \
+  (((btr)->s.btype == BTREE_TABLE) ? Tbl[(btr)->s.num].mm : NULL)
+
+#define MMT_RO_CHECK_OR_REPLY(TMATCH, RET)   \
+    if (Tbl[TMATCH].mm) {                    \
+        addReply(c, shared.mmt_readonly);    \
+        return RET;                          \
+    }
+
+typedef struct mmt_page_index { /* SPARSE INDEX: one entry per page */
+    ulong  ofst;  /* page's file offset */
+    uint32 frow;  /* page's first ROW   */
+    uint32 nrows; /* page's ROWs        */
+} mmpi_t;
+
+typedef struct mmt {
+    sds       fname;
+    uchar    *base;   /* PROT_READ mapping of the whole file */
+    size_t    size;
+    uint32    psize;
+    uint32    npages;
+    uint32    nrows;
+    uchar     ktype;
+    ushort16  bflag;
+    uint32    ncols;
+    uchar    *ctypes;
+    sds      *cnames;
+    mmpi_t   *pidx;   /* in the mapping */
+} mmt_t;
+
+mmt_t *mmtOpen     (sds fname, sds *err);
+void   mmtClose    (mmt_t *mm);
+bool   mmtAttach   (int tmatch, mmt_t *mm);
+void   mmtDropTable(r_tbl_t *rt);
+
+void  *mmtRow      (mmt_t *mm, bt *btr, long r, uint32 *hint);
+long   mmtSeek     (mmt_t *mm, bt *btr, void *bkey, bool asc);
+void  *mmtFind     (mmt_t *mm, bt *btr, void *bkey);
+void  *mmtMin      (mmt_t *mm, bt *btr);
+void  *mmtMax      (mmt_t *mm, bt *btr);
+
+void   mmtDumpTable(cli *c, int tmatch, sds fname);
+
+#endif /* __ALC_MMTBL__H */
@@ -29,6 +29,7 @@ ALL RIGHTS RESERVED
 #include <strings.h>
 #include <unistd.h>
 #include <float.h>
+#include <errno.h>
 #include <assert.h>
 
 #include "xdb_hooks.h"
@@ -54,74 +55,118 @@ uint32 OB_nob   = 0;                 // TODO push into cswc_t
 bool   OB_asc  [MAX_ORDER_BY_COLS];  // TODO push into cswc_t
 uchar  OB_ctype[MAX_ORDER_BY_COLS];  // TODO push into cswc_t
 
+// SPILL GLOBALS (ORDER BY bigger than sort_memory_budget -> external sort)
+static list   *OB_runs = NULL;       /* sorted runs spilled to disk (FILE *) */
+static size_t  OB_mem  = 0;          /* memory held by the in-memory run     */
+
 static float  Fmin = FLT_MIN;
 #define FSIZE sizeof(float)
 
-static int intOrderBySort(const void *s1, const void *s2) {
-    return (long)s1 - (long)s2;
-}
-static int intOrderByRevSort(const void *s1, const void *s2) {
-    return (long)s2 - (long)s1;
-}
-static int ulongOrderBySort(const void *s1, const void *s2) {
-    return ((ulong)s1 == (ulong)s2)  ? 0 : 
-           (((ulong)s1 >  (ulong)s2) ? 1 : -1);
-}
-static int ulongOrderByRevSort(const void *s1, const void *s2) {
-    return ((ulong)s1 == (ulong)s2)  ? 0 : 
-           (((ulong)s1 >  (ulong)s2) ? -1 : 1);
-}
-static int u128OrderBySort(const void *s1, const void *s2) {
-    uint128 x1 = *((uint128 *)s1); uint128 x2 = *((uint128 *)s2);
-    return x1 == x2 ? 0 : (x1 > x2) ? 1 : -1;
-}
-static int u128OrderByRevSort(const void *s1, const void *s2) {
-    uint128 x1 = *((uint128 *)s1); uint128 x2 = *((uint128 *)s2);
-    return x1 == x2 ? 0 : (x1 > x2) ? -1 : 1;
+/* NORMALISED_KEYS: all ORDER BY columns of a row are encoded into a single
+   byte string (ob->nkey) that sorts correctly w/ memcmp()
+     INT,LONG,U128 -> big-endian            FLOAT -> IEEE bits (sign fixed)
+     TEXT          -> [0x00] (NULL) or [0x01 bytes 0x00]
+     LUAO          -> big-endian (unsigned, as numbers from Lua)
+   DESC columns have their bytes inverted */
+
+static uint32 encodeObKeyBE(uchar *b, uint128 x, int nbytes) {
+    for (int i = nbytes - 1; i >= 0; i--) { b[i] = (uchar)(x & 0xFF); x >>= 8; }
+    return nbytes;
 }
-static int floatOrderBySort(const void *s1, const void *s2) {
-    float f1, f2;
-    memcpy(&f1, &s1, FSIZE); memcpy(&f2, &s2, FSIZE);
-    float   f  = f1 - f2;
-    return (f == 0.0) ? 0 : ((f > 0.0) ? 1: -1);
+static uint32 getSizeObKey(void *key, uchar ctype) {
+    if      C_IS_I(ctype) return 4;
+    else if C_IS_F(ctype) return FSIZE;
+    else if C_IS_X(ctype) return 16;
+    else if C_IS_S(ctype) return key ? strlen(key) + 2 : 1;
+    else /* L,O */        return 8;
 }
-static int floatOrderByRevSort(const void *s1, const void *s2) {
-    float f1, f2;
-    memcpy(&f1, &s1, FSIZE); memcpy(&f2, &s2, FSIZE);
-    float   f  = f2 - f1;
-    return (f == 0.0) ? 0 : ((f > 0.0) ? 1: -1);
+static uint32 encodeObKey(uchar *b, void *key, uchar ctype, bool asc) {
+    uint32 len;
+    if        C_IS_I(ctype) {
+        len = encodeObKeyBE(b, (uint32)(long)key, 4);
+    } else if C_IS_F(ctype) {
+        uint32 u; memcpy(&u, &key, FSIZE);
+        u   = (u & 0x80000000) ? ~u : (u | 0x80000000);
+        len = encodeObKeyBE(b, u, 4);
+    } else if C_IS_X(ctype) {
+        len = encodeObKeyBE(b, key ? *((uint128 *)key) : 0, 16);
+    } else if C_IS_S(ctype) {
+        if (!key) { b[0] = 0; len = 1; }
+        else {
+            uint32 slen = strlen(key);
+            b[0] = 1; memcpy(b + 1, key, slen); b[slen + 1] = 0;
+            len  = slen + 2;
+        }
+    } else /* L,O */ len = encodeObKeyBE(b, (ulong)key, 8);
+    if (!asc) for (uint32 i = 0; i < len; i++) b[i] = ~b[i];
+    return len;
 }
-static int stringOrderBySort(const void *s1, const void *s2) {
-    char *c1 = (char *)s1; char *c2 = (char *)s2;
-    return (c1 && c2) ? strcmp(c1, c2) : c1 - c2; /* strcmp() not ok w/ NULLs */
+static void free_obsl_key(obsl_t *ob, int i) {
+    if (C_IS_S(OB_ctype[i]) || C_IS_X(OB_ctype[i])) {
+        if (ob->keys[i]) { free(ob->keys[i]); ob->keys[i] = NULL; } //FREED 003
+    }
 }
-static int stringOrderByRevSort(const void *s1, const void *s2) {
-    char *c1 = (char *)s1; char *c2 = (char *)s2;
-    return (c1 && c2) ? strcmp(c2, c1) : c2 - c1; /* strcmp() not ok w/ NULLs */
+/* NOTE: frees the per-column keys, from here on ONLY ob->nkey is valid */
+void normaliseObKey(obsl_t *ob) {
+    uint32 nklen = 0;
+    for (uint32 i = 0; i < OB_nob; i++) {
+        nklen += getSizeObKey(ob->keys[i], OB_ctype[i]);
+    }
+    uchar  *nkey = malloc(nklen ? nklen : 1);            /* FREE ME 179 */
+    uint32  slot = 0;
+    for (uint32 i = 0; i < OB_nob; i++) {
+        slot += encodeObKey(nkey + slot, ob->keys[i], OB_ctype[i], OB_asc[i]);
+        free_obsl_key(ob, i);
+    }
+    if (ob->nkey) free(ob->nkey);
+    ob->nkey = nkey; ob->nklen = nklen;
 }
 
-typedef int ob_cmp(const void *, const void *);
-/* slot = OB_ctype[j] * 2 + OB_asc[j] */
-ob_cmp (*OB_cmp[14]) = { NULL,                 NULL,               // CTYPE: 0
-                         intOrderByRevSort,    intOrderBySort,     // CTYPE: 1
-                         ulongOrderByRevSort,  ulongOrderBySort,   // CTYPE: 2
-                         stringOrderByRevSort, stringOrderBySort,  // CTYPE: 3
-                         floatOrderByRevSort,  floatOrderBySort,   // CTYPE: 4
-                         u128OrderByRevSort,   u128OrderBySort,    // CTYPE: 5
-                         ulongOrderByRevSort,  ulongOrderBySort};  // CTYPE: 6
-
 int genOBsort(const void *s1, const void *s2) {
-    int     ret = 0;
     obsl_t *o1  = *(obsl_t **)s1; obsl_t *o2  = *(obsl_t **)s2;
-    for (uint32 j = 0; j < OB_nob; j++) {
-        ob_cmp *compar = OB_cmp[OB_ctype[j] * 2 + OB_asc[j]];
-        ret            = (*compar)(o1->keys[j], o2->keys[j]);
-        if (ret) return ret; /* return the first non-zero compar result */
+    uint32  len = (o1->nklen < o2->nklen) ? o1->nklen : o2->nklen;
+    int     ret = memcmp(o1->nkey, o2->nkey, len);
+    if (ret) return ret;
+    return (o1->nklen == o2->nklen) ? 0 : ((o1->nklen < o2->nklen) ? -1 : 1);
+}
+
+/* MSD radix sort on nkey bytes, small buckets & deep prefixes use qsort() */
+#define OB_RADIX_MIN   64   /* vectors smaller than this are qsort()ed  */
+#define OB_RADIX_DEPTH 32   /* common-prefix bytes before giving up     */
+static void radixSortOB(obsl_t **v, obsl_t **tmp, long n, uint32 d) {
+    if (n < OB_RADIX_MIN || d >= OB_RADIX_DEPTH) {
+        qsort(v, n, sizeof(obsl_t *), genOBsort); return;
+    }
+    long cnt[257]; long pos[257];
+    bzero(cnt, sizeof(cnt));
+    for (long i = 0; i < n; i++) { /* bucket 0: key ended (sorts first) */
+        cnt[(v[i]->nklen > d) ? v[i]->nkey[d] + 1 : 0]++;
+    }
+    pos[0] = 0;
+    for (int b = 1; b < 257; b++) pos[b] = pos[b - 1] + cnt[b - 1];
+    for (long i = 0; i < n; i++) {
+        int b = (v[i]->nklen > d) ? v[i]->nkey[d] + 1 : 0;
+        tmp[pos[b]++] = v[i];
+    }
+    memcpy(v, tmp, sizeof(obsl_t *) * n);
+    long strt = cnt[0];
+    for (int b = 1; b < 257; b++) {
+        if (cnt[b] > 1) radixSortOB(v + strt, tmp, cnt[b], d + 1);
+        strt += cnt[b];
     }
-    return ret;
+}
+
+static void releaseOBruns() {
+    if (!OB_runs) return;
+    listNode *ln;
+    listIter *li = listGetIterator(OB_runs, AL_START_HEAD);
+    while((ln = listNext(li))) fclose(ln->value);
+    listReleaseIterator(li);
+    listRelease(OB_runs); OB_runs = NULL;
 }
 
 list *initOBsort(bool qed, wob_t *wb, bool rcrud) {
+    releaseOBruns(); OB_mem = 0;
     OB_nob = wb->nob;
     if (OB_nob) {
         for (uint32 i = 0; i < OB_nob; i++) {
@@ -135,8 +180,12 @@ list *initOBsort(bool qed, wob_t *wb, bool rcrud) {
     } else                                               return NULL;
 }
 void releaseOBsort(list *ll) {
+    releaseOBruns(); OB_mem = 0;
     OB_nob = 0; if (ll) listRelease(ll);                 // DESTROYED 009
 }
+void reverseOBsort() { /* DELETE consumes its ORDER BY back to front */
+    for (uint32 i = 0; i < OB_nob; i++) OB_asc[i] = !OB_asc[i];
+}
 
 obsl_t *create_obsl(void *row, uint32 nob) {
     obsl_t *ob = (obsl_t *)malloc(sizeof(obsl_t));       /* FREE ME 001 */
@@ -145,11 +194,6 @@ obsl_t *create_obsl(void *row, uint32 nob) {
     ob->keys   = malloc(sizeof(void *) * nob);           /* FREE ME 006 */
     return ob;
 }
-static void free_obsl_key(obsl_t *ob, int i) {
-    if (C_IS_S(OB_ctype[i]) || C_IS_X(OB_ctype[i])) {
-        if (ob->keys[i]) { free(ob->keys[i]); ob->keys[i] = NULL; } //FREED 003
-    }
-}
 void destroy_obsl(obsl_t *ob, bool ofree) {
     for (uint32 i = 0; i < OB_nob; i++) free_obsl_key(ob, i);
     if (ob->row) {
@@ -157,6 +201,7 @@ void destroy_obsl(obsl_t *ob, bool ofree) {
         else if (ofree == OBY_FREE_AOBJ) destroyAobj(ob->row); /*DESTROYED 029*/
     }
     if (ob->apk) destroyAobj(ob->apk);                   /* DESTROYED 071 */
+    if (ob->nkey) free(ob->nkey);                        /* FREED 179 */
     free(ob->keys);                                      /* FREED 006 */
     free(ob);                                            /* FREED 001 */
 }
@@ -169,6 +214,10 @@ obsl_t * cloneOb(obsl_t *ob, uint32 nob) { /* JOIN's API */
             ob2->keys[i] = malloc(16); memcpy(ob2->keys[i], ob->keys[i], 16);
         } else                        ob2->keys[i] = ob->keys[i];
     }
+    if (ob->nkey) {
+        ob2->nkey = malloc(ob->nklen ? ob->nklen : 1);   /* FREE ME 179 */
+        memcpy(ob2->nkey, ob->nkey, ob->nklen); ob2->nklen = ob->nklen;
+    }
     if (ob->apk) ob2->apk = cloneAobj(ob->apk);          /* DESTROY ME 071 */
     ob2->lruc = ob->lruc; ob2->lrud = ob->lrud;
     ob2->lfuc = ob->lfuc; ob2->lfu  = ob->lfu;
@@ -248,6 +297,164 @@ bool assignObKey(wob_t *wb, bt     *btr, void *rrow,  aobj *apk,
     ob->keys[i] = key;
     return ret;
 }
+// EXTERNAL_SORT EXTERNAL_SORT EXTERNAL_SORT EXTERNAL_SORT EXTERNAL_SORT
+/* when an ORDER BY's in-memory run exceeds server.alc.SortMemBudget, the run
+   is sorted & written to a temp file [encoded keys, PK, row] and the runs are
+   k-way merged (w/ the final in-memory run) by the OB iterator on output */
+static bool canSpillOB(uchar ofree) {
+    if (!server.alc.SortMemBudget)          return 0;
+    if (EREDIS && ofree == OBY_FREE_ROBJ)   return 0; /* erow_t not flat */
+    return 1;
+}
+static size_t getSizeOBAobj(aobj *a) {
+    return sizeof(aobj) + (C_IS_S(a->type) ? a->len : 0);
+}
+static size_t getSizeOB(obsl_t *ob, uchar ofree) {
+    size_t size = sizeof(listNode) + sizeof(obsl_t) + sizeof(void *) * OB_nob +
+                  ob->nklen;
+    if (ob->apk) size += getSizeOBAobj(ob->apk);
+    if (!ob->row) return size;
+    if (ofree == OBY_FREE_ROBJ) {
+        robj *r = ob->row;
+        size   += sizeof(robj);
+        if (r->encoding == REDIS_ENCODING_RAW) size += sdslen(r->ptr);
+    } else size += getSizeOBAobj(ob->row);
+    return size;
+}
+
+static FILE *createSpillFile() {
+    static ulong nspill = 0;
+    if (!server.alc.SortSpillDir) return tmpfile();
+    sds   path = sdscatprintf(sdsempty(), "%s/alchemy_sort.%d.%lu",
+                              server.alc.SortSpillDir, (int)getpid(), nspill++);
+    FILE *fp   = fopen(path, "w+");
+    if (fp) unlink(path); /* file lives until fclose() */
+    sdsfree(path); return fp;
+}
+static bool spillBytes(FILE *fp, void *p, size_t len) {
+    return !len || fwrite(p, len, 1, fp) == 1;
+}
+static bool readBytes(FILE *fp, void *p, size_t len) {
+    return !len || fread(p, len, 1, fp) == 1;
+}
+static bool spillAobj(FILE *fp, aobj *a) {
+    uchar hit = a ? 1 : 0;
+    if (!spillBytes(fp, &hit, 1))           return 0;
+    if (!a)                                 return 1;
+    aobj  b   = *a; b.s = NULL; b.ic = NULL; b.freeme = 0;
+    if (!spillBytes(fp, &b, sizeof(aobj))) return 0;
+    return C_IS_S(a->type) ? spillBytes(fp, a->s, a->len) : 1;
+}
+static bool readAobj(FILE *fp, aobj **a) {
+    uchar hit;
+    *a = NULL;
+    if (!readBytes(fp, &hit, 1))            return 0;
+    if (!hit)                               return 1;
+    *a = malloc(sizeof(aobj));                           /* FREE ME 029,071 */
+    if (!readBytes(fp, *a, sizeof(aobj))) { free(*a); *a = NULL; return 0; }
+    if (C_IS_S((*a)->type)) {
+        (*a)->s = malloc((*a)->len ? (*a)->len : 1); (*a)->freeme = 1;
+        if (!readBytes(fp, (*a)->s, (*a)->len)) {
+            destroyAobj(*a); *a = NULL;     return 0;
+        }
+    }
+    return 1;
+}
+static bool spillRobj(FILE *fp, robj *r) {
+    uchar enc = r->encoding;
+    if (!spillBytes(fp, &enc, 1))           return 0;
+    if (enc != REDIS_ENCODING_RAW) return spillBytes(fp, &r->ptr, sizeof(void *));
+    uint32 len = sdslen(r->ptr);
+    if (!spillBytes(fp, &len, sizeof(uint32))) return 0;
+    return spillBytes(fp, r->ptr, len);
+}
+static bool readRobj(FILE *fp, robj **r) {
+    uchar enc; uint32 len; void *ptr;
+    if (!readBytes(fp, &enc, 1))            return 0;
+    if (enc != REDIS_ENCODING_RAW) {
+        if (!readBytes(fp, &ptr, sizeof(void *))) return 0;
+        *r = createObject(REDIS_STRING, ptr); (*r)->encoding = enc;
+        return 1;
+    }
+    if (!readBytes(fp, &len, sizeof(uint32))) return 0;
+    *r = createStringObject(NULL, len);
+    if (!readBytes(fp, (*r)->ptr, len)) { decrRefCount(*r); return 0; }
+    return 1;
+}
+/* NOTE: [lruc,lfuc] point into rows, they are valid for the query's life */
+static bool spillOB(FILE *fp, obsl_t *ob, uchar ofree) {
+    if (!spillBytes(fp, &ob->nklen, sizeof(uint32)) ||
+        !spillBytes(fp, ob->nkey,   ob->nklen))             return 0;
+    if (!spillAobj (fp, ob->apk))                           return 0;
+    if (!spillBytes(fp, &ob->lruc, sizeof(uchar *)) ||
+        !spillBytes(fp, &ob->lrud, sizeof(bool))    ||
+        !spillBytes(fp, &ob->lfuc, sizeof(uchar *)) ||
+        !spillBytes(fp, &ob->lfu,  sizeof(bool)))           return 0;
+    if (ofree == OBY_FREE_ROBJ) return spillRobj(fp, ob->row);
+    else                        return spillAobj(fp, ob->row);
+}
+static obsl_t *readOB(FILE *fp, uchar ofree) { /* NULL -> end of run */
+    int     ch = getc(fp);
+    if (ch == EOF) return NULL;
+    ungetc(ch, fp);
+    obsl_t *ob = create_obsl(NULL, OB_nob);              /* FREE ME 001 */
+    bzero(ob->keys, sizeof(void *) * OB_nob);
+    if (!readBytes(fp, &ob->nklen, sizeof(uint32)))         goto readob_err;
+    ob->nkey   = malloc(ob->nklen ? ob->nklen : 1);      /* FREE ME 179 */
+    if (!readBytes(fp, ob->nkey, ob->nklen))                goto readob_err;
+    if (!readAobj (fp, &ob->apk))                           goto readob_err;
+    if (!readBytes(fp, &ob->lruc, sizeof(uchar *)) ||
+        !readBytes(fp, &ob->lrud, sizeof(bool))    ||
+        !readBytes(fp, &ob->lfuc, sizeof(uchar *)) ||
+        !readBytes(fp, &ob->lfu,  sizeof(bool)))            goto readob_err;
+    bool ok = (ofree == OBY_FREE_ROBJ) ? readRobj(fp, (robj **)&ob->row) :
+                                         readAobj(fp, (aobj **)&ob->row);
+    if (!ok)                                                goto readob_err;
+    return ob;
+
+readob_err:
+    redisLog(REDIS_WARNING, "ORDER BY: truncated spill run: %s",
+             ferror(fp) ? strerror(errno) : "EOF");
+    destroy_obsl(ob, ofree); return NULL;
+}
+static bool spillOBRun(list *ll, uchar ofree) {
+    FILE    *fp   = createSpillFile();
+    if (!fp) {
+        CURR_ERR_CREATE_OBJ
+        "-ERR: ORDER BY spill file: %s [CARD: %ld]\r\n",
+         strerror(errno), server.alc.CurrCard));
+        return 0;
+    }
+    long     vlen = listLength(ll);
+    obsl_t **v    = sortOB2Vector(ll);                   /* FREE ME 004 */
+    bool     ret  = 1;
+    for (long i = 0; i < vlen; i++) {
+        if (ret && !spillOB(fp, v[i], ofree)) ret = 0;
+        destroy_obsl(v[i], ofree);
+    }
+    free(v);                                             /* FREED 004 */
+    while (listLength(ll)) listDelNode(ll, listFirst(ll));
+    OB_mem = 0;
+    if (!ret || fflush(fp)) {
+        CURR_ERR_CREATE_OBJ
+        "-ERR: ORDER BY spill write: %s [CARD: %ld]\r\n",
+         strerror(errno), server.alc.CurrCard));
+        fclose(fp); return 0;
+    }
+    rewind(fp);
+    if (!OB_runs) OB_runs = listCreate();
+    listAddNodeTail(OB_runs, fp);
+    return 1;
+}
+bool addOb2OBList(list *ll, obsl_t *ob, uchar ofree) {
+    normaliseObKey(ob);
+    listAddNodeTail(ll, ob);
+    if (!canSpillOB(ofree)) return 1;
+    OB_mem += getSizeOB(ob, ofree);
+    if (OB_mem <= server.alc.SortMemBudget) return 1;
+    return spillOBRun(ll, ofree);
+}
+
 /* Range Query API */
 bool addRow2OBList(list   *ll,    wob_t  *wb,   bt     *btr, void  *r,
                    bool    ofree, void   *rrow, aobj   *apk) {
@@ -263,7 +470,7 @@ bool addRow2OBList(list   *ll,    wob_t  *wb,   bt     *btr, void  *r,
     ob->apk = cloneAobj(apk);                                 /* FREED ME 071 */
     GET_LRUC ob->lruc = lruc; ob->lrud = lrud; // updateLRU (SELECT ORDER BY)
     GET_LFUC ob->lfuc = lfuc; ob->lfu  = lfu;  // updateLFU (SELECT ORDER BY)
-    listAddNodeTail(ll, ob); return 1;
+    return addOb2OBList(ll, ob, ofree);
 
 adr2oberr:
     destroy_obsl(ob, ofree); return 0;
@@ -277,7 +484,12 @@ obsl_t **sortOB2Vector(list *ll) {
     while((ln = listNext(li))) {
         vector[j] = (obsl_t *)ln->value; j++;
     } listReleaseIterator(li);
-    qsort(vector, vlen, sizeof(obsl_t *), genOBsort);
+    if (vlen < OB_RADIX_MIN) qsort(vector, vlen, sizeof(obsl_t *), genOBsort);
+    else {
+        obsl_t **tmp = malloc(sizeof(obsl_t *) * vlen);  /* FREE ME 180 */
+        radixSortOB(vector, tmp, vlen, 0);
+        free(tmp);                                       /* FREED 180 */
+    }
     return vector;
 }
 void sortOBCleanup(obsl_t **vector, int vlen, bool ofree) {
@@ -286,6 +498,56 @@ void sortOBCleanup(obsl_t **vector, int vlen, bool ofree) {
     }
 }
 
+/* OB_ITERATOR: returns rows in ORDER BY order, merging spilled runs
+   NOTE: an obsl_t returned by nextOBIter() is valid until the next call */
+void initOBIter(obi_t *obi, list *ll, uchar ofree) {
+    bzero(obi, sizeof(obi_t));
+    obi->ofree = ofree;
+    obi->vlen  = ll ? listLength(ll) : 0;
+    if (obi->vlen) obi->v = sortOB2Vector(ll);           /* FREE ME 004 */
+    if (!OB_runs) return;
+    obi->nruns = listLength(OB_runs);
+    obi->fps   = malloc(sizeof(FILE *)   * obi->nruns);  /* FREE ME 177 */
+    obi->heads = malloc(sizeof(obsl_t *) * obi->nruns);  /* FREE ME 178 */
+    listNode *ln;
+    int       k  = 0;
+    listIter *li = listGetIterator(OB_runs, AL_START_HEAD);
+    while((ln = listNext(li))) {
+        obi->fps  [k] = ln->value;
+        obi->heads[k] = readOB(obi->fps[k], ofree); k++;
+    } listReleaseIterator(li);
+    listRelease(OB_runs); OB_runs = NULL; /* obi now owns the runs */
+}
+obsl_t *nextOBIter(obi_t *obi) {
+    if (obi->prev) { destroy_obsl(obi->prev, obi->ofree); obi->prev = NULL; }
+    obsl_t *ob   = (obi->vi < obi->vlen) ? obi->v[obi->vi] : NULL;
+    int     hrun = -1; /* -1 -> in-memory run */
+    for (int k = 0; k < obi->nruns; k++) {
+        if (!obi->heads[k]) continue;
+        if (!ob || genOBsort(&obi->heads[k], &ob) < 0) {
+            ob = obi->heads[k]; hrun = k;
+        }
+    }
+    if (!ob) return NULL;
+    if (hrun == -1) obi->v[obi->vi++] = NULL;
+    else            obi->heads[hrun]  = readOB(obi->fps[hrun], obi->ofree);
+    obi->prev = ob; return ob;
+}
+void releaseOBIter(obi_t *obi) {
+    if (obi->prev) destroy_obsl(obi->prev, obi->ofree);
+    for (long i = obi->vi; i < obi->vlen; i++) {
+        if (obi->v[i]) destroy_obsl(obi->v[i], obi->ofree);
+    }
+    if (obi->v) free(obi->v);                            /* FREED 004 */
+    for (int k = 0; k < obi->nruns; k++) {
+        if (obi->heads[k]) destroy_obsl(obi->heads[k], obi->ofree);
+        fclose(obi->fps[k]);
+    }
+    if (obi->fps)   free(obi->fps);                      /* FREED 177 */
+    if (obi->heads) free(obi->heads);                    /* FREED 178 */
+    bzero(obi, sizeof(obi_t));
+}
+
 // DEBUG DEBUG DEBUG DEBUG DEBUG DEBUG DEBUG DEBUG DEBUG DEBUG DEBUG DEBUG
 void dumpObKey(printer *prn, int i, void *key, uchar ctype) {
     if        C_IS_I(ctype) (*prn)("\t\t%d: i: %d\n", i, (int)(long)key);
@@ -300,8 +562,14 @@ void dumpObKey(printer *prn, int i, void *key, uchar ctype) {
 }
 void dumpOb(printer *prn, obsl_t *ob) {
     (*prn)("\tdumpOB START: nob: %u\n", OB_nob);
-    for (uint32 i = 0; i < OB_nob; i++) {
-        dumpObKey(prn, i, ob->keys[i], OB_ctype[i]);
+    if (ob->nkey) {
+        (*prn)("\t\tnkey[%u]: ", ob->nklen);
+        for (uint32 i = 0; i < ob->nklen; i++) (*prn)("%02x", ob->nkey[i]);
+        (*prn)("\n");
+    } else {
+        for (uint32 i = 0; i < OB_nob; i++) {
+            dumpObKey(prn, i, ob->keys[i], OB_ctype[i]);
+        }
     }
     (*prn)("\tEND dumpOB\n");
 }
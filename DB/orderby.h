@@ -27,6 +27,8 @@ ALL RIGHTS RESERVED
 #ifndef __ORDER_BY__H
 #define __ORDER_BY__H
 
+#include <stdio.h>
+
 #include "adlist.h"
 
 #include "query.h"
@@ -34,20 +36,38 @@ ALL RIGHTS RESERVED
 
 list *initOBsort   (bool qed, wob_t *wb, bool rcrud);
 void  releaseOBsort(list *ll);
+void  reverseOBsort();
 
 obsl_t *create_obsl  (void *row, uint32 nob);
 void    destroy_obsl(obsl_t *ob, bool ofree);
 obsl_t *cloneOb     (obsl_t *ob, uint32 nob);
 
 void assignObEmptyKey(obsl_t *ob, uchar ctype, int i);
+void normaliseObKey  (obsl_t *ob);
 bool assignObKey(wob_t  *wb, bt *btr,    void *rrow, aobj *apk, int i,
                  obsl_t *ob, int tmatch);
+bool addOb2OBList (list *ll,      obsl_t *ob,  uchar ofree);
 bool addRow2OBList(list *ll,      wob_t *wb,   bt   *btr, void *r,
                    bool  is_robj, void  *rrow, aobj *apk);
 
 obsl_t **sortOB2Vector(list *ll);
 void     sortOBCleanup(obsl_t **vector, int vlen, bool decr_row);
 
+typedef struct ob_iterator { /* merges [in-memory run + spilled runs] */
+    obsl_t **v;      /* in-memory run (sorted)      */
+    long     vlen;
+    long     vi;
+    int      nruns;  /* runs spilled to disk        */
+    FILE   **fps;
+    obsl_t **heads;  /* current head of each run    */
+    obsl_t  *prev;   /* destroyed on next iteration */
+    uchar    ofree;
+} obi_t;
+
+void    initOBIter   (obi_t *obi, list *ll, uchar ofree);
+obsl_t *nextOBIter   (obi_t *obi);
+void    releaseOBIter(obi_t *obi);
+
 //DEBUG
 void    dumpObKey(printer *prn, int i, void *key, uchar ctype);
 void    dumpOb(printer *prn, obsl_t *ob);
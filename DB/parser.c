@@ -149,24 +149,6 @@ char *extract_string_col(char *start, int *len) { //NOTE: used in pRangeReply()
     }
     return start;
 }
-//NOTE: used in parseWC()
-char *strcasestr_blockchar(char *haystack, char *needle, char blockchar) {
-    char *bstart       = haystack;
-    while (1) {
-        char *found    = DXDB_strcasestr(bstart, needle);
-        if (!found)         return NULL;
-        while (1) {
-            bstart     = str_next_unescaped_chr(bstart, bstart, blockchar);
-            if (!bstart)        return found; /* no block */
-            if (bstart > found) return found; /* block after found */
-            bstart++;
-            char *bend = str_next_unescaped_chr(bstart, bstart, blockchar);
-            if (!bend)          return NULL; /* block doesnt end */
-            bstart     = bend + 1;
-            if (bstart >= found) break;      /* found w/in block, look again */
-        }
-    }
-}
 char *next_token_wc_key(char *tkn, uchar ctype) {
     if (C_IS_S(ctype)) {
         if (*tkn != '\'') return NULL;
@@ -282,6 +264,21 @@ char *get_next_insert_value_token(char *tkn) {
     return NULL;
 }
 
+/* "(..),(..)" -> RETURNS: char after the 1st tuple's closing ')' (or NULL) */
+char *get_next_insert_tuple(char *tkn) {
+    SKIP_SPACES(tkn) if (*tkn != '(') return NULL;
+    int depth = 0;
+    while (*tkn) {
+        if      (*tkn == '\'') tkn = str_next_unescaped_chr(tkn, tkn, '\'');
+        else if (*tkn == '{' ) tkn = str_next_unescaped_chr(tkn, tkn, '}');
+        else if (*tkn == '(' ) depth++;
+        else if (*tkn == ')' ) { depth--; if (!depth) return tkn + 1; }
+        if (!tkn) return NULL;
+        tkn++;
+    }
+    return NULL;
+}
+
 /* PIPE_PARSING PIPE_PARSING PIPE_PARSING PIPE_PARSING PIPE_PARSING */
 robj **parseScanCmdToArgv(char *as_cmd, int *argc) {
     int    rargc;
@@ -50,7 +50,6 @@ bool is_text (char *beg, int len);
 
 // PARSER
 char *extract_string_col(char *start, int *len);
-char *strcasestr_blockchar(char *haystack, char *needle, char blockchar);
 char *next_token_wc_key(char *tkn, uchar ctype);
 
 char *str_next_unescaped_chr(char *beg, char *s, int x);
@@ -60,6 +59,7 @@ char *str_matching_end_paren(char *beg);
 char *next_token(char *nextp);
 int   get_token_len(char *tok);
 char *get_next_insert_value_token(char *tkn);
+char *get_next_insert_tuple      (char *tkn);
 
 char *strstr_not_quoted(char *h, char *n);
 char *get_after_parens(char *p);
@@ -0,0 +1,398 @@
+/*
+ * This file implements the automatic (WHERE clause) plan cache
+ *
+
+AGPL License
+
+Copyright (c) 2011 Russell Sullivan <jaksprats AT gmail DOT com>
+ALL RIGHTS RESERVED
+
+   This file is part of ALCHEMY_DATABASE
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Affero General Public License as
+    published by the Free Software Foundation, either version 3 of the
+    License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Affero General Public License for more details.
+
+    You should have received a copy of the GNU Affero General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <assert.h>
+
+#include "dict.h"
+#include "redis.h"
+
+#include "filter.h"
+#include "fprog.h"
+#include "colparse.h"
+#include "parser.h"
+#include "aobj.h"
+#include "query.h"
+#include "common.h"
+#include "index.h"
+#include "find.h"
+#include "plan_cache.h"
+
+/* NOTE:
+    ORMs send the same few query shapes w/ different values. Every
+    SELECT/UPDATE/DELETE goes thru parseWCplusQO() -> parseWC() (string
+    scanning, column & index resolution) & optimiseRangeQueryPlan() (index
+    cardinality lookups, MCI matching, filter program compilation).
+    The WHERE clause's literals ('strings' & numbers) are normalised out
+    (-> "?") in a single pass, the normalised text [+ table & sop] is the
+    key of a cached PLAN: the post-QO filters (w/o values), their roles
+    [w->wf, wf.klist, w->flist], wtype, the wob_t & which literal feeds which
+    filter value (or LIMIT/OFFSET). A hit rebuilds cswc_t & wob_t straight
+    from the plan + the new literals.
+    A plan is cached the first time a shape parses w/o error & every
+    literal can be matched back to the filter value it produced, so Lua
+    filters & ORDER BYs, OFFSET variables, IN(redis_cmd), func-indexes
+    rewritten to LIMIT/OFFSET & filters on a column w/ a PARTIAL or a BITMAP
+    index (their use depends on the literals) are never cached. The access
+    path is frozen at first use (as a generic plan), DDL flushes the cache.
+*/
+
+// GLOBALS
+extern r_tbl_t  *Tbl;
+extern r_ind_t  *Index;
+extern aobj_cmp *OP_CMP[7];
+
+static dict  *PlanCacheD    = NULL;
+static ulong  PlanCacheHits = 0; static ulong PlanCacheMisses = 0;
+static ulong  PlanCacheInvs = 0;
+
+#define PCL_WF 0 /* w->wf       */
+#define PCL_KL 1 /* w->wf.klist */
+#define PCL_FL 2 /* w->flist    */
+
+typedef struct plan_filter {
+    f_t     f;    /* value-less copy [jan,imatch,tmatch,ic,op,iss,nin] */
+    uchar   kind; /* PCK_KEY, PCK_RANGE, PCK_IN                       */
+    uchar   loc;  /* PCL_WF,  PCL_KL,    PCL_FL                       */
+    uint32  lit;  /* first literal feeding this filter                */
+    uint32  nlit;
+} pflt_t;
+
+typedef struct cached_plan {
+    uchar   wtype;
+    uint32  nflt;
+    pflt_t *flt;
+    wob_t   wb;
+    int     limlit;  /* literal feeding LIMIT  (-1: none) */
+    int     ofstlit; /* literal feeding OFFSET (-1: none) */
+    uint32  nlit;
+} cplan_t;
+
+unsigned int dictSdsHash(const void *key);
+int          dictSdsKeyCompare(void *privdata, const void *key1,
+                               const void *key2);
+void         dictSdsDestructor(void *privdata, void *val);
+
+static void copyIC(icol_t *dic, icol_t *sic) {
+    cloneIC(dic, sic); dic->fimatch = sic->fimatch;
+}
+static void destroyPlan(void *privdata, void *val) {
+    (void) privdata;
+    cplan_t *cp = (cplan_t *)val;
+    for (uint32 i = 0; i < cp->nflt;    i++) releaseIC(&cp->flt[i].f.ic);
+    for (uint32 i = 0; i < cp->wb.nob;  i++) releaseIC(&cp->wb.obc[i]);
+    for (uint32 i = 0; i < cp->wb.ngby; i++) releaseIC(&cp->wb.gbc[i]);
+    free(cp->flt);                                       /* FREED 200 */
+    free(cp);                                            /* FREED 199 */
+}
+static dictType planCacheDictType = {
+    dictSdsHash,                /* hash function */
+    NULL,                       /* key dup */
+    NULL,                       /* val dup */
+    dictSdsKeyCompare,          /* key compare */
+    dictSdsDestructor,          /* key destructor */
+    destroyPlan                 /* val destructor */
+};
+
+void initPlanCache() {
+    if (PlanCacheD) dictRelease(PlanCacheD);
+    PlanCacheD = dictCreate(&planCacheDictType, NULL);
+}
+void invalidatePlanCache() {
+    if (!PlanCacheD || !dictSize(PlanCacheD)) return;
+    dictEmpty(PlanCacheD); PlanCacheInvs++;
+}
+
+// NORMALISE NORMALISE NORMALISE NORMALISE NORMALISE NORMALISE NORMALISE
+#define PC_IDENT(c) (ISALNUM(c) || c == '_' || c == '.' || c == ')')
+#define PC_NUM_START(s)                                                   \
+  (ISDIGIT(*s) || ((*s == '-' || *s == '.') && ISDIGIT(s[1])) ||          \
+   (*s == '-' && s[1] == '.' && ISDIGIT(s[2])))
+
+static char *endOfNumber(char *s) {
+    char *e = s + 1;
+    while (ISDIGIT(*e) || *e == '.') e++;
+    if ((*e == 'e' || *e == 'E') &&
+        (ISDIGIT(e[1]) || ((e[1] == '-' || e[1] == '+') && ISDIGIT(e[2])))) {
+        e += 2; while (ISDIGIT(*e)) e++;
+    }
+    return e;
+}
+static sds normaliseWC(pcq_t *q, int tmatch, uchar sop, char *wc) {
+    sds   k  = sdscatprintf(sdsempty(), "%d:%d:", tmatch, sop);
+    char *s  = wc; char *cp = wc; /* cp: start of pending verbatim text */
+    char  pr = ' ';
+    while (*s) {
+        char *e  = NULL; bool str = 0;
+        if        (*s == '$')                         goto nrml_err; // PREPARE
+        else if   (*s == '\'') {
+            e = s + 1;
+            while (*e && *e != '\'') { if (*e == '\\') goto nrml_err; e++; }
+            if (!*e)                                  goto nrml_err;
+            str = 1;
+        } else if (!PC_IDENT(pr) && PC_NUM_START(s)) {
+            e = endOfNumber(s);
+            if (ISALNUM(*e) || *e == '_' || *e == '.' ||
+                *e == '\'')                          goto nrml_err;
+        }
+        if (!e) { pr = *s; s++; continue; }
+        if (q->nlit == PC_MAX_LITS)                   goto nrml_err;
+        k = sdscatlen(k, cp, s - cp);
+        if (str) {
+            q->lit[q->nlit] = s + 1; q->llen[q->nlit] = e - s - 1;
+            k = sdscatlen(k, "'?'", 3); e++;
+        } else {
+            q->lit[q->nlit] = s;     q->llen[q->nlit] = e - s;
+            k = sdscatlen(k, "?",   1);
+        }
+        q->nlit++;
+        pr = *(e - 1); s = cp = e;
+    }
+    return sdscatlen(k, cp, s - cp);
+
+nrml_err:
+    sdsfree(k); return NULL;
+}
+
+// HIT HIT HIT HIT HIT HIT HIT HIT HIT HIT HIT HIT HIT HIT HIT HIT HIT
+static f_t *buildFilter(pflt_t *pf, pcq_t *q) {
+    f_t    *flt  = newEmptyFilter();
+    char  **lit  = &q->lit [pf->lit];
+    uint32 *llen = &q->llen[pf->lit];
+    flt->jan     = pf->f.jan;    flt->imatch = pf->f.imatch;
+    flt->tmatch  = pf->f.tmatch; flt->op     = pf->f.op;
+    flt->iss     = pf->f.iss;    flt->nin    = pf->f.nin;
+    copyIC(&flt->ic, &pf->f.ic);
+    if        (pf->kind == PCK_KEY) {
+        flt->key  = sdsnewlen(lit[0], llen[0]);
+    } else if (pf->kind == PCK_RANGE) {
+        flt->low  = sdsnewlen(lit[0], llen[0]);
+        flt->high = sdsnewlen(lit[1], llen[1]);
+    } else {   /* PCK_IN */
+        flt->inl  = listCreate();
+        for (uint32 i = 0; i < pf->nlit; i++) {
+            listAddNodeTail(flt->inl, sdsnewlen(lit[i], llen[i]));
+        }
+        uchar ctype = CTYPE_FROM_FLT(flt)
+        convertINLtoAobj(&flt->inl, ctype);
+        flt->ins    = createINSet(flt->inl, ctype);
+    }
+    return flt;
+}
+static void buildFromPlan(cplan_t *cp, pcq_t *q, cswc_t *w, wob_t *wb) {
+    list *tl = listCreate(); /* every filter, for the SDS->aobj conversion */
+    f_t  *wf = NULL;
+    for (uint32 i = 0; i < cp->nflt; i++) {
+        pflt_t *pf  = &cp->flt[i];
+        f_t    *flt = buildFilter(pf, q);
+        listAddNodeTail(tl, flt);
+        if        (pf->loc == PCL_WF) { wf = flt;
+        } else if (pf->loc == PCL_KL) {
+            if (!w->wf.klist) w->wf.klist = listCreate();
+            listAddNodeTail(w->wf.klist, flt);
+        } else {   /* PCL_FL */
+            if (!w->flist)    w->flist    = listCreate();
+            listAddNodeTail(w->flist,    flt);
+        }
+    }
+    convertFilterListToAobj(tl); listRelease(tl); /* tl is referential */
+    list *kl = w->wf.klist;
+    memcpy(&w->wf, wf, sizeof(f_t)); free(wf); /* same as promoteKLorFLtoW */
+    w->wf.klist = kl;
+    convertFilterSDStoAobj(&w->wf);
+    w->wtype    = cp->wtype;
+    w->lvr      = NULL;
+
+    memcpy(wb, &cp->wb, sizeof(wob_t));
+    for (uint32 i = 0; i < wb->nob;  i++) copyIC(&wb->obc[i], &cp->wb.obc[i]);
+    for (uint32 i = 0; i < wb->ngby; i++) copyIC(&wb->gbc[i], &cp->wb.gbc[i]);
+    if (cp->limlit  != -1) wb->lim  = strtol(q->lit[cp->limlit],  NULL, 10);
+    if (cp->ofstlit != -1) wb->ofst = strtol(q->lit[cp->ofstlit], NULL, 10);
+
+    w->fprog    = compileFilters(w->flist, w->wf.tmatch);
+}
+bool getCachedPlan(cswc_t *w, wob_t *wb, uchar sop, pcq_t *q) {
+    bzero(q, sizeof(pcq_t));
+    if (!PlanCacheD || !server.alc.PlanCacheSize || !w->token) return 0;
+    q->key      = normaliseWC(q, w->wf.tmatch, sop, w->token);
+    if (!q->key)                                                return 0;
+    cplan_t *cp = dictFetchValue(PlanCacheD, q->key);
+    if (!cp || cp->nlit != q->nlit) { PlanCacheMisses++;        return 0; }
+    PlanCacheHits++;
+    buildFromPlan(cp, q, w, wb);
+    return 1;
+}
+
+// MISS MISS MISS MISS MISS MISS MISS MISS MISS MISS MISS MISS MISS MISS
+static void *getFltSig(f_t *flt) { /* owned ptrs that move w/ the filter */
+    return flt->key ? (void *)flt->key : flt->low ? (void *)flt->low :
+                                                    (void *)flt->inl;
+}
+void snapPlanOrder(pcq_t *q, list *flist) { /* called B4 QO reorders flist */
+    q->nflt = -1;
+    if (!q->key || !flist || listLength(flist) > PC_MAX_FLTS) return;
+    listNode *ln;
+    int       n  = 0;
+    listIter *li = listGetIterator(flist, AL_START_HEAD);
+    while((ln = listNext(li))) {
+        f_t *flt   = ln->value;
+        q->sig [n] = getFltSig(flt);
+        q->kind[n] = flt->key ? PCK_KEY : flt->low ? PCK_RANGE : PCK_IN;
+        q->fnl [n] = flt->key ? 1      : flt->low ? 2        :
+                     flt->inl ? listLength(flt->inl) : 0;
+        if (!q->sig[n] || flt->op == LFUNC ||
+            hasPartialIndex(flt->tmatch, flt->ic.cmatch) ||
+            find_bitmap_index(flt->tmatch, flt->ic.cmatch) != -1) {
+            listReleaseIterator(li); return;
+        }
+        n++;
+    } listReleaseIterator(li);
+    q->nflt = n;
+}
+static bool litEQ(pcq_t *q, uint32 i, sds s) {
+    return s && sdslen(s) == q->llen[i] && !memcmp(s, q->lit[i], q->llen[i]);
+}
+static bool litEQAobj(pcq_t *q, uint32 i, aobj *a) {
+    if (C_IS_S(a->type)) {
+        return a->len == q->llen[i] && !memcmp(a->s, q->lit[i], q->llen[i]);
+    }
+    aobj  x;
+    sds   s   = sdsnewlen(q->lit[i], q->llen[i]);
+    convertSdsToAobj(s, &x, a->type);
+    bool  ret = (x.type == a->type) && (*OP_CMP[EQ])(&x, a);
+    releaseAobj(&x); sdsfree(s);
+    return ret;
+}
+static bool matchFilter(pcq_t *q, uint32 *lit0, bool *used, f_t *flt,
+                        uchar loc, pflt_t *pf) {
+    void *sig = getFltSig(flt);
+    int   j   = 0;
+    while (j < q->nflt && (used[j] || q->sig[j] != sig)) j++;
+    if (!sig || j == q->nflt) return 0;
+    used[j]  = 1;
+    uint32 i = lit0[j];
+    if        (q->kind[j] == PCK_KEY) {
+        if (!litEQ(q, i, flt->key))                              return 0;
+    } else if (q->kind[j] == PCK_RANGE) {
+        if (!litEQ(q, i, flt->low) || !litEQ(q, i + 1, flt->high)) return 0;
+    } else {
+        if (!flt->inl || listLength(flt->inl) != q->fnl[j])      return 0;
+        listNode *ln;
+        uint32    k  = i; bool ok = 1;
+        listIter *li = listGetIterator(flt->inl, AL_START_HEAD);
+        while(ok && (ln = listNext(li))) ok = litEQAobj(q, k++, ln->value);
+        listReleaseIterator(li);
+        if (!ok)                                                 return 0;
+    }
+    initFilter(&pf->f);
+    pf->f.jan    = flt->jan;    pf->f.imatch = flt->imatch;
+    pf->f.tmatch = flt->tmatch; pf->f.op     = flt->op;
+    pf->f.iss    = flt->iss;    pf->f.nin    = flt->nin;
+    copyIC(&pf->f.ic, &flt->ic);
+    pf->kind     = q->kind[j]; pf->loc = loc;
+    pf->lit      = i;          pf->nlit = q->fnl[j];
+    return 1;
+}
+static bool matchList(pcq_t *q, uint32 *lit0, bool *used, list *l, uchar loc,
+                      cplan_t *cp) {
+    if (!l) return 1;
+    listNode *ln;
+    bool      ok = 1;
+    listIter *li = listGetIterator(l, AL_START_HEAD);
+    while(ok && (ln = listNext(li))) {
+        ok = matchFilter(q, lit0, used, ln->value, loc, &cp->flt[cp->nflt]);
+        if (ok) cp->nflt++;
+    } listReleaseIterator(li);
+    return ok;
+}
+static bool matchLimOfst(pcq_t *q, uint32 n, wob_t *wb, cplan_t *cp) {
+    cp->limlit = cp->ofstlit = -1;
+    uint32 rem = q->nlit - n;
+    if (!rem)                                              return 1;
+    if (rem > 2 || wb->lim == -1)                          return 0;
+    if (strtol(q->lit[n], NULL, 10) != wb->lim)            return 0;
+    cp->limlit = n;
+    if (rem == 1)                                          return 1;
+    if (strtol(q->lit[n + 1], NULL, 10) != wb->ofst)       return 0;
+    cp->ofstlit = n + 1;
+    return 1;
+}
+static void evictPlan() {
+    dictEntry *de = dictGetRandomKey(PlanCacheD);
+    if (de) dictDelete(PlanCacheD, dictGetEntryKey(de));
+}
+void cachePlan(pcq_t *q, cswc_t *w, wob_t *wb) {
+    if (!q->key || q->nflt < 1 || !PlanCacheD || !server.alc.PlanCacheSize)
+                                                                   return;
+    if (w->wtype == SQL_ERR_LKP || w->wtype == SQL_BITMAP_LKP ||
+        w->lvr   || wb->ovar)                                     return;
+    for (uint32 i = 0; i < wb->nob; i++) if (wb->le[i].yes)       return;
+    uint32 lit0[q->nflt]; bool used[q->nflt]; uint32 n = 0;
+    for (int j = 0; j < q->nflt; j++) { lit0[j] = n; n += q->fnl[j]; }
+    if (n > q->nlit)                                              return;
+    bzero(used, sizeof(bool) * q->nflt);
+
+    cplan_t *cp = malloc(sizeof(cplan_t));               /* FREE ME 199 */
+    bzero(cp, sizeof(cplan_t));
+    cp->flt     = malloc(sizeof(pflt_t) * q->nflt);      /* FREE ME 200 */
+    cp->wtype   = w->wtype; cp->nlit = q->nlit;
+    bool ok     = matchFilter(q, lit0, used, &w->wf, PCL_WF, &cp->flt[0]);
+    if (ok) {
+        cp->nflt = 1;
+        ok = matchList(q, lit0, used, w->wf.klist, PCL_KL, cp) &&
+             matchList(q, lit0, used, w->flist,    PCL_FL, cp) &&
+             (int)cp->nflt == q->nflt && matchLimOfst(q, n, wb, cp);
+    }
+    memcpy(&cp->wb, wb, sizeof(wob_t));
+    for (uint32 i = 0; i < wb->nob;  i++) copyIC(&cp->wb.obc[i], &wb->obc[i]);
+    for (uint32 i = 0; i < wb->ngby; i++) copyIC(&cp->wb.gbc[i], &wb->gbc[i]);
+    if (!ok) { destroyPlan(NULL, cp);                              return; }
+
+    if (dictSize(PlanCacheD) >= (ulong)server.alc.PlanCacheSize) evictPlan();
+    if (dictAdd(PlanCacheD, q->key, cp) == DICT_OK) q->key = NULL; /* owned */
+    else destroyPlan(NULL, cp);
+}
+void releasePCQ(pcq_t *q) {
+    if (q->key) { sdsfree(q->key); q->key = NULL; }
+}
+
+// INFO INFO INFO INFO INFO INFO INFO INFO INFO INFO INFO INFO INFO INFO
+sds genPlanCacheInfoString(sds info) {
+    ulong  lkps = PlanCacheHits + PlanCacheMisses;
+    double rate = lkps ? ((double)PlanCacheHits * 100.0 / (double)lkps) : 0.0;
+    return sdscatprintf(info,
+            "plan_cache_size:%ld\r\n"
+            "plan_cache_entries:%lu\r\n"
+            "plan_cache_hits:%lu\r\n"
+            "plan_cache_misses:%lu\r\n"
+            "plan_cache_hit_rate:%.2f\r\n"
+            "plan_cache_invalidations:%lu\r\n",
+             server.alc.PlanCacheSize,
+             PlanCacheD ? (ulong)dictSize(PlanCacheD) : 0,
+             PlanCacheHits, PlanCacheMisses, rate, PlanCacheInvs);
+}
@@ -0,0 +1,61 @@
+/*
+ * This file implements the automatic (WHERE clause) plan cache
+ *
+
+AGPL License
+
+Copyright (c) 2011 Russell Sullivan <jaksprats AT gmail DOT com>
+ALL RIGHTS RESERVED
+
+   This file is part of ALCHEMY_DATABASE
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Affero General Public License as
+    published by the Free Software Foundation, either version 3 of the
+    License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Affero General Public License for more details.
+
+    You should have received a copy of the GNU Affero General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __ALCHEMY_PLAN_CACHE__H
+#define __ALCHEMY_PLAN_CACHE__H
+
+#include "adlist.h"
+#include "redis.h"
+
+#include "query.h"
+#include "common.h"
+
+#define PC_MAX_LITS 128 /* more literals than this -> not cached */
+#define PC_MAX_FLTS 32  /* more filters  than this -> not cached */
+
+#define PCK_KEY   0 /* WHERE col = ?              */
+#define PCK_RANGE 1 /* WHERE col BETWEEN ? AND ?  */
+#define PCK_IN    2 /* WHERE col [NOT] IN (?,?,?) */
+
+typedef struct plan_cache_query { /* literals normalised out of a WHERE */
+    sds     key;                  /* normalised text (NULL: not cacheable) */
+    uint32  nlit;
+    char   *lit [PC_MAX_LITS];    /* literals point into the WHERE clause  */
+    uint32  llen[PC_MAX_LITS];
+    int     nflt;                 /* parse order of filters (cache MISS)   */
+    void   *sig [PC_MAX_FLTS];    /* flt's [key,low,inl] -> survives QO    */
+    uchar   kind[PC_MAX_FLTS];
+    uint32  fnl [PC_MAX_FLTS];
+} pcq_t;
+
+void  initPlanCache      ();
+void  invalidatePlanCache();
+bool  getCachedPlan      (cswc_t *w, wob_t *wb, uchar sop, pcq_t *q);
+void  snapPlanOrder      (pcq_t  *q, list *flist);
+void  cachePlan          (pcq_t  *q, cswc_t *w, wob_t *wb);
+void  releasePCQ         (pcq_t  *q);
+sds   genPlanCacheInfoString(sds info);
+
+#endif /* __ALCHEMY_PLAN_CACHE__H */
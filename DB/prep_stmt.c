@@ -30,6 +30,7 @@ ALL RIGHTS RESERVED
 #include <unistd.h>
 #include <ctype.h>
 #include <assert.h>
+#include <limits.h>
 
 #include "sds.h"
 #include "dict.h"
@@ -45,23 +46,50 @@ ALL RIGHTS RESERVED
 #include "find.h"
 #include "query.h"
 #include "alsosql.h"
+#include "rpipe.h"
 #include "common.h"
 #include "prep_stmt.h"
 
 /* PREPARED_STATEMENTS TODO LIST
-    0.) Make Persistent -> add to DXDB_rdbSave/Load()
     1.) PREPARE STATEMENT for joins runs PRE QueryOptimisation -> do POST
-    2.) Support CRUD
-    3.) SELECTs -> support RangeQueries & IN()Queries
-    4.) "SHOW  STATEMENTS"
-    5.) "PRINT STATEMENT stmt_name"
-    6.) "DROP  STATEMENT stmt_name"
+    2.) "SHOW  STATEMENTS"
+    3.) "PRINT STATEMENT stmt_name"
+    4.) "DROP  STATEMENT stmt_name"
 */
 
+/* NOTE: a prepared statement's blob is [SOURCE][FLAG][PLAN]
+    SOURCE: the statement's argv[] (w/ "$N"s) -> rdbSave/Load() re-PREPAREs
+            from SOURCE (PLANs hold tmatch/cmatch/imatch, not stable on load)
+    FLAG:
+      PS_RQ:   single "col = $1" SELECT -> serialised post-QO plan
+      PS_JOIN: JOIN w/ "col = $N"s     -> serialised JOIN plan
+      PS_INS:  INSERT/REPLACE w/ a single VALUES tuple -> values are BOUND
+               per column on EXECUTE (no parseRowVals() tokenising)
+      PS_TMPL: everything else (UPDATE, DELETE, RANGE & IN() params, LIMITs)
+               argv[] pre-split into [literal,$N] pieces, EXECUTE splices the
+               args in & runs the command, its WHERE clause then hits the
+               plan cache (plan_cache.c) -> no WHERE parse/QO on EXECUTE
+    EXECUTEs that write propagate the equivalent SQL (not "EXECUTE") to the
+    AOF & slaves, so neither needs the statement to exist
+*/
+
+extern r_tbl_t *Tbl;
 extern dict *StmtD;
 extern bool  GlobalNeedCn;
 extern long  JoinLim; extern long JoinOfst; extern bool JoinQed;
 
+/* PROTOTYPES */
+int       rdbSaveLen(FILE *fp, uint32_t len);
+int       rdbSaveRawString(FILE *fp, sds s, size_t len);
+int       rdbSaveType(FILE *fp, unsigned char type);
+uint32_t  rdbLoadLen(FILE *fp, int *isencoded);
+robj     *rdbLoadStringObject(FILE *fp);
+
+#define PS_RQ   0
+#define PS_JOIN 1
+#define PS_TMPL 2
+#define PS_INS  3
+
 // PREPARED_STATEMENTS PREPARED_STATEMENTS PREPARED_STATEMENTS
 
 static bool has_prepare_arg(sds arg) {
@@ -72,15 +100,272 @@ static bool has_prepare_arg(sds arg) {
     }
     return 0;
 }
-static void storePreparedStatement(cli *c, uchar *blob, int size) {
+/* "$N" (N > 0) at s -> N (*e: end of "$N"), else 0 */
+static int getPrepareArgN(char *s, char **e) {
+    if (*s != '$' || !ISDIGIT(s[1])) return 0;
+    long n = strtol(s + 1, e, 10); /* OK: DELIM: [^0-9] */
+    return (n > 0 && n < INT_MAX) ? (int)n : 0;
+}
+
+static uchar *serialiseInt(uchar *x, int i) {
+    memcpy(x, &i, sizeof(int)); return x + sizeof(int);
+}
+static uchar *deserialiseInt(uchar *x, int *i) {
+    memcpy(i, x, sizeof(int));  return x + sizeof(int);
+}
+static sds catInt(sds s, int i) { return sdscatlen(s, &i, sizeof(int)); }
+static sds catStr(sds s, char *x, int len) {
+    return sdscatlen(catInt(s, len), x, len);
+}
+
+// SOURCE SOURCE SOURCE SOURCE SOURCE SOURCE SOURCE SOURCE SOURCE SOURCE
+static int getSizeStmtSrc(cli *c) {
+    int size = sizeof(int); // argc
+    for (int i = 0; i < c->argc; i++) {
+        size += sizeof(int) + sdslen(c->argv[i]->ptr);
+    }
+    return size;
+}
+static void serialiseStmtSrc(cli *c, uchar *x) {
+    x = serialiseInt(x, c->argc);
+    for (int i = 0; i < c->argc; i++) {
+        int len = sdslen(c->argv[i]->ptr);
+        x       = serialiseInt(x, len);
+        memcpy(x, c->argv[i]->ptr, len);       x += len;
+    }
+}
+static uchar *skipStmtSrc(uchar *x) {
+    int argc; x = deserialiseInt(x, &argc);
+    for (int i = 0; i < argc; i++) {
+        int len; x = deserialiseInt(x, &len);  x += len;
+    }
+    return x;
+}
+static void storeStatement(cli *c, char *plan, int size) {
+    int   ssize = getSizeStmtSrc(c);
+    sds   s     = sdsnewlen(NULL, ssize + size);
+    serialiseStmtSrc(c, (uchar *)s);
+    memcpy(s + ssize, plan, size);
     sds   pname = sdsdup(c->Prepare);
-    sds   s     = sdsnewlen(blob, size); free(blob);     // FREED 111
     robj *val   = createObject(REDIS_STRING, s);
     robj  *o    = dictFetchValue(StmtD, pname);
     if (o) ASSERT_OK(dictReplace(StmtD, pname, val));
     else   ASSERT_OK(dictAdd    (StmtD, pname, val));
     addReply(c, shared.ok);
 }
+static void storePreparedStatement(cli *c, uchar *blob, int size) {
+    storeStatement(c, (char *)blob, size); free(blob);   // FREED 111
+}
+
+// TEMPLATE TEMPLATE TEMPLATE TEMPLATE TEMPLATE TEMPLATE TEMPLATE TEMPLATE
+/* PLAN: [nprm, argc, argc * [npieces, npieces * [N | 0,len,literal]]] */
+static sds catArgPieces(sds p, char *a, int *nprm) {
+    int   npc = 0; sds pcs = sdsempty();
+    char *s   = a; char *l = a; char *e;
+    while (*s) {
+        int n = getPrepareArgN(s, &e);
+        if (!n) { s++; continue; }
+        if (s != l) { pcs = catStr(catInt(pcs, 0), l, s - l); npc++; }
+        pcs = catInt(pcs, n);                                npc++;
+        if (n > *nprm) *nprm = n;
+        s   = l = e;
+    }
+    if (s != l) { pcs = catStr(catInt(pcs, 0), l, s - l); npc++; }
+    p = sdscatlen(catInt(p, npc), pcs, sdslen(pcs)); sdsfree(pcs);
+    return p;
+}
+/* processCommand()'s arity check, PREPARE & EXECUTE call cmd->proc() */
+static bool checkStmtArity(cli *c, rcommand *cmd, int argc) {
+    if (!cmd) { addReply(c, shared.prepare_syntax);                return 0; }
+    if ((cmd->arity > 0 && cmd->arity != argc) || (argc < -cmd->arity)) {
+        addReplyErrorFormat(c, "wrong number of arguments for '%s' command",
+                            cmd->name);                           return 0;
+    }
+    return 1;
+}
+void prepareTemplate(cli *c) {
+    if (!checkStmtArity(c, lookupCommand(c->argv[0]->ptr), c->argc)) return;
+    int nprm = 0; sds pcs = sdsempty();
+    for (int i = 0; i < c->argc; i++) {
+        pcs = catArgPieces(pcs, c->argv[i]->ptr, &nprm);
+    }
+    sds plan = sdsnewlen("\002", 1); /* FLAG: PS_TMPL */
+    plan     = catInt(catInt(plan, nprm), c->argc);
+    plan     = sdscatlen(plan, pcs, sdslen(pcs)); sdsfree(pcs);
+    storeStatement(c, plan, sdslen(plan)); sdsfree(plan);
+}
+static robj **spliceTemplate(cli *c, uchar *x, int *argc) {
+    int nprm; x = deserialiseInt(x, &nprm);
+    if (nprm != (c->argc - 2)) { addReply(c, shared.execute_argc); return NULL;}
+    x = deserialiseInt(x, argc);
+    robj **argv = zmalloc(sizeof(robj *) * *argc);
+    for (int i = 0; i < *argc; i++) {
+        int npc; x = deserialiseInt(x, &npc);
+        sds a = sdsempty();
+        for (int j = 0; j < npc; j++) {
+            int n; x = deserialiseInt(x, &n);
+            if (n) {
+                sds arg = c->argv[n + 1]->ptr;
+                a = sdscatlen(a, arg, sdslen(arg));
+            } else {
+                int len; x = deserialiseInt(x, &len);
+                a = sdscatlen(a, x, len);                    x += len;
+            }
+        }
+        argv[i] = createObject(REDIS_STRING, a);
+    }
+    return argv;
+}
+/* run argv[] as c's command, if it wrote: c->argv[] becomes argv[] (so
+   call() propagates the SQL to AOF/slaves, not the EXECUTE) */
+static void runStatement(cli *c, robj **argv, int argc) {
+    rcommand  *cmd   = lookupCommand(argv[0]->ptr);
+    robj     **oargv = c->argv; int oargc = c->argc;
+    long long  dirty = server.dirty;
+    c->argv = argv; c->argc = argc;
+    if (checkStmtArity(c, cmd, argc)) cmd->proc(c);
+    if (server.dirty != dirty) { argv = oargv; argc = oargc; }
+    else                       { c->argv = oargv; c->argc = oargc; }
+    for (int i = 0; i < argc; i++) decrRefCount(argv[i]);
+    zfree(argv);
+}
+static void executeCommand_Tmpl(cli *c, uchar *x) {
+    int    argc;
+    robj **argv = spliceTemplate(c, x, &argc); if (!argv) return;
+    runStatement(c, argv, argc);
+}
+
+// INSERT INSERT INSERT INSERT INSERT INSERT INSERT INSERT INSERT INSERT
+/* PLAN: [nprm, repl, tname, cdecl, ncols * [cname], nvals * [N | 0,val]] */
+static bool isPropagated() {
+    return server.appendonly || listLength(server.slaves) ||
+           listLength(server.monitors);
+}
+static char *trimVal(char *s, char *e, int *len) { // [s,e) -> trimmed
+    SKIP_SPACES(s) while (e > s && ISBLANK(*(e - 1))) e--;
+    *len = e - s; return s;
+}
+static bool prepareInsert(cli *c) {
+    bool  repl  = !strcasecmp(c->argv[0]->ptr, "REPLACE");
+    if (strcasecmp(c->argv[1]->ptr, "INTO")) {
+        addReply(c, shared.insertsyntax_no_into);                  return 0;
+    }
+    int   tmatch = find_table(c->argv[2]->ptr);
+    if (tmatch == -1) { addReply(c, shared.nonexistenttable);       return 0; }
+    r_tbl_t *rt  = &Tbl[tmatch];
+    bool  cdecl  = (c->argc == 6);
+    if (strcasecmp(c->argv[cdecl ? 4 : 3]->ptr, "VALUES")) {
+        addReply(c, shared.insertsyntax_no_values);                return 0;
+    }
+    sds   cols   = cdecl ? c->argv[3]->ptr : NULL;
+    sds   vals   = c->argv[c->argc - 1]->ptr;
+    int   clen   = cols ? sdslen(cols) : 0;
+    int   vlen   = sdslen(vals);
+    if ((cols && (cols[0] != '(' || cols[clen - 1] != ')')) ||
+        vals[0] != '(' || vals[vlen - 1] != ')') {
+        addReply(c, shared.insertsyntax_no_values);                return 0;
+    }
+    int   nprm   = 0; int ncols = 0; int nvals = 0;
+    sds   pcs    = sdsempty(); sds vcs = sdsempty();
+    if (cols) { /* COL DECL */
+        char *s = cols + 1; char *end = cols + clen - 1;
+        while (s < end) {
+            char *nc = s; while (nc < end && *nc != ',') nc++;
+            int   len; char *cn = trimVal(s, nc, &len);
+            icol_t ic = find_column_n(tmatch, cn, len);
+            if (ic.cmatch == -1 || (rt->lrud && ic.cmatch == rt->lruc) ||
+                                   (rt->lfu  && ic.cmatch == rt->lfuc)) {
+                addReply(c, shared.nonexistentcolumn);   goto prpinserr;
+            }
+            pcs = catStr(pcs, cn, len); ncols++; s = nc + 1;
+        }
+    }
+    char *t = vals + 1; char *end = vals + vlen - 1; *end = '\0';
+    while (t && t < end) {
+        char *nc = get_next_insert_value_token(t);
+        int   len; char *v = trimVal(t, nc ? nc : end, &len);
+        char *q  = v; char *e = NULL;
+        if (len > 2 && *q == '\'' && v[len - 1] == '\'') q++;
+        int   n  = getPrepareArgN(q, &e);
+        if (n && e == v + len - (q != v)) {
+            vcs = catInt(vcs, n); if (n > nprm) nprm = n;
+        } else {
+            vcs = catStr(catInt(vcs, 0), v, len);
+        }
+        nvals++; t = nc ? nc + 1 : NULL;
+    }
+    *end = ')';
+    int lncols = insertableColCount(tmatch);
+    if ((ncols && nvals != ncols) || (!ncols && nvals != lncols)) {
+        addReply(c, shared.insertcolumn);                   goto prpinserr;
+    }
+    sds plan = sdsnewlen("\003", 1); /* FLAG: PS_INS */
+    plan     = sdscatlen(catInt(plan, nprm), &repl, sizeof(bool));
+    plan     = catStr(plan, c->argv[2]->ptr, sdslen(c->argv[2]->ptr));
+    plan     = catStr(plan, cols ? cols : "", clen);
+    plan     = sdscatlen(catInt(plan, ncols), pcs, sdslen(pcs));
+    plan     = sdscatlen(catInt(plan, nvals), vcs, sdslen(vcs));
+    storeStatement(c, plan, sdslen(plan)); sdsfree(plan);
+    sdsfree(pcs); sdsfree(vcs);                                   return 1;
+
+prpinserr:
+    sdsfree(pcs); sdsfree(vcs);                                   return 0;
+}
+static void executeCommand_Insert(cli *c, uchar *x) {
+    int   nprm; x = deserialiseInt(x, &nprm);
+    if (nprm != (c->argc - 2)) { addReply(c, shared.execute_argc); return; }
+    bool  repl;  memcpy(&repl, x, sizeof(bool));         x += sizeof(bool);
+    int   tlen;  x = deserialiseInt(x, &tlen);
+    sds   tname = sdsnewlen(x, tlen);                    x += tlen;
+    int   clen;  x = deserialiseInt(x, &clen);
+    char *cdecl = (char *)x;                             x += clen;
+    int   tmatch = find_table(tname);
+    if (tmatch == -1) {
+        addReply(c, shared.nonexistenttable); sdsfree(tname); return;
+    }
+    int   pcols; x = deserialiseInt(x, &pcols);
+    icol_t ics[pcols ? pcols : 1];
+    for (int i = 0; i < pcols; i++) {
+        int len; x = deserialiseInt(x, &len);
+        ics[i] = find_column_n(tmatch, (char *)x, len);  x += len;
+        if (ics[i].cmatch == -1) {
+            addReply(c, shared.nonexistentcolumn); sdsfree(tname); return;
+        }
+    }
+    int    nvals; x = deserialiseInt(x, &nvals);
+    char  *vals [nvals];
+    uint32 vlens[nvals];
+    for (int k = 0; k < nvals; k++) {
+        int n; x = deserialiseInt(x, &n);
+        if (n) {
+            sds arg  = c->argv[n + 1]->ptr;
+            vals[k]  = arg; vlens[k] = sdslen(arg);
+        } else {
+            int len; x = deserialiseInt(x, &len);
+            vals[k]  = (char *)x; vlens[k] = len;          x += len;
+        }
+    }
+    sds   mbuf = sdsempty();
+    uchar ret  = insertBound(c, tmatch, repl, pcols, ics, vals, vlens, nvals,
+                             &mbuf);
+    if (ret != INS_ERR && isPropagated()) { // propagate the INSERT
+        int    argc = clen ? 6 : 5; int i = 0;
+        robj **argv = zmalloc(sizeof(robj *) * argc);
+        argv[i++]   = createStringObject(repl ? "REPLACE" : "INSERT",
+                                         repl ? 7 : 6);
+        argv[i++]   = createStringObject("INTO", 4);
+        argv[i++]   = createObject(REDIS_STRING, sdsdup(tname));
+        if (clen) argv[i++] = createStringObject(cdecl, clen);
+        argv[i++]   = createStringObject("VALUES", 6);
+        argv[i++]   = createObject(REDIS_STRING,
+                                   sdscatlen(sdscatprintf(sdsempty(), "(%s",
+                                                          mbuf), ")", 1));
+        for (int j = 0; j < c->argc; j++) decrRefCount(c->argv[j]);
+        zfree(c->argv); c->argv = argv; c->argc = argc;
+    }
+    sdsfree(mbuf); sdsfree(tname);
+}
+
 bool prepareJoin(cli *c, jb_t *jb) {
     //COMPUTE size -> [cargs[], JTA, cstar, qols, js[], n_jind, ij[], wb]
     list *cargl = listCreate();
@@ -98,13 +383,13 @@ bool prepareJoin(cli *c, jb_t *jb) {
     for (uint32 i = 0; i < jb->n_jind; i++) {
         int lhsize = getSizeFLT(&jb->ij[i].lhs);
         int rhsize = getSizeFLT(&jb->ij[i].rhs);
-        if (lhsize == -1 || rhsize == -1) {
-            addReply(c, shared.supported_prepare);             return 0;
+        if (lhsize == -1 || rhsize == -1) { // e.g. RANGE -> TEMPLATE
+            listRelease(cargl); prepareTemplate(c);            return 1;
         }
         size += lhsize + rhsize + 1; // +1 for has_rhs
     }
     int wbsize = getSizeWB(&jb->wb);
-    if (wbsize == -1) { addReply(c, shared.supported_prepare); return 0; }
+    if (wbsize == -1) { listRelease(cargl); prepareTemplate(c); return 1; }
     size += wbsize;
 
     //SERIALISE -> ORDER [cargs[], JTA, cstar, qols, js[], n_jind, ij[], wb]
@@ -194,12 +479,15 @@ static void executeCommand_Join(cli *c, uchar *x) {
 void prepareRQ(cli *c,     cswc_t *w,      wob_t *wb, bool cstar,
                int  qcols, icol_t *ics) {
     //COMPUTE size -> ORDER [cstar, qcols, ics, wtype, wf]
+    int wfsize = getSizeFLT(&w->wf);
+    int wbsize = getSizeWB(wb);
+    if (wfsize == -1 || wbsize == -1 || (w->flist && listLength(w->flist)) ||
+        w->wtype == SQL_BITMAP_LKP) {
+        prepareTemplate(c); return; // [RANGE,IN,FLOAT,STRING,filters,BITMAP]
+    }
     int size   = 1 + sizeof(bool)      + sizeof(int)  + // isj, cstar, qcols
                  (sizeof(int) * qcols) + sizeof(bool) + // ics, wtype
-                 getSizeFLT(&w->wf);                    // wf
-    int wbsize = getSizeWB(wb);
-    if (wbsize == -1) { addReply(c, shared.supported_prepare); return; }
-    size += wbsize;
+                 wfsize + wbsize;                       // wf, wb
 
     //SERIALISE    -> ORDER [cstar, qcols, ics, wtype, wf]
     uchar *blob = malloc(size);                          // FREE ME 111
@@ -211,7 +499,6 @@ void prepareRQ(cli *c,     cswc_t *w,      wob_t *wb, bool cstar,
         memcpy(x, &ics[i].cmatch, sizeof(int)); x += sizeof(int); 
     }
     memcpy(x, &w->wtype, sizeof(bool));        x += sizeof(bool);
-    int    wfsize = getSizeFLT  (&w->wf);
     uchar *wfblob = serialiseFLT(&w->wf);
     memcpy(x, wfblob, wfsize);                 x += wfsize;
     
@@ -220,8 +507,26 @@ void prepareRQ(cli *c,     cswc_t *w,      wob_t *wb, bool cstar,
 
     storePreparedStatement(c, blob, size);
 }
-static void executeCommand_RQ(cli *c, uchar *x) {
-    if (c->argc > 3) { addReply(c, shared.execute_argc); return; }
+/* BEXECUTE's param is bound straight into the plan's key (no strtoul()) */
+static bool bindAobjKey(aobj *akey, aobj *prm) {
+    uchar ctype = akey->type;
+    if (prm->type == ctype) { memcpy(akey, prm, sizeof(aobj)); return 1; }
+    if        (C_IS_NUM(prm->type)) {
+        uint128 x = C_IS_I(prm->type) ? prm->i : C_IS_L(prm->type) ? prm->l :
+                                                                     prm->x;
+        if      C_IS_I(ctype) { if (x > UINT_MAX)  return 0; akey->i = x; }
+        else if C_IS_L(ctype) { if (x > ULONG_MAX) return 0; akey->l = x; }
+        else                                                 akey->x = x;
+        return 1;
+    } else if (C_IS_S(prm->type)) {
+        sds s = sdsnewlen(prm->s, prm->len);
+        convertSdsToAobj(s, akey, ctype); sdsfree(s);
+        return 1;
+    }
+    return 0;
+}
+static void executeCommand_RQ(cli *c, uchar *x, aobj *prm) {
+    if (!prm && c->argc > 3) { addReply(c, shared.execute_argc); return; }
 
     //DESERIALISE  -> ORDER [cstar, qcols, ics, wtype, wf]
     bool cstar; memcpy(&cstar, x, sizeof(bool));    x += sizeof(bool);
@@ -244,9 +549,16 @@ static void executeCommand_RQ(cli *c, uchar *x) {
     listAddNodeTail(w.flist, flt);
 #else
     int wfsize = deserialiseFLT(x, &w.wf);          x += wfsize;
-    w.wf.key   = sdsdup(c->argv[2]->ptr); // put c->argc[] into query-plan
-    releaseAobj(&w.wf.akey);              // take out the "$1"
-    convertFilterSDStoAobj(&w.wf);
+    if (prm) {
+        if (!bindAobjKey(&w.wf.akey, prm)) {
+            addReply(c, shared.execute_binary);
+            destroy_wob(&wb); destroy_check_sql_where_clause(&w); return;
+        }
+    } else {
+        w.wf.key = sdsdup(c->argv[2]->ptr); // put c->argc[] into query-plan
+        releaseAobj(&w.wf.akey);            // take out the "$1"
+        convertFilterSDStoAobj(&w.wf);
+    }
 #endif
 
     int wbsize = deserialiseWB(x, &wb);             x += wbsize;
@@ -262,22 +574,113 @@ static void executeCommand_RQ(cli *c, uchar *x) {
     destroy_wob(&wb); destroy_check_sql_where_clause(&w);
 }
 bool executeCommandBinary(cli *c, uchar *x) {
-    bool   isj = *x;                                x++;
-    if (isj) executeCommand_Join(c, x);
-    else     executeCommand_RQ  (c, x);
+    uchar  flag = *x;                               x++;
+    if      (flag == PS_JOIN) executeCommand_Join  (c, x);
+    else if (flag == PS_TMPL) executeCommand_Tmpl  (c, x);
+    else if (flag == PS_INS)  executeCommand_Insert(c, x);
+    else                      executeCommand_RQ    (c, x, NULL);
     return 1;
 }
 bool executeCommandInnards(cli *c) {
     robj  *o   = dictFetchValue(StmtD, (sds)c->argv[1]->ptr);
     if (!o) { addReply(c, shared.execute_miss); return 0; }
-    uchar *x   = o->ptr;
+    uchar *x   = skipStmtSrc(o->ptr);
     return executeCommandBinary(c, x);
 }
 void executeCommand(cli *c) {
     executeCommandInnards(c);
 }
+
+// BINARY_EXECUTE BINARY_EXECUTE BINARY_EXECUTE BINARY_EXECUTE BINARY_EXECUTE
+/* BEXECUTE planname params [BINARY]
+     params: nprm * [COL_TYPE(1 byte)][VALUE] (LITTLE_ENDIAN, as are rows)
+     VALUE:  INT:4 LONG:8 FLOAT:4 U128:16 STRING:[uint32 len][bytes]
+   PS_RQ binds its aobj directly into the plan, the other plans get their
+   params as text (they are spliced & parsed anyways)
+   BINARY: rows are returned as typed binary columns (see orow_binary()) */
+static int decodeBinaryParams(sds b, aobj *prms) { // prms: NULL -> count
+    uchar *x = (uchar *)b; uchar *end = x + sdslen(b); int n = 0;
+    while (x < end) {
+        uchar ctype = *x;                                      x++;
+        uint32 len;
+        if      C_IS_I(ctype) len = sizeof(uint32);
+        else if C_IS_L(ctype) len = sizeof(ulong);
+        else if C_IS_F(ctype) len = sizeof(float);
+        else if C_IS_X(ctype) len = sizeof(uint128);
+        else if C_IS_S(ctype) {
+            if (x + sizeof(uint32) > end)         return -1;
+            memcpy(&len, x, sizeof(uint32));     x += sizeof(uint32);
+        } else                                    return -1;
+        if ((ulong)(end - x) < len)               return -1;
+        if (prms) {
+            aobj *a = &prms[n];
+            if        C_IS_I(ctype) {
+                uint32  i; memcpy(&i, x, len); initAobjInt   (a, i);
+            } else if C_IS_L(ctype) {
+                ulong   l; memcpy(&l, x, len); initAobjLong  (a, l);
+            } else if C_IS_F(ctype) {
+                float   f; memcpy(&f, x, len); initAobjFloat (a, f);
+            } else if C_IS_X(ctype) {
+                uint128 u; memcpy(&u, x, len); initAobj(a); initAobjU128(a, u);
+            } else     initAobjString(a, (char *)x, len); // NOTE: points into b
+        }
+        x += len; n++;
+    }
+    return n;
+}
+static void bexecuteParamsToArgv(cli *c, aobj *prms, int nprm) {
+    robj **argv = zmalloc(sizeof(robj *) * (nprm + 2));
+    argv[0]     = c->argv[0]; argv[1] = c->argv[1];
+    for (int i = 0; i < nprm; i++) {
+        argv[i + 2] = createObject(REDIS_STRING, createSDSFromAobj(&prms[i]));
+    }
+    for (int i = 2; i < c->argc; i++) decrRefCount(c->argv[i]);
+    zfree(c->argv); c->argv = argv; c->argc = nprm + 2;
+}
+void bexecuteCommand(cli *c) {
+    bool bin = 0;
+    if (c->argc == 4) {
+        if (strcasecmp(c->argv[3]->ptr, "BINARY")) {
+            addReply(c, shared.execute_binary); return;
+        }
+        bin = 1;
+    } else if (c->argc != 3) { addReply(c, shared.execute_binary); return; }
+    robj  *o    = dictFetchValue(StmtD, (sds)c->argv[1]->ptr);
+    if (!o) { addReply(c, shared.execute_miss);                   return; }
+    int    nprm = decodeBinaryParams(c->argv[2]->ptr, NULL);
+    if (nprm == -1) { addReply(c, shared.execute_binary);         return; }
+    aobj   prms[nprm ? nprm : 1];
+    decodeBinaryParams(c->argv[2]->ptr, prms);
+    uchar  o_out = server.alc.OutputMode;
+    if (bin) server.alc.OutputMode = OUTPUT_BINARY;
+    uchar *x     = skipStmtSrc(o->ptr);
+    if (*x == PS_RQ) {
+        if (nprm != 1) addReply(c, shared.execute_argc);
+        else           executeCommand_RQ(c, x + 1, &prms[0]);
+    } else {
+        bexecuteParamsToArgv(c, prms, nprm); // argv[2] (& prms) freed here
+        executeCommandBinary(c, x);
+    }
+    server.alc.OutputMode = o_out;
+}
+/* NOTE: SELECTs w/ only "col = $N" params (single $1 or a JOIN) keep the
+         serialised plan, all other SELECTs are TEMPLATEs */
+static bool isEqOnlyPrepare(cli *c) {
+    if (c->argc < 4) return 0;
+    int nprm = 0;
+    for (int i = 0; i < c->argc; i++) {
+        char *a = c->argv[i]->ptr; char *e;
+        for (char *s = a; *s; s++) {
+            if (!getPrepareArgN(s, &e)) continue;
+            char *p = s - 1; while (p >= a && ISBLANK(*p)) p--;
+            if (p < a || *p != '=') return 0;
+            nprm++;
+        }
+    }
+    return (nprm == 1 || (nprm && strchr(c->argv[3]->ptr, ',')));
+}
 void prepareCommand(redisClient *c) {
-    if (strcasecmp(c->argv[2]->ptr, "AS")) {
+    if (strcasecmp(c->argv[2]->ptr, "AS") || c->argc < 5) {
         addReply(c, shared.prepare_syntax); return;
     }
     int   oargc = c->argc;
@@ -287,10 +690,91 @@ void prepareCommand(redisClient *c) {
     for (int i = 0; i < c->argc; i++) { /* shift argv[]s down 2 */
         c->argv[i] = c->argv[i + 3];
     }
-    if      (!strcasecmp(c->argv[0]->ptr, "SCAN"))   tscanCommand(c);
-    else if (!strcasecmp(c->argv[0]->ptr, "SELECT")) sqlSelectCommand(c);
+    sds cmd = c->argv[0]->ptr;
+    if        (!strcasecmp(cmd, "SCAN") || !strcasecmp(cmd, "SELECT")) {
+        if (!isEqOnlyPrepare(c))                prepareTemplate (c);
+        else if (!strcasecmp(cmd, "SCAN"))      tscanCommand    (c);
+        else                                    sqlSelectCommand(c);
+    } else if (!strcasecmp(cmd, "INSERT") || !strcasecmp(cmd, "REPLACE")) {
+        if ((c->argc == 5 || c->argc == 6) && // SINGLE "VALUES (...)" tuple
+            !strcasecmp(c->argv[c->argc - 2]->ptr, "VALUES"))
+                                                prepareInsert   (c);
+        else                                    prepareTemplate (c);
+    } else if (!strcasecmp(cmd, "UPDATE") || !strcasecmp(cmd, "DELETE")) {
+                                                prepareTemplate (c);
+    } else                                      addReply(c, shared.prepare_syntax);
     // free argv[] "PREPARE planname AS"
     c->argv[oargc - 3] = a0; c->argv[oargc - 2] = a1; c->argv[oargc - 1] = a2;
     c->argc     = oargc;                 /* so all argv[] get freed */
     c->Prepare  = NULL;
 }
+
+// PERSISTENCE PERSISTENCE PERSISTENCE PERSISTENCE PERSISTENCE PERSISTENCE
+static list *LoadedStmts = NULL; /* re-PREPAREd after the tables load */
+
+int rdbSavePreparedStatements(FILE *fp) {
+    dictEntry    *de;
+    dictIterator *di = dictGetIterator(StmtD);
+    while((de = dictNext(di))) {
+        sds    pname = dictGetEntryKey(de);
+        robj  *o     = dictGetEntryVal(de);
+        uchar *x     = o->ptr;
+        int    argc; x = deserialiseInt(x, &argc);
+        if (rdbSaveType     (fp, REDIS_PREP_STMT)          == -1) goto rpserr;
+        if (rdbSaveRawString(fp, pname, sdslen(pname))     == -1) goto rpserr;
+        if (rdbSaveLen      (fp, argc)                     == -1) goto rpserr;
+        for (int i = 0; i < argc; i++) {
+            int len; x = deserialiseInt(x, &len);
+            if (rdbSaveRawString(fp, (sds)x, len)          == -1) goto rpserr;
+            x += len;
+        }
+    } dictReleaseIterator(di);
+    return 0;
+
+rpserr:
+    dictReleaseIterator(di); return -1;
+}
+bool rdbLoadPreparedStatement(FILE *fp) {
+    robj  *pname; uint32 argc;
+    if (!(pname = rdbLoadStringObject(fp)))                        return 0;
+    if ((argc   = rdbLoadLen(fp, NULL)) == REDIS_RDB_LENERR)       return 0;
+    robj **argv = zmalloc(sizeof(robj *) * (argc + 4));  // FREE ME 201
+    argv[0]     = createStringObject("PREPARE", 7);
+    argv[1]     = pname;
+    argv[2]     = createStringObject("AS", 2);
+    for (uint32 i = 0; i < argc; i++) {
+        if (!(argv[i + 3] = rdbLoadStringObject(fp)))              return 0;
+    }
+    argv[argc + 3] = NULL;
+    if (!LoadedStmts) LoadedStmts = listCreate();
+    listAddNodeTail(LoadedStmts, argv);
+    return 1;
+}
+static bool replyIsErr(cli *rfc) {
+    if (rfc->bufpos) return (*rfc->buf == '-');
+    listNode *ln = listFirst(rfc->reply); if (!ln) return 0;
+    robj     *o  = ln->value;
+    return (*(char *)o->ptr == '-');
+}
+void rdbLoadPreparedStatementsFinished() {
+    if (!LoadedStmts) return;
+    cli      *occ = server.alc.CurrClient;
+    cli      *rfc = getFakeClient();
+    listNode *ln;
+    listIter *li  = listGetIterator(LoadedStmts, AL_START_HEAD);
+    while((ln = listNext(li))) {
+        robj **argv = ln->value;
+        cleanupFakeClient(rfc); resetFakeClient(rfc); rfc->bufpos = 0;
+        rfc->argv   = argv;                              // FREED 201
+        rfc->argc   = 0; while (argv[rfc->argc]) rfc->argc++;
+        server.alc.CurrClient = rfc;
+        prepareCommand(rfc);
+        if (replyIsErr(rfc)) {
+            redisLog(REDIS_WARNING, "PREPARE %s failed on load",
+                                    (char *)argv[1]->ptr);
+        }
+    } listReleaseIterator(li);
+    cleanupFakeClient(rfc); resetFakeClient(rfc); rfc->bufpos = 0;
+    server.alc.CurrClient = occ;
+    listRelease(LoadedStmts); LoadedStmts = NULL;
+}
@@ -35,10 +35,16 @@ ALL RIGHTS RESERVED
 void prepareRQ     (cli *c,     cswc_t *w, wob_t *wb, bool cstar,
                     int  qcols, icol_t *ic);
 bool prepareJoin   (cli *c, jb_t *jb);
+void prepareTemplate(cli *c);
 void prepareCommand(cli *c);
 
 bool executeCommandBinary (cli *c, uchar *x); // EMBEDDED
 bool executeCommandInnards(cli *c);           // EMBEDDED
 void executeCommand       (cli *c);
+void bexecuteCommand      (cli *c);
+
+int  rdbSavePreparedStatements        (FILE *fp);
+bool rdbLoadPreparedStatement         (FILE *fp);
+void rdbLoadPreparedStatementsFinished();
 
 #endif /* __ALCHEMYDB_PREP_STMT__H */ 
@@ -36,6 +36,8 @@ ALL RIGHTS RESERVED
 #include "join.h"
 #include "bt.h"
 #include "filter.h"
+#include "fprog.h"
+#include "bitmap.h"
 #include "index.h"
 #include "find.h"
 #include "alsosql.h"
@@ -261,6 +263,7 @@ static void checkMissnMCI(jb_t *jb, ijp_t *ij, list **flist, int ii, bool rhs) {
     MATCH_INDICES(iflt->tmatch)
     for (int i = 0; i < matches; i++) {
         r_ind_t *ri = &Index[inds[i]];
+        if (!ri->done) continue; /* BACKGROUND build in progress */
         if (ri->clist) { /* check ALL MCIs for this table */
             int       strt = 0;
             if (ii) { /* secondary joins can join on MCI clist[0] */
@@ -432,10 +435,10 @@ static uint32 matchCheapestMCI(list **flist,   list **klist,
 #define CNT_INDXD (UINT_MAX - 1) /* indexed columns before non-indexed */
 #define QOP_MAX_NUM_CHECK 10     /* if [range,inl] bigger, dont estimate cost */
 static uint32 numRows4INL(f_t *flt) {
-    int ctype = Tbl[flt->tmatch].col[flt->ic.cmatch].type;
+    int ctype = CTYPE_FROM_FLT(flt) /* EXPRESSION INDEXes: cmatch: -1 */
     if (!C_IS_NUM(ctype))        return CNT_INDXD; /* only NUMs */
     int num = listLength(flt->inl);
-    if (Index[flt->imatch].virt) return num;
+    if (Index[flt->imatch].virt || UNIQ(Index[flt->imatch].cnstr)) return num;
     if (num > QOP_MAX_NUM_CHECK) return CNT_INDXD;
     listNode *ln;
     aobj      afk; initAobjZeroNum(&afk, ctype);
@@ -455,12 +458,12 @@ static uint32 numRows4INL(f_t *flt) {
 }
 static uint32 numRows4Range(f_t *flt) {
     if (flt->ic.cmatch < -1)       return CNT_INDXD;
-    int ctype = Tbl[flt->tmatch].col[flt->ic.cmatch].type;
+    int ctype = CTYPE_FROM_FLT(flt) /* EXPRESSION INDEXes: cmatch: -1 */
     if (!C_IS_NUM(ctype))          return CNT_INDXD; /* only NUMs */
     int range = C_IS_I(ctype) ? flt->ahigh.i - flt->alow.i :
                 C_IS_L(ctype) ? flt->ahigh.l - flt->alow.l :
              /* C_IS_X */       flt->ahigh.x - flt->alow.x;
-    if (Index[flt->imatch].virt)   return range;
+    if (Index[flt->imatch].virt || UNIQ(Index[flt->imatch].cnstr)) return range;
     if (range > QOP_MAX_NUM_CHECK) return CNT_INDXD;
     aobj    afk; initAobjZeroNum(&afk, ctype);
     bt     *ibtr = getIBtr(flt->imatch);
@@ -511,6 +514,7 @@ static uint32 sortFLCheap(list **flist,   list **klist,
             if (ri->clist)                                  continue;
             if (jcmatch != -1 && flt->ic.cmatch != jcmatch) continue;
             if (flt->op == LFUNC)                           continue;
+            if (flt->nin)                     continue; /* NOT IN: filter */
             if (flt->op == EQ || flt->op == RQ || flt->op == IN) {/*KEY,RQ,INL*/
                 uint32 cnt = getNumRow4Filter(flt);
                 if (cnt < lowc) {
@@ -736,8 +740,8 @@ bool promoteKLorFLtoW(cswc_t *w, list **klist, list **flist, bool freeme) {
 }
 
 // RANGE_QUERY RANGE_QUERY RANGE_QUERY RANGE_QUERY RANGE_QUERY RANGE_QUERY
-static void rangeQuerySortFLCheap(list **flist, list **klist) {
-    sortFLCheap(flist, klist, &Idum, -1);
+static uint32 rangeQuerySortFLCheap(list **flist, list **klist) {
+    return sortFLCheap(flist, klist, &Idum, -1);
 }
 static bool rewriteFuncToLimOfstQuery(cswc_t *w, wob_t *wb) {
     //printf("REWRITE FUNC TO OFFSET\n"); dumpW(printf, w); dumpWB(printf, wb);
@@ -764,23 +768,87 @@ static bool rewriteFuncToLimOfstQuery(cswc_t *w, wob_t *wb) {
     return 1;
 }
 
+// BITMAP_INDEX BITMAP_INDEX BITMAP_INDEX BITMAP_INDEX BITMAP_INDEX
+static int bitmapFilterIndex(f_t *flt) { /* [col = x|col IN (x,y)] */
+    if (flt->ic.cmatch < 1 || flt->ic.nlo || flt->ic.fimatch != -1) return -1;
+    if (flt->op == EQ) {
+        if (flt->akey.type == COL_TYPE_NONE || flt->akey.empty)      return -1;
+    } else if (flt->op != IN || !flt->inl || flt->nin)               return -1;
+    return find_bitmap_index(flt->tmatch, flt->ic.cmatch);
+}
+static rbm_t *bitmapForFilter(r_ind_t *ri, f_t *flt) {   /* FREE ME 220 */
+    if (flt->op == EQ) {
+        rbm_t *b = bitmapIndexGet(ri, &flt->akey);
+        return b ? rbmClone(b) : rbmCreate();
+    }
+    rbm_t    *res = rbmCreate(); listNode *ln; /* IN() -> OR */
+    listIter *li  = listGetIterator(flt->inl, AL_START_HEAD);
+    while((ln = listNext(li))) {
+        rbm_t *b = bitmapIndexGet(ri, ln->value);
+        if (b) rbmOr(res, b);
+    } listReleaseIterator(li);
+    return res;
+}
+/* flist's [EQ,IN] filters on BITMAP indexed cols are ANDed together, if the
+   result has fewer PKs than the cheapest btree lookup (nrows) it becomes the
+   plan: rows are fetched by PK & those filters are dropped (never run) */
+static bool bitmapQueryPlan(cswc_t *w, uint32 nrows) {
+    rbm_t    *res = NULL; listNode *ln;
+    listIter *li  = listGetIterator(w->flist, AL_START_HEAD);
+    while((ln = listNext(li))) {
+        f_t *flt    = ln->value;
+        int  imatch = bitmapFilterIndex(flt);
+        if (imatch == -1) continue;
+        rbm_t *b    = bitmapForFilter(&Index[imatch], flt);
+        if (!res) res = b;
+        else {
+            rbm_t *a = rbmAnd(res, b); rbmDestroy(res); rbmDestroy(b); res = a;
+        }
+    } listReleaseIterator(li);
+    if (!res)                                              return 0;
+    if (res->card >= nrows) { rbmDestroy(res);             return 0; }
+    li = listGetIterator(w->flist, AL_START_HEAD);
+    while((ln = listNext(li))) {
+        f_t *flt = ln->value;
+        if (bitmapFilterIndex(flt) == -1) continue;
+        destroyFilter(flt); listDelNode(w->flist, ln);
+    } listReleaseIterator(li);
+    if (!w->flist->len) releaseFlist(&w->flist);
+    w->wtype        = SQL_BITMAP_LKP; w->bmap         = res;
+    w->wf.imatch    = Tbl[w->wf.tmatch].vimatch; /* PK order, PK lookups */
+    w->wf.ic.cmatch = 0;
+    return 1;
+}
+
 bool optimiseRangeQueryPlan(cli *c, cswc_t *w, wob_t *wb) {
     if (!w->flist) return 0;
-    list     *kl  = NULL;
-    rangeQuerySortFLCheap(&w->flist, &kl);
+    list     *kl    = NULL;
+    uint32    nrows = rangeQuerySortFLCheap(&w->flist, &kl);
+    if (!kl && bitmapQueryPlan(w, nrows)) {
+        w->fprog = compileFilters(w->flist, w->wf.tmatch);
+        return 1;
+    }
+    if (!kl && ((f_t *)listFirst(w->flist)->value)->nin) { /* never the w */
+        addReply(c, shared.where_not_in_lkp);          goto orqp_err;
+    }
     promoteKLorFLtoW     (w, &kl, &w->flist, 1);
     if (w->wf.imatch == -1) {
-        addReply(c, shared.whereclause_col_not_indxd); return 0;
+        addReply(c, shared.whereclause_col_not_indxd); goto orqp_err;
     }
     if (w->wf.op != EQ && w->wf.op != RQ && w->wf.op != IN) {
-        addReply(c, shared.key_query_mustbe_eq);       return 0;
+        addReply(c, shared.key_query_mustbe_eq);       goto orqp_err;
     }
     if (C_IS_P(w->wf.akey.type) || C_IS_P(w->wf.alow.type)) {
         if (!rewriteFuncToLimOfstQuery(w, wb)) {
-            addReply(c, shared.nullbulk);              return 0;
+            addReply(c, shared.nullbulk);              goto orqp_err;
         }
     }                                   //dumpW(printf, w); dumpWB(printf, wb);
+    w->fprog = compileFilters(w->flist, w->wf.tmatch);
     return 1;
+
+orqp_err: /* error already replied -> callers must not run the lookup */
+    w->wtype = SQL_ERR_LKP;
+    return 0;
 }
 
 /* DEBUG DEBUG DEBUG DEBUG DEBUG DEBUG DEBUG DEBUG DEBUG DEBUG DEBUG */
@@ -59,6 +59,11 @@ typedef struct lua_trigger {
     ushort16  num; /* Index[num] */
 } luat_t;
 
+typedef struct evicted_range { /* EVICT tbl RANGE lo hi */
+    ulong lo;
+    ulong hi;
+} evr_t;
+
 //TODO many of r_tbl's elements are optional -> bitmap + malloc(elements)
 //TODO MM: many of r_tbl's elements are optional -> bitmap + malloc(elements)
 typedef struct r_tbl { // 131 bytes -> 136B
@@ -89,10 +94,18 @@ typedef struct r_tbl { // 131 bytes -> 136B
     bool     lfu;        /* LFU: indexing on/off                  */
     int      lfuc;       /* LFU: column containing LFU            */
     int      lfui;       /* LFU: index containing LFU             */
+    dict    *lrua;       /* LRU: APPROX: pending [PK -> LRU]      */
+    dict    *lfua;       /* LFU: APPROX: pending [PK -> accesses] */
     bool     dirty;      /* ALTER TABLE [UN]SET DIRTY             */
     ulong    nerows;     /* Number of Evicted Rows                */
     ulong    nebytes;    /* Number of Evicted Bytes               */
+    dict    *rsd;        /* ROWSTORE: [PK -> evicted row on disk] */
+    bool     rsmiss;     /* ROWSTORE: a row was EVICTed w/o a copy */
+    evr_t   *evr;        /* EVICT RANGE: sorted non-resident PK spans */
+    uint32   nevr;       /* EVICT RANGE: number of spans in evr    */
+    struct mmt *mm;      /* MMAP: read-only page-backed ROWs      */
     bool     haslo;      /* Table has LuaTable-Columns            */
+    uint32   cepoch;     /* DELTA: BtEpoch at CREATE TABLE        */
     dict    *fdict;      // USAGE: maps LuaFunctionIndexName to imatch
 } r_tbl_t;
 
@@ -118,8 +131,12 @@ typedef struct r_ind { // 100 bytes -> 108B
     bool    hlt;       /* LUATRIGGER - call lua function per CRUD            */
 
     icol_t  obc;       /* ORDER BY col                                       */
+    icol_t  icov;      /* INCLUDE col -> covering index [PK -> icov] nodes   */
+    bool    cvmiss;    /* INCLUDE: a row had an empty icov -> dont cover     */
     bool    done;      /* CREATE INDEX OFFSET -> not done until finished     */
     long    ofst;      /* CREATE INDEX OFFSET partial indexes current offset */
+    bool    bg;        /* CREATE INDEX BACKGROUND -> built by indexBuildCron */
+    aobj    bgpk;      /* BACKGROUND: last PK scanned (PK <= bgpk indexed)   */
 
     bool    iposon;    /* Index Position On (i.e. SELECT "index.pos()"       */
     uint32  cipos;     /* Current Index position, when iposon                */
@@ -128,6 +145,16 @@ typedef struct r_ind { // 100 bytes -> 108B
     sds     fname;     /* LuaFunctionIndex: functionname                     */
     sds     iconstrct; /* LuaFunctionIndex: constructor                      */
     sds     idestrct;  /* LuaFunctionIndex: destructor                       */
+
+    sds     pwc;       /* PARTIAL: CREATE INDEX ... WHERE predicate (text)   */
+    list   *pflist;    /* PARTIAL: pwc's filters -> rows indexed iff pass    */
+    uchar   xop;       /* EXPRESSION: [+,-,*,/,%,IXPR_LEFT] applied to icol  */
+    ulong   xarg;      /* EXPRESSION: operand (LEFT -> number of chars)      */
+    dict   *bmd;       /* BITMAP: column value -> roaring bitmap of PKs      */
+    struct ihash *hsh; /* HASH: [column value -> PK] for EQ & IN lookups     */
+    uint32  hcoll;     /* HASH TEXT: strings whose hash slot was taken (BT)  */
+    bool    persist;   /* PERSIST: RDB stores the BT -> NOT rebuilt on load  */
+    bool    rdbbt;     /* RDB LOAD: BT was read from the RDB (skip rebuild)  */
 } r_ind_t;
 
 typedef struct update_expression {
@@ -168,6 +195,8 @@ typedef struct filter {
     aobj     ahigh;  /* value of HIGH [sds="4",int=4,float=4.0]           */
 
     list    *inl;    /* WHERE ..... AND x IN (1,2,3)                      */
+    struct in_set *ins; /* INL as a typed hash set (filter lookups)       */
+    bool     nin;    /* WHERE ..... AND x NOT IN (1,2,3)                  */
     list    *klist;  /* MCI list of matching (ordered) keys (as f_t)      */
 
     lue_t    le;     /* Filters can be Dynamic Lua Expressions            */
@@ -183,6 +212,9 @@ typedef struct where_clause_order_by {
     long    lim;                       /* ORDER BY LIMIT                      */
     long    ofst;                      /* ORDER BY OFFSET                     */
     sds     ovar;                      /* OFFSET varname - used by cursors    */
+    uint32  ngby;                      /* number GROUP BY columns             */
+    icol_t  gbc[MAX_GROUP_BY_COLS];    /* GROUP BY col                        */
+    bool    aggr;                      /* SELECT aggregates -> NO ORDER BY    */
 } wob_t;
 
 typedef struct check_sql_where_clause {
@@ -191,11 +223,15 @@ typedef struct check_sql_where_clause {
     sds     lvr;     /* Leftover AFTER parse                    */
     f_t     wf;      /* WhereClause Filter (i.e. i,c,t,low,inl) */
     list   *flist;   /* FILTER list (nonindexed cols in WC)     */
+    struct filter_prog *fprog; /* flist compiled at plan time  */
+    struct roaring_bitmap *bmap; /* BITMAP indexes' AND/OR of PKs */
 } cswc_t;
 
 typedef struct order_by_sort_element {
     void   *row;
     void  **keys;
+    uchar  *nkey;    /* normalised (memcmp-able) keys, see orderby.c */
+    uint32  nklen;
     aobj   *apk;
     uchar  *lruc;
     bool    lrud;
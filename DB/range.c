@@ -41,6 +41,12 @@ ALL RIGHTS RESERVED
 #include "bt.h"
 #include "bt_iterator.h"
 #include "filter.h"
+#include "fprog.h"
+#include "bitmap.h"
+#include "rowstore.h"
+#include "evict.h"
+#include "hash.h"
+#include "aggr.h"
 #include "orderby.h"
 #include "index.h"
 #include "wc.h"
@@ -71,7 +77,7 @@ typedef struct inner_bt_data {
     row_op  *p;    range_t *g;    qr_t    *q;
     bt      *btr;  bt      *nbtr;
     long    *ofst; long    *card; long    *loops; bool    *brkr;
-    icol_t   obc;
+    icol_t   obc;  aobj    *afk;  /* FK (index key) -> COVERING INDEX */
 } ibtd_t;
 typedef bool node_op(ibtd_t *d);
 
@@ -93,7 +99,7 @@ static void init_ibtd(ibtd_t *d,    row_op *p,    range_t *g,     qr_t *q,
                       bool   *brkr, icol_t  obc) {
     d->p    = p;    d->g    = g;    d->q     = q;     d->nbtr = nbtr;
     d->ofst = ofst; d->card = card; d->loops = loops; d->brkr = brkr;
-    d->obc  = obc;
+    d->obc  = obc;  d->afk  = NULL;
 }
 
 // QUEUE_FOR_ORDER_BY_SORT QUEUE_FOR_ORDER_BY_SORT QUEUE_FOR_ORDER_BY_SORT
@@ -134,7 +140,8 @@ static void setRangeQueued(cswc_t *w, wob_t *wb, qr_t *q) {
         q->pk       = ((wb->nob > 1) || 
                        (wb->nob == 1 && icol_cmp(&wb->obc[0], &obc)));
         q->pk_lim   = (!q->pk    && (wb->lim  != -1));
-        q->pk_lo    = (q->pk_lim && (wb->ofst != -1));
+        q->pk_lo    = (q->pk_lim && (wb->ofst != -1)) && // ROWSTORE: EVICTs
+                      !Tbl[w->wf.tmatch].rsd; // skew scions -> walk OFFSET
         q->xth      = q->pk_lo && !(w->flist && (wb->ofst != -1));
         q->qed      = q->pk;
     } else {
@@ -224,16 +231,26 @@ static long rangeOpPK(range_t *g, row_op *p) {                 //DEBUG_RANGE_PK
     bt      *btr   = getBtr(w->wf.tmatch); g->co.btr = btr;
     g->asc         = !q->pk_desc;
     bool     brkr  = 0; long loops = -1; long card =  0;
+    bool     rsin  = rsFaultInRange(w->wf.tmatch, &w->wf.alow, &w->wf.ahigh);
+    if (!rsin && !upx &&         // EVICT RANGE: whole range evicted -> MISS
+        evrCoversRange(w->wf.tmatch, &w->wf.alow, &w->wf.ahigh)) {
+        if      (isd) DELETE_MISS(g->co.c);
+        else if (isu) UPDATE_MISS(g->co.c);
+        return -1;                                // iss err in iselectAction
+    }
     bi = (q->xth) ? 
               btGetXthIter  (btr, &w->wf.alow, &w->wf.ahigh, wb->ofst, g->asc) :
               btGetRangeIter(btr, &w->wf.alow, &w->wf.ahigh, g->asc);
     if (!bi) return card;                              //DEBUG_RANGEPK_PRE_LOOP
     if (!bi->empty) {
-        if (bi->missed && !upx) {     card = -1; // iss error in iselectAction()
+        if (bi->missed && !upx && !rsin) { card = -1; // iss err in iselectAction
             if      (isd) DELETE_MISS(g->co.c);
             else if (isu) UPDATE_MISS(g->co.c);
         } else while ((be = btRangeNext(bi, g->asc))) {    //DEBUG_RANGEPK_LOOP
-            if (bi->missed && !upx) { card = -1;
+            if (rsin) { // ROWSTORE: all rows back, MISSes are stale DR spans
+                if (IS_GHOST(btr, be->val) ||       // MISS starts @ its span
+                    aobjLT(be->key, &w->wf.alow))                 continue;
+            } else if (bi->missed && !upx) { card = -1;
                 if (isu) UPDATE_MISS(g->co.c);
                 if (isd) DELETE_MISS(g->co.c);
                 break;
@@ -243,7 +260,7 @@ static long rangeOpPK(range_t *g, row_op *p) {                 //DEBUG_RANGE_PK
             }
             if (brkr) break;
         }
-        if ((card != -1) && !upx) {// FULL Iter8r, (last row dr > 0)
+        if ((card != -1) && !upx && !rsin) {// FULL Iter8r, (last row dr > 0)
             //DEBUG_RANGEPK_POST_LOOP
             if (q->pk_lim) { if (wb->lim > card && bi->missed) card = -1; }
             else if                               (bi->missed) card = -1;
@@ -265,7 +282,10 @@ static bool uBT_Op(ibtd_t *d) { /* OTHER_BTs (no evictions)*/    //DEBUG_UBT_OP
         else if (wb->lim == *d->card) { *d->brkr = 1; return 1; }
     }
     // FK lookup must succeed, evictions not possible
-    void *rrow = btFind(d->g->co.btr, &UniqueIndexVal);
+    crow_t cr; void *rrow;
+    if (d->g->se.cover) { /* COVERING: [FK -> PK] is the whole projection */
+        cr.btr = d->nbtr; cr.afk = d->afk; cr.nrow = NULL; rrow = &cr;
+    } else rrow = btFind(d->g->co.btr, &UniqueIndexVal);
     if (!(*d->p)(d->g, &UniqueIndexVal, rrow, d->g->q->qed, d->card)) return 0;
     return 1;
 }
@@ -299,7 +319,11 @@ static bool nBT_ROp(ibtd_t *d,    qr_t *q,    wob_t *wb,
         key = &akey;                                //DEBUG_NODE_BT_OBC_2
     } 
     // pk comes from Index, so it has not been evicted
-    void *rrow = btFind(d->g->co.btr, key); releaseAobj(&akey);
+    crow_t cr; void *rrow;
+    if (d->g->se.cover) { /* COVERING INDEX: [PK -> INCLUDE] node entry */
+        cr.btr = nbtr; cr.afk = d->afk; cr.nrow = brow; rrow = &cr;
+    } else rrow = btFind(d->g->co.btr, key);
+    releaseAobj(&akey);
     if (!(*d->p)(d->g, key, rrow, q->qed, d->card)) { *ret = 0; return 0; }
     //DEBUG_NBT_ROP
     if (q->fk_lim && wb->lim == *d->card) { *d->brkr = 1;       return 1; }
@@ -371,6 +395,32 @@ static bool setUniqIndexVal(bt *nbtr, aobj *akey) {
       else assert(!"setUniqIndexVal ERROR");
     return 1;
 }
+/* HASH: [FK -> PK] w/o an ibtr descent, the PK's row can be EVICTED (MISS)
+   TEXT (HASHS): the ihash key is the string's hash -> the hit is verified
+   against the row, a collision means the string may only be in the ibtr */
+#define HIDX_MISS -1
+#define HIDX_NONE  0
+#define HIDX_HIT   1 /* UniqueIndexVal is the PK */
+#define HIDX_IBTR  2 /* descend the ibtr */
+static int setHashIndexVal(r_ind_t *ri, aobj *akey, bt *btr) {
+    ulong  pk;
+    bool   text  = HASHS(ri->cnstr);
+    int    nohit = (text && ri->hcoll) ? HIDX_IBTR : HIDX_NONE;
+    if (!alc_ihash_fetch(HASH_KEY(akey), &pk, ri->hsh)) return nohit;
+    aobj  *uv    = &UniqueIndexVal; uv->empty = 0;
+    uchar  pktyp = Tbl[ri->tmatch].col[0].type;
+    uv->enc      = uv->type = pktyp;
+    if C_IS_I(pktyp) uv->i = (uint32)pk; else uv->l = pk;
+    dwm_t  dwm   = btFindD(btr, uv);
+    if (dwm.miss)                                        return HIDX_MISS;
+    if (!text)                                           return HIDX_HIT;
+    if (!dwm.k)                                          return nohit;
+    aobj   acol  = getCol(btr, dwm.k, ri->icol, uv, ri->tmatch, NULL);
+    bool   same  = (acol.len == akey->len &&
+                    !memcmp(acol.s, akey->s, akey->len));
+    releaseAobj(&acol);
+    return same ? HIDX_HIT : nohit;
+}
 
 bt *btMCIFindVal(cswc_t *w, bt *nbtr, uint32 *nmatch, r_ind_t *ri) {
     if (nbtr && w->wf.klist) {
@@ -468,6 +518,7 @@ static long rangeOpFK(range_t *g, row_op *p) {               //DEBUG_RANGE_FK
     while ((be = btRangeNext(bi, g->asc))) {              //DEBUG_RANGE_FK_LOOP
         if (iss && !be->val) { card = -1; break; }
         uint32  nmatch  = 0;
+        d.afk           = be->key;
         d.nbtr          = singu ? ibtr : btMCIFindVal(w, be->val, &nmatch, ri);
         if (d.nbtr) {
             uint32 diff = nexpc - nmatch;
@@ -493,18 +544,26 @@ static long singleOpFK(range_t *g, row_op *p) {               //DEBUG_SINGLE_FK
     node_op  *nop    = UNIQ(ri->cnstr) ? uBT_Op : nBT_Op;
     uint32    nexpc  = ri->clist ? (ri->clist->len - 1) : 0;
     bool      singu  = SIMP_UNIQ(ibtr);
-    bt       *fibtr  = singu ? NULL : btIndFind(ibtr, afk); //DEBUG_SINGFK_INFO
+    bool      hshu   = ri->hsh && !g->se.cover; /* HASH: O(1) */
+    int       hit    = hshu ? setHashIndexVal(ri, afk, g->co.btr) : HIDX_IBTR;
+    if      (hit == HIDX_MISS)                                     return -1;
+    else if (hit == HIDX_NONE)                                     return  0;
+    bool      hshd   = (hit == HIDX_HIT);  /* UniqueIndexVal -> uBT_Op() */
+    bool      nodsc  = singu || hshd;      /* NO ibtr descent */
+    bt       *fibtr  = nodsc ? NULL : btIndFind(ibtr, afk); //DEBUG_SINGFK_INFO
     // CHECK for a 100% Evicted Index
-    if (!singu && iss && !fibtr) { if (btIndExist(ibtr, afk)) return -1; }
-    bt       *nbtr   = singu ? ibtr : btMCIFindVal(w, fibtr, &nmatch, ri);
+    if (!nodsc && iss && !fibtr) { if (btIndExist(ibtr, afk)) return -1; }
+    bt       *nbtr   = nodsc ? ibtr : btMCIFindVal(w, fibtr, &nmatch, ri);
     long      ofst   = wb->ofst;
     long      loops  = -1; long card =  0; bool brkr =  0;
     init_ibtd(&d, p, g, q, nbtr, &ofst, &card, &loops, &brkr, ri->obc);
+    d.afk            = afk;
     if (d.nbtr) {
         uint32 diff = nexpc - nmatch;
         if      (diff) { if (!runOnNode(d.nbtr, diff, nop, &d, ri)) return -1; }
+        else if (hshd) { if (!uBT_Op(&d))                          return -1; }
         else {
-            if (singu && !setUniqIndexVal(nbtr, afk))              return -1;
+            if (singu && !setUniqIndexVal(nbtr, afk))              return card;
             if (!(*nop)(&d))                                       return -1;
         }
     }
@@ -531,7 +590,8 @@ static long inOpPK(range_t *g, row_op *p) {                //printf("inOpPK\n");
     listIter *li      = listGetIterator(w->wf.inl, AL_START_HEAD);
     while((ln = listNext(li))) {
         aobj  *apk  = ln->value;
-        dwm_t  dwm  = btFindD(g->co.btr, apk);   if (dwm.miss) return -1;
+        dwm_t  dwm  = evictFindD(w->wf.tmatch, apk);
+        if (dwm.miss) return -1;
         void  *rrow = dwm.k;
         bool   gost = IS_GHOST(g->co.btr, rrow); if (gost)     continue;
         if (rrow && !pk_op_l(apk, rrow, g, p, wb, q, &card, &loops, &brkr)) CBRK
@@ -548,6 +608,8 @@ static long inOpFK(range_t *g, row_op *p) {                //printf("inOpFK\n");
     r_ind_t  *ri      = &Index [w->wf.imatch];
     node_op  *nop     = UNIQ(ri->cnstr) ? uBT_Op : nBT_Op;
     uint32    nexpc   = ri->clist ? (ri->clist->len - 1) : 0;
+    bool      singu   = SIMP_UNIQ(ibtr);
+    bool      hshu    = ri->hsh && !g->se.cover; /* HASH: O(1) */
     long      ofst    = wb->ofst;
     long      loops   = -1; long card =  0; bool brkr =  0;
     init_ibtd(&d, p, g, q, NULL, &ofst, &card, &loops, &brkr, ri->obc);
@@ -555,7 +617,18 @@ static long inOpFK(range_t *g, row_op *p) {                //printf("inOpFK\n");
     while((ln = listNext(li))) {
         uint32  nmatch = 0;
         aobj   *afk    = ln->value;
+        int     hit    = hshu ? setHashIndexVal(ri, afk, g->co.btr) : HIDX_IBTR;
+        if      (hit == HIDX_MISS)                                      CBRK
+        else if (hit == HIDX_NONE)                                  continue;
+        if (singu || hit == HIDX_HIT) { /* SIMPLE UNIQUE: [FK -> PK] */
+            if (hit != HIDX_HIT && !setUniqIndexVal(ibtr, afk))     continue;
+            d.afk      = afk; d.nbtr = ibtr;
+            if (!uBT_Op(&d))                                            CBRK
+            if (brkr) break;
+            continue;
+        }
         bt     *beval  = btIndFind (ibtr, afk); //DEBUG_IN_OP_FK_LOOP
+        d.afk          = afk;
         if (iss && !beval) { if (btIndExist(ibtr, afk)) return -1; }
         d.nbtr         = btMCIFindVal(w, beval, &nmatch, ri);
         if (d.nbtr) {
@@ -570,13 +643,53 @@ static long inOpFK(range_t *g, row_op *p) {                //printf("inOpFK\n");
 static long inOp(range_t *g, row_op *p) {
     return Index[g->co.w->wf.imatch].virt ? inOpPK(g, p) : inOpFK(g, p);
 }
+
+// BITMAP BITMAP BITMAP BITMAP BITMAP BITMAP BITMAP BITMAP BITMAP BITMAP
+static long bitmapOp(range_t *g, row_op *p) {            //printf("bitmapOp\n");
+    cswc_t  *w     = g->co.w; wob_t *wb = g->co.wb; qr_t *q = g->q;
+    bool     iss   = g->se.qcols ? 1 : 0;  bool isu  = g->up.ncols ? 1 : 0;
+    bool     isd   = !iss && !isu;         bool upx  = g->up.upx;
+    bt      *btr   = getBtr(w->wf.tmatch); g->co.btr = btr;
+    g->asc         = !q->pk_desc;
+    bool     brkr  = 0; long loops = -1; long card =  0;
+    aobj     apk;  initAobjZeroNum(&apk, Tbl[w->wf.tmatch].col[0].type);
+    rbmi_t   it;   rbmIterInit(&it, w->bmap, g->asc);
+    if (q->xth) rbmSkip(&it, wb->ofst); /* OFFSET: skips whole containers */
+    long     ofst  = (q->pk_lo && !q->xth) ? wb->ofst : 0; /* FILTERS+OFFSET */
+    ulong    pk;
+    while (rbmNext(&it, &pk)) {
+        if C_IS_I(apk.type) apk.i = (uint32)pk; else apk.l = pk;
+        dwm_t  dwm  = evictFindD(w->wf.tmatch, &apk);
+        if (dwm.miss) {
+            if (upx) continue;
+            card = -1;
+            if      (isd) DELETE_MISS(g->co.c);
+            else if (isu) UPDATE_MISS(g->co.c);
+            break;
+        }
+        void  *rrow = dwm.k;
+        if (!rrow || IS_GHOST(btr, rrow)) continue;
+        if (ofst > 0) { /* OFFSET counts rows that PASS the filters */
+            bool hf = 0;
+            bool ok = passWFilts(w, btr, &apk, rrow, w->wf.tmatch, &hf);
+            if (hf) CBRK
+            if (ok) ofst--;
+            continue;
+        }
+        if (!pk_op_l(&apk, rrow, g, p, wb, q, &card, &loops, &brkr)) CBRK
+        if (brkr) break;
+    }
+    releaseAobj(&apk);
+    return card;
+}
 long Op(range_t *g, row_op *p) {
-    if (g->co.w->wtype == SQL_IN_LKP) return inOp( g, p);
-    else                              return keyOp(g, p);
+    if (g->co.w->wtype == SQL_BITMAP_LKP) return bitmapOp(g, p);
+    if (g->co.w->wtype == SQL_IN_LKP)     return inOp(    g, p);
+    else                                  return keyOp(   g, p);
 }
 
 // FILTERS FILTERS FILTERS FILTERS FILTERS FILTERS FILTERS FILTERS FILTERS
-static bool runLuaFilter(lue_t *le, bt *btr, aobj *apk, void *rrow, int tmatch,
+bool runLuaFilter(lue_t *le, bt *btr, aobj *apk, void *rrow, int tmatch,
                          bool  *hf) {
     //printf("runLuaFilter: fname: %s ncols: %d\n", le->fname, le->ncols);
     lua_getglobal(server.lua, le->fname);
@@ -608,7 +721,7 @@ static bool runLuaFilter(lue_t *le, bt *btr, aobj *apk, void *rrow, int tmatch,
 bool passFilts(bt   *btr, aobj *apk, void *rrow, list *flist, int tmatch, 
                bool *hf) {
     if (!flist) return 1; /* no filters always passes */
-    listNode *ln, *ln2;
+    listNode *ln;
     bool      ret = 1;       //printf("passFilts: nfliters: %d\n", flist->len);
     listIter *li  = listGetIterator(flist, AL_START_HEAD);
     while ((ln = listNext(li))) {
@@ -616,12 +729,7 @@ bool passFilts(bt   *btr, aobj *apk, void *rrow, list *flist, int tmatch,
         if (tmatch != flt->tmatch) continue;
         aobj a    = getCol(btr, rrow, flt->ic, apk, tmatch, NULL);
         if        (flt->inl) {
-            listIter *li2 = listGetIterator(flt->inl, AL_START_HEAD);
-            while((ln2 = listNext(li2))) {
-                aobj *a2  = ln2->value;
-                ret       = (*OP_CMP[EQ])(a2, &a);        //DEBUG_PASS_FILT_INL
-                if (ret) break;                   /* break INNER-LOOP on hit */
-            } listReleaseIterator(li2);
+            ret = passINL(flt, &a);                       //DEBUG_PASS_FILT_INL
             releaseAobj(&a);
             if (!ret) break;                      /* break OUTER-LOOP on miss */
         } else if (flt->alow.type != COL_TYPE_NONE) {
@@ -640,10 +748,17 @@ bool passFilts(bt   *btr, aobj *apk, void *rrow, list *flist, int tmatch,
     } listReleaseIterator(li);
     return ret;
 }
+bool passWFilts(cswc_t *w,    bt   *btr, aobj *apk, void *rrow, int tmatch,
+                bool   *hf) { /* compiled program, else walk the flist */
+    if (w->fprog && w->fprog->tmatch == tmatch) {
+        return runFProg(w->fprog, btr, apk, rrow, hf);
+    }
+    return passFilts(btr, apk, rrow, w->flist, tmatch, hf);
+}
 
 #define OP_FILTER_CHECK \
   int  tmatch = g->co.w->wf.tmatch; bool hf = 0; \
-  bool ret    = passFilts(g->co.btr, apk, rrow, g->co.w->flist, tmatch, &hf); \
+  bool ret    = passWFilts(g->co.w, g->co.btr, apk, rrow, tmatch, &hf); \
   if (hf) return 0; if (!ret) return 1;
 
 /* SQL_CALLS SQL_CALLS SQL_CALLS SQL_CALLS SQL_CALLS SQL_CALLS SQL_CALLS */
@@ -672,24 +787,55 @@ static bool select_op(range_t *g, aobj *apk, void *rrow, bool q, long *card) {
 bool opSelectSort(cli  *c,    list *ll,   wob_t *wb,
                   bool ofree, long *sent, int    tmatch) {
     bool     ret  = 1;
-    obsl_t **v    = sortOB2Vector(ll);
+    obi_t    obi; initOBIter(&obi, ll, ofree);
+    obsl_t  *ob;
     long     ofst = wb->ofst;
-    for (int i = 0; i < (int)listLength(ll); i++) {
+    while ((ob = nextOBIter(&obi))) {
         if (wb->lim != -1 && *sent == wb->lim) break;
         if (ofst > 0) ofst--;
         else {
             *sent      = *sent + 1;
-            obsl_t *ob = v[i];
             if (!addReplyRow(c, ob->row, tmatch, ob->apk, ob->lruc, ob->lrud,
                                                           ob->lfuc, ob->lfu)) {
                 ret = 0; break;
             }
         }
     }
-    sortOBCleanup(v, listLength(ll), ofree);
-    free(v); /* FREED 004 */
+    releaseOBIter(&obi);
     return ret;
 }
+/* COVERING INDEX: a SELECT w/ ONLY [PK, FK, INCLUDE] in its projection, no
+   filters, no ORDER BY queueing & no LRU/LFU touches is served by the index
+   nodes, the table's row is never looked up (nor decoded) */
+bool isCoveredSelect(cswc_t *w, qr_t *q, bool cstar, icol_t *ics, int qcols) {
+    if (cstar || q->qed || w->flist || w->wf.imatch == -1) return 0;
+    r_ind_t *ri   = &Index[w->wf.imatch];
+    r_tbl_t *rt   = &Tbl  [w->wf.tmatch];
+    if (ri->virt  || ri->clist   || ri->hlt || ri->fname || ri->lru ||
+        ri->lfu   || ri->icol.nlo || !ri->done || rt->lrud || rt->lfu) return 0;
+    bool     uniq = UNIQ(ri->cnstr);
+    if (uniq) { if (w->wtype == SQL_IN_LKP)                          return 0;
+    } else if (ri->icov.cmatch == -1 || ri->cvmiss)                  return 0;
+    for (int i = 0; i < qcols; i++) {
+        int cmatch = ics[i].cmatch;
+        if (ics[i].nlo)                                              return 0;
+        if (cmatch && cmatch != ri->icol.cmatch &&
+            (uniq  || cmatch != ri->icov.cmatch))                    return 0;
+    }
+    return 1;
+}
+static bool cover_op(range_t *g, aobj *apk, void *rrow, bool q, long *card) {
+    (void)q;
+    crow_t *cr     = (crow_t *)rrow;
+    int     tmatch = g->co.w->wf.tmatch;
+    uchar   ost    = OR_NONE;
+    robj   *r      = outputRow(cr->btr, cr,     g->se.qcols, g->se.ics,
+                               apk,     tmatch, NULL,        &ost);
+    if (!r) return 0;
+    bool    ret    = addReplyRow(g->co.c, r, tmatch, apk, NULL, 0, NULL, 0);
+    if (!(EREDIS)) decrRefCount(r);
+    INCR(*card) server.alc.CurrCard++; return ret;
+}
 void iselectAction(cli *c,      cswc_t *w,     wob_t *wb,
                    icol_t *ics, int     qcols, bool   cstar, lfca_t *lfca) {
     //printf("\n\niselectAction: imatch: %d\n", w->wf.imatch);
@@ -698,11 +844,16 @@ void iselectAction(cli *c,      cswc_t *w,     wob_t *wb,
     init_range(&g, c, w, wb, &q, ll, OBY_FREE_ROBJ, NULL);
     g.se.cstar   = cstar; g.se.qcols   = qcols;
     g.se.ics     = ics;   g.se.lfca    = lfca;
+    g.se.cover   = isCoveredSelect(w, &q, cstar, ics, qcols);
     void *rlen   = (cstar || EREDIS) ? NULL : addDeferredMultiBulkLength(c);
-    long  card   = Op(&g, select_op);
+    long  card   = Op(&g, g.se.cover ? cover_op : select_op);
     //printf("iselectAction: card: %ld CurrCard: %ld CurrUpdated: %ld\n",
     //        card, server.alc.CurrCard, server.alc.CurrUpdated);
-    if (card == -1) { replaceDMB(c, rlen, server.alc.CurrError); goto isele; }
+    if (card == -1) {
+        robj *err = server.alc.CurrError ? server.alc.CurrError :
+                                           shared.dirty_miss; /* PK miss */
+        replaceDMB(c, rlen, err);                             goto isele;
+    }
     long sent    = 0;
     if (card) {
         if (q.qed) {
@@ -723,6 +874,37 @@ isele:
     releaseOBsort(ll);
 }
 
+static bool aggr_op(range_t *g, aobj *apk, void *rrow, bool q, long *card) {
+    (void)q; OP_FILTER_CHECK
+    cli *c = g->co.c;
+    GET_LRUC GET_LFUC /* NOTE: rows are read (not replied) -> still touched */
+    updateLru(c, tmatch, apk, lruc, lrud);
+    updateLfu(c, tmatch, apk, lfuc, lfu);
+    agst_t *as = g->se.agst;
+    if (!aggrRow(as, g->co.btr, apk, rrow)) return 0;
+    if (as->strm) *card = as->ngrp; /* STREAM: scan's LIMIT counts GROUPS */
+    else          INCR(*card)
+    server.alc.CurrCard++; return ret;
+}
+void iaggrAction(cli *c, cswc_t *w, wob_t *wb, aggr_t *ag) {
+    agst_t as; initAggrState(&as, c, ag, w, wb); /* NOTE: resets LIMIT */
+    range_t g; qr_t q; setQueued(w, wb, &q);
+    init_range(&g, c, w, wb, &q, NULL, 0, NULL);
+    g.se.qcols   = ag->ncols; g.se.agst = &as;
+    void *rlen   = EREDIS ? NULL : addDeferredMultiBulkLength(c);
+    long  card   = Op(&g, aggr_op);
+    if (card == -1 || !finishAggr(&as)) {
+        robj *err = server.alc.CurrError ? server.alc.CurrError :
+                                           shared.dirty_miss; /* PK miss */
+        replaceDMB(c, rlen, err);                             goto iaggre;
+    }
+    if (!EREDIS) setDMB_Aggr_card_cnames(c, ag, as.sent, rlen);
+
+iaggre:
+    releaseAggrState(&as);
+    if (wb->ovar) incrOffsetVar(c, wb, as.sent);
+}
+
 typedef list *list_adder(list *list, void *value);
 static bool dellist_op(range_t *g, aobj *apk, void *rrow, bool q, long *card) {
     OP_FILTER_CHECK
@@ -739,23 +921,23 @@ static bool dellist_op(range_t *g, aobj *apk, void *rrow, bool q, long *card) {
 }
 static void opDeleteSort(list *ll,    cswc_t *w,      wob_t *wb,   bool  ofree,
                          long  *sent, int     matches, int   inds[]) {
-    obsl_t **v    = sortOB2Vector(ll);
+    obi_t    obi; initOBIter(&obi, ll, ofree); // REVERSED in ideleteAction()
+    obsl_t  *ob;
     long     ofst = wb->ofst;
-    for (int i = (int)listLength(ll) - 1; i >= 0; i--) { // REVERSE iteration
+    while ((ob = nextOBIter(&obi))) {
         if (wb->lim != -1 && *sent == wb->lim) break;
         if (ofst > 0) { ofst--; continue; }
-        obsl_t *ob  = v[i];
         aobj   *apk = ob->row;
         if (deleteRow(w->wf.tmatch, apk, matches, inds) == 1) INCR(*sent)
     }
-    sortOBCleanup(v, listLength(ll), ofree);
-    free(v); /* FREED 004 */
+    releaseOBIter(&obi);
 }
 void ideleteAction(redisClient *c, cswc_t *w, wob_t *wb) {
     range_t g; qr_t q; setQueued(w, wb, &q);
     MATCH_INDICES(w->wf.tmatch)
     list *ll   = initOBsort(q.qed, wb, 1);
     if (!q.qed) ll->free = destroyAobj;
+    else        reverseOBsort(); /* opDeleteSort() iterates in REVERSE */
     init_range(&g, c, w, wb, &q, ll, OBY_FREE_AOBJ, NULL);
     long  sent = 0;
     long  card = Op(&g, dellist_op);
@@ -795,26 +977,29 @@ static bool update_op(range_t *g, aobj *apk, void *rrow, bool q, long *card) {
 }
 static bool opUpdateSort(cli   *c,   list *ll,    cswc_t  *w,
                          wob_t *wb,  bool  ofree, long    *sent,
-                         bt    *btr, int   ncols, range_t *g, uc_t *uc) {
+                         bt    *btr, int   ncols, range_t *g, uc_t *uc,
+                         list  *opks) {
     bool     ret  = 1; /* presume success */
-    obsl_t **v    = sortOB2Vector(ll);
+    obi_t    obi; initOBIter(&obi, ll, ofree);
+    obsl_t  *ob;
     long     ofst = wb->ofst;
     init_uc(uc, btr, w->wf.tmatch, ncols, g->up.matches, g->up.indices,
             g->up.vals, g->up.vlens, g->up.chit, g->up.ue, g->up.le);
-    for (int i = 0; i < (int)listLength(ll); i++) {
+    while ((ob = nextOBIter(&obi))) {
         if (wb->lim != -1 && *sent == wb->lim) break;
         if (ofst > 0) ofst--;
         else {
             *sent        = *sent + 1;
-            obsl_t *ob   = v[i];
             aobj   *apk  = ob->row;
+            ob->row      = NULL; /* UpdateQueue references apk -> opks */
+            listAddNodeTail(opks, apk);
             void   *rrow = btFind(btr, apk); // pk comes from LL
             if (updateRow(c, uc, apk, rrow, 1) == -1) {
                 ret = 0; break; /* negate presumed success */
             } //NOTE: rrow is no longer valid, updateRow() can change it
         }
     }
-    sortOBCleanup(v, listLength(ll), ofree); free(v);//FREED004
+    releaseOBIter(&obi);
     return ret;
 }
 void iupdateAction(cli  *c,      cswc_t *w,       wob_t  *wb,
@@ -823,6 +1008,7 @@ void iupdateAction(cli  *c,      cswc_t *w,       wob_t  *wb,
                    ue_t  ue[],   lue_t  *le,      bool    upi) {
     range_t g; qr_t q; setQueued(w, wb, &q);
     list *ll     = initOBsort(q.qed, wb, 1);
+    list *opks   = listCreate(); opks->free = destroyAobj; /* sorted PKs */
     init_range(&g, c, w, wb, &q, ll, OBY_FREE_AOBJ, NULL);
     bt   *btr    = getBtr(w->wf.tmatch); g.up.btr = btr;
     g.up.ncols   = ncols;
@@ -840,7 +1026,7 @@ void iupdateAction(cli  *c,      cswc_t *w,       wob_t  *wb,
         uc_t  uc;
         if (q.qed) {
             if (!opUpdateSort(c, ll, w, wb, g.co.ofree, &sent,
-                              btr, ncols, &g, &uc))            goto iup_end;
+                              btr, ncols, &g, &uc, opks))      goto iup_end;
         } else {
             listNode  *ln;
             init_uc(&uc, g.up.btr,   g.co.w->wf.tmatch,
@@ -867,7 +1053,7 @@ void iupdateAction(cli  *c,      cswc_t *w,       wob_t  *wb,
     }
 
 iup_end:
-    releaseOBsort(ll);
+    releaseOBsort(ll); listRelease(opks);
 }
 
 // DEBUG DEBUG DEBUG DEBUG DEBUG DEBUG DEBUG DEBUG DEBUG DEBUG DEBUG DEBUG
@@ -59,6 +59,8 @@ typedef struct queue_range_results {
                i.e. not to be changed after initialization, just derefed */
 typedef struct range_select {
     bool cstar; int  qcols; icol_t *ics; lfca_t *lfca;
+    bool cover; /* COVERING INDEX -> rows are output from the index */
+    struct aggr_state *agst; /* GROUP BY & aggregates */
 } rsel_t;
 
 typedef struct range_update {
@@ -100,14 +102,20 @@ typedef bool row_op(range_t *g, aobj *apk, void *rrow, bool q, long *card);
 long keyOp(range_t *g, row_op *p); // Also Used in JOINs
 long Op(range_t *g, row_op *p);    // Also Used in JOINs
 
-bool passFilts(bt   *btr, aobj *akey, void *rrow, list *flist, int tmatch,
-               bool *hf);
+bool runLuaFilter(lue_t *le, bt *btr, aobj *apk, void *rrow, int tmatch,
+                  bool  *hf);
+bool passFilts (bt     *btr, aobj *akey, void *rrow, list *flist, int tmatch,
+                bool   *hf);
+bool passWFilts(cswc_t *w,   bt   *btr,  aobj *apk,  void *rrow,  int tmatch,
+                bool   *hf);
 
 bool opSelectSort(cli  *c,    list *ll,   wob_t *wb,
                   bool ofree, long *sent, int    tmatch);
 
+bool isCoveredSelect(cswc_t *w, qr_t *q, bool cstar, icol_t *ics, int qcols);
 void iselectAction(cli *c,      cswc_t *w,     wob_t *wb,
                    icol_t *ics, int     qcols, bool   cstar, lfca_t *lfca);
+void iaggrAction  (cli *c,      cswc_t *w,     wob_t *wb,    aggr_t *ag);
 
 void ideleteAction(cli *c,         cswc_t *w,       wob_t *wb);
 
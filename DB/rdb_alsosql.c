@@ -35,12 +35,17 @@ ALL RIGHTS RESERVED
 #include "find.h"
 #include "bt.h"
 #include "index.h"
+#include "bitmap.h"
+#include "hash.h"
 #include "lru.h"
 #include "stream.h"
 #include "ddl.h"
 #include "alsosql.h"
 #include "common.h"
 #include "rdb_alsosql.h"
+#include "rdb_pload.h"
+#include "rdb_delta.h"
+#include "mmtbl.h"
 
 /* RDB TODO LIST
     1.) [sk, fk_cmatch, fk_otmatch, fk_ocmatch] -> PERSISTENT
@@ -65,6 +70,14 @@ uint32_t  rdbLoadLen(FILE *fp, int *isencoded);
 int       rdbLoadType(FILE *fp);
 robj     *rdbLoadStringObject(FILE *fp);
 
+#define RDB_ICOV_FLAG (1 << 24) /* INDEX's obc slot holds INCLUDE's cmatch */
+#define RDB_IXTR_FLAG (1 << 24) /* INDEX's cnstr slot: [EXPRESSION,WHERE] end */
+#define RDB_PRST_FLAG (1 << 25) /* INDEX's cnstr slot: CREATE INDEX ... PERSIST */
+#define RDB_IBT_FLAG  (1 << 26) /* INDEX's cnstr slot: the BT follows the ktype */
+#define RDB_CNSTR_FLAGS (RDB_IXTR_FLAG | RDB_PRST_FLAG | RDB_IBT_FLAG)
+#define RDB_DLT_FLAG  2         /* TABLE's hashy slot: rows are a DELTA */
+#define RDB_MMT_FLAG  4         /* TABLE's hashy slot: rows are a MMAP file */
+
 #define NO_LTC  1
 #define HAS_LTC 2
 static int saveLtc(FILE *fp, ltc_t *ltc) {
@@ -125,8 +138,9 @@ bool rdbLoadLuaTrigger(FILE *fp) {
     if (loadLtc(fp, &luat->preup)            == 0)                  return 0;
     if (loadLtc(fp, &luat->postup)           == 0)                  return 0;
     DECLARE_ICOL(ic, -1)
-    if ((newIndex(NULL, trname->ptr, tmatch, ic, NULL, 0, 0, 0, luat, ic,
-                  0, 0, 0, NULL, NULL, NULL)) == -1)                return 0;
+    if ((newIndex(NULL, trname->ptr, tmatch, ic, NULL, 0, 0, 0, luat, ic, ic,
+                  0, 0, 0, NULL, NULL, NULL, NULL, NULL, 0, 0)) == -1)
+                                                                    return 0;
     decrRefCount(trname);
     return 1;
 }
@@ -164,6 +178,49 @@ static int rdbSaveIcol(FILE *fp, icol_t *ic) {
     return 0;
 }
 
+/* PERSIST: the index's BT is saved in key order, each key's nested BT (if
+            any) right before the key -> rdbLoadIBT() builds them bottom-up */
+static bool rdbPersistIndex(r_ind_t *ri) {
+    if (!ri->persist || !ri->done || ri->virt || ri->hlt || ri->fname ||
+        ri->luat)                                                     return 0;
+    if (BMAP(ri->cnstr) || HASHI(ri->cnstr) || ri->icol.nlo)          return 0;
+    for (int i = 0; i < ri->nclist; i++) if (ri->bclist[i].nlo)        return 0;
+    return !Tbl[ri->tmatch].dirty; /* evicted rows' DRs are NOT saved */
+}
+#define IBT_STREAM(btr) (NORM_BT(btr) && !INODE(btr)) /* [TEXT|FLOAT] keys */
+static bool innerIBT(bt *btr) { /* KEY -> nested BT */
+    uchar btype = btr->s.btype;
+    return btype == BTREE_INDEX || btype == BTREE_MCI || btype == BTREE_MCI_MID;
+}
+static int rdbSaveIBT(FILE *fp, bt *btr);
+static int rdbSaveIBTKeys(FILE *fp, bt *btr, bt_n *x, bool inr) {
+    uint32 vlen = inr ? sizeof(void *) : 0;
+    for (int i = 0; i <= x->n; i++) {
+        if (!x->leaf &&
+            rdbSaveIBTKeys(fp, btr, NODES(btr, x)[i], inr) == -1)   return -1;
+        if (i == x->n) break;
+        void *k = KEYS(btr, x, i);
+        if (inr && rdbSaveIBT(fp, (bt *)parseStream(k, btr)) == -1) return -1;
+        if IBT_STREAM(btr) {                 /* [klen, btkey] */
+            uint32 klen = getStreamRowSize(btr, k) - vlen;
+            if (rdbSaveLen(fp, klen) == -1)                         return -1;
+            if (fwrite(k, klen, 1, fp) == 0)                        return -1;
+        } else {                             /* raw slot, minus nested BT */
+            uint32  u    = (uint32)(long)k;
+            void   *slot = (btr->s.ksize == VOIDSIZE) ? (void *)&k :
+                           (btr->s.ksize == UINTSIZE) ? (void *)&u : k;
+            if (fwrite(slot, btr->s.ksize - vlen, 1, fp) == 0)      return -1;
+        }
+    }
+    return 0;
+}
+static int rdbSaveIBT(FILE *fp, bt *btr) {
+    if (!btr)                              return rdbSaveLen(fp, 0);
+    if (rdbSaveLen(fp, btr->numkeys) == -1)                         return -1;
+    if (!btr->numkeys)                                              return 0;
+    return rdbSaveIBTKeys(fp, btr, btr->root, innerIBT(btr));
+}
+
 int rdbSaveBT(FILE *fp, bt *btr) { //printf("rdbSaveBT\n");
     if (!btr) {
         if (fwrite(&VIRTUAL_INDEX_TYPE, 1, 1, fp) == 0)         return -1;
@@ -185,12 +242,24 @@ int rdbSaveBT(FILE *fp, bt *btr) { //printf("rdbSaveBT\n");
             decrRefCount(r);
             if (rdbSaveLen(fp, (int)rt->col[i].type) == -1)     return -1;
         }
-        if (rdbSaveLen(fp, rt->hashy) == -1)                    return -1;
+        bool dlt = rdbDeltaTable(tmatch); /* NOTE: flag shares hashy's byte */
+        uchar hb = rt->hashy | (dlt     ? RDB_DLT_FLAG : 0) |
+                               (rt->mm  ? RDB_MMT_FLAG : 0);
+        if (rdbSaveLen(fp, hb) == -1)                           return -1;
         if (fwrite(&(btr->s.ktype),    1, 1, fp) == 0)          return -1;
 
-        if (rdbSaveLen(fp, btr->numkeys)       == -1)           return -1;
-        if (btr->root && btr->numkeys > 0) {
-            if (rdbSaveAllRows(fp, btr, btr->root) == -1)       return -1;
+        if (rt->mm) {                    /* MMAP: [file] */
+            robj *r = createStringObject(rt->mm->fname,
+                                         sdslen(rt->mm->fname));
+            if (rdbSaveStringObject(fp, r) == -1)               return -1;
+            decrRefCount(r);
+        } else if (dlt) {                /* DELTA: [base-id, ops] */
+            if (rdbDeltaSaveRows(fp, btr, tmatch) == -1)        return -1;
+        } else {
+            if (rdbSaveLen(fp, btr->numkeys)   == -1)           return -1;
+            if (btr->root && btr->numkeys > 0) {
+                if (rdbSaveAllRows(fp, btr, btr->root) == -1)   return -1;
+            }
         }
     } else {                           /* INDEX */
         int      imatch = tmatch;
@@ -208,11 +277,20 @@ int rdbSaveBT(FILE *fp, bt *btr) { //printf("rdbSaveBT\n");
             if (rdbSaveLen(fp, 1) == -1)                        return -1;
             if (rdbSaveIcol(fp, &ri->icol) == -1)               return -1;
         }
-        if (rdbSaveLen(fp, ri->cnstr) == -1)                    return -1;
+        bool     ixtr   = (ri->xop || ri->pwc); /* NOTE: saved after idestrct */
+        bool     ibt    = rdbPersistIndex(ri);  /* NOTE: saved after ktype */
+        uint32   cnstrl = ri->cnstr | (ixtr         ? RDB_IXTR_FLAG : 0) |
+                                      (ri->persist  ? RDB_PRST_FLAG : 0) |
+                                      (ibt          ? RDB_IBT_FLAG  : 0);
+        if (rdbSaveLen(fp, cnstrl)    == -1)                    return -1;
         if (rdbSaveLen(fp, ri->lru)   == -1)                    return -1;
         if (rdbSaveLen(fp, ri->lfu)   == -1)                    return -1;
         // NOTE: obc: -1 not handled well, so incr on SAVE, decr on LOAD
-        if (rdbSaveLen(fp, (ri->obc.cmatch + 1)) == -1)         return -1;//INCR
+        //       INCLUDE & ORDER BY are exclusive -> icov shares obc's slot
+        uint32 obcl = (ri->icov.cmatch != -1) ?
+                        (RDB_ICOV_FLAG | (uint32)ri->icov.cmatch) :
+                        (uint32)(ri->obc.cmatch + 1);
+        if (rdbSaveLen(fp, obcl) == -1)                         return -1;//INCR
         if (rdbSaveLen(fp, ri->dtype) == -1)                    return -1;
         if (rdbSaveLen(fp, ri->fname ? 1 : 0) == -1)            return -1;
         if (ri->fname) {
@@ -229,7 +307,22 @@ int rdbSaveBT(FILE *fp, bt *btr) { //printf("rdbSaveBT\n");
             if (rdbSaveStringObject(fp, r) == -1)               return -1;
             decrRefCount(r);
         }
+        if (ixtr) { /* EXPRESSION: [xop, xarg(hi,lo)], PARTIAL: [0|1, pwc] */
+            if (rdbSaveLen(fp, ri->xop) == -1)                  return -1;
+            if (rdbSaveLen(fp, (uint32)(ri->xarg >> 32)) == -1) return -1;
+            if (rdbSaveLen(fp, (uint32)ri->xarg) == -1)         return -1;
+            if (rdbSaveLen(fp, ri->pwc ? 1 : 0) == -1)          return -1;
+            if (ri->pwc) {
+                robj *r = createStringObject(ri->pwc, sdslen(ri->pwc));
+                if (rdbSaveStringObject(fp, r) == -1)           return -1;
+                decrRefCount(r);
+            }
+        }
         if (fwrite(&(btr->s.ktype),    1, 1, fp) == 0)          return -1;
+        if (ibt) {                       /* PERSIST: [cvmiss, BT] */
+            if (rdbSaveLen(fp, ri->cvmiss) == -1)               return -1;
+            if (rdbSaveIBT(fp, btr)        == -1)               return -1;
+        }
     }
     return 0;
 }
@@ -237,6 +330,18 @@ int rdbSaveBT(FILE *fp, bt *btr) { //printf("rdbSaveBT\n");
 void *UUbuf;         ulk UL_RDBPointer; luk LU_RDBPointer; llk LL_RDBPointer;
 uxk   UX_RDBPointer; xuk XU_RDBPointer; lxk LX_RDBPointer; xlk XL_RDBPointer;
 xxk   XX_RDBPointer;
+/* NOTE: stream is the ROW or (OTHER_BT) the KEY's bytes, UU: the void * */
+void rdbInsertRow(bt *btr, int tmatch, void *stream) {
+#ifndef TEST_WITH_TRANS_ONE_ONLY
+    if (btr->numkeys == TRANS_ONE_MAX) btr = abt_resize(btr, TRANS_TWO);
+#endif
+    if UU(btr) stream = *(void **)stream;
+    uint32 dr = 0; //TODO DirtyStream needs to be saved/loaded w/ ROWs
+    bt_insert(btr, stream, dr);
+    aobj apk;                   convertStream2Key(stream, &apk, btr);
+    r_tbl_t *rt = &Tbl[tmatch]; UPDATE_AUTO_INC(rt->col[0].type, &apk);
+    releaseAobj(&apk);
+}
 static int rdbLoadRow(FILE *fp, bt *btr, int tmatch) {
     uint32  ssize;
     if ((ssize = rdbLoadLen(fp, NULL)) == REDIS_RDB_LENERR)     return -1;
@@ -246,23 +351,7 @@ static int rdbLoadRow(FILE *fp, bt *btr, int tmatch) {
                    LX(btr) ? &LX_RDBPointer : XL(btr) ? &XL_RDBPointer :
                    XX(btr) ? &XX_RDBPointer : row_malloc(btr, ssize);
     if (fread(stream, ssize, 1, fp) == 0)                       return -1;
-#ifndef TEST_WITH_TRANS_ONE_ONLY
-    if (btr->numkeys == TRANS_ONE_MAX) btr = abt_resize(btr, TRANS_TWO);
-#endif
-    uint32 dr = 0; //TODO DirtyStream needs to be saved/loaded w/ ROWs
-    if      UU(btr) bt_insert(btr, UUbuf,          dr);
-    else if UL(btr) bt_insert(btr, &UL_RDBPointer, dr);
-    else if LU(btr) bt_insert(btr, &LU_RDBPointer, dr);
-    else if LL(btr) bt_insert(btr, &LL_RDBPointer, dr);
-    else if UX(btr) bt_insert(btr, &UX_RDBPointer, dr);
-    else if XU(btr) bt_insert(btr, &XU_RDBPointer, dr);
-    else if LX(btr) bt_insert(btr, &LX_RDBPointer, dr);
-    else if XL(btr) bt_insert(btr, &XL_RDBPointer, dr);
-    else if XX(btr) bt_insert(btr, &XX_RDBPointer, dr);
-    else            bt_insert(btr, stream,         dr); // ROW
-    aobj apk;                   convertStream2Key(stream, &apk, btr);
-    r_tbl_t *rt = &Tbl[tmatch]; UPDATE_AUTO_INC(rt->col[0].type, &apk);
-    releaseAobj(&apk);
+    rdbInsertRow(btr, tmatch, stream);
     return 0;
 }
 
@@ -288,6 +377,69 @@ static bool rdbLoadIcol(FILE *fp, icol_t *ic, r_tbl_t *rt) {
     if (ic->cmatch != -1) rt->col[ic->cmatch].indxd  = 1;//for updateRow OVRWR
     return 1;
 }
+/* nested BT of a key in a level lvl BT -> same choices as iAdd*() */
+static bt *createNestedIBT(int imatch, int lvl) {
+    r_ind_t *ri    = &Index[imatch];
+    r_tbl_t *rt    = &Tbl[ri->tmatch];
+    uchar    pktyp = rt->col[0].type;
+    uchar    otype = (ri->obc.cmatch == -1) ? COL_TYPE_NONE :
+                                              rt->col[ri->obc.cmatch].type;
+    if (!ri->clist) {
+        if (ri->icov.cmatch != -1) {
+            return createCoverNode(pktyp, rt->col[ri->icov.cmatch].type,
+                                   imatch);
+        }
+        return createIndexNode(pktyp, otype);
+    }
+    int   trgr  = UNIQ(ri->cnstr) ? ri->nclist - 2 : -1;
+    int   final = ri->nclist - 1;
+    if (lvl == final) return createIndexNode(pktyp, otype);
+    uchar ntype = rt->col[ri->bclist[lvl + 1].cmatch].type;
+    if C_IS_O(ntype) ntype = ri->dtype; // DNI override
+    if (lvl == trgr) return createU_MCI_IBT(ntype, imatch, pktyp);
+    else             return createMCI_MIDBT(ntype, imatch);
+}
+static bool rdbLoadIBT(FILE *fp, bt *btr, int imatch, int lvl) {
+    uint32 n;
+    if ((n = rdbLoadLen(fp, NULL)) == REDIS_RDB_LENERR)             return 0;
+    if (!n)                                                         return 1;
+#ifndef TEST_WITH_TRANS_ONE_ONLY
+    if (n > TRANS_ONE_MAX) btr = abt_resize(btr, TRANS_TWO);
+#endif
+    bool    inr   = innerIBT(btr), ret = 0;
+    uint32  ks    = btr->s.ksize, vlen = inr ? sizeof(void *) : 0;
+    uchar  *slots = malloc((size_t)n * ks);              // FREE ME 236
+    uchar  *kbuf  = NULL; uint32 kcap = 0;
+    ulong   nsize = 0;                   /* ibtr inherits its nested BTs */
+    for (uint32 i = 0; i < n; i++) {
+        uchar *slot = slots + (size_t)i * ks;
+        bt    *nbtr = NULL;
+        if (inr) {
+            nbtr = createNestedIBT(imatch, lvl);
+            if (!rdbLoadIBT(fp, nbtr, imatch, lvl + 1))             goto libt_end;
+            nsize += nbtr->msize;
+        }
+        if IBT_STREAM(btr) {
+            uint32 klen, ssize;
+            if ((klen = rdbLoadLen(fp, NULL)) == REDIS_RDB_LENERR)  goto libt_end;
+            if (klen > kcap) {
+                kbuf = realloc(kbuf, klen); kcap = klen;         // FREE ME 237
+            }
+            if (fread(kbuf, klen, 1, fp) == 0)                      goto libt_end;
+            void *stream = createStream(btr, nbtr, (char *)kbuf, klen, &ssize);
+            memcpy(slot, &stream, ks);
+        } else {
+            if (fread(slot, ks - vlen, 1, fp) == 0)                 goto libt_end;
+            if (inr) memcpy(slot + ks - vlen, &nbtr, vlen);
+        }
+    }
+    bt_bulk_load(btr, slots, n); btr->msize += nsize; ret = 1;
+
+libt_end:
+    free(slots); if (kbuf) free(kbuf);                   // FREED 236, 237
+    return ret;
+}
+
 //TODO refactor into newTable() & newIndex() calls
 bool rdbLoadBT(FILE *fp) { //printf("rdbLoadBT\n");
     uint32  u; uchar   btype;
@@ -324,14 +476,34 @@ bool rdbLoadBT(FILE *fp) { //printf("rdbLoadBT\n");
             rt->col[i].type   = (uchar)u;
             rt->col[i].imatch = -1;
         }
-        if (fread(&u,    1, 1, fp) == 0)                            return 0;
-        rt->hashy = (bool)u;
+        uchar hb;
+        if (fread(&hb,   1, 1, fp) == 0)                            return 0;
+        rt->hashy = (bool)(hb & ~(RDB_DLT_FLAG | RDB_MMT_FLAG));
         if (fread(&u,    1, 1, fp) == 0)                            return 0;
         rt->btr   = createDBT(u, tmatch);
-        uint32 bt_nkeys; 
-        if ((bt_nkeys = rdbLoadLen(fp, NULL)) == REDIS_RDB_LENERR)  return 0;
-        for (uint32 i = 0; i < bt_nkeys; i++) {
-            if (rdbLoadRow(fp, rt->btr, tmatch) == -1)              return 0;
+        uint32 bt_nkeys = 0;
+        if (hb & RDB_MMT_FLAG) { /* MMAP: re-attach the file */
+            if (!(r = rdbLoadStringObject(fp)))                     return 0;
+            sds    err = NULL;
+            mmt_t *mm  = mmtOpen(r->ptr, &err);
+            if (!mm || !mmtAttach(tmatch, mm)) {
+                if (err) err = sdstrim(err, "-\r\n");
+                redisLog(REDIS_WARNING, "MMAP: table: %s: %s", rt->name,
+                         err ? err : "BT type mismatch");
+                if (err) sdsfree(err);
+                mmtClose(mm); decrRefCount(r);                      return 0;
+            }
+            decrRefCount(r);
+        } else if (hb & RDB_DLT_FLAG) { /* DELTA: BASE + ops merged here */
+            if (!rdbDeltaLoadRows(fp, rt->btr, tmatch))             return 0;
+        } else if ((bt_nkeys = rdbLoadLen(fp, NULL)) == REDIS_RDB_LENERR) {
+                                                                    return 0;
+        } else if (ploadActive()) { /* rows inserted on a loader thread */
+            if (!ploadReadRows(fp, tmatch, bt_nkeys))               return 0;
+        } else {
+            for (uint32 i = 0; i < bt_nkeys; i++) {
+                if (rdbLoadRow(fp, rt->btr, tmatch) == -1)          return 0;
+            }
         }
         ASSERT_OK(dictAdd(TblD, sdsdup(rt->name), VOIDINT(tmatch + 1)));
         if (Num_tbls < (tmatch + 1)) Num_tbls = tmatch + 1;
@@ -343,7 +515,7 @@ bool rdbLoadBT(FILE *fp) { //printf("rdbLoadBT\n");
                                                   INDEX_DELIM);
         ri->tmatch        =  tmatch; ri->icol.cmatch =  0; /* PK */
         ri->virt          =  1;      ri->cnstr       = CONSTRAINT_NONE;
-        ri->obc.cmatch    = -1;
+        ri->obc.cmatch    = -1; ri->icov.cmatch = -1;
         ri->done          =  1; ri->ofst = -1;
 
         rt->col[0].imatch = imatch;
@@ -389,7 +561,10 @@ bool rdbLoadBT(FILE *fp) { //printf("rdbLoadBT\n");
         }
         ri->virt    = 0;
         if ((u = rdbLoadLen(fp, NULL)) == REDIS_RDB_LENERR)         return 0;
-        ri->cnstr   = (int)u;
+        bool ixtr   = (u & RDB_IXTR_FLAG) ? 1 : 0;
+        bool ibt    = (u & RDB_IBT_FLAG)  ? 1 : 0;
+        ri->persist = (u & RDB_PRST_FLAG) ? 1 : 0;
+        ri->cnstr   = (int)(u & ~RDB_CNSTR_FLAGS);
         if ((u = rdbLoadLen(fp, NULL)) == REDIS_RDB_LENERR)         return 0;
         ri->lru     = (int)u;
         if (ri->lru) {
@@ -404,7 +579,12 @@ bool rdbLoadBT(FILE *fp) { //printf("rdbLoadBT\n");
         ri->luat    = 0;
         if ((u = rdbLoadLen(fp, NULL)) == REDIS_RDB_LENERR)         return 0;
         // NOTE: obc: -1 not handled well, so incr on SAVE, decr on LOAD
-        ri->obc.cmatch = ((int)u) - 1; //DECR
+        ri->icov.cmatch = -1;
+        if (u & RDB_ICOV_FLAG) { // INCLUDE (covering) index
+            ri->obc.cmatch  = -1;
+            ri->icov.cmatch = (int)(u & ~RDB_ICOV_FLAG);
+            rt->col[ri->icov.cmatch].indxd = 1; // for updateRow OVRWR
+        } else ri->obc.cmatch = ((int)u) - 1; //DECR
         if ((u = rdbLoadLen(fp, NULL)) == REDIS_RDB_LENERR)         return 0;
         ri->dtype   = u;
         if ((u = rdbLoadLen(fp, NULL)) == REDIS_RDB_LENERR)         return 0;
@@ -429,8 +609,33 @@ bool rdbLoadBT(FILE *fp) { //printf("rdbLoadBT\n");
             ri->idestrct = sdsdup(r->ptr);
             decrRefCount(r);
         }
+        if (ixtr) { // EXPRESSION & PARTIAL
+            if ((u = rdbLoadLen(fp, NULL)) == REDIS_RDB_LENERR)     return 0;
+            ri->xop      = (uchar)u;
+            if ((u = rdbLoadLen(fp, NULL)) == REDIS_RDB_LENERR)     return 0;
+            ri->xarg     = ((ulong)u) << 32;
+            if ((u = rdbLoadLen(fp, NULL)) == REDIS_RDB_LENERR)     return 0;
+            ri->xarg    |= (ulong)u;
+            if ((u = rdbLoadLen(fp, NULL)) == REDIS_RDB_LENERR)     return 0;
+            if (u) { //read in ri->pwc
+                robj *r;
+                if (!(r = rdbLoadStringObject(fp)))                 return 0;
+                ri->pwc    = sdsdup(r->ptr);
+                decrRefCount(r);
+                ri->pflist = parseIndexWC(NULL, ri->tmatch, ri->pwc);
+                if (!ri->pflist)                                    return 0;
+                listNode *ln;                  // pwc's columns: NO OVRWR
+                listIter *li = listGetIterator(ri->pflist, AL_START_HEAD);
+                while((ln = listNext(li))) {
+                    f_t *flt = ln->value; rt->col[flt->ic.cmatch].indxd = 1;
+                } listReleaseIterator(li);
+            }
+        }
         ri->done       =  1; ri->ofst = -1;
-        if (ri->icol.cmatch != -1) rt->col[ri->icol.cmatch].imatch = imatch;
+        if (ri->icol.cmatch != -1 && !ri->pflist && !ri->xop &&
+            !BMAP(ri->cnstr)) {
+            rt->col[ri->icol.cmatch].imatch = imatch;
+        }
         if (!rt->ilist) rt->ilist  = listCreate();       // DEST 088
         listAddNodeTail(rt->ilist, VOIDINT imatch);
         if (ri->icol.cmatch != -1) {
@@ -448,6 +653,14 @@ bool rdbLoadBT(FILE *fp) { //printf("rdbLoadBT\n");
         } else {
             ri->btr = createIndexBT(ri->dtype, imatch);
         }
+        if BMAP (ri->cnstr) ri->bmd = bitmapIndexCreate(); /* BUILT after load */
+        if HASHI(ri->cnstr) ri->hsh = alc_ihash_make(0);   /* BUILT after load */
+        if (ibt) {              /* PERSIST: BT is NOT rebuilt from the rows */
+            if ((u = rdbLoadLen(fp, NULL)) == REDIS_RDB_LENERR)     return 0;
+            ri->cvmiss = (bool)u;
+            if (!rdbLoadIBT(fp, ri->btr, imatch, 0))                return 0;
+            ri->rdbbt  = 1;
+        }
         ASSERT_OK(dictAdd(IndD, sdsdup(ri->name), VOIDINT(imatch + 1)));
         if (ri->iconstrct &&
             !runLuaFunctionIndexFunc(NULL, ri->iconstrct, rt->name,
@@ -457,12 +670,14 @@ bool rdbLoadBT(FILE *fp) { //printf("rdbLoadBT\n");
     return 1;
 }
 
- // NOTE: Indexes are NEVER STORED, they are BUILT AFTER data is loaded
+ // NOTE: Indexes are BUILT AFTER data is loaded (except PERSIST'ed BTs)
 void rdbLoadFinished() { //printf("rdbLoadFinished\n");
     for (int imatch = 0; imatch < Num_indx; imatch++) {
         r_ind_t *ri  = &Index[imatch];
         if (!ri->name) continue; // previously deleted
         if (ri->virt || ri->fname)  continue;
+        if (ri->rdbbt) { ri->rdbbt = 0; continue; } // read from the RDB
+        if (ploadBuilt(imatch))     continue; // built on a loader thread
         bt      *btr = getBtr(ri->tmatch);
         buildIndex(NULL, btr, imatch, -1);
     }
@@ -32,6 +32,7 @@ ALL RIGHTS RESERVED
 bool  rdbLoadBT(FILE *fp);
 bool  rdbLoadLuaTrigger(FILE *fp);
 void  rdbLoadFinished();
+void  rdbInsertRow(bt *btr, int tmatch, void *stream);
 
 int   rdbSaveBT(FILE *fp, bt *btr);
 int   rdbSaveLuaTrigger(FILE *fp, r_ind_t *ri);
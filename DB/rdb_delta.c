@@ -0,0 +1,382 @@
+/*
+ * This file implements incremental (DELTA) RDB snapshots of SQL tables
+ *
+
+AGPL License
+
+Copyright (c) 2011 Russell Sullivan <jaksprats AT gmail DOT com>
+ALL RIGHTS RESERVED
+
+   This file is part of ALCHEMY_DATABASE
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Affero General Public License as
+    published by the Free Software Foundation, either version 3 of the
+    License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Affero General Public License for more details.
+
+    You should have received a copy of the GNU Affero General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#define _DEFAULT_SOURCE /* fileno() */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <errno.h>
+#include <unistd.h>
+
+#include "redis.h"
+#include "adlist.h"
+
+#include "btreepriv.h"
+#include "bt.h"
+#include "stream.h"
+#include "rdb_alsosql.h"
+#include "query.h"
+#include "mmtbl.h"
+#include "common.h"
+#include "rdb_delta.h"
+
+extern r_tbl_t *Tbl;
+
+uint32_t  rdbLoadLen(FILE *fp, int *isencoded);
+
+/* DELTA SNAPSHOTS: a BASE snapshot ("<dbfilename>.<id>.base") holds the ROWs
+     of every clean table in key order, the RDB then saves such a table as
+     [base-id, ops]: the ROWs of the btn's written since the BASE was forked
+     (bt_n.epoch > DltBepoch) in RANGEs -> the RDB's size & the save's CPU
+     are proportional to what changed, not to the table.
+   RANGE: [LO lo-ROW | LO_INF] [ROW]* [HI hi-ROW | HI_INF] -> lo & hi are the
+          clean ROWs around a run of changed btn's, a ROW deleted since the
+          BASE lies between them (its btn or a neighbour's was written)
+   MERGE: LOAD streams the BASE's ROWs, those inside a RANGE are replaced by
+          the RANGE's ROWs (i.e. BASE + RDB -> table), the next save then
+          forks a new BASE (BGREBASE forces one) -> deltas do not chain
+   NOTE: deltas are cumulative (only BASE + latest RDB are read), every
+         (rdb_delta_saves + 1)th save is a new BASE. Tables created since the
+         BASE, dirty (evicted) tables & RDBs w/ slaves attached (SYNC) are
+         saved in full */
+
+#define DLT_FULL   0 /* save modes */
+#define DLT_REBASE 1
+#define DLT_DELTA  2
+
+#define DLT_END    0 /* ops */
+#define DLT_LO     1
+#define DLT_LO_INF 2
+#define DLT_ROW    3
+#define DLT_HI     4
+#define DLT_HI_INF 5
+
+#define DLT_KEY_SLOT sizeof(xxk) /* largest OTHER_BT key (XX) */
+
+static pid_t   DltPid     = 0; /* armed save (BGSAVE: parent's pid) */
+static int     DltMode    = DLT_FULL;
+static ull     DltNid     = 0; /* REBASE: BASE being written        */
+static uint32  DltNepoch  = 0; /* REBASE: BtEpoch it was forked at  */
+static ull     DltBid     = 0; /* BASE on disk, 0 -> none           */
+static uint32  DltBepoch  = 0; /* BASE's epoch, 0 -> must REBASE    */
+static ulong   DltNsince  = 0; /* DELTA saves since the BASE        */
+static bool    DltForce   = 0; /* BGREBASE                          */
+static FILE   *DltFp      = NULL; /* SAVE: BASE written, LOAD: read  */
+static ulong   DltRebases = 0;
+static ulong   DltDeltas  = 0;
+static ulong   DltLoads   = 0;
+
+static sds baseName(ull id) {                            // FREE ME 238
+    return sdscatprintf(sdsempty(), "%s.%llx.base", server.dbfilename, id);
+}
+static void unlinkBase(ull id) {
+    if (!id) return;
+    sds fname = baseName(id);
+    unlink(fname); sdsfree(fname);                        // FREED 238
+}
+
+// SAVE_STATE SAVE_STATE SAVE_STATE SAVE_STATE SAVE_STATE SAVE_STATE
+/* NOTE: called before rdbSave() & before BGSAVE's fork -> the child inherits
+         the armed mode & its own rdbSave() call is a no-op */
+void rdbDeltaBegin() {
+    if (DltPid) return;
+    DltPid = getpid();
+    if (!server.alc.RdbDeltaSaves || listLength(server.slaves)) {
+        DltMode   = DLT_FULL; /* slaves SYNC the RDB -> self-contained */
+    } else if (DltForce || !DltBepoch ||
+               DltNsince >= (ulong)server.alc.RdbDeltaSaves) {
+        DltMode   = DLT_REBASE;
+        DltNid    = (ull)ustime();
+        DltNepoch = BtEpoch++; /* writes after the fork -> (epoch > base) */
+    } else {
+        DltMode   = DLT_DELTA;
+    }
+}
+/* NOTE: the parent's rdbSave() return or BGSAVE's exit, child -> no-op */
+void rdbDeltaDone(bool ok) {
+    if (!DltPid || DltPid != getpid()) return;
+    DltPid = 0;
+    if        (DltMode == DLT_REBASE) {
+        if (ok) {
+            if (DltBid != DltNid) unlinkBase(DltBid);
+            DltBid    = DltNid; DltBepoch = DltNepoch;
+            DltNsince = 0;      DltForce  = 0; DltRebases++;
+        } else unlinkBase(DltNid);
+    } else if (DltMode == DLT_DELTA) {
+        if (ok) { DltNsince++; DltDeltas++; }
+    } else if (ok && DltBid) { /* the RDB no longer references the BASE */
+        unlinkBase(DltBid); DltBid = 0; DltBepoch = 0;
+    }
+    DltMode = DLT_FULL;
+}
+/* NOTE: in place ROW writes are not stamped w/ deltas off -> REBASE */
+void rdbDeltaReset() { DltBepoch = 0; }
+
+// SAVE SAVE SAVE SAVE SAVE SAVE SAVE SAVE SAVE SAVE SAVE SAVE SAVE SAVE
+bool rdbDeltaTable(int tmatch) {
+    if (DltMode == DLT_FULL)                        return 0;
+    r_tbl_t *rt = &Tbl[tmatch];
+    if (rt->mm)                                     return 0; /* MMAP */
+    if (rt->dirty || rt->btr->dirty)                return 0; /* DRs */
+    return DltMode == DLT_REBASE || rt->cepoch <= DltBepoch;
+}
+static int saveRow(FILE *fp, bt *btr, void *k) {
+    int    ssize = getStreamRowSize(btr, k);
+    uchar *wk    = UU(btr) ? (uchar *)&k : k;
+    if (rdbSaveLen(fp, ssize)      == -1)                       return -1;
+    if (fwrite(wk, ssize, 1, fp)   == 0)                        return -1;
+    return 0;
+}
+static int saveRowsInOrder(FILE *fp, bt *btr, bt_n *x) {
+    for (int i = 0; i <= x->n; i++) {
+        if (!x->leaf &&
+            saveRowsInOrder(fp, btr, NODES(btr, x)[i]) == -1)   return -1;
+        if (i == x->n) break;
+        if (saveRow(fp, btr, KEYS(btr, x, i)) == -1)            return -1;
+    }
+    return 0;
+}
+static int saveOp(FILE *fp, bt *btr, uchar op, void *k) {
+    if (rdbSaveLen(fp, op) == -1)                               return -1;
+    if (op != DLT_LO && op != DLT_ROW && op != DLT_HI)          return 0;
+    return saveRow(fp, btr, k);
+}
+typedef struct delta_walk {
+    FILE *fp;
+    bt   *btr;
+    void *prev;  /* previous key (in order) */
+    bool  hprev;
+    bool  run;   /* inside a RANGE */
+} dlw_t;
+static int saveChanged(dlw_t *w, bt_n *x) {
+    bt   *btr = w->btr;
+    bool  chg = (x->epoch > DltBepoch);
+    for (int i = 0; i <= x->n; i++) {
+        if (!x->leaf && saveChanged(w, NODES(btr, x)[i]) == -1)   return -1;
+        if (i == x->n) break;
+        void *k = KEYS(btr, x, i);
+        if (chg) {
+            if (!w->run) {
+                uchar op = w->hprev ? DLT_LO : DLT_LO_INF;
+                if (saveOp(w->fp, btr, op, w->prev) == -1)        return -1;
+                w->run = 1;
+            }
+            if (saveOp(w->fp, btr, DLT_ROW, k) == -1)             return -1;
+        } else if (w->run) {
+            if (saveOp(w->fp, btr, DLT_HI, k) == -1)              return -1;
+            w->run = 0;
+        }
+        w->prev = k; w->hprev = 1;
+    }
+    return 0;
+}
+static bool openSaveBase() {
+    sds fname = baseName(DltNid);
+    DltFp     = fopen(fname, "w");
+    if (!DltFp) redisLog(REDIS_WARNING, "DELTA: can not open BASE: %s: %s",
+                         fname, strerror(errno));
+    sdsfree(fname);                                      // FREED 238
+    if (!DltFp)                                                 return 0;
+    if (rdbSaveLen(DltFp, (uint32)(DltNid >> 32)) == -1)        return 0;
+    if (rdbSaveLen(DltFp, (uint32)DltNid)         == -1)        return 0;
+    return 1;
+}
+/* [base-id(hi,lo), ops], REBASE: the ROWs go to the BASE, no ops */
+int rdbDeltaSaveRows(FILE *fp, bt *btr, int tmatch) {
+    ull id = (DltMode == DLT_REBASE) ? DltNid : DltBid;
+    if (rdbSaveLen(fp, (uint32)(id >> 32)) == -1)               return -1;
+    if (rdbSaveLen(fp, (uint32)id)         == -1)               return -1;
+    if (DltMode == DLT_REBASE) {    /* BASE: [tmatch + 1, nrows, ROWs] */
+        if (!DltFp && !openSaveBase())                          return -1;
+        if (rdbSaveLen(DltFp, tmatch + 1)    == -1)             return -1;
+        if (rdbSaveLen(DltFp, btr->numkeys)  == -1)             return -1;
+        if (btr->numkeys &&
+            saveRowsInOrder(DltFp, btr, btr->root) == -1)       return -1;
+        return rdbSaveLen(fp, DLT_END);
+    }
+    if (!btr->numkeys) {            /* EMPTY: every BASE ROW is deleted */
+        if (rdbSaveLen(fp, DLT_LO_INF) == -1)                   return -1;
+        if (rdbSaveLen(fp, DLT_HI_INF) == -1)                   return -1;
+    } else {
+        dlw_t w; bzero(&w, sizeof(dlw_t)); w.fp = fp; w.btr = btr;
+        if (saveChanged(&w, btr->root) == -1)                   return -1;
+        if (w.run && rdbSaveLen(fp, DLT_HI_INF) == -1)          return -1;
+    }
+    return rdbSaveLen(fp, DLT_END);
+}
+/* NOTE: the BASE file always exists after a REBASE (even w/ no tables) */
+int rdbDeltaSaveEnd() {
+    if (DltMode != DLT_REBASE)                                  return 0;
+    if (!DltFp && !openSaveBase())                              return -1;
+    int ret = 0;
+    if (rdbSaveLen(DltFp, 0) == -1 || fflush(DltFp) == EOF ||
+        fsync(fileno(DltFp)) == -1) ret = -1;
+    fclose(DltFp); DltFp = NULL;
+    return ret;
+}
+
+// LOAD LOAD LOAD LOAD LOAD LOAD LOAD LOAD LOAD LOAD LOAD LOAD LOAD LOAD
+typedef struct row_buf {
+    uchar  *b;
+    uint32  cap;
+    uint32  len;
+} rbf_t;
+
+static bool readRow(FILE *fp, bt *btr, rbf_t *r) {
+    uint32 ssize;
+    if ((ssize = rdbLoadLen(fp, NULL)) == REDIS_RDB_LENERR)     return 0;
+    bool   obt  = OTHER_BT(btr);
+    uint32 need = (obt && ssize < DLT_KEY_SLOT) ? DLT_KEY_SLOT : ssize;
+    if (need > r->cap) {
+        r->b = realloc(r->b, need); r->cap = need;       // FREE ME 239
+    }
+    if (obt) bzero(r->b, r->cap); /* UU reads a void * */
+    r->len = ssize;
+    if (ssize && fread(r->b, ssize, 1, fp) == 0)                return 0;
+    return 1;
+}
+static void *rowKey(bt *btr, rbf_t *r) { /* what bt_insert() sees */
+    return UU(btr) ? *(void **)r->b : (void *)r->b;
+}
+static void insertRow(bt *btr, int tmatch, rbf_t *r) {
+    void *stream = r->b;         /* OTHER_BT: the KEY is copied into the btn */
+    if (!OTHER_BT(btr)) {
+        stream = row_malloc(btr, r->len); memcpy(stream, r->b, r->len);
+    }
+    rdbInsertRow(btr, tmatch, stream);
+}
+static int nextBaseRow(bt *btr, rbf_t *b, uint32 *left) { /* 1, 0:EOT, -1 */
+    if (!*left) return 0;
+    (*left)--;
+    return readRow(DltFp, btr, b) ? 1 : -1;
+}
+static bool openLoadBase(ull id) {
+    sds  fname = baseName(id);
+    bool ret   = 0;
+    if (!(DltFp = fopen(fname, "r"))) {
+        redisLog(REDIS_WARNING, "DELTA: can not open BASE: %s: %s",
+                 fname, strerror(errno));
+    } else {
+        uint32 hi, lo;
+        if ((hi = rdbLoadLen(DltFp, NULL)) != REDIS_RDB_LENERR &&
+            (lo = rdbLoadLen(DltFp, NULL)) != REDIS_RDB_LENERR &&
+            (((ull)hi << 32) | lo) == id) ret = 1;
+        else redisLog(REDIS_WARNING, "DELTA: BASE: %s: bad header", fname);
+    }
+    sdsfree(fname);                                      // FREED 238
+    if (ret) DltBid = id;
+    return ret;
+}
+/* NOTE: the BASE's tables are in tmatch order (as are the RDB's) */
+static bool seekBaseTable(int tmatch, uint32 *nrows) {
+    while (1) {
+        uint32 u, n;
+        if ((u = rdbLoadLen(DltFp, NULL)) == REDIS_RDB_LENERR || !u) return 0;
+        if ((n = rdbLoadLen(DltFp, NULL)) == REDIS_RDB_LENERR)       return 0;
+        if ((int)u - 1 == tmatch) { *nrows = n;                      return 1; }
+        if ((int)u - 1 >  tmatch)                                    return 0;
+        for (uint32 i = 0; i < n; i++) { /* table dropped since the BASE */
+            uint32 ssize;
+            if ((ssize = rdbLoadLen(DltFp, NULL)) == REDIS_RDB_LENERR) return 0;
+            if (fseek(DltFp, ssize, SEEK_CUR) == -1)                 return 0;
+        }
+    }
+}
+void rdbDeltaLoadBegin() { DltBepoch = 0; } /* new btn's -> next save REBASEs*/
+/* MERGE: BASE ROWs (in order) w/ the ops -> rows inserted on this thread */
+bool rdbDeltaLoadRows(FILE *fp, bt *btr, int tmatch) {
+    uint32 hi, lo, left;
+    if ((hi = rdbLoadLen(fp, NULL)) == REDIS_RDB_LENERR)        return 0;
+    if ((lo = rdbLoadLen(fp, NULL)) == REDIS_RDB_LENERR)        return 0;
+    ull    id = ((ull)hi << 32) | lo;
+    if (!DltFp) { if (!openLoadBase(id))                        return 0; }
+    else if (id != DltBid)                                      return 0;
+    if (!seekBaseTable(tmatch, &left)) {
+        redisLog(REDIS_WARNING, "DELTA: table: %s not in BASE: %llx",
+                 Tbl[tmatch].name, id);                         return 0;
+    }
+    rbf_t  b, d; bzero(&b, sizeof(rbf_t)); bzero(&d, sizeof(rbf_t));
+    bool   ret = 0;
+    int    hb  = nextBaseRow(btr, &b, &left);
+    if (hb == -1)                                               goto dlr_end;
+    while (1) {
+        uint32 op;
+        if ((op = rdbLoadLen(fp, NULL)) == REDIS_RDB_LENERR)    goto dlr_end;
+        if (op == DLT_END) break;
+        bool   rd = (op == DLT_LO || op == DLT_ROW || op == DLT_HI);
+        if (rd && !readRow(fp, btr, &d))                        goto dlr_end;
+        while (hb == 1 && op != DLT_LO_INF) { /* BASE ROWs up to the op */
+            int c = (op == DLT_HI_INF) ? -1 :
+                    btr->cmp(rowKey(btr, &b), rowKey(btr, &d));
+            if ((op == DLT_HI) ? (c >= 0) : (c > 0)) break;
+            if (op == DLT_LO) insertRow(btr, tmatch, &b); /* else REPLACED|DEL */
+            if ((hb = nextBaseRow(btr, &b, &left)) == -1)       goto dlr_end;
+        }
+        if (op == DLT_ROW) insertRow(btr, tmatch, &d);
+    }
+    while (hb == 1) {                         /* BASE ROWs after the last op */
+        insertRow(btr, tmatch, &b);
+        if ((hb = nextBaseRow(btr, &b, &left)) == -1)           goto dlr_end;
+    }
+    ret = 1;
+
+dlr_end:
+    if (b.b) free(b.b);                                  // FREED 239
+    if (d.b) free(d.b);                                  // FREED 239
+    return ret;
+}
+void rdbDeltaLoadEnd() {
+    if (!DltFp) return;
+    fclose(DltFp); DltFp = NULL; DltLoads++;
+}
+
+// COMMAND COMMAND COMMAND COMMAND COMMAND COMMAND COMMAND COMMAND
+/* BGREBASE: merges BASE + DELTA into a new BASE (a BGSAVE w/ a REBASE) */
+void bgrebaseCommand(redisClient *c) {
+    if (!server.alc.RdbDeltaSaves) { addReply(c, shared.rdbdeltaoff); return; }
+    if (server.bgsavechildpid != -1) {
+        addReplyError(c, "Background save already in progress");     return;
+    } else if (server.bgrewritechildpid != -1) {
+        addReplyError(c, "Can't BGREBASE while AOF log rewriting is in progress");
+        return;
+    }
+    DltForce = 1;
+    if (rdbSaveBackground(server.dbfilename) == REDIS_OK) {
+        addReplyStatus(c, "Background rebase started");
+    } else addReply(c, shared.err);
+}
+
+sds genRdbDeltaInfoString(sds info) {
+    return sdscatprintf(info, "rdb_delta_saves:%ld\r\n"
+                              "rdb_delta_base:%llx\r\n"
+                              "rdb_delta_since_base:%lu\r\n"
+                              "rdb_delta_rebases:%lu\r\n"
+                              "rdb_delta_deltas:%lu\r\n"
+                              "rdb_delta_loads:%lu\r\n",
+                        server.alc.RdbDeltaSaves, DltBid, DltNsince,
+                        DltRebases, DltDeltas, DltLoads);
+}
@@ -0,0 +1,53 @@
+/*
+ * This file implements incremental (DELTA) RDB snapshots of SQL tables
+ *
+
+AGPL License
+
+Copyright (c) 2011 Russell Sullivan <jaksprats AT gmail DOT com>
+ALL RIGHTS RESERVED
+
+   This file is part of ALCHEMY_DATABASE
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Affero General Public License as
+    published by the Free Software Foundation, either version 3 of the
+    License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Affero General Public License for more details.
+
+    You should have received a copy of the GNU Affero General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __ALC_RDB_DELTA__H
+#define __ALC_RDB_DELTA__H
+
+#include "redis.h"
+
+#include "bt.h"
+#include "common.h"
+
+/* in place ROW writes (no btn write) must stamp the ROW's btn */
+#define DELTA_TOUCH(btr, apk) \
+  if (server.alc.RdbDeltaSaves) btTouch(btr, apk);
+
+void rdbDeltaBegin       ();
+void rdbDeltaDone        (bool ok);
+void rdbDeltaReset       ();
+
+bool rdbDeltaTable       (int tmatch);
+int  rdbDeltaSaveRows    (FILE *fp, bt *btr, int tmatch);
+int  rdbDeltaSaveEnd     ();
+
+void rdbDeltaLoadBegin   ();
+bool rdbDeltaLoadRows    (FILE *fp, bt *btr, int tmatch);
+void rdbDeltaLoadEnd     ();
+
+void bgrebaseCommand     (redisClient *c);
+sds  genRdbDeltaInfoString(sds info);
+
+#endif /* __ALC_RDB_DELTA__H */
@@ -0,0 +1,302 @@
+/*
+ * This file implements the parallel RDB loader of SQL tables & indexes
+ *
+
+AGPL License
+
+Copyright (c) 2011 Russell Sullivan <jaksprats AT gmail DOT com>
+ALL RIGHTS RESERVED
+
+   This file is part of ALCHEMY_DATABASE
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Affero General Public License as
+    published by the Free Software Foundation, either version 3 of the
+    License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Affero General Public License for more details.
+
+    You should have received a copy of the GNU Affero General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#define _DEFAULT_SOURCE /* pthread_sigmask() */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <errno.h>
+#include <signal.h>
+#include <pthread.h>
+#include <unistd.h>
+
+#include "redis.h"
+#include "zmalloc.h"
+#include "adlist.h"
+
+#include "bt.h"
+#include "stream.h"
+#include "index.h"
+#include "rdb_alsosql.h"
+#include "query.h"
+#include "common.h"
+#include "rdb_pload.h"
+
+extern r_tbl_t *Tbl;
+extern r_ind_t *Index;
+
+uint32_t  rdbLoadLen(FILE *fp, int *isencoded);
+
+/* PARALLEL RDB LOAD: the main thread reads the RDB (one FILE) & keeps the
+     table & index definitions, a table's rows are read into a job that a
+     loader thread inserts into the table's BT, the same thread then queues
+     one job per (plain) index of the table -> indexes build concurrently.
+     The main thread reads the next table while the threads build (each BT
+     is independent), DXDB_rdbLoad() waits for the jobs (ploadEnd()) before
+     the load is published (i.e. returns), rdbLoadFinished() builds the
+     indexes the threads can not (Lua, PARTIAL, EXPRESSION, BITMAP, HASH)
+   NOTE: a table's rows are dispatched when the next table (or EOF) starts,
+         i.e. after its index sections are read (see DXDB_rdbSave())
+   NOTE: BT scratch buffers (stream.c, index.c, bt_iterator.c) are __thread */
+
+typedef struct pload_job {
+    int     tmatch;
+    int     imatch;   /* -1 -> TABLE job: insert rows, queue index jobs */
+    bool    obt;      /* OTHER_BT: rows are KEYs [PLOAD_KEY_SLOT] else ROWs */
+    uint32  nrows;
+    uchar  *rows;
+    int     ninds;
+    int    *inds;     /* indexes built on the threads after the rows */
+} plj_t;
+
+#define PLOAD_KEY_SLOT sizeof(xxk) /* largest OTHER_BT key (XX) */
+
+static pthread_mutex_t PlMutex    = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t  PlJobCond  = PTHREAD_COND_INITIALIZER;
+static pthread_cond_t  PlDoneCond = PTHREAD_COND_INITIALIZER;
+static pthread_t       PlThreads[PLOAD_MAX_THREADS];
+static int             PlNthreads = 0;
+static list           *PlJobs     = NULL;
+static long            PlPending  = 0;     /* queued + running jobs */
+static bool            PlExit     = 0;
+static bool            PlOn       = 0;     /* current load is parallel */
+static int             PlZmts     = 0;     /* zmalloc thread safeness before */
+static plj_t          *PlNext     = NULL;  /* rows read, indexes not yet */
+static bool           *PlBuilt    = NULL;  /* [imatch] built on a thread */
+static uint32          PlNindx    = 0;
+static long long       PlStart    = 0;
+
+/* INFO */
+static ulong           PlLoads = 0, PlTables = 0, PlIndexes = 0;
+static long long       PlLastUs = 0;
+static int             PlLastThreads = 0;
+
+static void releaseJob(plj_t *j) {
+    if (j->rows) free(j->rows);                              // FREED 230
+    if (j->inds) free(j->inds);                              // FREED 231
+    free(j);                                                 // FREED 232
+}
+static void queueJob(plj_t *j) { /* NOTE: called w/ PlMutex held */
+    listAddNodeTail(PlJobs, j); PlPending++;
+    pthread_cond_signal(&PlJobCond);
+}
+static plj_t *newJob(int tmatch, int imatch) {
+    plj_t *j  = malloc(sizeof(plj_t));                       // FREE ME 232
+    bzero(j, sizeof(plj_t));
+    j->tmatch = tmatch; j->imatch = imatch;
+    return j;
+}
+static void runJob(plj_t *j) {
+    if (j->imatch != -1) {
+        buildIndex(NULL, Tbl[j->tmatch].btr, j->imatch, -1);
+        return;
+    }
+    bt     *btr  = Tbl[j->tmatch].btr;
+    size_t  slot = PLOAD_KEY_SLOT;
+    for (uint32 i = 0; i < j->nrows; i++) {
+        void *stream = j->obt ? (void *)(j->rows + (i * slot)) :
+                                ((void **)j->rows)[i];
+        rdbInsertRow(btr, j->tmatch, stream);
+    }
+    if (!j->ninds) return;
+    if (!PlNthreads) { /* no threads -> build inline */
+        for (int i = 0; i < j->ninds; i++) {
+            buildIndex(NULL, btr, j->inds[i], -1);
+        }
+        return;
+    }
+    pthread_mutex_lock(&PlMutex);
+    for (int i = 0; i < j->ninds; i++) {
+        queueJob(newJob(j->tmatch, j->inds[i]));
+    }
+    pthread_mutex_unlock(&PlMutex);
+}
+static void *ploadThread(void *arg) {
+    (void)arg; // compiler warning
+    pthread_mutex_lock(&PlMutex);
+    while (1) {
+        while (!PlExit && !listLength(PlJobs)) {
+            pthread_cond_wait(&PlJobCond, &PlMutex);
+        }
+        if (!listLength(PlJobs)) break; /* PlExit & drained */
+        listNode *ln = listFirst(PlJobs);
+        plj_t    *j  = ln->value;
+        listDelNode(PlJobs, ln);
+        pthread_mutex_unlock(&PlMutex);
+        runJob(j); releaseJob(j);
+        pthread_mutex_lock(&PlMutex);
+        PlPending--;
+        if (!PlPending) pthread_cond_signal(&PlDoneCond);
+    }
+    pthread_mutex_unlock(&PlMutex);
+    return NULL;
+}
+static void startThreads() {
+    int  nthreads = (int)server.alc.RdbLoadThreads;
+    long ncpu     = sysconf(_SC_NPROCESSORS_ONLN); /* main thread reads RDB */
+    if (ncpu > 0 && nthreads > ncpu - 1) nthreads = (int)(ncpu - 1);
+    if (nthreads > PLOAD_MAX_THREADS)    nthreads = PLOAD_MAX_THREADS;
+    PlZmts  = zmalloc_set_thread_safeness(1); /* BT mallocs -> used_memory */
+    PlExit  = 0; PlPending = 0;
+    PlJobs  = listCreate();
+    sigset_t  mask, omask;
+    sigemptyset(&mask);
+    sigaddset(&mask, SIGCHLD); sigaddset(&mask, SIGHUP);
+    sigaddset(&mask, SIGPIPE);
+    pthread_sigmask(SIG_SETMASK, &mask, &omask);
+    for (int i = 0; i < nthreads; i++) {
+        int err = pthread_create(&PlThreads[PlNthreads], NULL, ploadThread,
+                                 NULL);
+        if (err) {
+            redisLog(REDIS_WARNING, "RDB LOAD: thread: %s", strerror(err));
+            break;
+        }
+        PlNthreads++;
+    }
+    pthread_sigmask(SIG_SETMASK, &omask, NULL);
+    PlLastThreads = PlNthreads;
+    if (!PlNthreads) zmalloc_set_thread_safeness(PlZmts); /* -> inline */
+}
+
+/* PLAIN index: its build touches only its own BT & the table's rows */
+static bool ploadCol(r_tbl_t *rt, icol_t *ic) {
+    return ic->cmatch >= 0 && !ic->nlo && !C_IS_O(rt->col[ic->cmatch].type);
+}
+static bool ploadableIndex(int imatch) {
+    r_ind_t *ri = &Index[imatch];
+    if (!ri->name || ri->virt || ri->fname || ri->luat || ri->hlt) return 0;
+    if (ri->rdbbt)                                     return 0; // RDB BT
+    if (ri->pflist || ri->xop || BMAP(ri->cnstr) || HASHI(ri->cnstr) ||
+        ri->hsh)                                                   return 0;
+    r_tbl_t *rt = &Tbl[ri->tmatch];
+    if (!ploadCol(rt, &ri->icol))                                  return 0;
+    for (int i = 0; i < ri->nclist; i++) {
+        if (!ploadCol(rt, &ri->bclist[i]))                         return 0;
+    }
+    if (ri->obc.cmatch  != -1 && !ploadCol(rt, &ri->obc))          return 0;
+    if (ri->icov.cmatch != -1 && !ploadCol(rt, &ri->icov))         return 0;
+    return 1;
+}
+static void dispatchNext() {
+    plj_t *j = PlNext; if (!j) return;
+    PlNext   = NULL;
+    r_tbl_t *rt = &Tbl[j->tmatch];
+    if (rt->ilist) { /* the table's index sections have been read */
+        j->inds = malloc(sizeof(int) * listLength(rt->ilist)); // FREE ME 231
+        listNode *ln;
+        listIter *li = listGetIterator(rt->ilist, AL_START_HEAD);
+        while((ln = listNext(li))) {
+            int imatch = (int)(long)ln->value;
+            if (!ploadableIndex(imatch)) continue;
+            j->inds[j->ninds++] = imatch; PlBuilt[imatch] = 1;
+        } listReleaseIterator(li);
+    }
+    PlTables++; PlIndexes += j->ninds;
+    if (!PlNthreads) { runJob(j); releaseJob(j); return; }
+    pthread_mutex_lock(&PlMutex);
+    queueJob(j);
+    pthread_mutex_unlock(&PlMutex);
+}
+
+void ploadBegin(uint32 nindx) {
+    PlStart = ustime();
+    PlOn    = (server.alc.RdbLoadThreads > 0);
+    if (PlBuilt) free(PlBuilt);                              // FREED 233
+    PlBuilt = NULL; PlNindx = nindx; PlNext = NULL; PlLastThreads = 0;
+    if (!PlOn) return;
+    PlBuilt = malloc(sizeof(bool) * (nindx ? nindx : 1));    // FREE ME 233
+    bzero(PlBuilt, sizeof(bool) * (nindx ? nindx : 1));
+    startThreads();
+}
+bool ploadActive() { return PlOn; }
+
+/* NOTE: ROWs are malloc'ed into the table's BT here (main thread), the BT is
+         not touched again by the main thread once the job is queued */
+bool ploadReadRows(FILE *fp, int tmatch, uint32 nrows) {
+    dispatchNext(); /* previous table: rows & index sections are complete */
+    bt     *btr  = Tbl[tmatch].btr;
+    plj_t  *j    = newJob(tmatch, -1);
+    j->obt       = OTHER_BT(btr);
+    size_t  slot = j->obt ? PLOAD_KEY_SLOT : sizeof(void *);
+    if (nrows) {
+        j->rows  = malloc(slot * nrows);                     // FREE ME 230
+        if (j->obt) bzero(j->rows, slot * nrows); /* UU reads a void * */
+    }
+    for (uint32 i = 0; i < nrows; i++) {
+        uint32  ssize;
+        if ((ssize = rdbLoadLen(fp, NULL)) == REDIS_RDB_LENERR) goto prows_err;
+        void   *stream;
+        if (j->obt) {
+            if (ssize > slot)                                   goto prows_err;
+            stream = j->rows + (i * slot);
+        } else {
+            stream = row_malloc(btr, ssize);
+            ((void **)j->rows)[i] = stream;
+        }
+        if (fread(stream, ssize, 1, fp) == 0)                   goto prows_err;
+        j->nrows++;
+    }
+    PlNext = j;
+    return 1;
+
+prows_err: /* NOTE: the load fails -> the server exits, ROWs are not freed */
+    releaseJob(j);
+    return 0;
+}
+void ploadEnd() {
+    if (!PlOn) return;
+    dispatchNext();
+    if (!PlNthreads) return;
+    pthread_mutex_lock(&PlMutex);
+    while (PlPending) pthread_cond_wait(&PlDoneCond, &PlMutex);
+    PlExit = 1;
+    pthread_cond_broadcast(&PlJobCond);
+    pthread_mutex_unlock(&PlMutex);
+    for (int i = 0; i < PlNthreads; i++) pthread_join(PlThreads[i], NULL);
+    PlNthreads = 0;
+    listRelease(PlJobs); PlJobs = NULL;
+    zmalloc_set_thread_safeness(PlZmts);
+}
+bool ploadBuilt(int imatch) {
+    return PlBuilt && (uint32)imatch < PlNindx && PlBuilt[imatch];
+}
+void ploadFinished() {
+    PlLoads++; PlLastUs = ustime() - PlStart;
+    if (PlBuilt) free(PlBuilt);                              // FREED 233
+    PlBuilt = NULL; PlOn = 0;
+}
+
+sds genRdbLoadInfoString(sds info) {
+    return sdscatprintf(info, "rdb_load_threads:%ld\r\n"
+                              "rdb_loads:%lu\r\n"
+                              "rdb_load_last_ms:%lld\r\n"
+                              "rdb_load_last_threads:%d\r\n"
+                              "rdb_load_parallel_tables:%lu\r\n"
+                              "rdb_load_parallel_indexes:%lu\r\n",
+                        server.alc.RdbLoadThreads, PlLoads, PlLastUs / 1000,
+                        PlLastThreads, PlTables, PlIndexes);
+}
@@ -0,0 +1,44 @@
+/*
+ * This file implements the parallel RDB loader of SQL tables & indexes
+ *
+
+AGPL License
+
+Copyright (c) 2011 Russell Sullivan <jaksprats AT gmail DOT com>
+ALL RIGHTS RESERVED
+
+   This file is part of ALCHEMY_DATABASE
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Affero General Public License as
+    published by the Free Software Foundation, either version 3 of the
+    License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Affero General Public License for more details.
+
+    You should have received a copy of the GNU Affero General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __ALC_RDB_PLOAD__H
+#define __ALC_RDB_PLOAD__H
+
+#include "redis.h"
+
+#include "common.h"
+
+#define PLOAD_MAX_THREADS 64
+
+void ploadBegin     (uint32 nindx);
+bool ploadActive    ();
+bool ploadReadRows  (FILE *fp, int tmatch, uint32 nrows);
+void ploadEnd       ();
+void ploadFinished  ();
+bool ploadBuilt     (int imatch);
+
+sds  genRdbLoadInfoString(sds info);
+
+#endif /* __ALC_RDB_PLOAD__H */
@@ -48,6 +48,9 @@ ALL RIGHTS RESERVED
 #include "sixbit.h"
 #include "lru.h"
 #include "lfu.h"
+#include "evict.h"
+#include "aof_row.h"
+#include "rdb_delta.h"
 #include "bt.h"
 #include "colparse.h"
 #include "index.h"
@@ -111,6 +114,8 @@ static aobj colFromUL(ulong   key, bool fs, int cmatch);
 static aobj colFromLU(ulong   key, bool fs, int cmatch);
 static aobj colFromLL(ulong   key, bool fs, int cmatch);
 static aobj colFromXX(uint128 key, bool fs, int cmatch);
+static aobj getRC_Expr(bt  *btr,    uchar *orow, int imatch, aobj *apk,
+                       int  tmatch, bool   fs);
 static bool evalExpr   (cli  *c, ue_t  *ue, aobj *aval, uchar ctype);
 static bool evalLuaExpr(cli  *c, icol_t *ic, uc_t *uc, aobj *apk,
                         void *orow, aobj *aval);
@@ -702,6 +707,15 @@ static aobj getRC_LFunc(bt   *btr, uchar  *orow, int tmatch, aobj *apk,
     }
     return a;
 }
+static aobj getRC_Cover(bt *btr, void *orow, int cmatch, aobj *apk, bool fs) {
+    crow_t  *cr   = (crow_t *)orow;
+    r_ind_t *ri   = &Index[btr->s.num];
+    aobj    *akey = !cmatch                  ? apk     :
+                    cmatch == ri->icol.cmatch ? cr->afk : NULL;
+    if (!akey) return getRC_OBT(btr, cr->nrow, 1, apk, fs); /* INCLUDE col */
+    if (!C_IS_S(akey->type) && !fs) return *akey; /* [PK,FK] echo the keys */
+    aobj a; initStringAobjFromAobj(&a, akey); a.type = akey->type; return a;
+}
 static aobj getRC_Ipos(int cmatch, bool fs) {
     aobj a; int imatch = getImatchFromOCmatch(cmatch);
     initIntAobjFromVal(&a, Index[imatch].cipos, fs, cmatch); return a;
@@ -796,7 +810,12 @@ aobj getRawCol(bt  *btr,    uchar *orow, icol_t  ic,  aobj *apk,
     if      (IS_LSF(cmatch)) return getRC_LFunc(btr, orow, tmatch, apk, fs,
                                                 lfca);
     else if (cmatch < -1)    return getRC_Ipos (cmatch, fs);
+    else if (COVERI(btr) ||
+             SIMP_UNIQ(btr)) return getRC_Cover(btr, orow, cmatch, apk, fs);
     else if (OTHER_BT(btr))  return getRC_OBT  (btr, orow, cmatch, apk, fs);
+    if (cmatch == -1 && ic.fimatch != -1 && Index[ic.fimatch].xop) {
+        return getRC_Expr(btr, orow, ic.fimatch, apk, tmatch, fs);
+    }
     aobj a; initAobj(&a); //DEBUG_GET_RAW_COL
     if (cmatch == -1)  return a; // NOTE: used for HASHABILITY miss
     r_tbl_t *rt    = &Tbl[tmatch];
@@ -837,6 +856,19 @@ aobj getRawCol(bt  *btr,    uchar *orow, icol_t  ic,  aobj *apk,
     }
     return a;
 }
+/* EXPRESSION INDEX's column (e.g. WHERE "col%10 = 3") -> evaluate in C */
+static aobj getRC_Expr(bt  *btr,    uchar *orow, int imatch, aobj *apk,
+                       int  tmatch, bool   fs) {
+    r_ind_t *ri = &Index[imatch];
+    aobj     a  = getRawCol(btr, orow, ri->icol, apk, tmatch, 0, NULL);
+    applyIndexExpr(ri, &a);
+    if (!fs || a.empty || C_IS_S(a.type)) return a;
+    aobj     sa;
+    if C_IS_I(a.type) initIntAobjFromVal (&sa, a.i, 1, ri->icol.cmatch);
+    else              initLongAobjFromVal(&sa, a.l, 1, ri->icol.cmatch);
+    releaseAobj(&a);
+    return sa;
+}
 inline aobj getCol(bt     *btr, uchar *rrow, icol_t ic, aobj *apk, int tmatch,
                    lfca_t *lfca) {
     return getRawCol(btr, rrow, ic, apk, tmatch, 0, lfca);
@@ -1118,12 +1150,59 @@ static robj *orow_lua(bt   *btr, void *rrow,   int     qcols, icol_t *ics,
 orowl_err:
     CLEAR_LUA_STACK *ost = OR_LUA_FAIL; return NULL;
 }
-robj *outputRow(bt  *btr, void *rrow,   int     qcols, icol_t *ics, 
+/* BINARY row: per column [COL_TYPE(1 byte)][VALUE] (host is LITTLE_ENDIAN)
+     VALUE: INT:4 LONG:8 FLOAT:4 U128:16 STRING:[uint32 len][bytes]
+            NONE (empty column): no VALUE
+   [LUAO,FUNC,CNAME] columns are output as STRINGs */
+static sds orow_binary_col(sds s, aobj *a) {
+    uchar ctype = a->empty ? COL_TYPE_NONE : a->type;
+    if (C_IS_O(ctype) || C_IS_P(ctype) || C_IS_C(ctype)) {
+        sl_t sl = outputReformat(a);
+        uchar t = COL_TYPE_STRING; uint32 len = sl.len;
+        s = sdscatlen(s, &t,   1);
+        s = sdscatlen(s, &len, sizeof(uint32));
+        s = sdscatlen(s, sl.s, sl.len); release_sl(sl);
+        return s;
+    }
+    s = sdscatlen(s, &ctype, 1);
+    if      C_IS_I(ctype) s = sdscatlen(s, &a->i, sizeof(uint32));
+    else if C_IS_L(ctype) s = sdscatlen(s, &a->l, sizeof(ulong));
+    else if C_IS_F(ctype) s = sdscatlen(s, &a->f, sizeof(float));
+    else if C_IS_X(ctype) s = sdscatlen(s, &a->x, sizeof(uint128));
+    else if C_IS_S(ctype) {
+        uint32 len = a->len;
+        s = sdscatlen(s, &len, sizeof(uint32)); s = sdscatlen(s, a->s, len);
+    }
+    return s;
+}
+static robj *orow_binary(bt     *btr, void *rrow, int qcols,
+                         icol_t *ics,  aobj *apk,  int tmatch,
+                         lfca_t *lfca, bool *ost) {
+    sds  s        = sdsempty();
+    bool allbools = 1; bool bool_ok = 0; // allbools means dont print row
+    for (int i = 0; i < qcols; i++) {
+        aobj  acol  = getCol(btr, rrow, ics[i], apk, tmatch, lfca);
+        if C_IS_E(acol.type) { releaseAobj(&acol);      goto orowb_err; }
+        if C_IS_B(acol.type) { if (acol.b) bool_ok = 1; continue; }
+        allbools    = 0;
+        s           = orow_binary_col(s, &acol);
+        releaseAobj(&acol);
+    }
+    if (allbools) {
+        sdsfree(s); *ost = bool_ok ? OR_ALLB_OK : OR_ALLB_NO; return NULL;
+    }
+    return createObject(REDIS_STRING, s);
+
+orowb_err:
+    sdsfree(s); *ost = OR_LUA_FAIL; return NULL;
+}
+robj *outputRow(bt  *btr, void *rrow,   int     qcols, icol_t *ics,
                aobj *apk, int   tmatch, lfca_t *lfca,  bool   *ost) {
     if (lfca) lfca->curr = 0; //RESET queue
     row_outputter *rop = (EREDIS ? orow_embedded :
                           OREDIS ? orow_redis    :
-                          LREDIS ? orow_lua      : orow_normal);
+                          LREDIS ? orow_lua      :
+                          BREDIS ? orow_binary   : orow_normal);
     return (*rop)(btr, rrow, qcols, ics, apk, tmatch, lfca, ost);
 }
 // ADD_REPLY_ROW ADD_REPLY_ROW ADD_REPLY_ROW ADD_REPLY_ROW ADD_REPLY_ROW
@@ -1177,6 +1256,7 @@ int deleteRow(int tmatch, aobj *apk, int matches, int inds[]) {
                 if C_IS_O(rt->col[i].type) deleteLuaTable(tmatch, i, apk);
             }}
     }
+    aofRowLog(tmatch, AOFROW_DEL, apk, NULL);
     btDelete(btr, apk); server.dirty++; 
     //printf("END: deleteRow\n\n\n"); fflush(NULL);
     return dwm.miss ? -1 : 1;
@@ -1225,12 +1305,22 @@ static bool upEffectedFailableIndexes(cli    *c,       bt *btr,
             for (int i = 0; i < ri->nclist; i++) {
                 if (chit[ri->bclist[i].cmatch].cmatch != -1) { up = 1; break; }
             }
-        } else { up = (chit[ri->icol.cmatch].cmatch != -1); }
+        } else {
+            up = (chit[ri->icol.cmatch].cmatch != -1) ||
+                 (ri->icov.cmatch != -1 && chit[ri->icov.cmatch].cmatch != -1) ||
+                 indexWCColHit(ri, chit);
+        }
         if (up) { hasup = 1; upit[i] = 1; }
     }
     if (!hasup) return 1;
     for (int i = 0; i < matches; i++) {
         if (!upit[i]) continue;
+        r_ind_t *ri = &Index[inds[i]]; /* INCLUDE,PARTIAL,EXPRESSION,BITMAP */
+        if (ri->icov.cmatch != -1 || ri->pflist || ri->xop ||
+            BMAP(ri->cnstr)) {                               // CAN NOT FAIL
+            delFromIndex(btr, opk, orow, inds[i], 0);  // DEL 1st: same KEY&PK
+            addToIndex  (c, btr, npk, nrow, inds[i]); continue;
+        }
         if (!addToIndex(c, btr, npk, nrow, inds[i])) {
             for (int j = 0; j < i; j++) { // ROLLBACK previous ADD-INDEXes
                 if (!upit[j]) continue;
@@ -1287,16 +1377,31 @@ static int runUpdate(cli *c,    uc_t *uc,   aobj *opk,   void *orow,
         runPreUpdateLuatriggers(uc->btr, opk, orow, uc->matches, uc->inds);
     }
     if (uc->chit[0].cmatch != -1) { // PK update
-        //NOTE: runFailableInsertIndexes() can NOT FAIL -> FACTORED OUT
-        runFailableInsertIndexes(c, uc->btr, npk, nrow, uc->matches, uc->inds);
+        //NOTE: DELETE 1st: UNIQUE column value may be unchanged
         runDeleteIndexes(uc->btr, opk, orow, uc->matches, uc->inds, 0);
+        if (!runFailableInsertIndexes(c, uc->btr, npk, nrow, uc->matches,
+                                      uc->inds)) {   // UNIQUE VIOLATION
+            runFailableInsertIndexes(c, uc->btr, opk, orow, uc->matches,
+                                     uc->inds);      // RESTORE OLD entries
+            if (NORM_BT(uc->btr)) free(nrow);            // FREED 023
+            destroyAobj(npk);                            // FREED 168
+            return -1;
+        }
         btDelete(uc->btr, opk);          // DELETE row w/ OLD PK
         ret = btAdd(uc->btr, npk, nrow); // ADD row w/ NEW PK
+        aofRowLog(uc->tmatch, AOFROW_DEL, opk, NULL);
+        aofRowLog(uc->tmatch, AOFROW_PUT, npk, nrow);
+        evrPunch(uc->tmatch, npk);
         UPDATE_AUTO_INC(rt->col[0].type, npk)
-    } else { // upEffectedFailableIndexes() CAN NOT FAIL -> FACTORED OUT
-        upEffectedFailableIndexes(c, uc->btr, opk, orow, npk, nrow,
-                                  uc->matches, uc->inds, uc->chit);
+    } else { // SINGLE-ROW UPDATE: UNIQUE VIOLATION -> row left untouched
+        if (!upEffectedFailableIndexes(c, uc->btr, opk, orow, npk, nrow,
+                                       uc->matches, uc->inds, uc->chit)) {
+            if (NORM_BT(uc->btr)) free(nrow);            // FREED 023
+            destroyAobj(npk);                            // FREED 168
+            return -1;
+        }
         ret = btReplace(uc->btr, opk, nrow); // OVERWRITE w/ new row 
+        aofRowLog(uc->tmatch, AOFROW_PUT, opk, nrow);
     }
     if (lodlt) { // Apply FULL LuaTable Updates
         lua_getglobal(server.lua, "pop_AQ");
@@ -1377,6 +1482,7 @@ void abandonUpdateQueue(cli *c) {
 static int updateOverwrite(cli   *c,         uc_t *uc,  cr_t *cr, crd_t *crd,
                            uchar  osflags[], aobj *opk, void *orow) {
     r_tbl_t *rt = &Tbl[uc->tmatch];
+    DELTA_TOUCH(uc->btr, opk) /* orow is written in place */
     for (int i = 1; i < cr->ncols; i++) {
         if (osflags[i]) {
             uint32 clen; uchar rflag;
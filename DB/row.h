@@ -57,6 +57,14 @@ int   output_start    (char *buf, uint32 blen, int qcols);
 robj *write_output_row(int   qcols,   uint32  prelen, char *pbuf,
                        uint32 totlen, sl_t   *outs);
 
+/* COVERING INDEX row: [PK, FK, INCLUDE] output w/o touching the table row
+     INCLUDE node: [PK -> INCLUDE], SIMPLE UNIQUE index: [FK -> PK] */
+typedef struct cover_row {
+    bt   *btr;  /* [INCLUDE node|UNIQUE index] -> getCol() dispatch */
+    aobj *afk;  /* FK: the index key being iterated */
+    void *nrow; /* INCLUDE node's value stream (NULL for UNIQUE) */
+} crow_t;
+
 #define OR_NONE      0
 #define OR_ALLB_OK   1
 #define OR_ALLB_NO   2
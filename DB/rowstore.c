@@ -0,0 +1,581 @@
+/*
+ * This file implements the ROWSTORE (evicted rows on local disk)
+ *
+
+AGPL License
+
+Copyright (c) 2011 Russell Sullivan <jaksprats AT gmail DOT com>
+ALL RIGHTS RESERVED
+
+   This file is part of ALCHEMY_DATABASE
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Affero General Public License as
+    published by the Free Software Foundation, either version 3 of the
+    License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Affero General Public License for more details.
+
+    You should have received a copy of the GNU Affero General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#define _DEFAULT_SOURCE /* pread(), pwrite(), pthread_sigmask() */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <errno.h>
+#include <assert.h>
+#include <signal.h>
+#include <pthread.h>
+
+#include "redis.h"
+#include "zmalloc.h"
+#include "anet.h"
+
+#include "bt.h"
+#include "row.h"
+#include "index.h"
+#include "find.h"
+#include "lru.h"
+#include "webserver.h"
+#include "alsosql.h"
+#include "query.h"
+#include "common.h"
+#include "rowstore.h"
+#include "evict.h"
+
+extern r_tbl_t *Tbl;   extern int Num_tbls;
+extern r_ind_t *Index;
+
+/* NOTE: "CONFIG SET rowstore_dir DIR" turns the ROWSTORE on: evictRow()
+         appends the evicted row's stream to the active segment file (in DIR)
+         and records [PK -> (segment, offset)] in rt->rsd. A PK lookup that
+         hits an evicted span calls rsFaultIn(): the row is read back, its
+         DR span in the table's btree is split around it (bt_unevict_dr())
+         and its index entries are re-added -> the client never sees a MISS.
+         Segments are append-only, a faulted-in row (or a dropped table)
+         leaves a dead record behind, rowstoreTimeProc() moves the live
+         records out of mostly dead segments and closes them.
+         Segments are unlinked when created (they live until close()), the
+         ROWSTORE is a cache tier: DRs are NOT saved in the RDB (see
+         rdbInsertRow()), evicted rows & their ROWSTORE records do NOT
+         survive an RDB reload
+   NOTE: "rowstore_async yes" (default) a SELECT from a connected client does
+         not pread() its evicted rows: rsFaultIn() queues an IO job, the
+         SELECT's MISS reply is dropped & the client is blocked (w/ argv kept,
+         no reads). An IO thread pread()s the rows, the main thread puts them
+         back in the table (rsIODone()) & re-runs the SELECT, so other clients
+         are served while the disk is read [same design as dscache.c] */
+#define RS_SEG_MAX  (64 * 1024 * 1024) /* bytes, then a new segment */
+#define RS_LIVE_PCT 50                 /* compact below 50% live bytes */
+
+typedef struct rs_segment {
+    int    fd;    /* -1 -> free slot */
+    ulong  size;  /* bytes appended */
+    ulong  live;  /* bytes of records still in an rt->rsd */
+} rss_t;
+typedef struct rs_location {
+    uint32 seg;
+    uint32 rlen;  /* row stream bytes */
+    ulong  ofst;  /* record's offset in the segment */
+    bool   lrlf;  /* LRU/LFU index entries were dropped (auto-evict) */
+} rsl_t;
+typedef struct rs_record_header { /* ON DISK: [rsh_t][PK bytes][row stream] */
+    uint32 tmatch;
+    uint32 klen;
+    uint32 rlen;
+} rsh_t;
+#define RS_RECLEN(klen, rlen) (sizeof(rsh_t) + (klen) + (rlen))
+
+static rss_t *RsSegs   = NULL;
+static uint32 RsNsegs  = 0;
+static int    RsActive = -1;
+
+static ulong RsWrites = 0; static ulong RsFaults      = 0;
+static ulong RsErrors = 0; static ulong RsCompactions = 0;
+
+typedef struct rs_wait_t { /* client blocked on ROWSTORE fault-ins */
+    cli   *c;       /* NULL -> client was freed while blocked */
+    int    pending; /* IO jobs still in flight */
+} rsw_t;
+typedef struct rs_iojob {
+    rsw_t *w;
+    int    tmatch;
+    sds    key;     /* PK's access key */
+    rsl_t  l;       /* record's location when queued, checked when done */
+    int    fd;
+    uchar *row;     /* pread() by the IO thread */
+    bool   ok;
+} rsj_t;
+
+static list           *RsNewJobs  = NULL; /* main thread -> IO thread */
+static list           *RsDoneJobs = NULL; /* IO thread -> main thread */
+static pthread_mutex_t RsMutex    = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t  RsCond     = PTHREAD_COND_INITIALIZER;
+static int             RsPipe[2]  = {-1, -1};
+static cli            *RsDeferC   = NULL; /* SELECT queueing its fault-ins */
+static rsw_t          *RsDeferW   = NULL;
+static bool            RsResuming = 0;
+static ulong           RsInflight = 0; /* NOTE: no compaction while > 0 */
+static ulong           RsBlocked  = 0;
+static ulong           RsAsyncFaults = 0;
+
+unsigned int dictSdsHash(const void *key);
+int          dictSdsKeyCompare(void *privdata, const void *key1,
+                               const void *key2);
+void         dictSdsDestructor(void *privdata, void *val);
+
+static void rsLocDestructor(void *privdata, void *val) {
+    (void)privdata; zfree(val);                          // FREED 224
+}
+static dictType rsDictType = {
+    dictSdsHash,                /* hash function */
+    NULL,                       /* key dup */
+    NULL,                       /* val dup */
+    dictSdsKeyCompare,          /* key compare */
+    dictSdsDestructor,          /* key destructor */
+    rsLocDestructor             /* val destructor */
+};
+
+// SEGMENT_IO SEGMENT_IO SEGMENT_IO SEGMENT_IO SEGMENT_IO SEGMENT_IO
+static bool rsWrite(int fd, void *p, size_t len, ulong ofst) {
+    char *b = p;
+    while (len) {
+        ssize_t n = pwrite(fd, b, len, (off_t)ofst);
+        if (n == -1 && errno == EINTR) continue;
+        if (n <= 0)                    return 0;
+        b += n; len -= n; ofst += n;
+    }
+    return 1;
+}
+static bool rsRead(int fd, void *p, size_t len, ulong ofst) {
+    char *b = p;
+    while (len) {
+        ssize_t n = pread(fd, b, len, (off_t)ofst);
+        if (n == -1 && errno == EINTR) continue;
+        if (n <= 0)                    return 0;
+        b += n; len -= n; ofst += n;
+    }
+    return 1;
+}
+static int rsNewSegment() {
+    int seg = -1;
+    for (uint32 i = 0; i < RsNsegs; i++) {
+        if (RsSegs[i].fd == -1) { seg = i; break; }
+    }
+    if (seg == -1) {
+        RsSegs = zrealloc(RsSegs, sizeof(rss_t) * (RsNsegs + 1));
+        seg    = RsNsegs++; RsSegs[seg].fd = -1;
+    }
+    sds path = sdscatprintf(sdsempty(), "%s/alchemy_rowstore.%d.%d",
+                            server.alc.RowStoreDir, (int)getpid(), seg);
+    int fd   = open(path, O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (fd != -1) unlink(path); /* segment lives until close() */
+    else {
+        RsErrors++;
+        redisLog(REDIS_WARNING, "ROWSTORE: segment: %s: %s",
+                 path, strerror(errno));
+    }
+    sdsfree(path);
+    if (fd == -1) return -1;
+    RsSegs[seg].fd = fd; RsSegs[seg].size = RsSegs[seg].live = 0;
+    return seg;
+}
+static bool rsAppend(int tmatch, sds key, void *row, uint32 rlen, rsl_t *l) {
+    if (RsActive == -1 || RsSegs[RsActive].size >= RS_SEG_MAX) {
+        if ((RsActive = rsNewSegment()) == -1)                return 0;
+    }
+    rss_t *s    = &RsSegs[RsActive];
+    rsh_t  h;   h.tmatch = tmatch; h.klen = sdslen(key); h.rlen = rlen;
+    ulong  ofst = s->size;
+    if (!rsWrite(s->fd, &h,  sizeof(rsh_t), ofst)                 ||
+        !rsWrite(s->fd, key, h.klen,        ofst + sizeof(rsh_t)) ||
+        !rsWrite(s->fd, row, rlen,          ofst + sizeof(rsh_t) + h.klen)) {
+        RsErrors++;
+        redisLog(REDIS_WARNING, "ROWSTORE: write: %s", strerror(errno));
+        return 0;
+    }
+    ulong  rlen2 = RS_RECLEN(h.klen, rlen);
+    s->size     += rlen2; s->live += rlen2;
+    l->seg       = RsActive; l->rlen = rlen; l->ofst = ofst;
+    return 1;
+}
+static void rsKill(rsl_t *l, uint32 klen) {
+    RsSegs[l->seg].live -= RS_RECLEN(klen, l->rlen);
+}
+
+// PUBLIC PUBLIC PUBLIC PUBLIC PUBLIC PUBLIC PUBLIC PUBLIC PUBLIC PUBLIC
+/* evictFromIndex() can not be undone for MCI, UNIQUE & COVERING indexes,
+   LuaTable columns are deleted on EVICT */
+static bool rsFaultable(int tmatch) {
+    r_tbl_t *rt  = &Tbl[tmatch];
+    bt      *btr = getBtr(tmatch);
+    if (rt->haslo || OTHER_BT(btr))                               return 0;
+    if (!C_IS_I(btr->s.ktype) && !C_IS_L(btr->s.ktype))           return 0;
+    MATCH_INDICES(tmatch)
+    for (int j = 0; j < matches; j++) {
+        r_ind_t *ri = &Index[inds[j]];
+        if (ri->virt || ri->fname || ri->hlt || ri->lru || ri->lfu) continue;
+        if (BMAP(ri->cnstr) || HASHI(ri->cnstr))                  continue;
+        if (ri->clist || UNIQ(ri->cnstr) || ri->icov.cmatch != -1) return 0;
+    }
+    return 1;
+}
+/* lrlf: evictRow() dropped the row's LRU/LFU index entries */
+bool rsPut(int tmatch, aobj *apk, void *rrow, bool lrlf) {
+    if (!server.alc.RowStoreDir || !rsFaultable(tmatch))          return 0;
+    r_tbl_t   *rt  = &Tbl[tmatch];
+    if (!rt->rsd) rt->rsd = dictCreate(&rsDictType, NULL); // FREE ME 223
+    sds        key = setAccessKey(apk);
+    rsl_t      l;  l.lrlf = lrlf;
+    if (!rsAppend(tmatch, key, rrow, getRowMallocSize(rrow), &l)) return 0;
+    dictEntry *de  = dictFind(rt->rsd, key);
+    if (de) {
+        rsl_t *ol = dictGetEntryVal(de); rsKill(ol, sdslen(key)); *ol = l;
+    } else {
+        rsl_t *nl = zmalloc(sizeof(rsl_t)); *nl = l;     // FREE ME 224
+        ASSERT_OK(dictAdd(rt->rsd, sdsdup(key), nl));
+    }
+    RsWrites++;
+    return 1;
+}
+/* RETURNS: number of evicted PKs strictly between alow (NULL -> -inf) & ahigh
+   NOTE: apk's DR span is split by these, PKs are not assumed to be dense */
+static uint32 rsEvictedBetween(r_tbl_t *rt, aobj *alow, aobj *ahigh) {
+    uchar  pktyp = rt->col[0].type;
+    uint32 n     = 0;
+    aobj   apk;  initAobjZeroNum(&apk, pktyp);
+    ulong  hi    = C_IS_I(pktyp) ? ahigh->i : ahigh->l;
+    ulong  lo    = !alow ? 0 : C_IS_I(pktyp) ? alow->i : alow->l;
+    if (alow && (hi - lo) <= dictSize(rt->rsd)) { // probe each PK in between
+        for (ulong k = lo + 1; k < hi; k++) {
+            if C_IS_I(pktyp) apk.i = (uint32)k; else apk.l = k;
+            sds key = setAccessKey(&apk);
+            if (dictFind(rt->rsd, key)) n++;
+        }
+        return n;
+    }
+    dictEntry    *de;                                    // scan evicted PKs
+    dictIterator *di = dictGetIterator(rt->rsd);
+    while((de = dictNext(di))) {
+        initAccessPK(&apk, dictGetEntryKey(de), pktyp);
+        if (alow && aobjKeyCmp(&apk, alow) <= 0) continue;
+        if (aobjKeyCmp(&apk, ahigh) < 0) n++;
+    } dictReleaseIterator(di);
+    return n;
+}
+static void rsQueueIOJob(int tmatch, sds key, rsl_t *l);
+
+/* row (read from l) goes back in the table & its indexes, row is freed */
+static bool rsLoad(int tmatch, aobj *apk, rsl_t *l, uint32 klen, uchar *row) {
+    r_tbl_t   *rt   = &Tbl[tmatch];
+    bt        *btr  = getBtr(tmatch);
+    aobj       aprv; initAobj(&aprv);
+    bool       hasp = btPrevKey(btr, apk, &aprv);
+    uint32     left = rsEvictedBetween(rt, hasp ? &aprv : NULL, apk);
+    ulong      pre  = btr->msize;
+    if (!btUnevict(btr, apk, row, left)) {
+        releaseAobj(&aprv); zfree(row);                  // FREED 225
+        return 0;
+    }
+    evrPunch(tmatch, apk);
+    if (hasp) { // GHOST predecessor w/ no more DR -> HARD_DELETE it
+        dwm_t dwm = btFindD(btr, &aprv);
+        if (IS_GHOST(btr, dwm.k) && !btGetDR(btr, &aprv)) btDelete(btr, &aprv);
+    }
+    releaseAobj(&aprv);
+    ulong      grow = btr->msize - pre;
+    MATCH_INDICES(tmatch)
+    for (int j = 0; j < matches; j++) {
+        r_ind_t *ri   = &Index[inds[j]];
+        if (ri->virt || !ri->btr) continue;
+        ulong    ipre = ri->btr->msize;
+        if (ri->lru || ri->lfu) {
+            if (l->lrlf) addToIndex(NULL, btr, apk, row, inds[j]);
+        } else unevictToIndex(btr, apk, row, inds[j]);
+        grow += (ri->btr->msize - ipre);
+    }
+    zfree(row);                                          // FREED 225
+    rt->nebytes -= (grow < rt->nebytes) ? grow : rt->nebytes;
+    if (rt->nerows) rt->nerows--;
+    rsKill(l, klen);
+    sds        key  = setAccessKey(apk); /* NOTE: AccKey is shared */
+    dictDelete(rt->rsd, key);                            // FREED 224
+    RsFaults++;
+    return 1;
+}
+/* RETURNS: 1 if apk was in the ROWSTORE & is now back in the table
+   NOTE: must NOT be called while tmatch's btree is being iterated
+   NOTE: w/in an async SELECT the row is queued for the IO thread -> 0 */
+bool rsFaultIn(int tmatch, aobj *apk) {
+    r_tbl_t   *rt   = &Tbl[tmatch];
+    if (!rt->rsd)                                                 return 0;
+    sds        key  = setAccessKey(apk);
+    dictEntry *de   = dictFind(rt->rsd, key);
+    if (!de || !rsFaultable(tmatch))                              return 0;
+    rsl_t     *l    = dictGetEntryVal(de);
+    if (RsDeferC) { rsQueueIOJob(tmatch, key, l);                 return 0; }
+    uint32     klen = sdslen(key);
+    uchar     *row  = zmalloc(l->rlen);                  // FREE ME 225
+    if (!rsRead(RsSegs[l->seg].fd, row, l->rlen,
+                l->ofst + sizeof(rsh_t) + klen)) {
+        RsErrors++;
+        redisLog(REDIS_WARNING, "ROWSTORE: read: %s", strerror(errno));
+        zfree(row);                                      // FREED 225
+        return 0;
+    }
+    return rsLoad(tmatch, apk, l, klen, row);
+}
+/* RETURNS: 1 if EVERY evicted row in [alow, ahigh] is now back in the table
+   NOTE: DRs assume dense PKs, w/ DELETEd holes a span can still claim a
+         MISS in [alow, ahigh] -> callers ignore MISSes when this is 1 */
+bool rsFaultInRange(int tmatch, aobj *alow, aobj *ahigh) {
+    r_tbl_t *rt    = &Tbl[tmatch];
+    if (!rt->rsd)                                                 return 0;
+    if (!dictSize(rt->rsd))                                return !rt->rsmiss;
+    uchar    pktyp = rt->col[0].type;
+    if (!C_IS_I(pktyp) && !C_IS_L(pktyp))                         return 0;
+    bool     ok    = !rt->rsmiss;
+    aobj     apk;  initAobjZeroNum(&apk, pktyp);
+    ulong    lo    = C_IS_I(pktyp) ? alow->i  : alow->l;
+    ulong    hi    = C_IS_I(pktyp) ? ahigh->i : ahigh->l;
+    if (hi >= lo && (hi - lo) < dictSize(rt->rsd)) { // probe each PK in range
+        for (ulong k = lo; ; k++) {
+            if C_IS_I(pktyp) apk.i = (uint32)k; else apk.l = k;
+            if (!rsFaultIn(tmatch, &apk) &&
+                dictFind(rt->rsd, setAccessKey(&apk)))           ok = 0;
+            if (k == hi) break;
+        }
+        return ok;
+    }
+    dictEntry    *de;                                    // scan evicted PKs
+    dictIterator *di = dictGetSafeIterator(rt->rsd);
+    while((de = dictNext(di))) {
+        initAccessPK(&apk, dictGetEntryKey(de), pktyp);
+        if (aobjKeyCmp(&apk, alow) < 0 || aobjKeyCmp(&apk, ahigh) > 0) continue;
+        if (!rsFaultIn(tmatch, &apk))                             ok = 0;
+    } dictReleaseIterator(di);
+    return ok;
+}
+void rsDropTable(r_tbl_t *rt) {
+    if (!rt->rsd) return;
+    dictEntry    *de;
+    dictIterator *di = dictGetIterator(rt->rsd);
+    while((de = dictNext(di))) {
+        rsKill(dictGetEntryVal(de), sdslen(dictGetEntryKey(de)));
+    } dictReleaseIterator(di);
+    dictRelease(rt->rsd); rt->rsd = NULL;                // FREED 223
+}
+
+// ASYNC_FAULT_IN ASYNC_FAULT_IN ASYNC_FAULT_IN ASYNC_FAULT_IN ASYNC_FAULT_IN
+static void *rsIOThread(void *arg) {
+    (void)arg; // compiler warning
+    pthread_detach(pthread_self());
+    pthread_mutex_lock(&RsMutex);
+    while (1) {
+        if (!listLength(RsNewJobs)) {
+            pthread_cond_wait(&RsCond, &RsMutex);              continue;
+        }
+        listNode *ln = listFirst(RsNewJobs);
+        rsj_t    *j  = ln->value;
+        listDelNode(RsNewJobs, ln);
+        pthread_mutex_unlock(&RsMutex);
+        j->ok = rsRead(j->fd, j->row, j->l.rlen,
+                       j->l.ofst + sizeof(rsh_t) + sdslen(j->key));
+        pthread_mutex_lock(&RsMutex);
+        listAddNodeTail(RsDoneJobs, j);
+        if (write(RsPipe[1], "x", 1) != 1) { /* main thread polls w/ jobs */ }
+    }
+    return NULL;
+}
+static void rsResume(cli *c) {
+    c->RsWait  = NULL; RsBlocked--;
+    aeCreateFileEvent(server.el, c->fd, AE_READABLE, readQueryFromClient, c);
+    RsResuming = 1;         /* re-run: rows are back, else fault-in is sync */
+    int ret    = processCommand(c);
+    RsResuming = 0;
+    if (ret == REDIS_OK) resetClient(c);
+    if (c->querybuf && sdslen(c->querybuf)) processInputBuffer(c);
+}
+/* the row goes back in (if its record is still the one that was read) */
+static void rsIOJobDone(rsj_t *j) {
+    RsInflight--;
+    r_tbl_t   *rt = (j->tmatch < Num_tbls) ? &Tbl[j->tmatch] : NULL;
+    dictEntry *de = (rt && rt->name && rt->rsd) ? dictFind(rt->rsd, j->key) :
+                                                  NULL;
+    rsl_t     *l  = de ? dictGetEntryVal(de) : NULL;
+    if (!j->ok) {
+        RsErrors++;
+        redisLog(REDIS_WARNING, "ROWSTORE: async read: %s", strerror(errno));
+        zfree(j->row);                                   // FREED 225
+    } else if (l && l->seg == j->l.seg && l->ofst == j->l.ofst &&
+               rsFaultable(j->tmatch)) {
+        aobj apk; initAccessPK(&apk, j->key, rt->col[0].type);
+        if (rsLoad(j->tmatch, &apk, l, sdslen(j->key), j->row)) RsAsyncFaults++;
+    } else zfree(j->row); /* faulted-in, re-EVICTed or DROPped meanwhile */
+    rsw_t *w = j->w;
+    sdsfree(j->key); zfree(j);                           // FREED 227
+    if (!--w->pending) {
+        if (w->c) rsResume(w->c);
+        zfree(w);                                        // FREED 226
+    }
+}
+static void rsIODone(aeEventLoop *el, int fd, void *privdata, int mask) {
+    (void)el; (void)privdata; (void)mask; // compiler warnings
+    char buf[64]; ssize_t n;
+    while ((n = read(fd, buf, sizeof(buf))) > 0) { /* 1 byte per done job */
+        while (n--) {
+            pthread_mutex_lock(&RsMutex);
+            listNode *ln = listFirst(RsDoneJobs);
+            rsj_t    *j  = ln->value;
+            listDelNode(RsDoneJobs, ln);
+            pthread_mutex_unlock(&RsMutex);
+            rsIOJobDone(j);
+        }
+    }
+}
+static bool rsIOInit() {
+    if (RsNewJobs)                                                return 1;
+    if (pipe(RsPipe) == -1)                                    goto rsio_err;
+    anetNonBlock(NULL, RsPipe[0]);
+    if (aeCreateFileEvent(server.el, RsPipe[0], AE_READABLE, rsIODone, NULL)
+        == AE_ERR)                                             goto rsio_err;
+    zmalloc_enable_thread_safeness(); /* IO thread uses lists */
+    RsNewJobs  = listCreate(); RsDoneJobs = listCreate();
+    sigset_t  mask, omask; pthread_t thread;
+    sigemptyset(&mask);
+    sigaddset(&mask, SIGCHLD); sigaddset(&mask, SIGHUP);
+    sigaddset(&mask, SIGPIPE);
+    pthread_sigmask(SIG_SETMASK, &mask, &omask);
+    int err = pthread_create(&thread, NULL, rsIOThread, NULL);
+    pthread_sigmask(SIG_SETMASK, &omask, NULL);
+    if (!err)                                                     return 1;
+    errno = err;
+
+rsio_err:
+    RsErrors++; server.alc.RowStoreAsync = 0; /* -> sync fault-in */
+    redisLog(REDIS_WARNING, "ROWSTORE: IO thread: %s", strerror(errno));
+    return 0;
+}
+static void rsQueueIOJob(int tmatch, sds key, rsl_t *l) {
+    if (!RsDeferW) {
+        RsDeferW = zmalloc(sizeof(rsw_t));               // FREE ME 226
+        RsDeferW->c = NULL; RsDeferW->pending = 0;
+    }
+    rsj_t *j  = zmalloc(sizeof(rsj_t));                  // FREE ME 227
+    j->w      = RsDeferW; j->tmatch = tmatch; j->key = sdsdup(key);
+    j->l      = *l;       j->fd     = RsSegs[l->seg].fd;
+    j->row    = zmalloc(l->rlen);                        // FREE ME 225
+    j->ok     = 0;
+    RsDeferW->pending++; RsInflight++;
+    pthread_mutex_lock(&RsMutex);
+    listAddNodeTail(RsNewJobs, j);
+    pthread_cond_signal(&RsCond);
+    pthread_mutex_unlock(&RsMutex);
+}
+/* RETURNS: 1 if this SELECT's fault-ins go to the IO thread
+   NOTE: only when the SELECT's reply can be dropped whole & re-run later */
+bool rsAsyncBegin(cli *c) {
+    if (!server.alc.RowStoreAsync || !server.alc.RowStoreDir || RsResuming ||
+        c->fd == -1 || c->http.mode != HTTP_MODE_OFF              ||
+        (c->flags & (REDIS_MULTI | REDIS_MASTER | REDIS_LUA_CLIENT)) ||
+        c->bufpos   || listLength(c->reply))                      return 0;
+    if (!rsIOInit())                                              return 0;
+    RsDeferC = c; RsDeferW = NULL;
+    return 1;
+}
+/* fault-ins were queued -> drop the reply (a MISS) & block the client */
+void rsAsyncEnd(cli *c) {
+    rsw_t *w = RsDeferW;
+    RsDeferC = NULL; RsDeferW = NULL;
+    if (!w) return;
+    c->bufpos = 0;
+    while (listLength(c->reply)) listDelNode(c->reply, listFirst(c->reply));
+    aeDeleteFileEvent(server.el, c->fd, AE_READABLE);
+    c->RsWait = w; w->c = c; RsBlocked++;
+}
+void rsFreeClient(cli *c) {
+    if (!c->RsWait) return;
+    c->RsWait->c = NULL; c->RsWait = NULL; RsBlocked--; /* jobs still finish */
+}
+
+// COMPACTION COMPACTION COMPACTION COMPACTION COMPACTION COMPACTION
+/* live records are re-appended to the active segment, then seg is closed */
+static void rsCompact(uint32 seg) {
+    ulong ofst = 0;
+    while (RsSegs[seg].live && ofst < RsSegs[seg].size) {
+        rsh_t h;
+        if (!rsRead(RsSegs[seg].fd, &h, sizeof(rsh_t), ofst))   goto rsc_err;
+        ulong    rlen2 = RS_RECLEN(h.klen, h.rlen);
+        r_tbl_t *rt    = (h.tmatch < (uint32)Num_tbls) ? &Tbl[h.tmatch] : NULL;
+        if (rt && rt->name && rt->rsd) {
+            sds        key = sdsnewlen(NULL, h.klen);
+            bool       ok  = rsRead(RsSegs[seg].fd, key, h.klen,
+                                    ofst + sizeof(rsh_t));
+            dictEntry *de  = ok ? dictFind(rt->rsd, key) : NULL;
+            rsl_t     *l   = de ? dictGetEntryVal(de) : NULL;
+            if (l && l->seg == seg && l->ofst == ofst) { // LIVE -> move
+                rsl_t  nl;  nl.lrlf = l->lrlf;
+                uchar *row = zmalloc(h.rlen);            // FREE ME 225
+                ok         = rsRead(RsSegs[seg].fd, row, h.rlen,
+                                    ofst + sizeof(rsh_t) + h.klen) &&
+                             rsAppend(h.tmatch, key, row, h.rlen, &nl);
+                zfree(row);                              // FREED 225
+                if (ok) { RsSegs[seg].live -= rlen2; *l = nl; }
+            }
+            sdsfree(key);
+            if (!ok)                                            goto rsc_err;
+        }
+        ofst += rlen2;
+    }
+    close(RsSegs[seg].fd);
+    RsSegs[seg].fd = -1; RsSegs[seg].size = RsSegs[seg].live = 0;
+    RsCompactions++;
+    return;
+
+rsc_err:
+    RsErrors++;
+    redisLog(REDIS_WARNING, "ROWSTORE: compaction: %s", strerror(errno));
+}
+int rowstoreTimeProc(struct aeEventLoop *eventLoop, lolo id, void *cdata) {
+    (void)eventLoop; (void)id; (void)cdata; // compiler warnings
+    if (RsInflight) return 1000; /* IO thread holds segment fds */
+    for (uint32 seg = 0; seg < RsNsegs; seg++) { /* one segment per tick */
+        rss_t *s = &RsSegs[seg];
+        if ((int)seg == RsActive || s->fd == -1) continue;
+        if (s->live * 100 < s->size * RS_LIVE_PCT) { rsCompact(seg); break; }
+    }
+    return 1000;
+}
+sds genRowStoreInfoString(sds info) {
+    ulong nsegs = 0, bytes = 0, live = 0, rows = 0;
+    for (uint32 seg = 0; seg < RsNsegs; seg++) {
+        if (RsSegs[seg].fd == -1) continue;
+        nsegs++; bytes += RsSegs[seg].size; live += RsSegs[seg].live;
+    }
+    for (int tmatch = 0; tmatch < Num_tbls; tmatch++) {
+        r_tbl_t *rt = &Tbl[tmatch];
+        if (rt->name && rt->rsd) rows += dictSize(rt->rsd);
+    }
+    return sdscatprintf(info, "rowstore_segments:%lu\r\n"
+                              "rowstore_bytes:%lu\r\n"
+                              "rowstore_live_bytes:%lu\r\n"
+                              "rowstore_rows:%lu\r\n"
+                              "rowstore_writes:%lu\r\n"
+                              "rowstore_faults:%lu\r\n"
+                              "rowstore_compactions:%lu\r\n"
+                              "rowstore_errors:%lu\r\n"
+                              "rowstore_async_faults:%lu\r\n"
+                              "rowstore_async_inflight:%lu\r\n"
+                              "rowstore_blocked_clients:%lu\r\n",
+                        nsegs, bytes, live, rows, RsWrites, RsFaults,
+                        RsCompactions, RsErrors, RsAsyncFaults, RsInflight,
+                        RsBlocked);
+}
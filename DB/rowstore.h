@@ -0,0 +1,46 @@
+/*
+ * This file implements the ROWSTORE (evicted rows on local disk)
+ *
+
+AGPL License
+
+Copyright (c) 2011 Russell Sullivan <jaksprats AT gmail DOT com>
+ALL RIGHTS RESERVED
+
+   This file is part of ALCHEMY_DATABASE
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Affero General Public License as
+    published by the Free Software Foundation, either version 3 of the
+    License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Affero General Public License for more details.
+
+    You should have received a copy of the GNU Affero General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __ALC_ROWSTORE__H
+#define __ALC_ROWSTORE__H
+
+#include "redis.h"
+
+#include "query.h"
+#include "common.h"
+
+bool rsPut         (int tmatch, aobj *apk, void *rrow, bool lrlf);
+bool rsFaultIn     (int tmatch, aobj *apk);
+bool rsFaultInRange(int tmatch, aobj *alow, aobj *ahigh);
+void rsDropTable   (r_tbl_t *rt);
+
+bool rsAsyncBegin  (cli *c);
+void rsAsyncEnd    (cli *c);
+void rsFreeClient  (cli *c);
+
+int  rowstoreTimeProc     (struct aeEventLoop *eventLoop, lolo id, void *cdata);
+sds  genRowStoreInfoString(sds info);
+
+#endif /* __ALC_ROWSTORE__H */
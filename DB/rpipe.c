@@ -49,6 +49,7 @@ void cleanupFakeClient(cli *rfc) {
     if (rfc->argc) { // free last call to getFakeClient
         while(rfc->argc--) decrRefCount(rfc->argv[rfc->argc]);
         if (rfc->argv) { zfree(rfc->argv); rfc->argv = NULL; }
+        rfc->argc = 0; // "while(argc--)" leaves -1
     }
 }
 void resetFakeClient(cli *rfc) {
@@ -43,6 +43,7 @@ ALL RIGHTS RESERVED
 #include "qo.h"
 #include "orderby.h"
 #include "filter.h"
+#include "fprog.h"
 #include "index.h"
 #include "colparse.h"
 #include "range.h"
@@ -123,7 +124,14 @@ void tscanCommand(redisClient *c) { //printf("tscanCommand\n");
     if ((where && !*where) || (wc && !*wc)) {
         addReply(c, shared.scansyntax);  RELEASE_CS_LS_LIST return;
     }
-    if (!parseSelect(c, 1, &nowc, &tmatch, cmatchl, ls, &qcols, &join,
+    aggr_t ag; bzero(&ag, sizeof(aggr_t));
+    bool  isag    = isAggrSelect(c->argv[1]->ptr);
+    if (isag) {
+        if (!parseAggrSelect(c, 1, &nowc, &tmatch, &ag, c->argv[1]->ptr,
+                             c->argv[2]->ptr, c->argv[3]->ptr, where, 1)) {
+            releaseAggr(&ag); RELEASE_CS_LS_LIST return;
+        }
+    } else if (!parseSelect(c, 1, &nowc, &tmatch, cmatchl, ls, &qcols, &join,
                      &cstar, c->argv[1]->ptr, c->argv[2]->ptr,
                      c->argv[3]->ptr, where, 1)) { 
                          RELEASE_CS_LS_LIST return; }
@@ -137,10 +145,11 @@ void tscanCommand(redisClient *c) { //printf("tscanCommand\n");
     c->LfuColInSelect = initLFUCS(tmatch, ics, qcols);
     cswc_t w; wob_t wb;
     init_check_sql_where_clause(&w, tmatch, wc); /* on error: GOTO tscan_end */
-    init_wob(&wb);
+    init_wob(&wb); wb.aggr = isag;
 
-    if (nowc && c->argc > 4) { /* "[ORDER BY or LIMIT] w/o WHERE CLAUSE */
-        if (!strncasecmp(where, "ORDER ", 6) ||
+    if (nowc && c->argc > 4) { /* "[GROUP BY,ORDER BY,LIMIT] w/o WHERE */
+        if (!strncasecmp(where, "GROUP ", 6) ||
+            !strncasecmp(where, "ORDER ", 6) ||
             !strncasecmp(where, "LIMIT ", 6)) {
             if (!parseWCEnd(c, c->argv[4]->ptr, &w, &wb, 0))   goto tscan_end;
             if (w.lvr) {
@@ -149,7 +158,7 @@ void tscanCommand(redisClient *c) { //printf("tscanCommand\n");
             }
         }
     }
-    if (nowc && !wb.nob && (wb.lim == -1) && c->argc > 4) { // argv[4] parse err
+    if (nowc && !wb.nob && !wb.ngby && (wb.lim == -1) && c->argc > 4) {//ERR
         w.lvr = sdsdup(where); leftoverParsingReply(c, w.lvr); goto tscan_end;
     }
     if (!nowc && !wb.nob) { /* WhereClause exists and no ORDER BY */
@@ -164,8 +173,11 @@ void tscanCommand(redisClient *c) { //printf("tscanCommand\n");
         addReply(c, shared.orderby_count);                     goto tscan_end;
     }
 
+    if (wb.ngby && !isag && !aggrFromICS(c, &ag, tmatch, cstar, ics, qcols)) {
+                                                               goto tscan_end;
+    }
     bt *btr = getBtr(w.wf.tmatch);
-    if (cstar && nowc) { /* SCAN COUNT(*) FROM tbl */
+    if (cstar && nowc && !wb.ngby) { /* SCAN COUNT(*) FROM tbl */
         addReplyLongLong(c, (long long)btr->numkeys);          goto tscan_end;
     }
     aobj aL, aH;
@@ -178,7 +190,9 @@ void tscanCommand(redisClient *c) { //printf("tscanCommand\n");
     w.wf.ic.cmatch = 0; /* PK RangeQuery */
     w.wtype        = SQL_RANGE_LKP; //dumpW(printf, &w);
     convertFilterListToAobj(w.flist);
-    if      (c->Prepare) prepareRQ(c, &w, &wb, cstar, qcols, ics);
+    w.fprog        = compileFilters(w.flist, w.wf.tmatch);
+    if      (ag.cols)    sqlAggrBinary(c, &ag, &w, &wb);
+    else if (c->Prepare) prepareRQ(c, &w, &wb, cstar, qcols, ics);
     else if (c->Explain) explainRQ(c, &w, &wb, cstar, qcols, ics);
     else {
 #ifdef EMBEDDED_VERSION
@@ -188,6 +202,7 @@ void tscanCommand(redisClient *c) { //printf("tscanCommand\n");
     }
 
 tscan_end: fflush(NULL);
+    releaseAggr(&ag);
     if (!cstar) resetIndexPosOn(qcols, ics);
     RELEASE_CS_LS_LIST releaseLFCA(&lfca);
     destroy_wob(&wb); destroy_check_sql_where_clause(&w);
@@ -112,13 +112,13 @@ void DXDB_createSharedObjects() {
         "-ERR SYNTAX: SELECT ... WHERE x IN ([SELECT|SCAN])\r\n"));
 
     shared.createsyntax = createObject(REDIS_STRING,sdsnew(
-        "-ERR SYNTAX: \"CREATE TABLE tablename (columnname type,,,,)\" OR \"CREATE INDEX indexname ON tablename (columnname) [ORDER BY othercolumn] [OFFSET X]\" OR \"CREATE LRUINDEX ON tablename\" OR \"CREATE LUATRIGGER luatriggername ON tablename ADD_LUA_CALL DEL_LUA_CALL\"\r\n"));
+        "-ERR SYNTAX: \"CREATE TABLE tablename (columnname type,,,,)\" OR \"CREATE TABLE tablename FROM MMAP filename\" OR \"CREATE INDEX indexname ON tablename (columnname) [USING BITMAP|HASH] [INCLUDE (othercolumn)] [WHERE \"pred\"] [ORDER BY othercolumn] [OFFSET X] [BACKGROUND] [PERSIST]\" OR \"CREATE LRUINDEX ON tablename\" OR \"CREATE LUATRIGGER luatriggername ON tablename ADD_LUA_CALL DEL_LUA_CALL\"\r\n"));
     shared.createsyntax_dn = createObject(REDIS_STRING,sdsnew(
         "-ERR SYNTAX: CREATE TABLE tablename (luatbl.x.y.z,,,) TYPE\r\n"));
     shared.dropsyntax = createObject(REDIS_STRING,sdsnew(
         "-ERR SYNTAX: DROP TABLE tablename OR DROP INDEX indexname OR DROP LUATRIGGER\r\n"));
     shared.altersyntax = createObject(REDIS_STRING,sdsnew(
-        "-ERR SYNTAX: ALTER TABLE tablename ADD [COLUMN columname type[INT,LONG,FLOAT,TEXT,U128]] [SHARDKEY columname] [FOREIGN KEY (fk_name) REFERENCES othertable (other_table_indexed_column)] [HASHABILITY] - ALTER TABLE tablename SET DIRTY\r\n"));
+        "-ERR SYNTAX: ALTER TABLE tablename ADD [COLUMN columname type[INT,LONG,FLOAT,TEXT,U128]] [SHARDKEY columname] [FOREIGN KEY (fk_name) REFERENCES othertable (other_table_indexed_column)] [HASHABILITY] - ALTER TABLE tablename SET DIRTY - ALTER INDEX indexname SET [PERSIST|NOPERSIST]\r\n"));
     shared.alter_other = createObject(REDIS_STRING,sdsnew(
         "-ERR SYNTAX: ALTER TABLE - CAN NOT be done on OPTIMISED 2 COLUMN TABLES\r\n"));
     shared.lru_other = createObject(REDIS_STRING,sdsnew(
@@ -140,6 +140,10 @@ void DXDB_createSharedObjects() {
         "-ERR SYNTAX: INSERT INTO tablename VALUES (vals,,,,) - \"INTO\" keyword MISSING\r\n"));
     shared.insertsyntax_no_values = createObject(REDIS_STRING,sdsnew(
         "-ERR SYNTAX: INSERT INTO tablename VALUES (vals,,,,) - \"VALUES\" keyword MISSING\r\n"));
+    shared.load_data_syntax = createObject(REDIS_STRING,sdsnew(
+        "-ERR SYNTAX: LOAD DATA INFILE filename INTO TABLE tablename (file: one row per line: vals,,,,)\r\n"));
+    shared.load_data_file = createObject(REDIS_STRING,sdsnew(
+        "-ERR LOAD DATA INFILE: could not open file\r\n"));
     shared.part_insert_other = createObject(REDIS_STRING,sdsnew(
         "-ERR SYNTAX: INSERT INTO table with 2 values, both values must be specified - these tables are optimised and stored inside the BTREE and MUST have ALL values defined\r\n"));
 
@@ -150,6 +154,8 @@ void DXDB_createSharedObjects() {
         "-ERR SYNTAX: WHERE col IN (...) - \"IN\" requires () delimited list\r\n"));
     shared.where_in_select = createObject(REDIS_STRING,sdsnew(
         "-ERR SYNTAX: WHERE col IN (SELECT col ....) INNER SELECT SYNTAX ERROR \r\n"));
+    shared.where_not_in_lkp = createObject(REDIS_STRING,sdsnew(
+        "-ERR SYNTAX: WHERE col NOT IN (...) can not be the index lookup - add an indexed (=, BETWEEN, IN) filter OR use \"SCAN\"\r\n"));
     shared.whereclause_between = createObject(REDIS_STRING,sdsnew(
         "-ERR SYNTAX: WHERE col BETWEEN x AND y\r\n"));
 
@@ -164,6 +170,25 @@ void DXDB_createSharedObjects() {
     shared.orderby_count = createObject(REDIS_STRING,sdsnew(
         "-ERR SYNTAX: SELECT COUNT(*) ... WHERE ... ORDER BY col - \"ORDER BY\" and \"COUNT(*)\" dont mix, drop the \"ORDER BY\"\r\n"));
 
+    shared.wc_groupby_no_by = createObject(REDIS_STRING,sdsnew(
+        "-ERR SYNTAX: WHERE ... GROUP BY col - \"BY\" MISSING\r\n"));
+    shared.groupby_col_not_found = createObject(REDIS_STRING,sdsnew(
+        "-ERR SELECT: GROUP BY columname - column does not exist\r\n"));
+    shared.toomany_ngby = createObject(REDIS_STRING,sdsnew(
+        "-ERR SELECT: GROUP BY columns MAX = 16\r\n"));
+    shared.groupby_not_select = createObject(REDIS_STRING,sdsnew(
+        "-ERR SYNTAX: GROUP BY is only supported in SELECT & SCAN\r\n"));
+    shared.aggr_syntax = createObject(REDIS_STRING,sdsnew(
+        "-ERR SYNTAX: SELECT [COUNT|SUM|MIN|MAX|AVG](col) - aggregate functions take a single column (or COUNT(*))\r\n"));
+    shared.aggr_sum_text = createObject(REDIS_STRING,sdsnew(
+        "-ERR SELECT: SUM() & AVG() require a numeric [INT,LONG,U128,FLOAT] column\r\n"));
+    shared.aggr_not_grouped = createObject(REDIS_STRING,sdsnew(
+        "-ERR SELECT: non-aggregated columns must be in the GROUP BY clause\r\n"));
+    shared.aggr_orderby = createObject(REDIS_STRING,sdsnew(
+        "-ERR SYNTAX: SELECT aggregates ... GROUP BY col ORDER BY col - \"ORDER BY\" not supported (groups are returned in GROUP BY order)\r\n"));
+    shared.aggr_join = createObject(REDIS_STRING,sdsnew(
+        "-ERR SELECT: aggregate functions & GROUP BY are not supported in JOINs\r\n"));
+
     shared.selectsyntax = createObject(REDIS_STRING,sdsnew(
         "-ERR SYNTAX: SELECT [col,,,,] FROM tablename WHERE [[indexed_column = val]|| [indexed_column BETWEEN x AND y] || [indexed_column IN (X,Y,Z,...)] || [indexed_column IN (nested sql statment)]] [ORDER BY [col [DESC/ASC]*,,] LIMIT n OFFSET m]\r\n"));
     shared.selectsyntax_nofrom = createObject(REDIS_STRING,sdsnew(
@@ -260,7 +285,7 @@ void DXDB_createSharedObjects() {
         "-ERR TYPE: CREATE TABLE tbl AS SELECT COUNT(*) - is disallowed\r\n"));
 
     shared.dump_syntax = createObject(REDIS_STRING,sdsnew(
-        "-ERR SYNTAX: DUMP tablename [TO MYSQL [mysqltablename]],[TO FILE fname]\r\n"));
+        "-ERR SYNTAX: DUMP tablename [TO MYSQL [mysqltablename]],[TO FILE fname],[TO MMAP fname]\r\n"));
     shared.show_syntax = createObject(REDIS_STRING,sdsnew(
         "-ERR SYNTAX: SHOW [TABLES|INDEXES]\r\n"));
 
@@ -302,6 +327,24 @@ void DXDB_createSharedObjects() {
     shared.indexobcill            = createObject(REDIS_STRING,sdsnew(
         "-ERR CREATE INDEX ... ORDER BY col - Lots of constraints: No UniqueMultipleColumnIndexes, Both indexed_column & order_by_column must be [INT|LONG] and can not be the same column\r\n"));
 
+    shared.indexcovererr          = createObject(REDIS_STRING,sdsnew(
+        "-ERR CREATE INDEX ... INCLUDE (col) - column not found (ONE column can be INCLUDEd)\r\n"));
+    shared.indexcoverill          = createObject(REDIS_STRING,sdsnew(
+        "-ERR CREATE INDEX ... INCLUDE (col) - Lots of constraints: No UNIQUE, MultipleColumn, ORDER BY, FUNCTION or DotNotation indexes, PK & included_column must be [INT|LONG|U128] and included_column can not be the PK or the indexed_column\r\n"));
+
+    shared.indexwcerr             = createObject(REDIS_STRING,sdsnew(
+        "-ERR CREATE INDEX ... WHERE \"pred\" - pred must be [col OP val|col BETWEEN x AND y] predicates (on the table's columns) joined by AND, OP is one of [=,!=,<,<=,>,>=]\r\n"));
+    shared.indexwcill             = createObject(REDIS_STRING,sdsnew(
+        "-ERR CREATE INDEX ... WHERE \"pred\" - Lots of constraints: No UNIQUE, MultipleColumn, ORDER BY, LIMIT, FUNCTION, EXPRESSION, DotNotation or LUAOBJ indexes\r\n"));
+    shared.indexexprill           = createObject(REDIS_STRING,sdsnew(
+        "-ERR CREATE INDEX ... (col OP NUM) - OP is one of [+,-,*,/,%] on an [INT|LONG] column (NUM can not be 0 for [/,%]) OR (LEFT(col,NUM)) on a TEXT column, No UNIQUE, ORDER BY, INCLUDE, LIMIT or WHERE\r\n"));
+    shared.indexbitmapill         = createObject(REDIS_STRING,sdsnew(
+        "-ERR CREATE INDEX ... (col) USING BITMAP - Lots of constraints: No UNIQUE, MultipleColumn, ORDER BY, INCLUDE, LIMIT, WHERE, FUNCTION, EXPRESSION or DotNotation indexes, indexed_column must be [INT|LONG|TEXT] (not the PK) and the PK must be [INT|LONG]\r\n"));
+    shared.indexhashill           = createObject(REDIS_STRING,sdsnew(
+        "-ERR CREATE UNIQUE INDEX ... (col) USING HASH - Lots of constraints: No MultipleColumn, ORDER BY, INCLUDE, LIMIT, WHERE, FUNCTION, EXPRESSION or DotNotation indexes, indexed_column must be [INT|LONG|TEXT] (not the PK) and the PK must be [INT|LONG]\r\n"));
+    shared.indexpersistill        = createObject(REDIS_STRING,sdsnew(
+        "-ERR INDEX ... PERSIST - No PK, FUNCTION, DotNotation, BITMAP, HASH or LUATRIGGER indexes\r\n"));
+
     shared.indexcursorerr         = createObject(REDIS_STRING,sdsnew(
         "-ERR CREATE INDEX ... OFFEST NUM error - caveats: PK must be [INT|LONG], NUM must be positive\r\n"));
 
@@ -333,13 +376,17 @@ void DXDB_createSharedObjects() {
         "-ERR PROHIBITED: UPDATING index.pos()\r\n"));
 
     shared.prepare_syntax       = createObject(REDIS_STRING,sdsnew(
-        "-ERR SYNTAX: PREPARE planname AS SELECT cols FROM tbls WHERE clause\r\n"));
+        "-ERR SYNTAX: PREPARE planname AS [SELECT|SCAN|INSERT|REPLACE|UPDATE|DELETE] ... (args: $1,$2,...)\r\n"));
     shared.supported_prepare    = createObject(REDIS_STRING,sdsnew(
         "-ERR SUPPORTED: PREPARE does not yet support [IN() clause, RangeQueries]\r\n"));
     shared.execute_argc         = createObject(REDIS_STRING,sdsnew(
         "-ERR SYNTAX: EXECUTE number-of-args does NOT match PREPARE number-of-args\r\n"));
     shared.execute_miss         = createObject(REDIS_STRING,sdsnew(
         "-ERR NOT-FOUND: EXECUTE prepared statement not found\r\n"));
+    shared.execute_binary       = createObject(REDIS_STRING,sdsnew(
+        "-ERR SYNTAX: BEXECUTE planname params [BINARY] (params: N*[COL_TYPE(1 byte)][INT(4),LONG(8),FLOAT(4),U128(16),STRING(uint32 len + bytes)])\r\n"));
+    shared.parsebench_syntax    = createObject(REDIS_STRING,sdsnew(
+        "-ERR SYNTAX: PARSEBENCH N [SELECT cl FROM tbl WHERE wc | INSERT INTO tbl VALUES (vals) | CREATE TABLE tbl (cdecl)] (NO JOINs, NO HASHABILITY tables)\r\n"));
 
     shared.dirty_miss = createObject(REDIS_STRING,sdsnew(
         "-MISS: SELECT hit a MISSED row, unable to complete\r\n"));
@@ -349,6 +396,8 @@ void DXDB_createSharedObjects() {
         "-MISS: UPDATE hit a MISSED row, unable to complete\r\n"));
     shared.evict_other = createObject(REDIS_STRING,sdsnew(
         "-ERR: EVICT only supported on tables w/ [INT|LONG] PKs & 2+ columns\r\n"));
+    shared.evict_range = createObject(REDIS_STRING,sdsnew(
+        "-ERR SYNTAX: EVICT tablename RANGE low high (INT|LONG PK, low <= high)\r\n"));
 
     shared.replace_dirty        = createObject(REDIS_STRING,sdsnew(
         "-ERR: REPLACE on a Table w/ SecondaryIndexes & EVICTIONS - PROHIBITED\r\n"));
@@ -395,4 +444,12 @@ void DXDB_createSharedObjects() {
         "-ERR: MATH: INTEGER OVERFLOW\r\n"));
     shared.nonunique_ltname      = createObject(REDIS_STRING,sdsnew(
         "-ERR: NON-UNIQUE: LUATRIGGER name AND LUATRIGGER type already defined\r\n"));
+    shared.aofrow_syntax         = createObject(REDIS_STRING,sdsnew(
+        "-ERR: AOFROW tablename records - malformed records or table can not be replayed from row streams\r\n"));
+    shared.rdbdeltaoff           = createObject(REDIS_STRING,sdsnew(
+        "-ERR: BGREBASE - DELTA snapshots are off (CONFIG SET rdb_delta_saves N), use BGSAVE\r\n"));
+    shared.mmt_readonly          = createObject(REDIS_STRING,sdsnew(
+        "-ERR: table is a read-only MMAP snapshot (CREATE TABLE tbl FROM MMAP file)\r\n"));
+    shared.mmt_dump              = createObject(REDIS_STRING,sdsnew(
+        "-ERR: DUMP TO MMAP - table can not be DIRTY or have LRU, LFU or LUATABLE columns\r\n"));
 }
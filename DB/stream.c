@@ -409,10 +409,12 @@ int btTextCmp(void *a, void *b) {                      //printf("btTextCmp\n");
 }
 
 #define BTK_BSIZE 2048
-static uchar BTKeyBuffer[BTK_BSIZE]; /* avoid malloc()s */
-static ulk UL_BTKeyPtr; static luk LU_BTKeyPtr; static llk LL_BTKeyPtr;
-static xxk XX_BTKeyPtr; static xlk XL_BTKeyPtr; static lxk LX_BTKeyPtr;
-static uxk UX_BTKeyPtr; static xuk XU_BTKeyPtr;
+/* NOTE: scratch is __thread -> RDB load builds BTs on threads (rdb_pload.c) */
+static __thread uchar BTKeyBuffer[BTK_BSIZE]; /* avoid malloc()s */
+static __thread ulk UL_BTKeyPtr; static __thread luk LU_BTKeyPtr;
+static __thread llk LL_BTKeyPtr; static __thread xxk XX_BTKeyPtr;
+static __thread xlk XL_BTKeyPtr; static __thread lxk LX_BTKeyPtr;
+static __thread uxk UX_BTKeyPtr; static __thread xuk XU_BTKeyPtr;
 
 void destroyBTKey(char *btkey, bool med) { if (med) free(btkey);/* FREED 033 */}
 
@@ -570,9 +572,10 @@ uint32 getStreamRowSize(bt *btr, uchar *stream) { /* for rdbSaveAllRows() */
     }
 }
 
-static ulk UL_StreamPtr; static luk LU_StreamPtr; static llk LL_StreamPtr;
-static xxk XX_StreamPtr; static xlk XL_StreamPtr; static lxk LX_StreamPtr;
-static uxk UX_StreamPtr; static xuk XU_StreamPtr;
+static __thread ulk UL_StreamPtr; static __thread luk LU_StreamPtr;
+static __thread llk LL_StreamPtr; static __thread xxk XX_StreamPtr;
+static __thread xlk XL_StreamPtr; static __thread lxk LX_StreamPtr;
+static __thread uxk UX_StreamPtr; static __thread xuk XU_StreamPtr;
 #define OBT_CR8_STRM(tcast, sptr, vcast)        \
   { tcast *ul = (tcast *)btkey;                 \
     sptr.key  = ul->key; sptr.val = (vcast)val; \
@@ -43,10 +43,12 @@ ALL RIGHTS RESERVED
 #include "index.h"
 #include "qo.h"
 #include "filter.h"
+#include "plan_cache.h"
 #include "cr8tblas.h"
 #include "colparse.h"
 #include "rpipe.h"
 #include "parser.h"
+#include "lexer.h"
 #include "find.h"
 #include "alsosql.h"
 #include "common.h"
@@ -152,8 +154,8 @@ static bool parseOBYcol(cli   *c,  char  **token, int   tmatch,
     REV_SKIP_SPACES(endc)             //printf("more: %d t2: %s\n", *more, t2);
     if (!nextc) {
         char *lim = strstr_not_quoted(t2, " LIMIT");
-        if (lim) { lim++;
-            *token = *fin = lim;
+        if (lim) { lim++; // NOTE: t2 is freed below, point into *token
+            *token = *fin = *token + (lim - t2);
             sds t3 = sdsnewlen(t2, lim - t2 - 1); sdsfree(t2); t2 = t3;
             endc   = t2 + sdslen(t2) - 1;
             REV_SKIP_SPACES(endc)
@@ -246,9 +248,51 @@ static bool parseOrderBy(cli  *c, char *by, int tmatch, wob_t *wb, char **fin,
     if (token) return parseLimit(c, token, wb, fin);
     return 1;
 }
+static bool parseGroupBy(cli *c, char *by, int tmatch, wob_t *wb, char **fin) {
+    if (strncasecmp(by, "BY ", 3)) {
+        addReply(c, shared.wc_groupby_no_by);                         return 0;
+    }
+    char *token = next_token(by);
+    if (!token) { addReply(c, shared.wc_groupby_no_by);               return 0;}
+    while (1) {
+        if (wb->ngby == MAX_GROUP_BY_COLS) {
+            addReply(c, shared.toomany_ngby);                         return 0;
+        }
+        int clen = 0;
+        while (token[clen] && !ISBLANK(token[clen]) && token[clen] != ',') {
+            clen++;
+        }
+        icol_t ic = find_column_n(tmatch, token, clen);
+        if (ic.cmatch < 0) {
+            releaseIC(&ic); addReply(c, shared.groupby_col_not_found); return 0;
+        }
+        wb->gbc[wb->ngby] = ic; wb->ngby++;
+        token += clen; SKIP_SPACES(token)
+        if (*token != ',') break;
+        token++;       SKIP_SPACES(token)
+    }
+    if (*token) *fin = token; /* still something to parse */
+    return 1;
+}
 bool parseWCEnd(redisClient *c, char *token, cswc_t *w, wob_t *wb, bool isj) {
     w->lvr         = token;   /* assume parse error */
+    if (!strncasecmp(token, "GROUP ", 6)) {
+        if (isj) { w->lvr = NULL; addReply(c, shared.aggr_join); return 0; }
+        char *by      = next_token(token);
+        if (!by) {
+            w->lvr = NULL; addReply(c, shared.wc_groupby_no_by); return 0;
+        }
+        char *lfin    = NULL;
+        if (!parseGroupBy(c, by, w->wf.tmatch, wb, &lfin)) {
+            w->lvr = NULL;                                       return 0;
+        }
+        if (lfin) w->lvr = token = lfin; /* [ORDER BY,LIMIT] may follow */
+        else    { w->lvr = NULL;                                 return 1; }
+    }
     if (!strncasecmp(token, "ORDER ", 6)) {
+        if (wb->aggr || wb->ngby) { /* BEFORE the ORDER BY columns resolve */
+            w->lvr = NULL; addReply(c, shared.aggr_orderby);     return 0;
+        }
         char *by      = next_token(token);
         if (!by) {
             w->lvr = NULL; addReply(c, shared.wc_orderby_no_by); return 0;
@@ -337,10 +381,11 @@ static char *checkIN_Clause(redisClient *c, char *token) {
     }
     return end;
 }
-// SYNTAX: IN (a,b,c)
-static bool pWC_IN(cli *c, char *tok, list **inl, uchar ctype, char **fin) {
-    char *end = checkIN_Clause(c, tok);
+// SYNTAX: [NOT] IN (a,b,c)
+static bool pWC_IN(cli *c, char *tok, f_t *flt, uchar ctype, char **fin) {
+    char *end  = checkIN_Clause(c, tok);
     if (!end) return 0;
+    list **inl = &flt->inl;
     *inl       = listCreate();
     bool piped = 0;
     tok++;
@@ -381,6 +426,7 @@ static bool pWC_IN(cli *c, char *tok, list **inl, uchar ctype, char **fin) {
         }
     }
     convertINLtoAobj(inl, ctype); /* convert from STRING to ctype */
+    flt->ins = createINSet(*inl, ctype);   /* filters probe the hash set */
     end++;
     if (*end) {
         SKIP_SPACES(end)
@@ -415,11 +461,13 @@ static robj *parseInumCol(char *token, int tlen, f_t *flt) {
     return NULL;
 }
 static uchar pWC_checkLuaFunc(cli *c, f_t *flt, sds tkn, char **fin, robj *ro) {
-    char *oby =              strstr_not_quoted(tkn, " ORDER BY ");
-    char *lim = oby ? NULL : strstr_not_quoted(tkn, " LIMIT ");
-    sds s; // Do NOT include ORDERBY or LIMIT -> UGLY need tokenizer
-    if      (oby) { s = sdsnewlen(tkn, (oby - tkn)); *fin = oby;  }
-    else if (lim) { s = sdsnewlen(tkn, (oby - lim)); *fin = lim;  }
+    char *gby =              strstr_not_quoted(tkn, " GROUP BY ");
+    char *oby = gby ? NULL : strstr_not_quoted(tkn, " ORDER BY ");
+    char *lim = (gby || oby) ? NULL : strstr_not_quoted(tkn, " LIMIT ");
+    sds s; // Do NOT include GROUPBY,ORDERBY,LIMIT -> UGLY need tokenizer
+    if      (gby) { s = sdsnewlen(tkn, (gby - tkn)); *fin = gby;  }
+    else if (oby) { s = sdsnewlen(tkn, (oby - tkn)); *fin = oby;  }
+    else if (lim) { s = sdsnewlen(tkn, (lim - tkn)); *fin = lim;  }
     else          { s = sdsnew   (tkn);              *fin = NULL; }
     bool ret = checkOrCr8LFunc(flt->tmatch, &flt->le, s, 1);
     sdsfree(s);
@@ -470,10 +518,15 @@ static uchar parseWCTokRelation(cli *c,   cswc_t *w,   sds    tkn, char **fin,
         if (ro)                                           PARSE_WC_CHECK_LUA
         ctype         = CTYPE_FROM_FLT(flt)
         SKIP_SPACES(nextp)
+        if (!strncasecmp(nextp, "NOT IN ", 7)) {
+            nextp     = next_token(nextp);
+            if (!nextp)                                   PARSE_WC_CHECK_LUA
+            flt->nin  = 1;
+        }
         if (!strncasecmp(nextp, "IN ", 3)) {
             nextp     = next_token(nextp);
             if (!nextp)                                   PARSE_WC_CHECK_LUA
-            if (!pWC_IN(c, nextp, &flt->inl, ctype, fin)) PARSE_WC_CHECK_LUA
+            if (!pWC_IN(c, nextp, flt, ctype, fin))       PARSE_WC_CHECK_LUA
             flt->op = IN;
         } else if (!strncasecmp(nextp, "BETWEEN ", 8)) { /* RANGE QUERY */
             nextp     = next_token(nextp);
@@ -503,34 +556,42 @@ static bool addIndexes2Join(redisClient *c, f_t *flt, jb_t *jb, list *ijl) {
     listAddNodeTail(ijl, ij); jb->n_jind++;
     return 1;
 }
+/* predicate [i, RETURN) ends at the next paren-depth-0 " AND " that is not
+   a "BETWEEN x AND y"'s AND (-1: the rest of the line), "IN (...)" lists are
+   a single paren-depth-1 token-run, so nested ANDs are skipped */
+static int nextWCAnd(lex_t *lx, int i, uchar *ttype) {
+    bool in = 0; uchar btwn = 0; int and = -1;
+    for (; i < lx->n; i++) {
+        ltk_t *tk = &lx->t[i];
+        if (tk->depth) continue;
+        if      (LTK_SPACED_KW(tk, LKW_IN))      { if (!btwn) in = 1;        }
+        else if (LTK_SPACED_KW(tk, LKW_BETWEEN)) { if (!in && !btwn) btwn = 1;}
+        else if (LTK_SPACED_KW(tk, LKW_AND)) {
+            if (btwn == 1) { btwn = 2; continue; } /* BETWEEN x AND y */
+            and = i; break;
+        }
+    }
+    *ttype = in ? TOK_TYPE_IN : (btwn == 2) ? TOK_TYPE_RANGE : TOK_TYPE_KEY;
+    return and;
+}
 uchar parseWC(cli *c, cswc_t *w, wob_t *wb, jb_t *jb, list *ijl) {
-    uchar   prs;
+    uchar   prs   = PRS_OK;
     f_t    *flt   = NULL;
     bool    isj   = jb ? 1 : 0;
     char   *line  = w->token;
     sds     token = NULL;
+    lex_t   lx;   lexSQL(&lx, line, strlen(line)); /* tokenise ONCE */
+    int     i     = 0;
     while (1) {
         flt            = newEmptyFilter();
-        uchar  ttype   = TOK_TYPE_KEY;
+        uchar  ttype;
         char  *tfin    = NULL;
-        char  *in      = strcasestr_blockchar(line, " IN ", '\'');
-        char  *and     = strcasestr_blockchar(line, " AND ", '\'');
-        if (in && (!and || in < and)) ttype = TOK_TYPE_IN;
-        if (and && in && in < and) {     /* include nested "IN (...AND....)"  */
-            and        = in + 4;
-            SKIP_SPACES(and)
-            if (!*and)                                goto p_wd_err;
-            and        = checkIN_Clause(c, and); /* and now @ ')' */
-            if (!and)                                 goto p_wd_err;
-            and        = strcasestr_blockchar(and, " AND ", '\'');
-        } else {                         /* include "BETWEEN x AND y" */
-            char *btwn = strcasestr_blockchar(line, " BETWEEN ", '\'');
-            if (and && btwn && btwn < and) {
-                and    = strcasestr_blockchar(and + 5, " AND ", '\'');
-                ttype  = TOK_TYPE_RANGE;
-            }
+        int    and     = nextWCAnd(&lx, i, &ttype);
+        int    tlen    = (and != -1) ? (lx.t[and].s - 1) - line :
+                                       (int)strlen(line);
+        if (and == i || tlen <= 0) { /* "x = 1 AND AND y = 2" */
+            prs = PRS_GEN_ERR;                      goto p_wd_err;
         }
-        int   tlen     = and ? and - line : (int)strlen(line);
         if (token) sdsfree(token);
         token = sdsnewlen(line, tlen);
         prs   = parseWCTokRelation(c, w, token, &tfin, flt, isj, ttype);
@@ -543,10 +604,10 @@ uchar parseWC(cli *c, cswc_t *w, wob_t *wb, jb_t *jb, list *ijl) {
             listAddNodeTail(w->flist, flt);
             flt = NULL; // means do not destroy below
         }
-        if (and) {
-            line = and + 5; /* go past " AND " */
-            SKIP_SPACES(line)
-            if (!*line)   break;
+        if (and != -1) {
+            i = and + 1;    /* go past " AND " */
+            if (i == lx.n) { prs = PRS_GEN_ERR;     break; } /* trailing AND */
+            line = lx.t[i].s;
         } else {
             if (!tfin)    break;
             line = tfin;
@@ -566,15 +627,27 @@ p_wd_err:
         else           w->lvr = NULL;
     }
     if (token) sdsfree(token);
+    releaseLex(&lx);
     return prs;
 }
 
 /* RANGE_QUERY RANGE_QUERY RANGE_QUERY RANGE_QUERY RANGE_QUERY RANGE_QUERY */
 void parseWCplusQO(cli *c, cswc_t *w, wob_t *wb, uchar sop) {
+    pcq_t q;
+    if (getCachedPlan(w, wb, sop, &q)) { releasePCQ(&q);  return; }
     uchar prs = parseWC(c, w, wb, NULL, NULL);
     if (prs == PRS_GEN_ERR)              genericParseError(c, sop);
-    if (prs != PRS_OK)                   return;
-    if (!optimiseRangeQueryPlan(c, w, wb)) return;
+    if (prs != PRS_OK)                                    goto pwcqo_end;
+    if (wb->ngby && sop != SQL_SELECT) {
+        addReply(c, shared.groupby_not_select);           goto pwcqo_end;
+    }
+    usePartialIndexes(w->flist); /* WHERE contains a PARTIAL index's pred */
+    snapPlanOrder(&q, w->flist); /* QO reorders & promotes filters */
+    if (!optimiseRangeQueryPlan(c, w, wb))                goto pwcqo_end;
+    cachePlan(&q, w, wb);
+
+pwcqo_end:
+    releasePCQ(&q);
 }
 
 /* JOIN JOIN JOIN JOIN JOIN JOIN JOIN JOIN JOIN JOIN JOIN JOIN JOIN JOIN */
@@ -95,6 +95,8 @@ static void update_vals_mod(int *argc, char **argv) {
 
 static void create_table_mod(int *argc, char **argv) {
     if (*argc < 3) return;
+    if (*argc == 6 && !strcasecmp(argv[3], "FROM") && /* FROM MMAP file */
+                      !strcasecmp(argv[4], "MMAP")) return;
     merge_vals(argc, argv, 3, (*argc - 1), 1);
 }
 static void update_where_mod(int *argc, char **argv) {
@@ -143,8 +145,8 @@ static void scan_mod(int *argc, char **argv) {
 static void prepare_mod(int *argc, char **argv) {
     int    pargc = *argc - 3;
     char **pargv = &(argv[3]);
-    select_mod(&pargc, pargv);
-    *argc        = 9;
+    DXDB_cliSendCommand(&pargc, pargv); /* mod the prepared statement */
+    *argc        = pargc + 3;
 }
 void DXDB_cliSendCommand(int *argc, char **argv) {
     //printf("DXDB_cliSendCommand\n");
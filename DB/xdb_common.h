@@ -12,12 +12,14 @@
 
 #define REDIS_BTREE       5
 #define REDIS_LUA_TRIGGER 6
+#define REDIS_PREP_STMT   7
 
 #define OUTPUT_NONE       0 /* this is an error state */
 #define OUTPUT_NORMAL     1
 #define OUTPUT_PURE_REDIS 2
 #define OUTPUT_EMBEDDED   3
 #define OUTPUT_LUA        4
+#define OUTPUT_BINARY     5
 
 #include <endian.h>
 #ifndef BYTE_ORDER
@@ -113,6 +115,7 @@ typedef struct uq_t {
     sds                 bindaddr;           \
     int                 bindport;           \
     select_callback    *scb;                \
+    struct rs_wait_t   *RsWait;             \
     uq_t                UpdateQueue;
 
 struct redisClient;
@@ -147,6 +150,20 @@ typedef struct alchemy_server_extensions_t {
     bool                 SQL_AOF;
     bool                 SQL_AOF_MYSQL;
 
+    size_t               SortMemBudget; /* ORDER BY bytes before spilling */
+    char                *SortSpillDir;
+
+    long                 PlanCacheSize; /* max cached WHERE plans, 0 -> off */
+    long                 IndexBuildSlice; /* BACKGROUND index build ms/tick */
+    long                 LruLfuFlush; /* APPROX LRU/LFU flush ms, 0 -> exact */
+    long                 EvictSlice;  /* maxmemory auto-EVICT ms/tick       */
+    char                *RowStoreDir; /* evicted rows on disk, NULL -> off */
+    bool                 RowStoreAsync; /* SELECT blocks on IO thread fault-in */
+    bool                 AofBinary;   /* SQL row writes -> AOFROW records */
+    bool                 AofFsyncAsync; /* everysec fdatasync() in a thread */
+    long                 RdbLoadThreads; /* RDB load: BT builders, 0 -> off */
+    long                 RdbDeltaSaves; /* DELTA RDBs per BASE, 0 -> off */
+
     bool                 lua_dirty;
 } alchemy_server_extensions_t;
 
@@ -178,11 +195,14 @@ typedef struct alchemy_server_extensions_t {
     *insertsyntax,           *insertsyntax_no_into, *part_insert_other,   \
     *insertsyntax_no_values, *luat_decl_fmt,        *luat_c_decl,         \
     *key_query_mustbe_eq,                                                 \
-    *whereclause_in_err,         *where_in_select, \
+    *whereclause_in_err,         *where_in_select,    *where_not_in_lkp, \
     *wc_orderby_no_by, \
     *order_by_col_not_found, \
     *oby_lim_needs_num,          *oby_ofst_needs_num, \
     *orderby_count, \
+    *wc_groupby_no_by,     *groupby_col_not_found, *toomany_ngby, \
+    *groupby_not_select,   *aggr_syntax,           *aggr_sum_text, \
+    *aggr_not_grouped,     *aggr_orderby,          *aggr_join, \
     *selectsyntax,           *selectsyntax_nofrom,   *selectsyntax_nowhere, \
     *deletesyntax,           *deletesyntax_nowhere, \
     *updatesyntax,           *update_pk_range_query, *update_pk_ovrw, \
@@ -213,6 +233,10 @@ typedef struct alchemy_server_extensions_t {
     *indexobcerr,             *indexobcrpt,                \
     *indexobcill,             *indexcursorerr,             \
     *obindexviol,             *repeat_hash_cnames,         \
+    *indexcovererr,           *indexcoverill,              \
+    *indexwcerr,              *indexwcill,                 \
+    *indexexprill,            *indexbitmapill,             \
+    *indexhashill,            *indexpersistill,            \
     *lfu_other,               *lfu_repeat,                 \
     *drop_lfu,                *col_lfu,                    \
     *insert_lfu,              *kw_cname,                   \
@@ -222,7 +246,10 @@ typedef struct alchemy_server_extensions_t {
     *uniq_simp_index_nums,   *updateipos,                  \
     *join_type_err,          *supported_prepare,           \
     *prepare_syntax,         *execute_argc,                \
-    *execute_miss,           *evictnotdirty,               \
+    *execute_miss,           *execute_binary,              \
+    *load_data_syntax,       *load_data_file,              \
+    *parsebench_syntax,                                    \
+    *evictnotdirty,           *evict_range,                \
     *range_mciup,            *range_u_up,                  \
     *deletemiss,             *uviol,                       \
     *updatemiss,             *dirtypk,                     \
@@ -232,7 +259,9 @@ typedef struct alchemy_server_extensions_t {
     *http_not_on,            *create_findex,               \
     *luafuncindex_rpt,       *interpret_syntax,            \
     *nested_dni,             *overflow,                    \
-    *nonunique_ltname;
+    *nonunique_ltname,       *aofrow_syntax,               \
+    *rdbdeltaoff,            *mmt_readonly,                \
+    *mmt_dump;
 
 #define DEBUG_C_ARGV(c) \
   for (int i = 0; i < c->argc; i++) \
@@ -51,11 +51,19 @@ int inet_aton(const char *cp, struct in_addr *inp);
 #include "aof_alsosql.h"
 #include "rdb_alsosql.h"
 #include "desc.h"
+#include "plan_cache.h"
 #include "range.h"
 #include "ddl.h"
 #include "index.h"
+#include "lru.h"
+#include "evict.h"
+#include "rowstore.h"
+#include "aof_row.h"
+#include "rdb_pload.h"
+#include "rdb_delta.h"
 #include "find.h"
 #include "alsosql.h"
+#include "prep_stmt.h"
 
 extern int       Num_tbls; extern r_tbl_t *Tbl;
 extern int       Num_indx; extern r_ind_t *Index;
@@ -95,6 +103,7 @@ void sqlDumpCommand  (redisClient *c);
 
 void insertCommand   (redisClient *c);
 void replaceCommand  (redisClient *c);
+void loadDataCommand (redisClient *c);
 void sqlSelectCommand(redisClient *c);
 void updateCommand   (redisClient *c);
 void deleteCommand   (redisClient *c);
@@ -103,8 +112,10 @@ void tscanCommand    (redisClient *c);
 void luafuncCommand  (redisClient *c);
 
 void explainCommand  (redisClient *c);
+void parsebenchCommand(redisClient *c);
 void prepareCommand  (redisClient *c);
 void executeCommand  (redisClient *c);
+void bexecuteCommand (redisClient *c);
 
 #ifdef CLIENT_BTREE_DEBUG
 void btreeCommand    (redisClient *c);
@@ -118,6 +129,8 @@ void dirtyCommand    (redisClient *c);
 
 void evictCommand    (redisClient *c);
 
+void bgrebaseCommand (redisClient *c);
+
 void interpretCommand(redisClient *c);
 
 #ifdef REDIS3
@@ -136,8 +149,13 @@ struct redisCommand DXDBCommandTable[] = {
     {"update",     updateCommand,      6, REDIS_CMD_DENYOOM, CMD_END},
     {"delete",     deleteCommand,      5, 0,                 CMD_END},
     {"replace",    replaceCommand,    -5, REDIS_CMD_DENYOOM, CMD_END},
+    {"load",       loadDataCommand,    7, REDIS_CMD_DENYOOM, GLOB_FUNC_END},
     // EVICT
     {"evict",      evictCommand,      -3, 0,                 GLOB_FUNC_END},
+    // DELTA RDB (new BASE snapshot)
+    {"bgrebase",   bgrebaseCommand,    1, 0,                 GLOB_FUNC_END},
+    // AOF (replay of row writes)
+    {"aofrow",     aofrowCommand,      3, REDIS_CMD_DENYOOM, GLOB_FUNC_END},
     // DDL
     {"create",     createCommand,     -4, REDIS_CMD_DENYOOM, GLOB_FUNC_END},
     {"drop",       dropCommand,        3, 0,                 GLOB_FUNC_END},
@@ -155,14 +173,16 @@ struct redisCommand DXDBCommandTable[] = {
     {"dirty",      dirtyCommand,      -1, 0,                 GLOB_FUNC_END},
     // PROFILE/DEBUG
     {"explain",    explainCommand,    -6, 0,                 GLOB_FUNC_END},
+    {"parsebench", parsebenchCommand, -6, 0,                 GLOB_FUNC_END},
     {"show",       showCommand,        2, 0,                 GLOB_FUNC_END},
 #ifdef CLIENT_BTREE_DEBUG
     {"btree",      btreeCommand,      -2, 0,                 GLOB_FUNC_END},
     {"vbtree",     validateBTommand,  -2, 0,                 GLOB_FUNC_END},
 #endif
     // PREPARED_STATEMENTs
-    {"prepare",    prepareCommand,     9, 0,                 GLOB_FUNC_END},
+    {"prepare",    prepareCommand,    -5, 0,                 GLOB_FUNC_END},
     {"execute",    executeCommand,    -2, 0,                 GLOB_FUNC_END},
+    {"bexecute",   bexecuteCommand,   -3, 0,                 GLOB_FUNC_END},
 };
 
 
@@ -217,6 +237,7 @@ static void init_DXDB_PersistentStorageItems(uint32 ntbl, uint32 nindx) {
 
     if (StmtD) dictRelease(StmtD);
     StmtD    = dictCreate(&dbDictType,  NULL);
+    initPlanCache();
 }
 static void initServer_Extra() {
     if (DynLuaD) dictRelease(DynLuaD);
@@ -228,11 +249,24 @@ void DXDB_initServerConfig() {             //printf("DXDB_initServerConfig\n");
     server.alc.Basedir       = zstrdup("./");
     server.alc.WebServerMode = -1;
     server.alc.RestAPIMode   = -1;
+    server.alc.PlanCacheSize = 1024;
+    server.alc.IndexBuildSlice = 2;
+    server.alc.LruLfuFlush     = 0;
+    server.alc.EvictSlice      = 1;
+    server.alc.RowStoreAsync   = 1;
+    server.alc.AofBinary       = 1;
+    server.alc.AofFsyncAsync   = 1;
+    server.alc.RdbLoadThreads  = 4;
+    server.alc.RdbDeltaSaves   = 0;
 }
 void DXDB_initServer() {                   //printf("DXDB_initServer\n");
     server.alc.RestClient         = createClient(-1);
     server.alc.RestClient->flags |= REDIS_LUA_CLIENT;
     aeCreateTimeEvent(server.el, 1, luaCronTimeProc, NULL, NULL);
+    aeCreateTimeEvent(server.el, 1, indexBuildTimeProc, NULL, NULL);
+    aeCreateTimeEvent(server.el, 1, accessFlushTimeProc, NULL, NULL);
+    aeCreateTimeEvent(server.el, 1, evictTimeProc,       NULL, NULL);
+    aeCreateTimeEvent(server.el, 1, rowstoreTimeProc,    NULL, NULL);
     initX_DB_Range(); initAccessCommands(); init_six_bit_strings();
     init_DXDB_PersistentStorageItems(INIT_MAX_NUM_TABLES, INIT_MAX_NUM_INDICES);
     initServer_Extra();
@@ -338,8 +372,11 @@ rcommand *DXDB_lookupCommand(sds name) {
     return cmd;
 }
 
+void DXDB_call_begin() { aofRowBegin(); }
+void DXDB_call_end()   { aofRowEnd();   }
 void DXDB_call(struct redisCommand *cmd, long long *dirty) {
     if (cmd->proc == luafuncCommand || cmd->proc == messageCommand) *dirty = 0;
+    if (cmd->proc == loadDataCommand) *dirty = 0; /* propagated as INSERTs */
     if (*dirty) server.alc.stat_num_dirty_commands++;
     if (server.alc.lua_dirty) lua_gc(server.lua, LUA_GCCOLLECT, 0);
 }
@@ -382,6 +419,8 @@ int DXDB_loadServerConfig(int argc, sds *argv) {
             server.alc.OutputMode = OUTPUT_PURE_REDIS;
         } else if (!strcasecmp(argv[1], "normal")) {
             server.alc.OutputMode = OUTPUT_NORMAL;
+        } else if (!strcasecmp(argv[1], "binary")) {
+            server.alc.OutputMode = OUTPUT_BINARY;
         } else if (!strcasecmp(argv[1], "lua")) {
             if (!server.alc.OutputLuaFunc_Start ||
                 !server.alc.OutputLuaFunc_Cnames ||
@@ -393,7 +432,7 @@ int DXDB_loadServerConfig(int argc, sds *argv) {
             }
             server.alc.OutputMode = OUTPUT_LUA;
         } else {
-            char *err = "argument must be 'embedded', 'pure_redis' or 'normal'";
+            char *err = "argument must be 'embedded', 'pure_redis', 'binary' or 'normal'";
             fprintf(stderr, "%s\n", err);
             return -1;
         }
@@ -462,6 +501,45 @@ int DXDB_loadServerConfig(int argc, sds *argv) {
         }
         server.alc.SQL_AOF = 1;
         return 0;
+    } else if (!strcasecmp(argv[0], "sort_memory_budget") && argc == 2) {
+        server.alc.SortMemBudget = memtoll(argv[1], NULL); return 0;
+    } else if (!strcasecmp(argv[0], "sort_spill_dir")     && argc == 2) {
+        if (server.alc.SortSpillDir) zfree(server.alc.SortSpillDir);
+        server.alc.SortSpillDir = zstrdup(argv[1]); return 0;
+    } else if (!strcasecmp(argv[0], "rowstore_dir")       && argc == 2) {
+        if (server.alc.RowStoreDir) zfree(server.alc.RowStoreDir);
+        server.alc.RowStoreDir = zstrdup(argv[1]); return 0;
+    } else if (!strcasecmp(argv[0], "rowstore_async")     && argc == 2) {
+        int yn = yesnotoi(argv[1]);
+        if (yn == -1) {
+            fprintf(stderr, "argument must be 'yes' or 'no'\n"); return -1;
+        }
+        server.alc.RowStoreAsync = yn; return 0;
+    } else if (!strcasecmp(argv[0], "aof_binary")         && argc == 2) {
+        int yn = yesnotoi(argv[1]);
+        if (yn == -1) {
+            fprintf(stderr, "argument must be 'yes' or 'no'\n"); return -1;
+        }
+        server.alc.AofBinary = yn; return 0;
+    } else if (!strcasecmp(argv[0], "aof_fsync_async")    && argc == 2) {
+        int yn = yesnotoi(argv[1]);
+        if (yn == -1) {
+            fprintf(stderr, "argument must be 'yes' or 'no'\n"); return -1;
+        }
+        server.alc.AofFsyncAsync = yn; return 0;
+    } else if (!strcasecmp(argv[0], "rdb_load_threads")   && argc == 2) {
+        server.alc.RdbLoadThreads = atol(argv[1]);
+        if (server.alc.RdbLoadThreads < 0 ||
+            server.alc.RdbLoadThreads > PLOAD_MAX_THREADS) return 1;
+        return 0;
+    } else if (!strcasecmp(argv[0], "rdb_delta_saves")    && argc == 2) {
+        server.alc.RdbDeltaSaves = atol(argv[1]);
+        if (server.alc.RdbDeltaSaves < 0) return 1;
+        return 0;
+    } else if (!strcasecmp(argv[0], "plan_cache_size")    && argc == 2) {
+        server.alc.PlanCacheSize = atol(argv[1]);
+        if (server.alc.PlanCacheSize < 0) return 1;
+        return 0;
     }
     return 1;
 }
@@ -484,6 +562,7 @@ void initClient(redisClient *c) {       //printf("initClient\n");
 void DXDB_createClient(int fd, redisClient *c) {//printf("DXDB_createClient\n");
     initClient(c);
     c->scb             =  NULL;
+    c->RsWait          =  NULL;
     if (fd == -1) c->InternalRequest = 1;
 }
 
@@ -508,6 +587,7 @@ int DXDB_processCommand(redisClient *c) { //printf("DXDB_processCommand\n");
 }
 
 bool DXDB_processInputBuffer_begin(redisClient *c) {// NOTE: used for POST BODY
+    if (c->RsWait) return 1; /* blocked on a ROWSTORE fault-in */
     if (c->http.post && c->http.req_clen && c->http.mode == HTTP_MODE_POSTBODY){
         c->http.post_body = c->querybuf;
         c->querybuf       = sdsempty();
@@ -526,6 +606,9 @@ void DXDB_processInputBuffer_ZeroArgs(redisClient *c) {//HTTP Request End-Delim
 void DXDB_cleanup(redisClient *c) { //printf("DXDB_cleanup\n");
     cleanup_http_session(c);
 }
+void DXDB_freeClient(redisClient *c) { //printf("DXDB_freeClient\n");
+    rsFreeClient(c); /* blocked on a ROWSTORE fault-in */
+}
 
 //TODO webserver_mode,              webserver_index_function,
 //     webserver_whitelist_address, webserver_whitelist_netmask,
@@ -551,6 +634,57 @@ int DXDB_configSetCommand(cli *c, robj *o) {
         int yn = yesnotoi(o->ptr);
         if (yn == -1) goto badfmt;
         server.alc.RestAPIMode = yn ? 1 : -1; return 0;
+    } else if (!strcasecmp(c->argv[2]->ptr, "sort_memory_budget")) {
+        int err;
+        long long ll = memtoll(o->ptr, &err);
+        if (err || ll < 0) goto badfmt;
+        server.alc.SortMemBudget = ll; return 0;
+    } else if (!strcasecmp(c->argv[2]->ptr, "sort_spill_dir")) {
+        if (server.alc.SortSpillDir) zfree(server.alc.SortSpillDir);
+        server.alc.SortSpillDir = zstrdup(o->ptr); return 0;
+    } else if (!strcasecmp(c->argv[2]->ptr, "rowstore_dir")) { // "" -> off
+        if (server.alc.RowStoreDir) zfree(server.alc.RowStoreDir);
+        server.alc.RowStoreDir = sdslen(o->ptr) ? zstrdup(o->ptr) : NULL;
+        return 0;
+    } else if (!strcasecmp(c->argv[2]->ptr, "rowstore_async")) {
+        int yn = yesnotoi(o->ptr);
+        if (yn == -1) goto badfmt;
+        server.alc.RowStoreAsync = yn; return 0;
+    } else if (!strcasecmp(c->argv[2]->ptr, "aof_binary")) {
+        int yn = yesnotoi(o->ptr);
+        if (yn == -1) goto badfmt;
+        server.alc.AofBinary = yn; return 0;
+    } else if (!strcasecmp(c->argv[2]->ptr, "aof_fsync_async")) {
+        int yn = yesnotoi(o->ptr);
+        if (yn == -1) goto badfmt;
+        server.alc.AofFsyncAsync = yn; return 0;
+    } else if (!strcasecmp(c->argv[2]->ptr, "rdb_load_threads")) { // 0 -> off
+        long long ll;
+        if (getLongLongFromObject(o, &ll) == REDIS_ERR || ll < 0 ||
+            ll > PLOAD_MAX_THREADS) goto badfmt;
+        server.alc.RdbLoadThreads = (long)ll; return 0;
+    } else if (!strcasecmp(c->argv[2]->ptr, "rdb_delta_saves")) { // 0 -> off
+        long long ll;
+        if (getLongLongFromObject(o, &ll) == REDIS_ERR || ll < 0) goto badfmt;
+        server.alc.RdbDeltaSaves = (long)ll;
+        rdbDeltaReset(); return 0;
+    } else if (!strcasecmp(c->argv[2]->ptr, "plan_cache_size")) {
+        long long ll;
+        if (getLongLongFromObject(o, &ll) == REDIS_ERR || ll < 0) goto badfmt;
+        server.alc.PlanCacheSize = (long)ll;
+        invalidatePlanCache(); return 0;
+    } else if (!strcasecmp(c->argv[2]->ptr, "index_build_slice_ms")) {
+        long long ll;
+        if (getLongLongFromObject(o, &ll) == REDIS_ERR || ll < 1) goto badfmt;
+        server.alc.IndexBuildSlice = (long)ll; return 0;
+    } else if (!strcasecmp(c->argv[2]->ptr, "lru_lfu_flush_ms")) {
+        long long ll;
+        if (getLongLongFromObject(o, &ll) == REDIS_ERR || ll < 0) goto badfmt;
+        server.alc.LruLfuFlush = (long)ll; return 0;
+    } else if (!strcasecmp(c->argv[2]->ptr, "evict_slice_ms")) {
+        long long ll;
+        if (getLongLongFromObject(o, &ll) == REDIS_ERR || ll < 1) goto badfmt;
+        server.alc.EvictSlice = (long)ll; return 0;
     } else if (!strcasecmp(c->argv[2]->ptr, "outputmode")) {
         if        (!strcasecmp(o->ptr, "embedded")) {
             server.alc.OutputMode = OUTPUT_EMBEDDED;
@@ -558,6 +692,8 @@ int DXDB_configSetCommand(cli *c, robj *o) {
             server.alc.OutputMode = OUTPUT_PURE_REDIS;
         } else if (!strcasecmp(o->ptr, "normal")) {
             server.alc.OutputMode = OUTPUT_NORMAL;
+        } else if (!strcasecmp(o->ptr, "binary")) {
+            server.alc.OutputMode = OUTPUT_BINARY;
         } else if (!strcasecmp(o->ptr, "lua")) {
             if (!server.alc.OutputLuaFunc_Start ||
                 !server.alc.OutputLuaFunc_Cnames ||
@@ -570,7 +706,7 @@ int DXDB_configSetCommand(cli *c, robj *o) {
             server.alc.OutputMode = OUTPUT_LUA;
         } else {
             addReplySds(c,sdscatprintf(sdsempty(),
-               "-ERR OUTPUTMODE: [EMBEDDED|PURE_REDIS|LUA|NORMAL] not: %s\r\n",
+               "-ERR OUTPUTMODE: [EMBEDDED|PURE_REDIS|LUA|BINARY|NORMAL] not: %s\r\n",
                 (char *)o->ptr));
             decrRefCount(o);
             return -1;
@@ -602,12 +738,78 @@ void DXDB_configGetCommand(redisClient *c, char *pattern, int *matches) {
         if      (EREDIS) addReplyBulkCString(c, "embedded");
         else if (OREDIS) addReplyBulkCString(c, "pure_redis");
         else if (LREDIS) addReplyBulkCString(c, "lua");
+        else if (BREDIS) addReplyBulkCString(c, "binary");
         else             addReplyBulkCString(c, "normal");
         *matches = *matches + 1;
     }
+    if (stringmatch(pattern, "sort_memory_budget", 0)) {
+        addReplyBulkCString(c, "sort_memory_budget");
+        addReplyBulkLongLong(c, server.alc.SortMemBudget);
+        *matches = *matches + 1;
+    }
+    if (stringmatch(pattern, "sort_spill_dir", 0)) {
+        addReplyBulkCString(c, "sort_spill_dir");
+        addReplyBulkCString(c, server.alc.SortSpillDir);
+        *matches = *matches + 1;
+    }
+    if (stringmatch(pattern, "rowstore_dir", 0)) {
+        addReplyBulkCString(c, "rowstore_dir");
+        addReplyBulkCString(c, server.alc.RowStoreDir);
+        *matches = *matches + 1;
+    }
+    if (stringmatch(pattern, "rowstore_async", 0)) {
+        addReplyBulkCString(c, "rowstore_async");
+        addReplyBulkCString(c, server.alc.RowStoreAsync ? "yes" : "no");
+        *matches = *matches + 1;
+    }
+    if (stringmatch(pattern, "aof_binary", 0)) {
+        addReplyBulkCString(c, "aof_binary");
+        addReplyBulkCString(c, server.alc.AofBinary ? "yes" : "no");
+        *matches = *matches + 1;
+    }
+    if (stringmatch(pattern, "aof_fsync_async", 0)) {
+        addReplyBulkCString(c, "aof_fsync_async");
+        addReplyBulkCString(c, server.alc.AofFsyncAsync ? "yes" : "no");
+        *matches = *matches + 1;
+    }
+    if (stringmatch(pattern, "rdb_load_threads", 0)) {
+        addReplyBulkCString(c, "rdb_load_threads");
+        addReplyBulkLongLong(c, server.alc.RdbLoadThreads);
+        *matches = *matches + 1;
+    }
+    if (stringmatch(pattern, "rdb_delta_saves", 0)) {
+        addReplyBulkCString(c, "rdb_delta_saves");
+        addReplyBulkLongLong(c, server.alc.RdbDeltaSaves);
+        *matches = *matches + 1;
+    }
+    if (stringmatch(pattern, "plan_cache_size", 0)) {
+        addReplyBulkCString(c, "plan_cache_size");
+        addReplyBulkLongLong(c, server.alc.PlanCacheSize);
+        *matches = *matches + 1;
+    }
+    if (stringmatch(pattern, "index_build_slice_ms", 0)) {
+        addReplyBulkCString(c, "index_build_slice_ms");
+        addReplyBulkLongLong(c, server.alc.IndexBuildSlice);
+        *matches = *matches + 1;
+    }
+    if (stringmatch(pattern, "lru_lfu_flush_ms", 0)) {
+        addReplyBulkCString(c, "lru_lfu_flush_ms");
+        addReplyBulkLongLong(c, server.alc.LruLfuFlush);
+        *matches = *matches + 1;
+    }
+    if (stringmatch(pattern, "evict_slice_ms", 0)) {
+        addReplyBulkCString(c, "evict_slice_ms");
+        addReplyBulkLongLong(c, server.alc.EvictSlice);
+        *matches = *matches + 1;
+    }
 }
 
+/* DELTA: rdbSave() & BGSAVE's fork are bracketed by Begin & Done */
+void DXDB_rdbSaveBegin()      { rdbDeltaBegin();       }
+void DXDB_rdbSaveDone(int ok) { rdbDeltaDone((bool)ok); }
+
 int DXDB_rdbSave(FILE *fp) { //printf("DXDB_rdbSave\n");
+    flushAccesses(); /* APPROX LRU/LFU: save the pending accesses */
     if (rdbSaveLen(fp, Num_tbls)                               == -1) return -1;
     if (rdbSaveLen(fp, Num_indx)                               == -1) return -1;
     for (int tmatch = 0; tmatch < Num_tbls; tmatch++) {
@@ -629,6 +831,8 @@ int DXDB_rdbSave(FILE *fp) { //printf("DXDB_rdbSave\n");
             }
         }
     }
+    if (rdbSavePreparedStatements(fp)                          == -1) return -1;
+    if (rdbDeltaSaveEnd()                                      == -1) return -1;
     if (rdbSaveType(fp, REDIS_EOF) == -1) return -1; /* SQL delim REDIS_EOF */
     int ret = 0;
     CLEAR_LUA_STACK lua_getglobal(server.lua, "save_lua_universe");
@@ -646,16 +850,22 @@ int DXDB_rdbLoad(FILE *fp) { //printf("DXDB_rdbLoad\n");
    if ((ntbl  = rdbLoadLen(fp, NULL)) == REDIS_RDB_LENERR) return -1;
    if ((nindx = rdbLoadLen(fp, NULL)) == REDIS_RDB_LENERR) return -1;
     init_DXDB_PersistentStorageItems(ntbl, nindx);
+    rdbDeltaLoadBegin();
+    ploadBegin(nindx); /* tables & indexes built on loader threads */
     while (1) {
         int type;
-        if ((type = rdbLoadType(fp))  == -1)               return -1;
+        if ((type = rdbLoadType(fp))  == -1)               goto rdbl_err;
         if (type == REDIS_EOF)              break;    /* SQL delim REDIS_EOF */
         if        (type == REDIS_BTREE) {
-            if (!rdbLoadBT(fp))                            return -1;
+            if (!rdbLoadBT(fp))                            goto rdbl_err;
         } else if (type == REDIS_LUA_TRIGGER) {
-            if (!rdbLoadLuaTrigger(fp))                    return -1;
+            if (!rdbLoadLuaTrigger(fp))                    goto rdbl_err;
+        } else if (type == REDIS_PREP_STMT) {
+            if (!rdbLoadPreparedStatement(fp))             goto rdbl_err;
         }
     }
+    ploadEnd(); /* waits for the loader threads -> BTs published */
+    rdbDeltaLoadEnd();
     CLEAR_LUA_STACK lua_getglobal(server.lua, "load_lua_universe");
     int r = DXDB_lua_pcall(server.lua, 0, 0, 0);
     if (r) {
@@ -663,8 +873,14 @@ int DXDB_rdbLoad(FILE *fp) { //printf("DXDB_rdbLoad\n");
                                  lua_tostring(server.lua, -1)); //return -1;
     }
     CLEAR_LUA_STACK
-    rdbLoadFinished(); // -> build Indexes
+    rdbLoadFinished(); // -> build Indexes (not built by loader threads)
+    rdbLoadPreparedStatementsFinished(); // -> re-PREPARE (needs Tbls)
+    ploadFinished();
     return 0;
+
+rdbl_err:
+    ploadEnd(); ploadFinished(); rdbDeltaLoadEnd();
+    return -1;
 }
 
 int DXDB_rewriteAppendOnlyFile(FILE *fp) {
@@ -689,7 +905,7 @@ void DXDB_flushdbCommand() {
     Num_tbls = Num_indx = 0;
 }
 
-void DBXD_genRedisInfoString(sds info) {
+sds DBXD_genRedisInfoString(sds info) {
 #ifdef REDIS3
     info = sdscat(info,"\r\n");
 #endif
@@ -706,7 +922,8 @@ void DBXD_genRedisInfoString(sds info) {
              server.alc.LuaCronFunc, server.alc.Basedir,
              (EREDIS ? "embedded"   :
               OREDIS ? "pure_redis" : 
-              LREDIS ? "lua"        : "normal"),
+              LREDIS ? "lua"        :
+              BREDIS ? "binary"     : "normal"),
              (server.alc.WebServerMode == -1) ? "no" : "yes",
              server.alc.WebServerIndexFunc,
              (server.alc.RestAPIMode == -1)   ? "no" : "yes");
@@ -722,6 +939,14 @@ void DBXD_genRedisInfoString(sds info) {
         info = sdscatprintf(info, "lua_output_row:%s\r\n",
                             server.alc.OutputLuaFunc_Row);
     }
+    info = genIndexBuildInfoString(info);
+    info = genAccessInfoString(info);
+    info = genEvictInfoString(info);
+    info = genRowStoreInfoString(info);
+    info = genAofRowInfoString(info);
+    info = genRdbLoadInfoString(info);
+    info = genRdbDeltaInfoString(info);
+    return genPlanCacheInfoString(info);
 }
 
 extern struct sockaddr_in AcceptedClientSA;
@@ -829,6 +1054,19 @@ sds DXDB_SQL_feedAppendOnlyFile(rcommand *cmd, robj **argv, int argc) {
     return sdsempty();
 }
 
+bool DXDB_feedAppendOnlyFile(rcommand *cmd, robj **argv, int argc, sds *buf) {
+    bool   crud = (cmd->proc == insertCommand || cmd->proc == updateCommand ||
+                   cmd->proc == deleteCommand || cmd->proc == replaceCommand);
+    size_t tlen = 16;                       /* SQL text's size in the AOF */
+    if (crud) {
+        for (int j = 0; j < argc; j++) tlen += stringObjectLen(argv[j]) + 16;
+    }
+    return aofRowFeed(buf, crud, tlen);
+}
+bool DXDB_aofFsync(int fd, bool everysec) {
+    return aofRowFsync(fd, everysec);
+}
+
 // LUA_GC LUA_GC LUA_GC LUA_GC LUA_GC LUA_GC LUA_GC LUA_GC LUA_GC LUA_GC
 int DXDB_lua_pcall(lua_State *L, int nargs, int nresults, int errfunc) {
     server.alc.lua_dirty = 1;
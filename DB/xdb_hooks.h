@@ -46,17 +46,22 @@ void  DXDB_emptyDb();
 
 rcommand *DXDB_lookupCommand(sds name);
 
+void      DXDB_call_begin();
 void      DXDB_call(struct redisCommand *cmd, long long *dirty);
+void      DXDB_call_end();
 
 int           DXDB_processCommand             (redisClient *c);
 unsigned char DXDB_processInputBuffer_begin   (redisClient *c);
 void          DXDB_processInputBuffer_ZeroArgs(redisClient *c);
 void          DXDB_cleanup                    (redisClient *c);
+void          DXDB_freeClient                 (redisClient *c);
 
 int           DXDB_loadServerConfig(int argc, sds *argv);
 int           DXDB_configSetCommand(redisClient *c, robj *o);
 void          DXDB_configGetCommand(redisClient *c, char *pattern, int *matchs);
 
+void  DXDB_rdbSaveBegin();
+void  DXDB_rdbSaveDone(int ok);
 int   DXDB_rdbSave(FILE *fp);
 int   DXDB_rdbLoad(FILE *fp);
 
@@ -64,7 +69,7 @@ void  DXDB_flushdbCommand();
 
 int   DXDB_rewriteAppendOnlyFile(FILE *fp);
 
-void  DBXD_genRedisInfoString(sds info);
+sds   DBXD_genRedisInfoString(sds info);
 
 void DXDB_setClientSA(redisClient *c);
 
@@ -76,7 +81,10 @@ void DXDB_syncCommand(redisClient *c);
 
 unsigned char isWhiteListedIp(redisClient *c); //TODO move to another file?
 
-sds DXDB_SQL_feedAppendOnlyFile(rcommand *cmd, robj **argv, int argc);
+sds  DXDB_SQL_feedAppendOnlyFile(rcommand *cmd, robj **argv, int argc);
+bool DXDB_feedAppendOnlyFile    (rcommand *cmd, robj **argv, int argc,
+                                 sds      *buf);
+bool DXDB_aofFsync              (int fd, bool everysec);
 
 // HELPERS HELPERS HELPERS HELPERS HELPERS HELPERS HELPERS HELPERS HELPERS
 bool loadLuaHelperFile(cli *c, char *fname);
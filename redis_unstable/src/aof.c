@@ -102,7 +102,12 @@ void flushAppendOnlyFile(void) {
     {
         /* aof_fsync is defined as fdatasync() for Linux in order to avoid
          * flushing metadata. */
+#ifdef ALCHEMY_DATABASE
+        if (!DXDB_aofFsync(server.appendfd,
+                           server.appendfsync == APPENDFSYNC_EVERYSEC)) return;
+#else
         aof_fsync(server.appendfd); /* Let's try to get this data on the disk */
+#endif
         server.lastfsync = now;
     }
 }
@@ -179,6 +184,10 @@ void feedAppendOnlyFile(struct redisCommand *cmd, int dictid, robj **argv, int a
         buf = catAppendOnlyGenericCommand(buf,3,tmpargv);
         decrRefCount(tmpargv[0]);
         buf = catAppendOnlyExpireAtCommand(buf,argv[1],argv[2]);
+#ifdef ALCHEMY_DATABASE
+    } else if (DXDB_feedAppendOnlyFile(cmd, argv, argc, &buf)) {
+        /* SQL row writes -> binary AOFROW record */
+#endif
     } else {
         buf = catAppendOnlyGenericCommand(buf,argc,argv);
     }
@@ -3071,6 +3071,47 @@ function benchmark_SB() {
   taskset -c 1 ./alchemy-gen-benchmark -n 900000 -c 200 -s 1 -A MULTI -Q SELECT "i_SB.pos()" FROM SB WHERE "i_SB.pos()=00000000000001"
 }
 
+function benchmark_parser() {
+  N=1000000
+  if [ -n "$1" ]; then N=$1; fi
+  $CLI DROP   TABLE PB > /dev/null;
+  $CLI CREATE TABLE PB "(id INT, fk LONG, price FLOAT, name TEXT, u U128)";
+  $CLI CREATE INDEX i_PB ON PB "(fk)";
+  echo SELECT PK
+  $CLI PARSEBENCH $N SELECT "id,name" FROM PB WHERE "id = 1"
+  echo SELECT RANGE w/ FILTERs
+  $CLI PARSEBENCH $N SELECT "id,fk,price,name" FROM PB WHERE "fk BETWEEN 1 AND 1000 AND price > 9.99 AND name != 'a AND b' ORDER BY price DESC LIMIT 10"
+  echo SELECT IN
+  $CLI PARSEBENCH $N SELECT "*" FROM PB WHERE "id IN (1,2,3,4,5,6,7,8,9,10) AND fk = 7"
+  echo INSERT
+  $CLI PARSEBENCH $N INSERT INTO PB VALUES "(1,12345678901,99.99,'some name, with a comma',1|2)"
+  echo CREATE TABLE
+  $CLI PARSEBENCH $N CREATE TABLE PB2 "(id INT, fk LONG, price FLOAT, name TEXT, u U128)"
+  $CLI DROP   TABLE PB > /dev/null;
+}
+
+function benchmark_rdb_load() {
+  N=1000000
+  if [ -n "$1" ]; then N=$1; fi
+  for T in RL1 RL2 RL3 RL4; do
+    $CLI DROP   TABLE $T > /dev/null;
+    $CLI CREATE TABLE $T "(id INT, fk INT, g INT, name TEXT, w LONG)";
+    $CLI CREATE INDEX i_${T}_fk   ON $T "(fk)";
+    $CLI CREATE INDEX i_${T}_name ON $T "(name)";
+    $CLI CREATE INDEX i_${T}_mci  ON $T "(g,w)";
+    echo populate $T
+    taskset -c 1 ./alchemy-gen-benchmark -q -n $N -c 200 -s 1 -A OK -Q INSERT INTO $T VALUES "(00000000000001,00000000000001,00000000000001,'name_00000000000001',00000000000001)"
+  done
+  $CLI SAVE
+  for TH in 0 4; do
+    echo RDB LOAD rdb_load_threads: $TH
+    $CLI CONFIG SET rdb_load_threads $TH
+    $CLI DEBUG RELOAD
+    $CLI INFO | grep rdb_load_last_
+  done
+  for T in RL1 RL2 RL3 RL4; do $CLI DROP TABLE $T > /dev/null; done
+}
+
 function test_prepare_execute() {
   echo "test_prepare_execute"
   dropper; initer; inserter;
@@ -3080,6 +3121,20 @@ function test_prepare_execute() {
   $CLI PREPARE P_JOIN AS SELECT "s.name, d.name, d.location,e.name,e.salary" FROM "division d,external e,subdivision s" WHERE "s.division = d.id AND s.division=e.division AND d.id = \$1 ORDER BY s.name DESC"; 
   echo "2 rows JOIN (name[0] sort DESC)"
   $CLI EXECUTE P_JOIN 11
+  $CLI PREPARE P_RANGE AS SELECT id,name FROM employee WHERE "id BETWEEN \$1 AND \$2";
+  echo "3 rows RANGE"
+  $CLI EXECUTE P_RANGE 1 3
+  $CLI PREPARE P_IN AS SELECT id,name FROM employee WHERE "id IN (\$1,\$2)";
+  echo "2 rows IN()"
+  $CLI EXECUTE P_IN 2 4
+  $CLI PREPARE P_INS AS INSERT INTO employee VALUES "(\$1,\$2,\$3,\$4)";
+  $CLI EXECUTE P_INS 100 22 1000.99 "prepared name"
+  $CLI PREPARE P_UPD AS UPDATE employee SET "salary=\$2" WHERE "id = \$1";
+  $CLI EXECUTE P_UPD 100 2000.99
+  $CLI PREPARE P_DEL AS DELETE FROM employee WHERE "id = \$1";
+  echo "1 row (salary: 2000.99)"
+  $CLI SELECT \* FROM employee WHERE "id = 100"
+  $CLI EXECUTE P_DEL 100
 }
 
 # CACHE_SIMPLE CACHE_SIMPLE CACHE_SIMPLE CACHE_SIMPLE CACHE_SIMPLE
@@ -3548,3 +3603,878 @@ function advanced_tests() {
   wiki_example_2_updates
 }
 
+
+# CHECKED_TESTS CHECKED_TESTS CHECKED_TESTS CHECKED_TESTS CHECKED_TESTS
+# the test_* functions below compare replies & only print on a mismatch
+function check_reply() {
+  if [ "$2" != "$3" ]; then
+    echo "FAILURE: $1: expected: [$2] got: [$3]"
+    CHECK_FAILS=$((CHECK_FAILS + 1))
+  fi
+}
+
+function test_sort_spill() {
+  $CLI DROP   TABLE ct_sort > /dev/null
+  $CLI CREATE TABLE ct_sort "(id INT, fk INT, name TEXT)" > /dev/null
+  for i in $(seq 1 300); do
+    $CLI INSERT INTO ct_sort VALUES "($i,$(( (i * 7919) % 101 )),'n$i')" > /dev/null
+  done
+  $CLI CONFIG SET sort_memory_budget 0 > /dev/null
+  MEM=$($CLI SELECT "*" FROM ct_sort WHERE "id BETWEEN 1 AND 300 ORDER BY fk DESC, name")
+  $CLI CONFIG SET sort_memory_budget 2000 > /dev/null
+  SPL=$($CLI SELECT "*" FROM ct_sort WHERE "id BETWEEN 1 AND 300 ORDER BY fk DESC, name")
+  check_reply "sort_spill: spilled ORDER BY" "$MEM" "$SPL"
+  SPL=$($CLI SELECT "id" FROM ct_sort WHERE "id BETWEEN 1 AND 300 ORDER BY fk DESC, name LIMIT 2 OFFSET 1")
+  check_reply "sort_spill: spilled LIMIT OFFSET" "$(echo "$MEM" | sed -n '3,4p' | cut -d, -f1 | (echo id; cat))" "$SPL"
+  $CLI CONFIG SET sort_memory_budget 0 > /dev/null
+  $CLI DROP   TABLE ct_sort > /dev/null
+}
+
+function test_orderby_nkey() { # 64+ rows -> radix sort on the encoded keys
+  $CLI DROP   TABLE ct_nkey > /dev/null
+  $CLI CREATE TABLE ct_nkey "(id INT, l LONG, f FLOAT, name TEXT)" > /dev/null
+  for i in $(seq 1 200); do
+    $CLI INSERT INTO ct_nkey VALUES "($i,$(( (i * 37) % 23 * 4294967296 + i )),$(( (i * 13) % 41 - 20 )).5,'k$(( (i * 7) % 31 ))')" > /dev/null
+  done
+  Q="id BETWEEN 1 AND 200"
+  GOT=$($CLI SELECT "f" FROM ct_nkey WHERE "$Q ORDER BY f" | tail -n +2)
+  check_reply "orderby_nkey: FLOAT w/ negatives" "$(echo "$GOT" | sort -g)" "$GOT"
+  GOT=$($CLI SELECT "l" FROM ct_nkey WHERE "$Q ORDER BY l DESC" | tail -n +2)
+  check_reply "orderby_nkey: LONG DESC" "$(echo "$GOT" | sort -n -r)" "$GOT"
+  GOT=$($CLI SELECT "name,id" FROM ct_nkey WHERE "$Q ORDER BY name DESC, id" | tail -n +2)
+  check_reply "orderby_nkey: TEXT DESC, INT" "$(echo "$GOT" | LC_ALL=C sort -t, -k1,1r -k2,2n)" "$GOT"
+  $CLI DROP   TABLE ct_nkey > /dev/null
+}
+
+function test_filter_program() {
+  $CLI DROP   TABLE ct_fprog > /dev/null
+  $CLI CREATE TABLE ct_fprog "(id INT, g INT, f FLOAT, name TEXT)" > /dev/null
+  for i in $(seq 1 20); do
+    $CLI INSERT INTO ct_fprog VALUES "($i,$((i % 4)),$i.25,'n$i')" > /dev/null
+  done
+  $CLI INTERPRET LUA "function ct_even(x) return (x % 2) == 0; end" > /dev/null
+  Q="id BETWEEN 1 AND 20"
+  check_reply "filter_program: INT EQ" 5 \
+              $($CLI SELECT "COUNT(*)" FROM ct_fprog WHERE "$Q AND g = 1")
+  check_reply "filter_program: FLOAT GT" 10 \
+              $($CLI SELECT "COUNT(*)" FROM ct_fprog WHERE "$Q AND f > 10.5")
+  check_reply "filter_program: NE + FLOAT BETWEEN" 4 \
+              $($CLI SELECT "COUNT(*)" FROM ct_fprog WHERE "$Q AND g != 0 AND f BETWEEN 3 AND 9")
+  check_reply "filter_program: TEXT EQ" 1 \
+              $($CLI SELECT "COUNT(*)" FROM ct_fprog WHERE "$Q AND name = 'n7'")
+  check_reply "filter_program: LUA only (no registers)" 10 \
+              $($CLI SELECT "COUNT(*)" FROM ct_fprog WHERE "$Q AND ct_even(g)")
+  check_reply "filter_program: LUA + FLOAT" 4 \
+              $($CLI SELECT "COUNT(*)" FROM ct_fprog WHERE "$Q AND ct_even(g) AND f < 10")
+  check_reply "filter_program: SCAN LUA only" 10 \
+              $($CLI SCAN "COUNT(*)" FROM ct_fprog WHERE "ct_even(id)")
+  $CLI DROP   TABLE ct_fprog > /dev/null
+}
+
+function test_in_not_in() {
+  $CLI DROP   TABLE ct_in > /dev/null
+  $CLI CREATE TABLE ct_in "(id INT, s INT, f FLOAT, t TEXT)" > /dev/null
+  $CLI CREATE INDEX ct_in_s ON ct_in "(s)" > /dev/null
+  for i in $(seq 1 30); do
+    $CLI INSERT INTO ct_in VALUES "($i,$((i % 3)),$i.5,'t$((i % 5))')" > /dev/null
+  done
+  Q="id BETWEEN 1 AND 30"
+  check_reply "in_not_in: INT IN filter" 10 \
+              $($CLI SELECT "COUNT(*)" FROM ct_in WHERE "$Q AND s IN (2,7,9)")
+  check_reply "in_not_in: FLOAT IN filter" 2 \
+              $($CLI SELECT "COUNT(*)" FROM ct_in WHERE "$Q AND f IN (3.5,4.5,99.5)")
+  check_reply "in_not_in: TEXT IN filter" 12 \
+              $($CLI SELECT "COUNT(*)" FROM ct_in WHERE "$Q AND t IN ('t1','t4')")
+  check_reply "in_not_in: NOT IN filter" 18 \
+              $($CLI SELECT "COUNT(*)" FROM ct_in WHERE "$Q AND t NOT IN ('t1','t4')")
+  check_reply "in_not_in: NOT IN w/ indexed IN" 10 \
+              $($CLI SELECT "COUNT(*)" FROM ct_in WHERE "s IN (1,2) AND s NOT IN (1)")
+  check_reply "in_not_in: SCAN NOT IN" 20 \
+              $($CLI SCAN "COUNT(*)" FROM ct_in WHERE "s NOT IN (0)")
+  # NOT IN on the lookup column: an error & NOTHING done
+  ERR=$($CLI SELECT "*" FROM ct_in WHERE "s NOT IN (0)" | head -c 10)
+  check_reply "in_not_in: SELECT NOT IN lookup" "ERR SYNTAX" "$ERR"
+  ERR=$($CLI DELETE FROM ct_in WHERE "s NOT IN (0)" | head -c 10)
+  check_reply "in_not_in: DELETE NOT IN lookup" "ERR SYNTAX" "$ERR"
+  ERR=$($CLI UPDATE ct_in SET "f = 0.5" WHERE "s NOT IN (0)" | head -c 10)
+  check_reply "in_not_in: UPDATE NOT IN lookup" "ERR SYNTAX" "$ERR"
+  check_reply "in_not_in: no rows DELETEd" 30 \
+              $($CLI SELECT "COUNT(*)" FROM ct_in WHERE "$Q")
+  check_reply "in_not_in: no rows UPDATEd" 0 \
+              $($CLI SELECT "COUNT(*)" FROM ct_in WHERE "$Q AND f = 0.5")
+  $CLI DROP   TABLE ct_in > /dev/null
+}
+
+function test_aggregates() {
+  $CLI DROP   TABLE ct_aggr > /dev/null
+  $CLI CREATE TABLE ct_aggr "(id INT, g INT, h INT, x INT)" > /dev/null
+  $CLI CREATE INDEX ct_aggr_g ON ct_aggr "(g)" > /dev/null
+  for i in $(seq 1 40); do
+    $CLI INSERT INTO ct_aggr VALUES "($i,$((i % 5)),$((i % 5)),$i)" > /dev/null
+  done
+  $CLI INTERPRET LUA "ct_n = 0; function ct_cnt(x) ct_n = ct_n + 1; return true; end function ct_rows() local n = ct_n; ct_n = 0; return n; end" > /dev/null
+  check_reply "aggregates: STREAM" "g, COUNT(*), SUM(x), MIN(x), MAX(x) 0,8,180,5,40 1,8,148,1,36 2,8,156,2,37 3,8,164,3,38 4,8,172,4,39" \
+    "$($CLI SELECT "g, COUNT( * ), sum( x ), MIN(x), MAX(x)" FROM ct_aggr WHERE "g BETWEEN 0 AND 9 GROUP BY g" | tr '\n' ' ' | sed 's/ $//')"
+  check_reply "aggregates: HASH" "h, COUNT(*), AVG(x) 0,8,22.5 1,8,18.5 2,8,19.5 3,8,20.5 4,8,21.5" \
+    "$($CLI SELECT "h, COUNT(*), AVG(x)" FROM ct_aggr WHERE "id BETWEEN 1 AND 40 GROUP BY h" | tr '\n' ' ' | sed 's/ $//')"
+  check_reply "aggregates: empty GROUP BY -> header only" "g, COUNT(*)" \
+    "$($CLI SELECT "g, COUNT(*)" FROM ct_aggr WHERE "g BETWEEN 7 AND 9 GROUP BY g")"
+  check_reply "aggregates: no GROUP BY, no rows" "COUNT(*), MAX(x) 0," \
+    "$($CLI SELECT "COUNT(*), MAX(x)" FROM ct_aggr WHERE "id BETWEEN 100 AND 200" | tr '\n' ' ' | sed 's/ $//')"
+  check_reply "aggregates: STREAM LIMIT OFFSET" "g, COUNT(*) 1,8 2,8" \
+    "$($CLI SELECT "g, COUNT(*)" FROM ct_aggr WHERE "g BETWEEN 0 AND 9 AND ct_cnt(x) GROUP BY g LIMIT 2 OFFSET 1" | tr '\n' ' ' | sed 's/ $//')"
+  check_reply "aggregates: STREAM LIMIT stops the scan" 25 $($CLI LUAFUNC ct_rows)
+  check_reply "aggregates: HASH LIMIT" "h, COUNT(*) 1,8 2,8" \
+    "$($CLI SELECT "h, COUNT(*)" FROM ct_aggr WHERE "id BETWEEN 1 AND 40 AND ct_cnt(x) GROUP BY h LIMIT 2 OFFSET 1" | tr '\n' ' ' | sed 's/ $//')"
+  check_reply "aggregates: HASH scans every row" 40 $($CLI LUAFUNC ct_rows)
+  check_reply "aggregates: ORDER BY rejected" "1 1 1 1" \
+    "$($CLI SELECT "g, COUNT(*)" FROM ct_aggr WHERE "g BETWEEN 0 AND 9 GROUP BY g ORDER BY g DESC" | grep -c '"ORDER BY" not supported') $($CLI SELECT "SUM(x)" FROM ct_aggr WHERE "g BETWEEN 0 AND 9 ORDER BY nosuchcol" | grep -c '"ORDER BY" not supported') $($CLI SELECT "g" FROM ct_aggr WHERE "g BETWEEN 0 AND 9 GROUP BY g ORDER BY g" | grep -c '"ORDER BY" not supported') $($CLI SCAN "h, COUNT(*)" FROM ct_aggr ORDER BY h | grep -c '"ORDER BY" not supported')"
+  $CLI DROP   TABLE ct_aggr > /dev/null
+}
+
+function info_field() {
+  $CLI INFO | grep "^$1:" | cut -d: -f2 | tr -d '\r'
+}
+function test_plan_cache() {
+  $CLI DROP   TABLE ct_pc > /dev/null
+  $CLI CREATE TABLE ct_pc "(id INT, s INT, t TEXT)" > /dev/null
+  $CLI CREATE INDEX ct_pc_s ON ct_pc "(s)" > /dev/null
+  for i in $(seq 1 20); do
+    $CLI INSERT INTO ct_pc VALUES "($i,$((i % 4)),'t$((i % 2))')" > /dev/null
+  done
+  H0=$(info_field plan_cache_hits); M0=$(info_field plan_cache_misses)
+  check_reply "plan_cache: miss" "id 3 7 11 15 19" \
+    "$($CLI SELECT id FROM ct_pc WHERE "s = 3" | tr '\n' ' ' | sed 's/ $//')"
+  check_reply "plan_cache: hit, new literal" "id 2 6 10 14 18" \
+    "$($CLI SELECT id FROM ct_pc WHERE "s = 2" | tr '\n' ' ' | sed 's/ $//')"
+  check_reply "plan_cache: 1 miss" $((M0 + 1)) $(info_field plan_cache_misses)
+  check_reply "plan_cache: 1 hit"  $((H0 + 1)) $(info_field plan_cache_hits)
+  check_reply "plan_cache: RANGE + TEXT filter" 2 \
+    $($CLI SELECT "COUNT(*)" FROM ct_pc WHERE "id BETWEEN 3 AND 6 AND t = 't1'")
+  check_reply "plan_cache: RANGE + TEXT filter, rebound" 3 \
+    $($CLI SELECT "COUNT(*)" FROM ct_pc WHERE "id BETWEEN 10 AND 15 AND t = 't0'")
+  check_reply "plan_cache: LIMIT rebound" "id 5 6" \
+    "$($CLI SELECT id FROM ct_pc WHERE "id BETWEEN 5 AND 20 LIMIT 2" | tr '\n' ' ' | sed 's/ $//')"
+  check_reply "plan_cache: LIMIT OFFSET rebound" "id 10 11 12" \
+    "$($CLI SELECT id FROM ct_pc WHERE "id BETWEEN 8 AND 20 LIMIT 3 OFFSET 2" | tr '\n' ' ' | sed 's/ $//')"
+  check_reply "plan_cache: UPDATE via cached plan" 5 \
+    $($CLI UPDATE ct_pc SET "t = 'u'" WHERE "s = 1")
+  check_reply "plan_cache: DELETE via cached plan" 5 \
+    $($CLI DELETE FROM ct_pc WHERE "s = 1")
+  I0=$(info_field plan_cache_invalidations)
+  $CLI CREATE INDEX ct_pc_t ON ct_pc "(t)" > /dev/null
+  check_reply "plan_cache: DDL invalidates" $((I0 + 1)) \
+    $(info_field plan_cache_invalidations)
+  check_reply "plan_cache: 0 entries after DDL" 0 $(info_field plan_cache_entries)
+  check_reply "plan_cache: after DDL" 5 \
+    $($CLI SELECT "COUNT(*)" FROM ct_pc WHERE "s = 2")
+  $CLI CONFIG SET plan_cache_size 0 > /dev/null
+  H0=$(info_field plan_cache_hits)
+  $CLI SELECT "COUNT(*)" FROM ct_pc WHERE "s = 2" > /dev/null
+  $CLI SELECT "COUNT(*)" FROM ct_pc WHERE "s = 3" > /dev/null
+  check_reply "plan_cache: size 0 -> off" $H0 $(info_field plan_cache_hits)
+  $CLI CONFIG SET plan_cache_size 1024 > /dev/null
+  $CLI DROP   TABLE ct_pc > /dev/null
+}
+
+function test_prepare_execute_checked() {
+  $CLI DROP   TABLE ct_ps > /dev/null
+  $CLI CREATE TABLE ct_ps "(id INT, ival INT, t TEXT)" > /dev/null
+  check_reply "prepare: INSERT" OK \
+    $($CLI PREPARE ct_ps_ins AS INSERT INTO ct_ps VALUES "(\$1,\$2,'\$3')")
+  for i in $(seq 1 6); do
+    $CLI EXECUTE ct_ps_ins $i $((i * 10)) t$i > /dev/null
+  done
+  $CLI PREPARE ct_ps_eq  AS SELECT "t" FROM ct_ps WHERE "id = \$1" > /dev/null
+  $CLI PREPARE ct_ps_rng AS SELECT "id" FROM ct_ps WHERE "id BETWEEN \$1 AND \$2" > /dev/null
+  $CLI PREPARE ct_ps_in  AS SELECT "id" FROM ct_ps WHERE "id IN (\$1,\$2)" > /dev/null
+  $CLI PREPARE ct_ps_upd AS UPDATE ct_ps SET "ival = \$2" WHERE "id = \$1" > /dev/null
+  $CLI PREPARE ct_ps_del AS DELETE FROM ct_ps WHERE "id = \$1" > /dev/null
+  check_reply "execute: EQ" "t 't4'" \
+    "$($CLI EXECUTE ct_ps_eq 4 | tr '\n' ' ' | sed 's/ $//')"
+  check_reply "execute: RANGE" "id 2 3 4" \
+    "$($CLI EXECUTE ct_ps_rng 2 4 | tr '\n' ' ' | sed 's/ $//')"
+  check_reply "execute: IN" "id 6 1" \
+    "$($CLI EXECUTE ct_ps_in 6 1 | tr '\n' ' ' | sed 's/ $//')"
+  check_reply "execute: UPDATE" 1 $($CLI EXECUTE ct_ps_upd 5 555)
+  check_reply "execute: UPDATEd row" 555 \
+    $($CLI SELECT ival FROM ct_ps WHERE "id = 5" | tail -n 1)
+  check_reply "execute: DELETE" 1 $($CLI EXECUTE ct_ps_del 6)
+  check_reply "execute: DELETEd" 5 \
+    $($CLI SELECT "COUNT(*)" FROM ct_ps WHERE "id BETWEEN 1 AND 10")
+  check_reply "execute: wrong number of args" \
+    "ERR SYNTAX: EXECUTE number-of-args does NOT match PREPARE number-of-args" \
+    "$($CLI EXECUTE ct_ps_rng 1)"
+  check_reply "prepare: template w/ too few args" \
+    "ERR wrong number of arguments for 'update' command" \
+    "$($CLI PREPARE ct_ps_bad AS UPDATE ct_ps)"
+  check_reply "prepare: bad template not stored" \
+    "ERR NOT-FOUND: EXECUTE prepared statement not found" \
+    "$($CLI EXECUTE ct_ps_bad)"
+  $CLI DEBUG RELOAD > /dev/null
+  check_reply "execute: after RELOAD" "id 2 3" \
+    "$($CLI EXECUTE ct_ps_rng 2 3 | tr '\n' ' ' | sed 's/ $//')"
+  $CLI DROP   TABLE ct_ps > /dev/null
+}
+
+function test_bexecute() {
+  $CLI DROP   TABLE ct_bx > /dev/null
+  $CLI CREATE TABLE ct_bx "(id INT, v LONG, t TEXT)" > /dev/null
+  for i in $(seq 1 4); do
+    $CLI INSERT INTO ct_bx VALUES "($i,$((i * 10)),'t$i')" > /dev/null
+  done
+  $CLI PREPARE ct_bx_eq  AS SELECT "id, t" FROM ct_bx WHERE "id = \$1" > /dev/null
+  $CLI PREPARE ct_bx_rng AS SELECT "id" FROM ct_bx WHERE "id BETWEEN \$1 AND \$2" > /dev/null
+  $CLI PREPARE ct_bx_txt AS SELECT "id" FROM ct_bx WHERE "id BETWEEN 1 AND 4 AND t = '\$1'" > /dev/null
+  $CLI PREPARE ct_bx_upd AS UPDATE ct_bx SET "v = \$2" WHERE "id = \$1" > /dev/null
+  # params: [COL_TYPE][LITTLE_ENDIAN value], INT:1 LONG:2 STRING:3 (uint32 len)
+  check_reply "bexecute: INT EQ (bound plan)" "id, t 3,'t3'" \
+    "$(printf '\001\003\000\000\000' | $CLI -x BEXECUTE ct_bx_eq | tr '\n' ' ' | sed 's/ $//')"
+  check_reply "bexecute: INT RANGE (template)" "id 2 3 4" \
+    "$(printf '\001\002\000\000\000\001\004\000\000\000' | $CLI -x BEXECUTE ct_bx_rng | tr '\n' ' ' | sed 's/ $//')"
+  check_reply "bexecute: STRING param" "id 2" \
+    "$(printf '\003\002\000\000\000t2' | $CLI -x BEXECUTE ct_bx_txt | tr '\n' ' ' | sed 's/ $//')"
+  check_reply "bexecute: LONG UPDATE" 1 \
+    $(printf '\001\001\000\000\000\002\007\000\000\000\000\000\000\000' | $CLI -x BEXECUTE ct_bx_upd)
+  check_reply "bexecute: UPDATEd row" 7 \
+    $($CLI SELECT v FROM ct_bx WHERE "id = 1" | tail -n 1)
+  check_reply "bexecute: bad COL_TYPE" 1 \
+    $(printf '\011' | $CLI -x BEXECUTE ct_bx_eq | grep -c "ERR SYNTAX: BEXECUTE")
+  check_reply "bexecute: truncated INT" 1 \
+    $(printf '\001\003' | $CLI -x BEXECUTE ct_bx_eq | grep -c "ERR SYNTAX: BEXECUTE")
+  check_reply "bexecute: param count" \
+    "ERR SYNTAX: EXECUTE number-of-args does NOT match PREPARE number-of-args" \
+    "$(printf '\001\003\000\000\000' | $CLI -x BEXECUTE ct_bx_rng)"
+  $CLI DROP   TABLE ct_bx > /dev/null
+}
+
+function test_where_lexer() {
+  $CLI DROP   TABLE ct_lex > /dev/null
+  $CLI CREATE TABLE ct_lex "(id INT, ival INT, t TEXT)" > /dev/null
+  for i in $(seq 1 10); do
+    $CLI INSERT INTO ct_lex VALUES "($i,$((i % 3)),'a $i AND b')" > /dev/null
+  done
+  check_reply "lexer: BETWEEN AND + AND" 3 \
+    $($CLI SELECT "COUNT(*)" FROM ct_lex WHERE "id BETWEEN 2 AND 9 AND ival = 2")
+  check_reply "lexer: AND inside a string" "id 4" \
+    "$($CLI SELECT id FROM ct_lex WHERE "id BETWEEN 1 AND 10 AND t = 'a 4 AND b'" | tr '\n' ' ' | sed 's/ $//')"
+  check_reply "lexer: AND inside IN()" 2 \
+    $($CLI SELECT "COUNT(*)" FROM ct_lex WHERE "id IN (1,5,7) AND t IN ('a 1 AND b','a 7 AND b')")
+  for q in "ival = 2 AND AND id = 3" "id = 3 AND AND ival = 2" "id = 3 AND " \
+           "AND id = 3"; do
+    check_reply "lexer: empty predicate [$q]" 1 \
+      $($CLI SELECT id FROM ct_lex WHERE "$q" | grep -c "^ERR SYNTAX")
+  done
+  check_reply "lexer: server survives" 10 \
+    $($CLI SELECT "COUNT(*)" FROM ct_lex WHERE "id BETWEEN 1 AND 10")
+  check_reply "parsebench: SELECT" 1 \
+    $($CLI PARSEBENCH 100 SELECT id FROM ct_lex WHERE "id = 3 AND ival = 0" | grep -c "^PARSEBENCH: SELECT: 100 statements")
+  check_reply "parsebench: INSERT commits nothing" 1 \
+    $($CLI PARSEBENCH 100 INSERT INTO ct_lex VALUES "(11,1,'x')" | grep -c "^PARSEBENCH: INSERT: 100 statements")
+  check_reply "parsebench: no rows added" 10 \
+    $($CLI SELECT "COUNT(*)" FROM ct_lex WHERE "id BETWEEN 1 AND 100")
+  $CLI DROP   TABLE ct_lex > /dev/null
+}
+
+function wait_bg() { # wait out a BGSAVE/BGREWRITEAOF
+  for i in $(seq 1 100); do
+    if [ "$(info_field bgrewriteaof_in_progress)$(info_field bgsave_in_progress)" = "00" ]; then
+      return
+    fi
+    sleep 0.1
+  done
+}
+function test_multi_insert() {
+  $CLI DROP   TABLE ct_mi > /dev/null
+  $CLI CREATE TABLE ct_mi "(id INT, s INT, t TEXT)" > /dev/null
+  $CLI CREATE INDEX ct_mi_s ON ct_mi "(s)" > /dev/null
+  check_reply "multi-insert: batch" OK \
+    $($CLI INSERT INTO ct_mi VALUES "(3,1,'c'),(1,2,'a'),(2,1,'b, (x)')")
+  check_reply "multi-insert: index filled" "id, t 2,'b, (x)' 3,'c'" \
+    "$($CLI SELECT "id, t" FROM ct_mi WHERE "s = 1" | tr '\n' ' ' | sed 's/ $//')"
+  check_reply "multi-insert: dup PK in batch" 1 \
+    $($CLI INSERT INTO ct_mi VALUES "(5,1,'e'),(5,2,'f')" | grep -c "^ERR")
+  check_reply "multi-insert: existing PK" 1 \
+    $($CLI INSERT INTO ct_mi VALUES "(6,1,'e'),(3,2,'f')" | grep -c "^ERR")
+  check_reply "multi-insert: all or nothing" 3 \
+    $($CLI SELECT "COUNT(*)" FROM ct_mi WHERE "s BETWEEN 0 AND 9")
+  check_reply "multi-insert: index rolled back" 2 \
+    $($CLI SELECT "COUNT(*)" FROM ct_mi WHERE "s = 1")
+  LD=$(mktemp /tmp/ct_mi.XXXXXX)
+  for i in $(seq 10 49); do echo "$i,$((i % 2)),'r$i'" >> $LD; done
+  echo "" >> $LD
+  check_reply "load data: rows" 40 $($CLI LOAD DATA INFILE $LD INTO TABLE ct_mi)
+  check_reply "load data: index" 22 \
+    $($CLI SELECT "COUNT(*)" FROM ct_mi WHERE "s = 1")
+  printf "60,1,'x'\n60,2,'y'\n" > $LD
+  check_reply "load data: bad batch" 1 \
+    $($CLI LOAD DATA INFILE $LD INTO TABLE ct_mi | grep -c "^ERR")
+  check_reply "load data: bad batch rolled back" 43 \
+    $($CLI SELECT "COUNT(*)" FROM ct_mi WHERE "s BETWEEN 0 AND 9")
+  check_reply "load data: missing file" "ERR LOAD DATA INFILE: could not open file" \
+    "$($CLI LOAD DATA INFILE $LD.nonexistent INTO TABLE ct_mi)"
+  $CLI CONFIG SET appendonly yes > /dev/null; wait_bg
+  printf "70,1,'x'\n71,2,'y'\n" > $LD
+  $CLI LOAD DATA INFILE $LD INTO TABLE ct_mi > /dev/null
+  $CLI INSERT INTO ct_mi VALUES "(80,1,'p'),(81,2,'q')" > /dev/null
+  $CLI DEBUG LOADAOF > /dev/null
+  check_reply "load data + multi-insert: AOF replay" 47 \
+    $($CLI SELECT "COUNT(*)" FROM ct_mi WHERE "s BETWEEN 0 AND 9")
+  $CLI CONFIG SET appendonly no > /dev/null
+  rm -f $LD
+  $CLI DROP   TABLE ct_mi > /dev/null
+}
+
+function wait_index_builds() {
+  for i in $(seq 1 100); do
+    if [ "$(info_field index_builds_in_progress)" = "0" ]; then return; fi
+    sleep 0.1
+  done
+}
+function test_index_background() {
+  $CLI DROP   TABLE ct_bg > /dev/null
+  $CLI CREATE TABLE ct_bg "(id INT, s INT, t INT)" > /dev/null
+  LD=$(mktemp /tmp/ct_bg.XXXXXX)
+  seq 1 50000 | awk '{print $1","$1 % 10","$1}' > $LD
+  $CLI LOAD DATA INFILE $LD INTO TABLE ct_bg > /dev/null
+  rm -f $LD
+  $CLI CONFIG SET index_build_slice_ms 1 > /dev/null
+  # ONE connection, MULTI: the writes run before the 1st build slice
+  OUT=$(printf '%s\n' 'MULTI' \
+          'CREATE INDEX ct_bg_s ON ct_bg "(s)" BACKGROUND' \
+          'DELETE FROM ct_bg WHERE "id = 49999"' \
+          'UPDATE ct_bg SET "s = 3" WHERE "id = 2"' \
+          'INSERT INTO ct_bg VALUES "(60000,3,1)"' \
+          'UPDATE ct_bg SET "s = 5" WHERE "id = 49000"' \
+          'SELECT id FROM ct_bg WHERE "s = 3"' 'EXEC' 'INFO' | $CLI)
+  check_reply "index background: not used while building" 1 \
+    $(echo "$OUT" | grep -c "Column must be indexed")
+  check_reply "index background: in progress" 1 \
+    $(echo "$OUT" | grep -c "^index_builds_in_progress:1")
+  wait_index_builds
+  check_reply "index background: done" 0 $(info_field index_builds_in_progress)
+  for k in 3 5 9; do
+    check_reply "index background: s = $k" \
+      $($CLI SCAN "COUNT(*)" FROM ct_bg WHERE "s = $k") \
+      $($CLI SELECT "COUNT(*)" FROM ct_bg WHERE "s = $k")
+  done
+  check_reply "index background: writes after the build" 5003 \
+    $($CLI INSERT INTO ct_bg VALUES "(60001,3,1)" > /dev/null; \
+      $CLI SELECT "COUNT(*)" FROM ct_bg WHERE "s = 3")
+  $CLI CONFIG SET index_build_slice_ms 2 > /dev/null
+  $CLI DROP   TABLE ct_bg > /dev/null
+}
+
+function test_index_include() {
+  $CLI DROP   TABLE ct_cv > /dev/null
+  $CLI CREATE TABLE ct_cv "(id INT, fk INT, v INT, o TEXT)" > /dev/null
+  $CLI INSERT INTO ct_cv VALUES "(1,1,10,'a'),(2,1,20,'b'),(3,2,30,'c'),(4,2,40,'d')" > /dev/null
+  check_reply "include: CREATE" OK \
+    $($CLI CREATE INDEX ct_cv_fk ON ct_cv "(fk)" INCLUDE "(v)")
+  check_reply "include: EXPLAIN covered" 1 \
+    $($CLI EXPLAIN SELECT "id, v" FROM ct_cv WHERE "fk = 1" | grep -c "COVERING INDEX: ct_cv_fk")
+  check_reply "include: EXPLAIN not covered" 0 \
+    $($CLI EXPLAIN SELECT "id, o" FROM ct_cv WHERE "fk = 1" | grep -c "COVERING INDEX")
+  check_reply "include: EQ" "id, v 1,10 2,20" \
+    "$($CLI SELECT "id, v" FROM ct_cv WHERE "fk = 1" | tr '\n' ' ' | sed 's/ $//')"
+  $CLI UPDATE ct_cv SET "v = 99" WHERE "id = 2" > /dev/null
+  check_reply "include: UPDATE of the INCLUDE column" "id, v 1,10 2,99 3,30 4,40" \
+    "$($CLI SELECT "id, v" FROM ct_cv WHERE "fk BETWEEN 1 AND 2" | tr '\n' ' ' | sed 's/ $//')"
+  $CLI UPDATE ct_cv SET "fk = 2" WHERE "id = 1" > /dev/null
+  check_reply "include: UPDATE of the FK" "id, fk, v 1,2,10 3,2,30 4,2,40" \
+    "$($CLI SELECT "id, fk, v" FROM ct_cv WHERE "fk = 2" | tr '\n' ' ' | sed 's/ $//')"
+  $CLI DELETE FROM ct_cv WHERE "id = 3" > /dev/null
+  check_reply "include: DELETE" "id, v 1,10 4,40" \
+    "$($CLI SELECT "id, v" FROM ct_cv WHERE "fk = 2" | tr '\n' ' ' | sed 's/ $//')"
+  $CLI INSERT INTO ct_cv "(id, fk, o)" VALUES "(5,1,'e')" > /dev/null
+  check_reply "include: empty INCLUDE -> NOT COVERING" 1 \
+    $($CLI DESC ct_cv | grep -c "INCLUDE v (NOT COVERING)")
+  check_reply "include: NOT COVERING reads rows" "id, v 2,99 5," \
+    "$($CLI SELECT "id, v" FROM ct_cv WHERE "fk = 1" | tr '\n' ' ' | sed 's/ $//')"
+  check_reply "include: TEXT INCLUDE rejected" 1 \
+    $($CLI CREATE INDEX ct_cv_bad ON ct_cv "(fk)" INCLUDE "(o)" | grep -c "^ERR")
+  $CLI DEBUG RELOAD > /dev/null
+  check_reply "include: after RELOAD" 1 \
+    $($CLI DESC ct_cv | grep -c "INCLUDE v")
+  $CLI DROP   TABLE ct_cv > /dev/null
+}
+
+function test_index_partial_expr() {
+  $CLI DROP   TABLE ct_px > /dev/null
+  $CLI CREATE TABLE ct_px "(id INT, st INT, v INT, t TEXT)" > /dev/null
+  for i in $(seq 1 20); do
+    $CLI INSERT INTO ct_px VALUES "($i,$((i % 3)),$i,'name$i')" > /dev/null
+  done
+  $CLI CREATE INDEX ct_px_p ON ct_px "(v)" WHERE "st = 1" > /dev/null
+  $CLI CREATE INDEX ct_px_e ON ct_px "(v % 10)" > /dev/null
+  $CLI CREATE INDEX ct_px_l ON ct_px "(LEFT(t,5))" > /dev/null
+  check_reply "partial: used w/ its predicate" 1 \
+    $($CLI EXPLAIN SELECT id FROM ct_px WHERE "v BETWEEN 1 AND 20 AND st = 1" | grep -c "imatch: [0-9]* (ct_px_p)")
+  check_reply "partial: rows" "id 1 4 7 10 13 16 19" \
+    "$($CLI SELECT id FROM ct_px WHERE "v BETWEEN 1 AND 20 AND st = 1" | tr '\n' ' ' | sed 's/ $//')"
+  check_reply "partial: unused w/o its predicate" 1 \
+    $($CLI SELECT id FROM ct_px WHERE "v BETWEEN 1 AND 20" | grep -c "Column must be indexed")
+  $CLI UPDATE ct_px SET "st = 1" WHERE "id = 3" > /dev/null
+  $CLI UPDATE ct_px SET "st = 0" WHERE "id = 4" > /dev/null
+  check_reply "partial: rows move in & out" "id 1 3" \
+    "$($CLI SELECT id FROM ct_px WHERE "v BETWEEN 1 AND 5 AND st = 1" | tr '\n' ' ' | sed 's/ $//')"
+  check_reply "expression: used" 1 \
+    $($CLI EXPLAIN SELECT id FROM ct_px WHERE "v%10 = 3" | grep -c "imatch: [0-9]* (ct_px_e)")
+  $CLI UPDATE ct_px SET "v = 33" WHERE "id = 5" > /dev/null
+  $CLI DELETE FROM ct_px WHERE "id = 13" > /dev/null
+  check_reply "expression: arithmetic" "id 3 5" \
+    "$($CLI SELECT id FROM ct_px WHERE "v%10 = 3" | tr '\n' ' ' | sed 's/ $//')"
+  check_reply "expression: LEFT()" 10 \
+    $($CLI SELECT "COUNT(*)" FROM ct_px WHERE "LEFT(t,5) = 'name1'")
+  $CLI DEBUG RELOAD > /dev/null
+  check_reply "partial + expression: after RELOAD" \
+    "v | INT UNSIGNED - INDEX: ct_px_p [BYTES: *] - WHERE st = 1, INDEX: ct_px_e EXPRESSION: (v%10) [BYTES: *]" \
+    "$($CLI DESC ct_px | grep "^v " | sed 's/BYTES: [0-9]*/BYTES: */g')"
+  check_reply "expression: after RELOAD" "id 3 5" \
+    "$($CLI SELECT id FROM ct_px WHERE "v%10 = 3" | tr '\n' ' ' | sed 's/ $//')"
+  $CLI DROP   TABLE ct_px > /dev/null
+}
+
+function test_index_bitmap() {
+  $CLI DROP   TABLE ct_bm > /dev/null
+  $CLI CREATE TABLE ct_bm "(id INT, c INT, g TEXT, b INT)" > /dev/null
+  LD=$(mktemp /tmp/ct_bm.XXXXXX)
+  seq 1 10000 | awk '{print $1","$1 % 7",'"'"'g"$1 % 3"'"'"',"$1 % 2}' > $LD
+  $CLI LOAD DATA INFILE $LD INTO TABLE ct_bm > /dev/null
+  rm -f $LD
+  $CLI CREATE INDEX ct_bm_c ON ct_bm "(c)" USING BITMAP > /dev/null
+  $CLI CREATE INDEX ct_bm_g ON ct_bm "(g)" USING BITMAP > /dev/null
+  $CLI CREATE INDEX ct_bm_b ON ct_bm "(b)" USING BITMAP > /dev/null
+  check_reply "bitmap: AND plan" 1 \
+    $($CLI EXPLAIN SELECT id FROM ct_bm WHERE "c = 3 AND g = 'g1'" | grep -c "type: 5 (BITMAP)")
+  for q in "c = 3 AND g = 'g1'" "c IN (1,2) AND g = 'g0'" "b = 1 AND c = 4" \
+           "b = 0 AND g IN ('g1','g2') AND c IN (0,6)"; do
+    check_reply "bitmap: [$q]" $($CLI SCAN "COUNT(*)" FROM ct_bm WHERE "$q") \
+      $($CLI SELECT "COUNT(*)" FROM ct_bm WHERE "$q")
+  done
+  check_reply "bitmap: DESC LIMIT OFFSET" "id 9969 9963 9948" \
+    "$($CLI SELECT id FROM ct_bm WHERE "c IN (1,2) AND g = 'g0' ORDER BY id DESC LIMIT 3 OFFSET 2" | tr '\n' ' ' | sed 's/ $//')"
+  $CLI UPDATE ct_bm SET "c = 3, g = 'g1'" WHERE "id = 2" > /dev/null
+  $CLI DELETE FROM ct_bm WHERE "id = 10" > /dev/null
+  $CLI INSERT INTO ct_bm VALUES "(20000,3,'g1',1)" > /dev/null
+  for q in "c = 3 AND g = 'g1'" "b = 1 AND c = 3"; do
+    check_reply "bitmap: after writes [$q]" $($CLI SCAN "COUNT(*)" FROM ct_bm WHERE "$q") \
+      $($CLI SELECT "COUNT(*)" FROM ct_bm WHERE "$q")
+  done
+  $CLI DEBUG RELOAD > /dev/null
+  check_reply "bitmap: after RELOAD" $($CLI SCAN "COUNT(*)" FROM ct_bm WHERE "c = 3 AND g = 'g1'") \
+    $($CLI SELECT "COUNT(*)" FROM ct_bm WHERE "c = 3 AND g = 'g1'")
+  $CLI DROP   TABLE ct_bm > /dev/null
+}
+
+function test_index_hash() {
+  $CLI DROP   TABLE ct_hs > /dev/null
+  $CLI CREATE TABLE ct_hs "(id INT, email TEXT, n INT, f FLOAT)" > /dev/null
+  LD=$(mktemp /tmp/ct_hs.XXXXXX)
+  seq 1 10000 | awk '{print $1",'"'"'u"$1"@x.org'"'"',"$1 * 3","$1".5"}' > $LD
+  $CLI LOAD DATA INFILE $LD INTO TABLE ct_hs > /dev/null
+  rm -f $LD
+  $CLI CREATE UNIQUE INDEX ct_hs_e ON ct_hs "(email)" USING HASH > /dev/null
+  $CLI CREATE UNIQUE INDEX ct_hs_n ON ct_hs "(n)"     USING HASH > /dev/null
+  check_reply "hash: FLOAT col" 1 \
+    $($CLI CREATE UNIQUE INDEX ct_hs_f ON ct_hs "(f)" USING HASH | grep -c "USING HASH")
+  check_reply "hash: DESC" 2 $($CLI DESC ct_hs | grep -c "UNIQUE HASH")
+  check_reply "hash: TEXT EQ" "7777" \
+    "$($CLI SELECT id FROM ct_hs WHERE "email = 'u7777@x.org'" | tail -n +2)"
+  check_reply "hash: TEXT EQ none" "" \
+    "$($CLI SELECT id FROM ct_hs WHERE "email = 'u7777@x.orgX'" | tail -n +2)"
+  check_reply "hash: TEXT IN" "5 9" \
+    "$($CLI SELECT id FROM ct_hs WHERE "email IN ('u5@x.org','nope','u9@x.org')" | tail -n +2 | tr '\n' ' ' | sed 's/ $//')"
+  check_reply "hash: INT EQ" "33" \
+    "$($CLI SELECT id FROM ct_hs WHERE "n = 99" | tail -n +2)"
+  check_reply "hash: TEXT range -> BT" 1112 \
+    $($CLI SELECT "COUNT(*)" FROM ct_hs WHERE "email BETWEEN 'u1' AND 'u2'")
+  check_reply "hash: TEXT dup INSERT" 1 \
+    $($CLI INSERT INTO ct_hs VALUES "(20000,'u5@x.org',1,1.0)" | grep -c VIOLATION)
+  check_reply "hash: TEXT dup UPDATE" 1 \
+    $($CLI UPDATE ct_hs SET "email = 'u6@x.org'" WHERE "id = 7" | grep -c VIOLATION)
+  $CLI UPDATE ct_hs SET "email = 'moved'" WHERE "id = 7" > /dev/null
+  $CLI DELETE FROM ct_hs WHERE "email = 'u8@x.org'"       > /dev/null
+  $CLI INSERT INTO ct_hs VALUES "(20000,'u7@x.org',1,1.0)" > /dev/null
+  check_reply "hash: after writes" "7 20000 -" \
+    "$($CLI SELECT id FROM ct_hs WHERE "email = 'moved'" | tail -n +2) $($CLI SELECT id FROM ct_hs WHERE "email = 'u7@x.org'" | tail -n +2) -$($CLI SELECT id FROM ct_hs WHERE "email = 'u8@x.org'" | tail -n +2)"
+  $CLI DEBUG RELOAD > /dev/null
+  check_reply "hash: after RELOAD" "20000 33" \
+    "$($CLI SELECT id FROM ct_hs WHERE "email = 'u7@x.org'" | tail -n +2) $($CLI SELECT id FROM ct_hs WHERE "n = 99" | tail -n +2)"
+  check_reply "hash: dup after RELOAD" 1 \
+    $($CLI INSERT INTO ct_hs VALUES "(20001,'moved',2,1.0)" | grep -c VIOLATION)
+  $CLI DROP   TABLE ct_hs > /dev/null
+}
+
+function test_lru_lfu_flush() {
+  $CLI DROP   TABLE ct_lf > /dev/null
+  $CLI CREATE TABLE ct_lf "(id INT, fk INT, v INT)" > /dev/null
+  $CLI CREATE LFUINDEX ON ct_lf > /dev/null
+  for i in 1 2 3 4; do
+    $CLI INSERT INTO ct_lf "(id, fk, v)" VALUES "($i,1,$i)" > /dev/null
+  done
+  $CLI CONFIG SET lru_lfu_flush_ms 300 > /dev/null
+  check_reply "lru_lfu: CONFIG GET" 300 $($CLI CONFIG GET lru_lfu_flush_ms | tail -1)
+  FL=$(info_field lru_lfu_flushed)
+  $CLI SELECT id FROM ct_lf WHERE "id = 1" > /dev/null
+  for i in 1 2 3 4 5; do $CLI SELECT id FROM ct_lf WHERE "id = 2" > /dev/null; done
+  check_reply "lru_lfu: queued" 2 $(info_field lru_lfu_pending)
+  check_reply "lru_lfu: index untouched" "1 1" \
+    "$($CLI SELECT LFU FROM ct_lf WHERE "id = 1" | tail -1) $($CLI SELECT LFU FROM ct_lf WHERE "id = 2" | tail -1)"
+  sleep 0.7
+  check_reply "lru_lfu: flushed" "0 $((FL + 2))" \
+    "$(info_field lru_lfu_pending) $(info_field lru_lfu_flushed)"
+  check_reply "lru_lfu: LFU after flush" "2 6 1" \
+    "$($CLI SELECT LFU FROM ct_lf WHERE "id = 1" | tail -1) $($CLI SELECT LFU FROM ct_lf WHERE "id = 2" | tail -1) $($CLI SELECT LFU FROM ct_lf WHERE "id = 3" | tail -1)"
+  $CLI CONFIG SET lru_lfu_flush_ms 0 > /dev/null
+  $CLI SELECT id FROM ct_lf WHERE "id = 3" > /dev/null
+  check_reply "lru_lfu: exact mode" "0 2" \
+    "$(info_field lru_lfu_pending) $($CLI SELECT LFU FROM ct_lf WHERE "id = 3" | tail -1)"
+  $CLI DROP   TABLE ct_lf > /dev/null
+}
+
+function test_auto_evict() {
+  $CLI DROP   TABLE ct_ae > /dev/null
+  $CLI CONFIG SET appendonly yes > /dev/null; wait_bg
+  $CLI CREATE TABLE ct_ae "(id INT, a INT, t TEXT)" > /dev/null
+  $CLI CREATE LRUINDEX ON ct_ae > /dev/null
+  LD=$(mktemp /tmp/ct_ae.XXXXXX)
+  seq 1 20000 | awk '{print $1","$1",'"'"'xxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxx"$1"'"'"'"}' > $LD
+  $CLI LOAD DATA INFILE $LD INTO TABLE ct_ae > /dev/null
+  rm -f $LD
+  $CLI ALTER TABLE ct_ae SET DIRTY > /dev/null
+  U=$(info_field used_memory); A=$(info_field alchemy_used_memory)
+  check_reply "auto-evict: used memory not double counted" 1 \
+    $(( A - U < 65536 && U - A < 65536 ))
+  R=$(info_field evict_auto_rows)
+  $CLI CONFIG SET maxmemory $((U - 500000)) > /dev/null
+  sleep 1.5
+  $CLI CONFIG SET maxmemory 0 > /dev/null
+  N=$($CLI SELECT "COUNT(*)" FROM ct_ae WHERE "id BETWEEN 1 AND 20000")
+  check_reply "auto-evict: rows evicted" 1 \
+    $(( $(info_field evict_auto_rows) - R == 20000 - N && N < 20000 ))
+  check_reply "auto-evict: coldest first" "MISS 20000" \
+    "$($CLI SELECT id FROM ct_ae WHERE "id = 1" | grep -c id | sed 's/^0$/MISS/') $($CLI SELECT id FROM ct_ae WHERE "id = 20000" | tail -1)"
+  $CLI DEBUG LOADAOF > /dev/null
+  check_reply "auto-evict: EVICTs replayed from the AOF" $N \
+    $($CLI SELECT "COUNT(*)" FROM ct_ae WHERE "id BETWEEN 1 AND 20000")
+  $CLI CONFIG SET appendonly no > /dev/null
+  $CLI DROP   TABLE ct_ae > /dev/null
+}
+
+function rowstore_populate() { # $1: table, 100 rows, DIRTY
+  $CLI DROP   TABLE $1 > /dev/null
+  $CLI CREATE TABLE $1 "(id INT, a INT, t TEXT)" > /dev/null
+  $CLI CREATE INDEX ${1}_a ON $1 "(a)" > /dev/null
+  LD=$(mktemp /tmp/$1.XXXXXX)
+  seq 1 100 | awk '{print $1","$1 % 10",'"'"'t"$1"'"'"'"}' > $LD
+  $CLI LOAD DATA INFILE $LD INTO TABLE $1 > /dev/null
+  rm -f $LD
+  $CLI ALTER TABLE $1 SET DIRTY > /dev/null
+}
+function test_rowstore() {
+  RSD=$(mktemp -d /tmp/ct_rs.XXXXXX)
+  $CLI CONFIG SET rowstore_dir $RSD > /dev/null
+  $CLI CONFIG SET rowstore_async no > /dev/null
+  rowstore_populate ct_rs
+  W=$(info_field rowstore_writes); F=$(info_field rowstore_faults)
+  check_reply "rowstore: EVICT" 4 $($CLI EVICT ct_rs 5 6 7 50)
+  check_reply "rowstore: rows written" 4 $(( $(info_field rowstore_writes) - W ))
+  check_reply "rowstore: PK fault-in" "5,5,'t5'" \
+    "$($CLI SELECT "*" FROM ct_rs WHERE "id = 5" | tail -1)"
+  check_reply "rowstore: IN fault-in" "6 7" \
+    "$($CLI SELECT id FROM ct_rs WHERE "id IN (6,7)" | tail -n +2 | tr '\n' ' ' | sed 's/ $//')"
+  check_reply "rowstore: PK range fault-in" 21 \
+    $($CLI SELECT "COUNT(*)" FROM ct_rs WHERE "id BETWEEN 40 AND 60")
+  check_reply "rowstore: faults" 4 $(( $(info_field rowstore_faults) - F ))
+  check_reply "rowstore: index restored" 10 \
+    $($CLI SELECT "COUNT(*)" FROM ct_rs WHERE "a = 0")
+  $CLI EVICT ct_rs 9 > /dev/null
+  check_reply "rowstore: FK scan still MISSes" 1 \
+    $($CLI SELECT id FROM ct_rs WHERE "a = 9" | grep -c "^MISS")
+  $CLI CONFIG SET rowstore_dir "" > /dev/null
+  $CLI CONFIG SET rowstore_async yes > /dev/null
+  $CLI DROP   TABLE ct_rs > /dev/null
+  rm -rf $RSD
+}
+
+function test_rowstore_async() {
+  RSD=$(mktemp -d /tmp/ct_ra.XXXXXX)
+  $CLI CONFIG SET rowstore_dir $RSD > /dev/null
+  $CLI CONFIG SET rowstore_async yes > /dev/null
+  rowstore_populate ct_ra
+  $CLI EVICT ct_ra 5 6 7 50 60 > /dev/null
+  A=$(info_field rowstore_async_faults); F=$(info_field rowstore_faults)
+  check_reply "rowstore async: PK" "5,5,'t5'" \
+    "$($CLI SELECT "*" FROM ct_ra WHERE "id = 5" | tail -1)"
+  check_reply "rowstore async: IN" "6 7" \
+    "$($CLI SELECT id FROM ct_ra WHERE "id IN (6,7)" | tail -n +2 | tr '\n' ' ' | sed 's/ $//')"
+  check_reply "rowstore async: PK range" 16 \
+    $($CLI SELECT "COUNT(*)" FROM ct_ra WHERE "id BETWEEN 40 AND 55")
+  check_reply "rowstore async: via the IO thread" "3 4" \
+    "$(( $(info_field rowstore_async_faults) - A )) $(( $(info_field rowstore_faults) - F ))"
+  check_reply "rowstore async: nothing blocked" "0 0" \
+    "$(info_field rowstore_async_inflight) $(info_field rowstore_blocked_clients)"
+  A=$(info_field rowstore_async_faults)
+  check_reply "rowstore async: MULTI reads synchronously" 60 \
+    $(printf 'MULTI\nSELECT id FROM ct_ra WHERE "id = 60"\nEXEC\n' | $CLI | tail -1)
+  check_reply "rowstore async: MULTI not queued" 0 \
+    $(( $(info_field rowstore_async_faults) - A ))
+  $CLI CONFIG SET rowstore_dir "" > /dev/null
+  $CLI DROP   TABLE ct_ra > /dev/null
+  rm -rf $RSD
+}
+
+function test_evict_range() {
+  $CLI CONFIG SET appendonly yes > /dev/null; wait_bg
+  rowstore_populate ct_er
+  check_reply "evict range: rows" 20 $($CLI EVICT ct_er RANGE 20 39)
+  check_reply "evict range: overlapping" 6 $($CLI EVICT ct_er RANGE 30 45)
+  check_reply "evict range: syntax" 1 \
+    $($CLI EVICT ct_er RANGE 50 | grep -c "^ERR SYNTAX")
+  check_reply "evict range: spans merged" 1 $(info_field evict_ranges)
+  check_reply "evict range: MISS" 1 \
+    $($CLI SELECT id FROM ct_er WHERE "id = 25" | grep -c "^MISS")
+  check_reply "evict range: outside" "19 55" \
+    "$($CLI SELECT "COUNT(*)" FROM ct_er WHERE "id BETWEEN 1 AND 19") $($CLI SELECT "COUNT(*)" FROM ct_er WHERE "id BETWEEN 46 AND 100")"
+  $CLI DEBUG LOADAOF > /dev/null
+  check_reply "evict range: AOF replay" "1 55" \
+    "$($CLI SELECT id FROM ct_er WHERE "id = 45" | grep -c "^MISS") $($CLI SELECT "COUNT(*)" FROM ct_er WHERE "id BETWEEN 46 AND 100")"
+  $CLI CONFIG SET appendonly no > /dev/null
+  $CLI DROP   TABLE ct_er > /dev/null
+}
+
+function test_aofrow() {
+  $CLI CONFIG SET appendonly yes > /dev/null; wait_bg
+  $CLI CONFIG SET aof_binary yes > /dev/null
+  local RC=$(info_field aof_row_commands) RR=$(info_field aof_row_records)
+  rowstore_populate ct_ar
+  $CLI UPDATE ct_ar SET "t = 'u'" WHERE "id = 4" > /dev/null
+  $CLI DELETE FROM ct_ar WHERE "id = 100" > /dev/null
+  $CLI DELETE FROM ct_ar WHERE "id BETWEEN 91 AND 99" > /dev/null
+  check_reply "aofrow: rows as records" "4 111" \
+    "$(($(info_field aof_row_commands) - RC)) $(($(info_field aof_row_records) - RR))"
+  $CLI DEBUG LOADAOF > /dev/null
+  check_reply "aofrow: AOF replay" "90 'u' 't5'" \
+    "$($CLI SELECT "COUNT(*)" FROM ct_ar WHERE "id BETWEEN 1 AND 100") $($CLI SELECT t FROM ct_ar WHERE "id = 4" | tail -1) $($CLI SELECT t FROM ct_ar WHERE "id = 5" | tail -1)"
+  check_reply "aofrow: index replay" 9 \
+    $($CLI SELECT "COUNT(*)" FROM ct_ar WHERE "a = 5")
+  $CLI CONFIG SET aof_binary no > /dev/null
+  $CLI CONFIG SET appendonly no > /dev/null
+  $CLI DROP   TABLE ct_ar > /dev/null
+}
+
+function pload_state() { # $1: table
+  echo $($CLI SELECT "COUNT(*)" FROM $1 WHERE "id BETWEEN 1 AND 1000") \
+       $($CLI SELECT "COUNT(*)" FROM $1 WHERE "a = 7") \
+       $($CLI SELECT id FROM $1 WHERE "a = 3" ORDER BY id DESC LIMIT 1 | tail -1)
+}
+function test_rdb_pload() {
+  local T
+  for T in ct_pl1 ct_pl2; do
+    $CLI DROP   TABLE $T > /dev/null
+    $CLI CREATE TABLE $T "(id INT, a INT, t TEXT)" > /dev/null
+    LD=$(mktemp /tmp/$T.XXXXXX)
+    seq 1 1000 | awk '{print $1","$1 % 10",'"'"'t"$1"'"'"'"}' > $LD
+    $CLI LOAD DATA INFILE $LD INTO TABLE $T > /dev/null
+    rm -f $LD
+    $CLI CREATE INDEX ${T}_a ON $T "(a)" > /dev/null
+  done
+  $CLI CREATE UNIQUE INDEX ct_pl2_t ON ct_pl2 "(t)" USING HASH > /dev/null
+  local S1=$(pload_state ct_pl1) S2=$(pload_state ct_pl2)
+  check_reply "rdb pload: before" "1000 100 993 1000 100 993" "$S1 $S2"
+  $CLI CONFIG SET rdb_load_threads 4 > /dev/null
+  local NL=$(info_field rdb_loads) NT=$(info_field rdb_load_parallel_tables)
+  local NI=$(info_field rdb_load_parallel_indexes)
+  $CLI DEBUG RELOAD > /dev/null
+  check_reply "rdb pload: loads" 1 $(($(info_field rdb_loads) - NL))
+  check_reply "rdb pload: tables, plain indexes" "2 2" \
+    "$(($(info_field rdb_load_parallel_tables) - NT)) $(($(info_field rdb_load_parallel_indexes) - NI))"
+  check_reply "rdb pload: after" "$S1 $S2" \
+    "$(pload_state ct_pl1) $(pload_state ct_pl2)"
+  check_reply "rdb pload: HASH UNIQUE" "1 1" \
+    "$($CLI SELECT "COUNT(*)" FROM ct_pl2 WHERE "t = 't77'") $($CLI INSERT INTO ct_pl2 VALUES "(1001, 1, 't77')" | grep -c "^ERR")"
+  $CLI CONFIG SET rdb_load_threads 0 > /dev/null
+  NT=$(info_field rdb_load_parallel_tables)
+  $CLI DEBUG RELOAD > /dev/null
+  check_reply "rdb pload: serial" "0 $S1 $S2" \
+    "$(($(info_field rdb_load_parallel_tables) - NT)) $(pload_state ct_pl1) $(pload_state ct_pl2)"
+  $CLI CONFIG SET rdb_load_threads 4 > /dev/null
+  $CLI DROP   TABLE ct_pl1 > /dev/null
+  $CLI DROP   TABLE ct_pl2 > /dev/null
+}
+
+function persist_state() {
+  echo $($CLI SELECT "COUNT(*)" FROM ct_pi WHERE "a = 7") \
+       $($CLI SELECT id FROM ct_pi WHERE "t = 't77'" | tail -1) \
+       $($CLI SELECT id FROM ct_pi WHERE "a = 3" ORDER BY id DESC LIMIT 1 | tail -1) \
+       $($CLI SELECT "COUNT(*)" FROM ct_pu WHERE "fk = 3") \
+       $($CLI SELECT "COUNT(*)" FROM ct_pu WHERE "fk = 4") \
+       $( ($CLI DESC ct_pi; $CLI DESC ct_pu) | grep -c "PERSIST$")
+}
+function test_index_persist() {
+  $CLI DROP   TABLE ct_pi > /dev/null
+  $CLI DROP   TABLE ct_pu > /dev/null
+  $CLI CREATE TABLE ct_pi "(id INT, a INT, t TEXT)" > /dev/null
+  LD=$(mktemp /tmp/ct_pi.XXXXXX)
+  seq 1 1000 | awk '{print $1","$1 % 10",'"'"'t"$1"'"'"'"}' > $LD
+  $CLI LOAD DATA INFILE $LD INTO TABLE ct_pi > /dev/null
+  rm -f $LD
+  $CLI CREATE INDEX ct_pi_a ON ct_pi "(a)" PERSIST > /dev/null
+  $CLI CREATE INDEX ct_pi_t ON ct_pi "(t)" > /dev/null
+  $CLI ALTER INDEX ct_pi_t SET PERSIST > /dev/null
+  $CLI CREATE TABLE ct_pu "(pk U128, fk INT, c INT)" > /dev/null
+  $CLI CREATE INDEX ct_pu_fk ON ct_pu "(fk)" PERSIST > /dev/null
+  local I
+  for ((I = 1; I <= 300; I++)); do
+    echo "INSERT INTO ct_pu VALUES ($I|$((I * 3)),$((I % 7)),$I)"
+  done | $CLI > /dev/null
+  $CLI DELETE FROM ct_pu WHERE "fk = 4" > /dev/null
+  local S=$(persist_state)
+  check_reply "index persist: before" "100 77 993 43 0 3" "$S"
+  check_reply "index persist: illegal" "1 1" \
+    "$($CLI CREATE INDEX ct_pi_h ON ct_pi "(t)" USING HASH PERSIST | grep -c "^ERR") $($CLI ALTER INDEX ct_pi_id_index SET PERSIST | grep -c "^ERR")"
+  $CLI CONFIG SET rdb_load_threads 4 > /dev/null
+  local NI=$(info_field rdb_load_parallel_indexes)
+  $CLI DEBUG RELOAD > /dev/null
+  check_reply "index persist: not rebuilt" 0 \
+    $(($(info_field rdb_load_parallel_indexes) - NI))
+  check_reply "index persist: after RDB load" "$S" "$(persist_state)"
+  $CLI INSERT INTO ct_pi VALUES "(1001, 7, 't1001')" > /dev/null
+  $CLI INSERT INTO ct_pu VALUES "(1001|3, 4, 1)" > /dev/null
+  check_reply "index persist: writes" "101 1001 1" \
+    "$($CLI SELECT "COUNT(*)" FROM ct_pi WHERE "a = 7") $($CLI SELECT id FROM ct_pi WHERE "t = 't1001'" | tail -1) $($CLI SELECT "COUNT(*)" FROM ct_pu WHERE "fk = 4")"
+  $CLI ALTER INDEX ct_pi_t SET NOPERSIST > /dev/null
+  NI=$(info_field rdb_load_parallel_indexes)
+  $CLI DEBUG RELOAD > /dev/null
+  check_reply "index persist: NOPERSIST rebuilt" "1 2" \
+    "$(($(info_field rdb_load_parallel_indexes) - NI)) $( ($CLI DESC ct_pi; $CLI DESC ct_pu) | grep -c "PERSIST$")"
+  $CLI CONFIG SET appendonly yes > /dev/null; wait_bg
+  $CLI DEBUG LOADAOF > /dev/null
+  check_reply "index persist: AOF rewrite" "2 101 1" \
+    "$( ($CLI DESC ct_pi; $CLI DESC ct_pu) | grep -c "PERSIST$") $($CLI SELECT "COUNT(*)" FROM ct_pi WHERE "a = 7") $($CLI SELECT "COUNT(*)" FROM ct_pu WHERE "fk = 4")"
+  $CLI CONFIG SET appendonly no > /dev/null
+  $CLI DROP   TABLE ct_pi > /dev/null
+  $CLI DROP   TABLE ct_pu > /dev/null
+}
+
+function delta_state() {
+  echo $($CLI SELECT "COUNT(*)" FROM ct_dl WHERE "id BETWEEN 1 AND 2000") \
+       $($CLI SELECT "COUNT(*)" FROM ct_dl WHERE "a = 7") \
+       $($CLI SELECT t FROM ct_dl WHERE "id = 4" | tail -1) \
+       $($CLI SELECT t FROM ct_dl WHERE "id = 5" | tail -1) \
+       $($CLI SELECT "COUNT(*)" FROM ct_dd WHERE "id BETWEEN 1 AND 100")
+}
+function delta_counts() { # rebases deltas loads
+  echo $(($(info_field rdb_delta_rebases) - R0)) \
+       $(($(info_field rdb_delta_deltas) - D0)) \
+       $(($(info_field rdb_delta_loads) - L0))
+}
+function test_rdb_delta() {
+  $CLI DROP   TABLE ct_dl > /dev/null
+  $CLI CREATE TABLE ct_dl "(id INT, a INT, t TEXT)" > /dev/null
+  LD=$(mktemp /tmp/ct_dl.XXXXXX)
+  seq 1 1000 | awk '{print $1","$1 % 10",'"'"'t"$1"'"'"'"}' > $LD
+  $CLI LOAD DATA INFILE $LD INTO TABLE ct_dl > /dev/null
+  rm -f $LD
+  $CLI CREATE INDEX ct_dl_a ON ct_dl "(a)" > /dev/null
+  rowstore_populate ct_dd
+  $CLI CONFIG SET rdb_delta_saves 2 > /dev/null
+  local R0=$(info_field rdb_delta_rebases) D0=$(info_field rdb_delta_deltas)
+  local L0=$(info_field rdb_delta_loads)
+  $CLI SAVE > /dev/null
+  check_reply "rdb delta: REBASE" "1 0 0" "$(delta_counts)"
+  $CLI UPDATE ct_dl SET "t = 'u'" WHERE "id = 4" > /dev/null
+  $CLI DELETE FROM ct_dl WHERE "id BETWEEN 991 AND 1000" > /dev/null
+  $CLI INSERT INTO ct_dl VALUES "(1001, 7, 't1001')" > /dev/null
+  $CLI SAVE > /dev/null
+  check_reply "rdb delta: DELTA" "1 1 0" "$(delta_counts)"
+  $CLI UPDATE ct_dl SET "t = 'v'" WHERE "id = 5" > /dev/null
+  $CLI DEBUG RELOAD > /dev/null
+  check_reply "rdb delta: cumulative DELTA" "1 2 1" "$(delta_counts)"
+  check_reply "rdb delta: BASE + DELTA load" "991 100 'u' 'v' 100" \
+    "$(delta_state)"
+  $CLI SAVE > /dev/null
+  check_reply "rdb delta: REBASE after a load" "2 2 1" "$(delta_counts)"
+  $CLI DELETE FROM ct_dl WHERE "id = 4" > /dev/null
+  $CLI BGREBASE > /dev/null; wait_bg
+  check_reply "rdb delta: BGREBASE" "3 2 1" "$(delta_counts)"
+  $CLI DEBUG RELOAD > /dev/null
+  check_reply "rdb delta: BGREBASE load" "3 3 2 990 2 98" \
+    "$(delta_counts) $($CLI SELECT "COUNT(*)" FROM ct_dl WHERE "id BETWEEN 1 AND 2000") $($CLI SELECT "COUNT(*)" FROM ct_dl WHERE "id BETWEEN 3 AND 5") $($CLI SELECT "COUNT(*)" FROM ct_dl WHERE "a = 4")"
+  $CLI CONFIG SET rdb_delta_saves 0 > /dev/null
+  $CLI SAVE > /dev/null
+  check_reply "rdb delta: off" "0 1" \
+    "$(info_field rdb_delta_base) $($CLI BGREBASE | grep -c "^ERR")"
+  $CLI DROP   TABLE ct_dl > /dev/null
+  $CLI DROP   TABLE ct_dd > /dev/null
+}
+
+function mmap_state() {
+  echo $($CLI SELECT t FROM ct_mm WHERE "id = 500" | tail -1) \
+       $($CLI SELECT "COUNT(*)" FROM ct_mm WHERE "id BETWEEN 101 AND 350") \
+       $($CLI SCAN id FROM ct_mm | grep -c "^[0-9]") \
+       $($CLI SELECT "COUNT(*)" FROM ct_mm WHERE "a = 7")
+}
+function test_mmap_table() {
+  local MMF=$(mktemp /tmp/ct_mm.XXXXXX)
+  $CLI DROP   TABLE ct_mm > /dev/null
+  rowstore_populate ct_ms
+  check_reply "mmap: DIRTY refused" 1 \
+    $($CLI DUMP ct_ms TO MMAP $MMF | grep -c "^ERR")
+  $CLI DROP   TABLE ct_ms > /dev/null
+  $CLI CREATE TABLE ct_ms "(id INT, a INT, t TEXT)" > /dev/null
+  LD=$(mktemp /tmp/ct_ms.XXXXXX)
+  seq 1 1000 | awk '{print $1","$1 % 10",'"'"'t"$1"'"'"'"}' > $LD
+  $CLI LOAD DATA INFILE $LD INTO TABLE ct_ms > /dev/null
+  rm -f $LD
+  check_reply "mmap: DUMP" 1 \
+    $($CLI DUMP ct_ms TO MMAP $MMF | grep -c "^SUCCESS: MMAPED: 1000 rows")
+  $CLI DROP   TABLE ct_ms > /dev/null
+  check_reply "mmap: CREATE FROM MMAP" OK \
+    $($CLI CREATE TABLE ct_mm FROM MMAP $MMF)
+  $CLI CREATE INDEX ct_mm_a ON ct_mm "(a)" > /dev/null
+  local S=$(mmap_state)
+  check_reply "mmap: in place" "'t500' 250 1000 100" "$S"
+  check_reply "mmap: read-only" "1 1 1" \
+    "$($CLI INSERT INTO ct_mm VALUES "(1001, 1, 'x')" | grep -c "^ERR") $($CLI UPDATE ct_mm SET "a = 1" WHERE "id = 4" | grep -c "^ERR") $($CLI DELETE FROM ct_mm WHERE "id = 4" | grep -c "^ERR")"
+  $CLI DEBUG RELOAD > /dev/null
+  check_reply "mmap: RDB load" "$S 1" \
+    "$(mmap_state) $($CLI DESC ct_mm | grep -c "^MMAP: \[FILE: $MMF")"
+  $CLI CONFIG SET appendonly yes > /dev/null; wait_bg
+  $CLI DEBUG LOADAOF > /dev/null
+  check_reply "mmap: AOF replay" "$S" "$(mmap_state)"
+  $CLI CONFIG SET appendonly no > /dev/null
+  $CLI DROP   TABLE ct_mm > /dev/null
+  rm -f $MMF
+}
+
+function checked_tests() {
+  CHECK_FAILS=0
+  test_sort_spill
+  test_orderby_nkey
+  test_filter_program
+  test_in_not_in
+  test_aggregates
+  test_plan_cache
+  test_prepare_execute_checked
+  test_bexecute
+  test_where_lexer
+  test_multi_insert
+  test_index_background
+  test_index_include
+  test_index_partial_expr
+  test_index_bitmap
+  test_index_hash
+  test_lru_lfu_flush
+  test_auto_evict
+  test_rowstore
+  test_rowstore_async
+  test_evict_range
+  test_aofrow
+  test_rdb_pload
+  test_index_persist
+  test_rdb_delta
+  test_mmap_table
+  echo "checked_tests: FAILURES: $CHECK_FAILS"
+}
@@ -473,6 +473,9 @@ void freeClient(redisClient *c) {
     c->querybuf = NULL;
     if (c->flags & REDIS_BLOCKED)
         unblockClientWaitingData(c);
+#ifdef ALCHEMY_DATABASE
+    DXDB_freeClient(c);
+#endif
 
     /* UNWATCH all the keys */
     unwatchAllKeys(c);
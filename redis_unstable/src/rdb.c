@@ -420,12 +420,18 @@ int rdbSave(char *filename) {
         cacheForcePointInTime();
         return dsRdbSave(filename);
     }
+#ifdef ALCHEMY_DATABASE
+    DXDB_rdbSaveBegin(); /* no-op in BGSAVE's child */
+#endif
 
     snprintf(tmpfile,256,"temp-%d.rdb", (int) getpid());
     fp = fopen(tmpfile,"w");
     if (!fp) {
         redisLog(REDIS_WARNING, "Failed opening .rdb for saving: %s",
             strerror(errno));
+#ifdef ALCHEMY_DATABASE
+        DXDB_rdbSaveDone(0);
+#endif
         return REDIS_ERR;
     }
     if (fwrite("REDIS0002",9,1,fp) == 0) goto werr;
@@ -439,6 +445,9 @@ int rdbSave(char *filename) {
         di = dictGetSafeIterator(d);
         if (!di) {
             fclose(fp);
+#ifdef ALCHEMY_DATABASE
+            DXDB_rdbSaveDone(0);
+#endif
             return REDIS_ERR;
         }
 
@@ -471,11 +480,17 @@ int rdbSave(char *filename) {
     if (rename(tmpfile,filename) == -1) {
         redisLog(REDIS_WARNING,"Error moving temp DB file on the final destination: %s", strerror(errno));
         unlink(tmpfile);
+#ifdef ALCHEMY_DATABASE
+        DXDB_rdbSaveDone(0);
+#endif
         return REDIS_ERR;
     }
     redisLog(REDIS_NOTICE,"DB saved on disk");
     server.dirty = 0;
     server.lastsave = time(NULL);
+#ifdef ALCHEMY_DATABASE
+    DXDB_rdbSaveDone(1);
+#endif
     return REDIS_OK;
 
 werr:
@@ -483,6 +498,9 @@ werr:
     unlink(tmpfile);
     redisLog(REDIS_WARNING,"Write error saving DB on disk: %s", strerror(errno));
     if (di) dictReleaseIterator(di);
+#ifdef ALCHEMY_DATABASE
+    DXDB_rdbSaveDone(0);
+#endif
     return REDIS_ERR;
 }
 
@@ -501,6 +519,9 @@ int rdbSaveBackground(char *filename) {
     }
 
     start = ustime();
+#ifdef ALCHEMY_DATABASE
+    DXDB_rdbSaveBegin(); /* the child inherits the DELTA save mode */
+#endif
     if ((childpid = fork()) == 0) {
         int retval;
 
@@ -515,6 +536,9 @@ int rdbSaveBackground(char *filename) {
         if (childpid == -1) {
             redisLog(REDIS_WARNING,"Can't save in background: fork: %s",
                 strerror(errno));
+#ifdef ALCHEMY_DATABASE
+            DXDB_rdbSaveDone(0);
+#endif
             return REDIS_ERR;
         }
         redisLog(REDIS_NOTICE,"Background saving started by pid %d",childpid);
@@ -1021,6 +1045,9 @@ void backgroundSaveDoneHandler(int exitcode, int bysignal) {
             "Background saving terminated by signal %d", bysignal);
         rdbRemoveTempFile(server.bgsavechildpid);
     }
+#ifdef ALCHEMY_DATABASE
+    DXDB_rdbSaveDone(!bysignal && exitcode == 0);
+#endif
     server.bgsavechildpid = -1;
     server.bgsavethread = (pthread_t) -1;
     server.bgsavethread_state = REDIS_BGSAVE_THREAD_UNACTIVE;
@@ -1102,6 +1102,9 @@ struct redisCommand *lookupCommandByCString(char *s) {
 void call(redisClient *c, struct redisCommand *cmd) {
     long long dirty, start = ustime();
 
+#ifdef ALCHEMY_DATABASE
+    DXDB_call_begin();
+#endif
     dirty = server.dirty;
     cmd->proc(c);
     dirty = server.dirty-dirty;
@@ -1119,6 +1122,9 @@ void call(redisClient *c, struct redisCommand *cmd) {
     if (listLength(server.monitors))
         replicationFeedMonitors(server.monitors,c->db->id,c->argv,c->argc);
     server.stat_numcommands++;
+#ifdef ALCHEMY_DATABASE
+    DXDB_call_end();
+#endif
 }
 
 /* If this function gets called we already read a whole
@@ -1241,6 +1247,9 @@ int processCommand(redisClient *c) {
         if (server.ds_enabled && blockClientOnSwappedKeys(c,cmd))
             return REDIS_ERR;
         call(c,cmd);
+#ifdef ALCHEMY_DATABASE
+        if (c->RsWait) return REDIS_ERR; /* blocked on ROWSTORE, keep argv */
+#endif
     }
     return REDIS_OK;
 }
@@ -1639,7 +1648,7 @@ sds genRedisInfoString(char *section) {
 
 #ifdef ALCHEMY_DATABASE
     if (allsections || defsections || !strcasecmp(section, "alchemy")) {
-        DBXD_genRedisInfoString(info);
+        info = DBXD_genRedisInfoString(info);
     }
 #endif
     /* Key space */
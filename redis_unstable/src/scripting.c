@@ -178,6 +178,7 @@ int luaRedisCommand(lua_State *lua) {
     long long dirty         = server.dirty, start = ustime();;
     uchar     o_outputmode  = server.alc.OutputMode;
     server.alc.OutputMode   = OUTPUT_PURE_REDIS; // best output mode for LUA tables
+    DXDB_call_begin();
 #endif
     c->argv = argv;
     c->argc = argc;
@@ -193,6 +194,7 @@ int luaRedisCommand(lua_State *lua) {
     if ((dirty || cmd->flags & REDIS_CMD_FORCE_REPLICATION) &&
         listLength(server.slaves))
         replicationFeedSlaves(server.slaves,c->db->id,c->argv,c->argc);
+    DXDB_call_end();
 #endif
 
 
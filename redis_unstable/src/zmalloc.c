@@ -98,6 +98,10 @@ void increment_used_memory(size_t size) {
 void decrement_used_memory(size_t size) {
     update_zmalloc_stat_free(size);
 }
+/* returns the previous setting (threads that come & go restore it) */
+int zmalloc_set_thread_safeness(int on) {
+    int old = zmalloc_thread_safe; zmalloc_thread_safe = on; return old;
+}
 #endif
 
 static void zmalloc_oom(size_t size) {
@@ -69,6 +69,7 @@
 #ifdef ALCHEMY_DATABASE
 void increment_used_memory(size_t size);
 void decrement_used_memory(size_t size);
+int  zmalloc_set_thread_safeness(int on);
 #endif
 
 void *zmalloc(size_t size);